@@ -0,0 +1,538 @@
+/*
+ * aiding.c -- keep what a receiver has told us about the sky, so we
+ * can tell it back on the next start.
+ *
+ * Ephemerides, almanac pages and the ionosphere/UTC page are collected
+ * from decoded subframes as raw navigation-message words, and the last
+ * 3D fix is kept alongside.  The lot is checkpointed to a small text
+ * file now and then and at exit; drivers that know how to aid their
+ * receiver push it on activation, which turns a cold start into a
+ * warm or hot one.
+ *
+ * Store file format, one record per line, fields blank-separated:
+ *
+ *	EPH <prn> <collected> <how> <24 hex words: subframes 1-3, words 3-10>
+ *	ALM <prn> <collected> <week> <8 hex words: words 3-10>
+ *	ION <collected> <8 hex words: subframe 4 page 18, words 3-10>
+ *	POS <time> <lat> <lon> <alt>
+ *	CYC <collected> <period> <quiet> <ender> <offset> <spread>
+ *	    <32 hex bytes: core sentence counts> <device> <driver>;<subtype>
+ *
+ * Times are Unix seconds from the system clock at collection.  CYC
+ * records are learned NMEA reporting cycles (see driver_nmea.c), with
+ * their durations in seconds; the receiver identity runs to the end of
+ * the line.
+ *
+ * This file is Copyright (c) 2010 by the GPSD project
+ * BSD terms apply: see the file COPYING in the distribution root for details.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <math.h>
+#include <time.h>
+#include <limits.h>
+#include <fcntl.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#ifndef S_SPLINT_S
+#include <unistd.h>
+#endif /* S_SPLINT_S */
+
+#include "gpsd.h"
+
+#ifdef AIDING_ENABLE
+
+#define GPS_EPOCH	315964800	/* 1980-01-06 in Unix time */
+#define SECS_PER_WEEK	(60*60*24*7)
+
+bool aiding_gpstime(const struct gps_context_t *context,
+		    /*@out@*/unsigned int *week, /*@out@*/double *tow)
+/* GPS week and time of week now, from the system clock */
+{
+    struct timeval tv;
+    double gpstime;
+
+    *week = 0;
+    *tow = 0;
+    (void)gettimeofday(&tv, NULL);
+    /* a clock that hasn't been set isn't worth telling a receiver about */
+    if (tv.tv_sec < GPS_EPOCH + 30 * 365 * 86400)
+	return false;
+    gpstime = (double)(tv.tv_sec - GPS_EPOCH + context->leap_seconds)
+	+ tv.tv_usec / 1e6;
+    *week = (unsigned int)(gpstime / SECS_PER_WEEK);
+    *tow = gpstime - (double)*week * SECS_PER_WEEK;
+    return true;
+}
+
+static void aiding_checkpoint(struct gps_context_t *context)
+/* save the store if it has changed and we haven't saved lately */
+{
+    struct aiding_t *store = &context->aiding;
+
+    if (store->path != NULL && store->dirty
+	&& timestamp() - store->saved >= AIDING_SAVE_INTERVAL)
+	(void)aiding_save(context);
+}
+
+void aiding_subframe(struct gps_context_t *context,
+		     unsigned int tSVID, uint32_t words[])
+/* collect what we can use from a parity-checked subframe */
+{
+    struct aiding_t *store = &context->aiding;
+    unsigned int subframe = (words[1] >> 2) & 0x07;
+    unsigned int pageid, i;
+    uint32_t data[8];
+    time_t now = time(NULL);
+    unsigned int week;
+    double tow;
+
+    for (i = 0; i < 8; i++)
+	data[i] = words[i + 2] & 0xffffff;
+    pageid = (data[0] >> 16) & 0x3f;
+
+    switch (subframe) {
+    case 1:
+    case 2:
+    case 3:
+	if (tSVID < 1 || tSVID > AIDING_SVS)
+	    return;
+	else {
+	    /*@-type@*/
+	    unsigned int iodc, iode2, iode3;
+	    unsigned int prn = tSVID - 1;
+
+	    (void)memcpy(store->eph[prn].pending[subframe - 1], data,
+			 sizeof(data));
+	    if (subframe == 1)
+		store->eph[prn].how = words[1] & 0xffffff;
+	    store->eph[prn].have |= 1u << (subframe - 1);
+	    if (store->eph[prn].have != 0x07)
+		return;
+	    /*
+	     * An upload can land between subframes; only keep a set whose
+	     * issue-of-data fields all match.  Otherwise wait for the
+	     * next subframe to replace the stale one.
+	     */
+	    iodc = (store->eph[prn].pending[0][5] >> 16) & 0xff;
+	    iode2 = (store->eph[prn].pending[1][0] >> 16) & 0xff;
+	    iode3 = (store->eph[prn].pending[2][7] >> 16) & 0xff;
+	    if (iodc != iode2 || iodc != iode3)
+		return;
+	    (void)memcpy(store->eph[prn].words, store->eph[prn].pending,
+			 sizeof(store->eph[prn].words));
+	    store->eph[prn].collected = now;
+	    store->eph[prn].have = 0;
+	    gpsd_report(LOG_PROG, "aiding: ephemeris for PRN %u, IODE %u\n",
+			tSVID, iodc);
+	    /*@+type@*/
+	}
+	break;
+    case 4:
+	if (pageid == 56) {
+	    (void)memcpy(store->ionoutc.words, data, sizeof(data));
+	    store->ionoutc.collected = now;
+	    break;
+	}
+	if (pageid < 25 || pageid > 32)
+	    return;
+	/*@fallthrough@*/
+    case 5:
+	/* almanac pages carry the SV ID of the satellite they describe */
+	if (pageid < 1 || pageid > AIDING_SVS)
+	    return;
+	(void)memcpy(store->alm[pageid - 1].words, data, sizeof(data));
+	store->alm[pageid - 1].collected = now;
+	if (aiding_gpstime(context, &week, &tow))
+	    store->alm[pageid - 1].week = week;
+	break;
+    default:
+	return;
+    }
+    store->dirty = true;
+    aiding_checkpoint(context);
+}
+
+void aiding_fix(struct gps_device_t *session)
+/* remember the last good 3D position */
+{
+    struct aiding_t *store = &session->context->aiding;
+    struct gps_fix_t *fix = &session->gpsdata.fix;
+
+    if (fix->mode != MODE_3D || isnan(fix->latitude) != 0
+	|| isnan(fix->longitude) != 0 || isnan(fix->altitude) != 0)
+	return;
+    store->position.time = time(NULL);
+    store->position.lat = fix->latitude;
+    store->position.lon = fix->longitude;
+    store->position.alt = fix->altitude;
+    store->dirty = true;
+    aiding_checkpoint(session->context);
+}
+
+bool aiding_save(struct gps_context_t *context)
+/* write the store out; a new file is renamed over the old one */
+{
+    struct aiding_t *store = &context->aiding;
+    char tmp[PATH_MAX];
+    bool replace = true;
+    FILE *fp;
+    int i, j;
+
+    if (store->path == NULL)
+	return false;
+    store->saved = timestamp();
+    (void)snprintf(tmp, sizeof(tmp), "%s.tmp", store->path);
+    if ((fp = fopen(tmp, "w")) == NULL && errno == EACCES) {
+	/* we've dropped privileges and can't write the directory */
+	replace = false;
+	fp = fopen(store->path, "w");
+    }
+    if (fp == NULL) {
+	gpsd_report(LOG_WARN, "aiding: can't write %s: %s\n",
+		    replace ? tmp : store->path, strerror(errno));
+	return false;
+    }
+    (void)fprintf(fp, "# gpsd aiding store\n");
+    for (i = 0; i < AIDING_SVS; i++) {
+	if (store->eph[i].collected == 0)
+	    continue;
+	(void)fprintf(fp, "EPH %d %ld %06x", i + 1,
+		      (long)store->eph[i].collected, store->eph[i].how);
+	for (j = 0; j < 24; j++)
+	    (void)fprintf(fp, " %06x", store->eph[i].words[j / 8][j % 8]);
+	(void)fputc('\n', fp);
+    }
+    for (i = 0; i < AIDING_SVS; i++) {
+	if (store->alm[i].collected == 0)
+	    continue;
+	(void)fprintf(fp, "ALM %d %ld %u", i + 1,
+		      (long)store->alm[i].collected, store->alm[i].week);
+	for (j = 0; j < 8; j++)
+	    (void)fprintf(fp, " %06x", store->alm[i].words[j]);
+	(void)fputc('\n', fp);
+    }
+    if (store->ionoutc.collected != 0) {
+	(void)fprintf(fp, "ION %ld", (long)store->ionoutc.collected);
+	for (j = 0; j < 8; j++)
+	    (void)fprintf(fp, " %06x", store->ionoutc.words[j]);
+	(void)fputc('\n', fp);
+    }
+    if (store->position.time != 0)
+	(void)fprintf(fp, "POS %ld %.9f %.9f %.3f\n",
+		      (long)store->position.time,
+		      store->position.lat, store->position.lon,
+		      store->position.alt);
+#ifdef NMEA_ENABLE
+    for (i = 0; i < AIDING_CYCLES; i++) {
+	if (store->cycle[i].collected == 0)
+	    continue;
+	(void)fprintf(fp, "CYC %ld %.4f %.4f %u %.4f %.4f ",
+		      (long)store->cycle[i].collected,
+		      store->cycle[i].period, store->cycle[i].quiet,
+		      store->cycle[i].ender,
+		      store->cycle[i].offset, store->cycle[i].spread);
+	for (j = 0; j < NMEA_CYCLE_TAGS; j++)
+	    (void)fprintf(fp, "%02x", store->cycle[i].core[j]);
+	(void)fprintf(fp, " %s %s\n",
+		      store->cycle[i].device, store->cycle[i].receiver);
+    }
+#endif /* NMEA_ENABLE */
+    if (fclose(fp) != 0 || (replace && rename(tmp, store->path) != 0)) {
+	gpsd_report(LOG_WARN, "aiding: can't save %s: %s\n",
+		    store->path, strerror(errno));
+	if (replace)
+	    (void)unlink(tmp);
+	return false;
+    }
+    store->dirty = false;
+    gpsd_report(LOG_PROG, "aiding: saved %s\n", store->path);
+    return true;
+}
+
+static bool aiding_hexwords(char *cp, uint32_t *words, int n)
+/* parse n blank-separated hex words */
+{
+    int i;
+
+    for (i = 0; i < n; i++) {
+	char *end;
+	unsigned long w = strtoul(cp, &end, 16);
+
+	if (end == cp || w > 0xffffff)
+	    return false;
+	words[i] = (uint32_t)w;
+	cp = end;
+    }
+    return true;
+}
+
+#ifdef NMEA_ENABLE
+static bool aiding_cycle_parse(char *line, struct aiding_t *store, int slot)
+/* parse a CYC record into a cycle slot */
+{
+    long collected;
+    unsigned int ender, byte;
+    char core[2 * NMEA_CYCLE_TAGS + 1], *receiver;
+    int i, n;
+
+    if (slot >= AIDING_CYCLES
+	|| sscanf(line, "CYC %ld %lf %lf %u %lf %lf %64s %63s %n",
+		  &collected, &store->cycle[slot].period,
+		  &store->cycle[slot].quiet, &ender,
+		  &store->cycle[slot].offset, &store->cycle[slot].spread,
+		  core, store->cycle[slot].device, &n) != 8
+	|| strlen(core) != sizeof(core) - 1 || ender >= NMEA_CYCLE_TAGS)
+	return false;
+    for (i = 0; i < NMEA_CYCLE_TAGS; i++) {
+	if (sscanf(core + 2 * i, "%2x", &byte) != 1)
+	    return false;
+	store->cycle[slot].core[i] = (unsigned char)byte;
+    }
+    if (store->cycle[slot].core[ender] == 0)
+	return false;
+    receiver = line + n;
+    receiver[strcspn(receiver, "\r\n")] = '\0';
+    (void)strlcpy(store->cycle[slot].receiver, receiver,
+		  sizeof(store->cycle[slot].receiver));
+    store->cycle[slot].ender = ender;
+    store->cycle[slot].collected = (time_t)collected;
+    return true;
+}
+#endif /* NMEA_ENABLE */
+
+static /*@null@*/char *aiding_abspath(const char *path)
+/* absolute form of a path whose directory, but not file, has to exist */
+{
+    char dir[PATH_MAX], resolved[PATH_MAX];
+    const char *base = strrchr(path, '/');
+    char *full;
+    size_t len;
+
+    if (base == NULL) {
+	(void)strlcpy(dir, ".", sizeof(dir));
+	base = path;
+    } else {
+	len = (size_t)(base - path);
+	if (len == 0)
+	    len = 1;		/* a file in the root directory */
+	if (len >= sizeof(dir))
+	    return NULL;
+	(void)memcpy(dir, path, len);
+	dir[len] = '\0';
+	base++;
+    }
+    if (realpath(dir, resolved) == NULL)
+	return NULL;
+    len = strlen(resolved) + strlen(base) + 2;
+    if ((full = (char *)malloc(len)) != NULL)
+	(void)snprintf(full, len, "%s/%s",
+		       strcmp(resolved, "/") == 0 ? "" : resolved, base);
+    return full;
+}
+
+bool aiding_load(struct gps_context_t *context, const char *path)
+/* attach the store to a file, reading what's there already */
+{
+    struct aiding_t *store = &context->aiding;
+    char line[BUFSIZ];
+    FILE *fp;
+    int lineno = 0, loaded = 0, cycles = 0;
+
+    /* the daemon changes to / when it goes into the background */
+    if ((store->path = aiding_abspath(path)) == NULL) {
+	gpsd_report(LOG_WARN, "aiding: can't resolve %s: %s\n",
+		    path, strerror(errno));
+	store->path = path;
+    }
+    path = store->path;
+    store->saved = timestamp();
+    if ((fp = fopen(path, "r")) == NULL) {
+	gpsd_report(errno == ENOENT ? LOG_INF : LOG_WARN,
+		    "aiding: can't read %s: %s\n", path, strerror(errno));
+	return false;
+    }
+    while (fgets(line, (int)sizeof(line), fp) != NULL) {
+	int prn, n;
+	long collected;
+	unsigned int how;
+	uint32_t words[24];
+	bool ok = false;
+
+	lineno++;
+	if (line[0] == '#' || line[0] == '\n')
+	    continue;
+	if (sscanf(line, "EPH %d %ld %x%n", &prn, &collected, &how, &n) == 3
+	    && prn >= 1 && prn <= AIDING_SVS
+	    && aiding_hexwords(line + n, words, 24)) {
+	    store->eph[prn - 1].collected = (time_t)collected;
+	    store->eph[prn - 1].how = how;
+	    (void)memcpy(store->eph[prn - 1].words, words,
+			 sizeof(store->eph[prn - 1].words));
+	    ok = true;
+	} else if (sscanf(line, "ALM %d %ld %u%n", &prn, &collected, &how, &n) == 3
+	    && prn >= 1 && prn <= AIDING_SVS
+	    && aiding_hexwords(line + n, words, 8)) {
+	    store->alm[prn - 1].collected = (time_t)collected;
+	    store->alm[prn - 1].week = how;
+	    (void)memcpy(store->alm[prn - 1].words, words,
+			 sizeof(store->alm[prn - 1].words));
+	    ok = true;
+	} else if (sscanf(line, "ION %ld%n", &collected, &n) == 1
+	    && aiding_hexwords(line + n, words, 8)) {
+	    store->ionoutc.collected = (time_t)collected;
+	    (void)memcpy(store->ionoutc.words, words,
+			 sizeof(store->ionoutc.words));
+	    ok = true;
+	} else if (sscanf(line, "POS %ld %lf %lf %lf",
+			  &collected, &store->position.lat,
+			  &store->position.lon, &store->position.alt) == 4) {
+	    store->position.time = (time_t)collected;
+	    ok = true;
+	}
+#ifdef NMEA_ENABLE
+	else if (strncmp(line, "CYC ", 4) == 0
+	    && aiding_cycle_parse(line, store, cycles)) {
+	    cycles++;
+	    ok = true;
+	}
+#endif /* NMEA_ENABLE */
+	if (ok)
+	    loaded++;
+	else
+	    gpsd_report(LOG_WARN, "aiding: %s:%d: bad record\n",
+			path, lineno);
+    }
+    (void)fclose(fp);
+    gpsd_report(LOG_INF, "aiding: %d records from %s\n", loaded, path);
+    return true;
+}
+
+#ifdef NMEA_ENABLE
+static void aiding_receiver(const struct gps_device_t *session,
+			    /*@out@*/char *buf, size_t len)
+/* the receiver identity a cycle model is filed under */
+{
+    (void)snprintf(buf, len, "%s;%s",
+		   session->nmea_cycle.driver != NULL ?
+		   session->nmea_cycle.driver->type_name : "",
+		   session->nmea_cycle.subtype);
+}
+
+void aiding_cycle_save(struct gps_device_t *session)
+/* file a device's learned NMEA reporting cycle in the store */
+{
+    struct aiding_t *store = &session->context->aiding;
+    char receiver[sizeof(store->cycle[0].receiver)];
+    unsigned int ender = session->nmea_cycle.ender;
+    int i, slot = 0;
+
+    aiding_receiver(session, receiver, sizeof(receiver));
+    for (i = 0; i < AIDING_CYCLES; i++) {
+	if (strcmp(store->cycle[i].device, session->gpsdata.dev.path) == 0
+	    && strcmp(store->cycle[i].receiver, receiver) == 0) {
+	    slot = i;
+	    break;
+	}
+	if (store->cycle[i].collected < store->cycle[slot].collected)
+	    slot = i;
+    }
+    if (i == AIDING_CYCLES) {
+	/* a new one takes a free slot, or the longest unused one */
+	(void)memset(&store->cycle[slot], '\0', sizeof(store->cycle[slot]));
+	(void)strlcpy(store->cycle[slot].device, session->gpsdata.dev.path,
+		      sizeof(store->cycle[slot].device));
+	(void)strlcpy(store->cycle[slot].receiver, receiver,
+		      sizeof(store->cycle[slot].receiver));
+	store->dirty = true;
+    } else if (store->cycle[slot].ender != ender
+	       || memcmp(store->cycle[slot].core, session->nmea_cycle.core,
+			 sizeof(store->cycle[slot].core)) != 0)
+	store->dirty = true;
+    /* timing alone drifts all the time and isn't worth a save */
+    (void)memcpy(store->cycle[slot].core, session->nmea_cycle.core,
+		 sizeof(store->cycle[slot].core));
+    store->cycle[slot].ender = ender;
+    store->cycle[slot].period = session->nmea_cycle.period;
+    store->cycle[slot].quiet = session->nmea_cycle.quiet;
+    store->cycle[slot].offset = session->nmea_cycle.offset[ender];
+    store->cycle[slot].spread = session->nmea_cycle.spread[ender];
+    store->cycle[slot].collected = time(NULL);
+    aiding_checkpoint(session->context);
+}
+
+bool aiding_cycle_restore(struct gps_device_t *session)
+/* start a device's NMEA cycle model from what was learned before */
+{
+    struct aiding_t *store = &session->context->aiding;
+    char receiver[sizeof(store->cycle[0].receiver)];
+    int i, j;
+
+    aiding_receiver(session, receiver, sizeof(receiver));
+    for (i = 0; i < AIDING_CYCLES; i++)
+	if (store->cycle[i].collected != 0
+	    && strcmp(store->cycle[i].device, session->gpsdata.dev.path) == 0
+	    && strcmp(store->cycle[i].receiver, receiver) == 0) {
+	    unsigned int ender = store->cycle[i].ender;
+
+	    /* as if the core had turned up in every epoch remembered */
+	    for (j = 0; j < NMEA_CYCLE_DEPTH; j++)
+		(void)memcpy(session->nmea_cycle.history[j],
+			     store->cycle[i].core,
+			     sizeof(session->nmea_cycle.history[j]));
+	    (void)memcpy(session->nmea_cycle.core, store->cycle[i].core,
+			 sizeof(session->nmea_cycle.core));
+	    session->nmea_cycle.ender = ender;
+	    session->nmea_cycle.locked = true;
+	    session->nmea_cycle.epochs = NMEA_CYCLE_DEPTH;
+	    session->nmea_cycle.period = store->cycle[i].period;
+	    session->nmea_cycle.quiet = store->cycle[i].quiet;
+	    session->nmea_cycle.offset[ender] = (float)store->cycle[i].offset;
+	    session->nmea_cycle.spread[ender] = (float)store->cycle[i].spread;
+	    return true;
+	}
+    return false;
+}
+#endif /* NMEA_ENABLE */
+
+void aiding_own(struct gps_context_t *context, uid_t uid, gid_t gid)
+/* create the store file if need be, and hand it to the given user */
+{
+    const char *path = context->aiding.path;
+    const char *refusal = NULL;
+    struct stat sb;
+    int fd;
+
+    if (path == NULL)
+	return;
+    /*
+     * We're still root here, and the user we're about to become may be
+     * able to write the store's directory; it has to, for the store to
+     * be replaced on save.  So whatever is at the path may have been
+     * put there to get some other file chowned.  Don't follow a
+     * symlink, don't block on a FIFO, and only take a plain file with
+     * no other names that belongs to root or the user already.
+     */
+    if ((fd = open(path, O_WRONLY | O_CREAT | O_NOFOLLOW | O_NONBLOCK,
+		   0644)) == -1 || fstat(fd, &sb) == -1)
+	refusal = strerror(errno);
+    else if (!S_ISREG(sb.st_mode))
+	refusal = "not a regular file";
+    else if (sb.st_nlink != 1)
+	refusal = "file has other links";
+    else if (sb.st_uid != 0 && sb.st_uid != uid)
+	refusal = "file belongs to another user";
+    else if ((sb.st_uid != uid || sb.st_gid != gid)
+	     && fchown(fd, uid, gid) == -1)
+	refusal = strerror(errno);
+    if (refusal != NULL)
+	gpsd_report(LOG_WARN, "aiding: won't hand %s to uid %d: %s\n",
+		    path, (int)uid, refusal);
+    if (fd != -1)
+	(void)close(fd);
+}
+
+#endif /* AIDING_ENABLE */
@@ -114,6 +114,8 @@ int json_ais_read(const char *buf,
 	}
     } else if (strstr(buf, "\"type\":6,") != NULL) {
 	bool imo = false;
+	/* whatever the daemon sent is as decoded as it will get */
+	ais->type6.raw = false;
 	if (strstr(buf, "\"dac\":1,") != NULL) {
 	    if (strstr(buf, "\"fid\":12,") != NULL) {
 		status = json_read_object(buf, json_ais6_fid12, endptr);
@@ -214,6 +216,8 @@ int json_ais_read(const char *buf,
 	status = json_read_object(buf, json_ais7, endptr);
     } else if (strstr(buf, "\"type\":8,") != NULL) {
 	bool imo = false;
+	/* whatever the daemon sent is as decoded as it will get */
+	ais->type8.raw = false;
 	if (strstr(buf, "\"dac\":1,") != NULL) {
 	    if (strstr(buf, "\"fid\":13,") != NULL) {
 		status = json_read_object(buf, json_ais8_fid13, endptr);
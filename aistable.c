@@ -0,0 +1,496 @@
+/*
+ * aistable.c -- the daemon's picture of the AIS traffic it is hearing
+ *
+ * Every decoded AIS report is folded into a per-MMSI vessel record
+ * holding the latest position report and the latest static and voyage
+ * data, with the time it was last heard and the path of the device it
+ * was heard on.  Clients can ask for the whole picture with ?AIS, or
+ * watch with "vessels" set to get a VESSEL report only when a message
+ * actually changed a record.
+ *
+ * The records live in a fixed open-addressing hash table keyed by MMSI,
+ * with linear probing and backward-shift deletion, so lookups never walk
+ * over tombstones.  Vessels not heard from in AIS_VESSEL_TIMEOUT seconds
+ * are swept out now and then; if the table still fills up, the vessel
+ * heard from least recently is evicted to make room.
+ *
+ * Watchers can also filter the AIS reports they get by area, MMSI and
+ * message type.  The filters from WATCH are compiled once into integer
+ * form, so testing a message is a few compares on its raw position.
+ *
+ * This file is Copyright (c) 2010 by the GPSD project
+ * BSD terms apply: see the file COPYING in the distribution root for details.
+ */
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+
+#include "gpsd.h"
+#include "gps_json.h"
+
+#if defined(AIVDM_ENABLE) && defined(SOCKET_EXPORT_ENABLE)
+
+#define VESSEL_MASK	(AIS_VESSELS - 1)
+
+static struct vessel_t vessels[AIS_VESSELS];
+static int nvessels;
+static timestamp_t swept;
+
+static unsigned int vessel_home(unsigned int mmsi)
+/* the slot an MMSI hashes to; MMSIs cluster by country, so mix them */
+{
+    return (unsigned int)((mmsi * 2654435761u) >> 16) & VESSEL_MASK;
+}
+
+static void vessel_delete(unsigned int i)
+/* empty a slot, moving later members of its probe run back over the hole */
+{
+    unsigned int j, k;
+
+    for (j = (i + 1) & VESSEL_MASK; vessels[j].mmsi != 0;
+	 j = (j + 1) & VESSEL_MASK) {
+	k = vessel_home(vessels[j].mmsi);
+	/* the entry at j can fill the hole unless it hashes into (i, j] */
+	if (i <= j ? (k <= i || k > j) : (k <= i && k > j)) {
+	    vessels[i] = vessels[j];
+	    i = j;
+	}
+    }
+    memset(&vessels[i], 0, sizeof(vessels[i]));
+    nvessels--;
+}
+
+static void aistable_sweep(timestamp_t now)
+/* drop vessels that have gone quiet */
+{
+    unsigned int i;
+
+    swept = now;
+    for (i = 0; i < AIS_VESSELS;)
+	if (vessels[i].mmsi != 0
+	    && now - vessels[i].heard > AIS_VESSEL_TIMEOUT) {
+	    gpsd_report(LOG_PROG, "AIS: vessel %09u timed out\n",
+			vessels[i].mmsi);
+	    vessel_delete(i);	/* may shift an unchecked entry into i */
+	} else
+	    i++;
+}
+
+static /*@null@*/ struct vessel_t *aistable_lookup(unsigned int mmsi)
+/* find the record for an MMSI, if there is one */
+{
+    unsigned int i;
+
+    for (i = vessel_home(mmsi); vessels[i].mmsi != 0;
+	 i = (i + 1) & VESSEL_MASK)
+	if (vessels[i].mmsi == mmsi)
+	    return &vessels[i];
+    return NULL;
+}
+
+static struct vessel_t *aistable_find(unsigned int mmsi, timestamp_t now)
+/* find the record for an MMSI, making one if need be */
+{
+    struct vessel_t *vp;
+    unsigned int i, oldest = 0;
+
+    if ((vp = aistable_lookup(mmsi)) != NULL)
+	return vp;
+
+    if (nvessels >= AIS_VESSELS_MAX) {
+	aistable_sweep(now);
+	if (nvessels >= AIS_VESSELS_MAX) {
+	    for (i = 1; i < AIS_VESSELS; i++)
+		if (vessels[i].mmsi != 0
+		    && (vessels[oldest].mmsi == 0
+			|| vessels[i].heard < vessels[oldest].heard))
+		    oldest = i;
+	    gpsd_report(LOG_INF, "AIS: table full, evicting %09u\n",
+			vessels[oldest].mmsi);
+	    vessel_delete(oldest);
+	}
+    }
+    /* deletion moves entries around, so find the hole afresh */
+    for (i = vessel_home(mmsi); vessels[i].mmsi != 0;
+	 i = (i + 1) & VESSEL_MASK)
+	continue;
+    vessels[i].mmsi = mmsi;
+    vessels[i].state.status = 15;
+    nvessels++;
+    return &vessels[i];
+}
+
+static void vessel_position(struct vessel_t *vp, unsigned int type,
+			    unsigned int status, bool accuracy,
+			    int lon, int lat, unsigned int speed,
+			    unsigned int course, unsigned int heading)
+{
+    vp->state.postype = type;
+    vp->state.status = status;
+    vp->state.accuracy = accuracy;
+    vp->state.lon = lon;
+    vp->state.lat = lat;
+    vp->state.speed = speed;
+    vp->state.course = course;
+    vp->state.heading = heading;
+}
+
+static void vessel_static(struct vessel_t *vp, unsigned int type,
+			  const char *shipname, unsigned int shiptype,
+			  unsigned int to_bow, unsigned int to_stern,
+			  unsigned int to_port, unsigned int to_starboard)
+{
+    vp->state.statictype = type;
+    (void)strlcpy(vp->state.shipname, shipname,
+		  sizeof(vp->state.shipname));
+    vp->state.shiptype = shiptype;
+    vp->state.to_bow = to_bow;
+    vp->state.to_stern = to_stern;
+    vp->state.to_port = to_port;
+    vp->state.to_starboard = to_starboard;
+}
+
+const struct vessel_t *aistable_update(struct gps_device_t *session)
+/* fold an AIS report into the table; return its vessel if that changed it */
+{
+    struct ais_t *ais = &session->gpsdata.ais;
+    struct vessel_t *vp;
+    timestamp_t now = timestamp();
+    bool position = false, described = false, changed;
+
+    /*@-type@*/
+    switch (ais->type) {
+    case 1:
+    case 2:
+    case 3:
+    case 18:
+    case 19:
+    case 27:
+	position = true;
+	break;
+    case 5:
+    case 24:
+	described = true;
+	break;
+    default:
+	/* base stations, binary messages and the like aren't vessels */
+	return NULL;
+    }
+    if (ais->mmsi == 0)
+	return NULL;
+
+    if (now - swept > AIS_VESSEL_SWEEP)
+	aistable_sweep(now);
+    vp = aistable_find(ais->mmsi, now);
+
+    {
+	/* copying keeps the padding equal, so the states can be memcmp'd */
+	struct vessel_t old = *vp;
+
+	switch (ais->type) {
+	case 1:
+	case 2:
+	case 3:
+	    vessel_position(vp, ais->type, ais->type1.status,
+			    ais->type1.accuracy, ais->type1.lon, ais->type1.lat,
+			    ais->type1.speed, ais->type1.course,
+			    ais->type1.heading);
+	    break;
+	case 18:
+	    vessel_position(vp, ais->type, 15, ais->type18.accuracy,
+			    ais->type18.lon, ais->type18.lat, ais->type18.speed,
+			    ais->type18.course, ais->type18.heading);
+	    break;
+	case 19:
+	    vessel_position(vp, ais->type, 15, ais->type19.accuracy,
+			    ais->type19.lon, ais->type19.lat, ais->type19.speed,
+			    ais->type19.course, ais->type19.heading);
+	    vessel_static(vp, ais->type, ais->type19.shipname,
+			  ais->type19.shiptype, ais->type19.to_bow,
+			  ais->type19.to_stern, ais->type19.to_port,
+			  ais->type19.to_starboard);
+	    described = true;
+	    break;
+	case 27:
+	    /* long-range reports are coarser; bring them to type 1 units */
+	    vessel_position(vp, ais->type, ais->type27.status,
+			    ais->type27.accuracy,
+			    ais->type27.lon == AIS_LONGRANGE_LON_NOT_AVAILABLE
+			    ? AIS_LON_NOT_AVAILABLE : ais->type27.lon * 1000,
+			    ais->type27.lat == AIS_LONGRANGE_LAT_NOT_AVAILABLE
+			    ? AIS_LAT_NOT_AVAILABLE : ais->type27.lat * 1000,
+			    ais->type27.speed == AIS_LONGRANGE_SPEED_NOT_AVAILABLE
+			    ? AIS_SPEED_NOT_AVAILABLE : ais->type27.speed * 10,
+			    ais->type27.course == AIS_LONGRANGE_COURSE_NOT_AVAILABLE
+			    ? AIS_COURSE_NOT_AVAILABLE : ais->type27.course * 10,
+			    AIS_HEADING_NOT_AVAILABLE);
+	    break;
+	case 5:
+	    vessel_static(vp, ais->type, ais->type5.shipname,
+			  ais->type5.shiptype, ais->type5.to_bow,
+			  ais->type5.to_stern, ais->type5.to_port,
+			  ais->type5.to_starboard);
+	    vp->state.imo = ais->type5.imo;
+	    (void)strlcpy(vp->state.callsign, ais->type5.callsign,
+			  sizeof(vp->state.callsign));
+	    vp->state.draught = ais->type5.draught;
+	    (void)strlcpy(vp->state.destination, ais->type5.destination,
+			  sizeof(vp->state.destination));
+	    vp->state.month = ais->type5.month;
+	    vp->state.day = ais->type5.day;
+	    vp->state.hour = ais->type5.hour;
+	    vp->state.minute = ais->type5.minute;
+	    break;
+	case 24:
+	    /* auxiliary craft send their mothership's MMSI, not dimensions */
+	    if (AIS_AUXILIARY_MMSI(ais->mmsi))
+		vessel_static(vp, ais->type, ais->type24.shipname,
+			      ais->type24.shiptype, 0, 0, 0, 0);
+	    else
+		vessel_static(vp, ais->type, ais->type24.shipname,
+			      ais->type24.shiptype, ais->type24.dim.to_bow,
+			      ais->type24.dim.to_stern, ais->type24.dim.to_port,
+			      ais->type24.dim.to_starboard);
+	    (void)strlcpy(vp->state.callsign, ais->type24.callsign,
+			  sizeof(vp->state.callsign));
+	    break;
+	}
+	/* hearing the same thing on another receiver is no change */
+	changed = memcmp(&old.state, &vp->state, sizeof(vp->state)) != 0;
+    }
+    /*@+type@*/
+
+    /*
+     * Keep the path, not the device: its slot in the daemon's device
+     * pool can be freed and reused while the vessel is remembered.
+     */
+    if (strcmp(vp->device, session->gpsdata.dev.path) != 0)
+	(void)strlcpy(vp->device, session->gpsdata.dev.path,
+		      sizeof(vp->device));
+    vp->heard = now;
+    if (position)
+	vp->reported = now;
+    if (described)
+	vp->described = now;
+    return changed ? vp : NULL;
+}
+
+const struct vessel_t *aistable_next(const struct vessel_filter_t *filter,
+				     const struct vessel_t *prev)
+/* step through the vessels a filter selects; start and end with NULL */
+{
+    const struct vessel_t *vp;
+    timestamp_t now = timestamp();
+
+    for (vp = (prev == NULL) ? vessels : prev + 1;
+	 vp < vessels + AIS_VESSELS; vp++) {
+	if (vp->mmsi == 0)
+	    continue;
+	if (filter->mmsi != 0 && vp->mmsi != filter->mmsi)
+	    continue;
+	if (filter->age > 0 && now - vp->heard > filter->age)
+	    continue;
+	if (filter->device[0] != '\0'
+	    && strcmp(vp->device, filter->device) != 0)
+	    continue;
+	return vp;
+    }
+    return NULL;
+}
+
+#define RAW_DEGREE	600000		/* 1/10000 minute, as in type 1 */
+#define RAW_NM		10000		/* a minute of latitude */
+#define RAW_HALFTURN	(180 * RAW_DEGREE)
+
+static int raw_degrees(double deg)
+{
+    return (int)floor(deg * RAW_DEGREE + 0.5);
+}
+
+bool aistable_compile(const struct ais_filter_t *filter,
+		      /*@out@*/struct ais_predicate_t *pred)
+/* turn a watcher's filters into a predicate; false if they don't make sense */
+{
+    int i;
+
+    memset(pred, 0, sizeof(*pred));
+    pred->types = ~(uint32_t)0;
+    if (filter->ntypes > 0) {
+	pred->types = 0;
+	for (i = 0; i < filter->ntypes; i++) {
+	    if (filter->types[i] < 1 || filter->types[i] > 27)
+		return false;
+	    pred->types |= (uint32_t)1 << filter->types[i];
+	}
+	pred->active = true;
+    }
+    if (filter->nbox > 0) {
+	const double *box = filter->box;
+
+	if (filter->nbox != 4
+	    || box[0] < -90 || box[0] > box[2] || box[2] > 90
+	    || fabs(box[1]) > 180 || fabs(box[3]) > 180)
+	    return false;
+	pred->south = raw_degrees(box[0]);
+	pred->west = raw_degrees(box[1]);
+	pred->north = raw_degrees(box[2]);
+	pred->east = raw_degrees(box[3]);
+	pred->active = pred->box = true;
+    }
+    if (filter->nradius > 0) {
+	const double *circle = filter->radius;
+	int64_t range;
+
+	if (filter->nradius != 3
+	    || fabs(circle[0]) > 90 || fabs(circle[1]) > 180
+	    || circle[2] <= 0 || circle[2] > 180 * 60)
+	    return false;
+	pred->lat = raw_degrees(circle[0]);
+	pred->lon = raw_degrees(circle[1]);
+	pred->coslat = (int)floor(cos(circle[0] * M_PI / 180) * 32768 + 0.5);
+	range = (int64_t)floor(circle[2] * RAW_NM + 0.5);
+	pred->range2 = range * range;
+	pred->active = pred->circle = true;
+    }
+    if (filter->nmmsi > 0 || filter->nnotmmsi > 0) {
+	pred->nmmsi = filter->nmmsi;
+	(void)memcpy(pred->mmsi, filter->mmsi, sizeof(pred->mmsi));
+	pred->nnotmmsi = filter->nnotmmsi;
+	(void)memcpy(pred->notmmsi, filter->notmmsi, sizeof(pred->notmmsi));
+	pred->active = true;
+    }
+    return true;
+}
+
+static bool ais_position(const struct ais_t *ais, int *lat, int *lon)
+/* where a message puts its sender, in type 1 units */
+{
+    const struct vessel_t *vp;
+
+    /*@-type@*/
+    switch (ais->type) {
+    case 1:
+    case 2:
+    case 3:
+	*lat = ais->type1.lat;
+	*lon = ais->type1.lon;
+	break;
+    case 4:
+    case 11:
+	*lat = ais->type4.lat;
+	*lon = ais->type4.lon;
+	break;
+    case 9:
+	*lat = ais->type9.lat;
+	*lon = ais->type9.lon;
+	break;
+    case 18:
+	*lat = ais->type18.lat;
+	*lon = ais->type18.lon;
+	break;
+    case 19:
+	*lat = ais->type19.lat;
+	*lon = ais->type19.lon;
+	break;
+    case 21:
+	*lat = ais->type21.lat;
+	*lon = ais->type21.lon;
+	break;
+    case 27:
+	if (ais->type27.lat == AIS_LONGRANGE_LAT_NOT_AVAILABLE
+	    || ais->type27.lon == AIS_LONGRANGE_LON_NOT_AVAILABLE)
+	    return false;
+	*lat = ais->type27.lat * 1000;
+	*lon = ais->type27.lon * 1000;
+	break;
+    default:
+	/* no position in the message; use the sender's last known one */
+	if ((vp = aistable_lookup(ais->mmsi)) == NULL
+	    || vp->state.postype == 0)
+	    return false;
+	*lat = vp->state.lat;
+	*lon = vp->state.lon;
+	break;
+    }
+    /*@+type@*/
+    return *lat != AIS_LAT_NOT_AVAILABLE && *lon != AIS_LON_NOT_AVAILABLE;
+}
+
+bool aistable_match(const struct ais_predicate_t *pred,
+		    const struct ais_t *ais)
+/* does a watcher's predicate pass this message? */
+{
+    int i, lat, lon;
+
+    if (!pred->active)
+	return true;
+    if (ais->type > 27
+	? pred->types != ~(uint32_t)0
+	: (pred->types & ((uint32_t)1 << ais->type)) == 0)
+	return false;
+    for (i = 0; i < pred->nnotmmsi; i++)
+	if (ais->mmsi == pred->notmmsi[i])
+	    return false;
+    if (pred->nmmsi > 0) {
+	for (i = 0; i < pred->nmmsi; i++)
+	    if (ais->mmsi == pred->mmsi[i])
+		break;
+	if (i == pred->nmmsi)
+	    return false;
+    }
+    if (!pred->box && !pred->circle)
+	return true;
+    if (!ais_position(ais, &lat, &lon))
+	return false;
+    if (pred->box) {
+	if (lat < pred->south || lat > pred->north)
+	    return false;
+	/* a box whose west edge is east of its east edge spans 180 */
+	if (pred->west <= pred->east
+	    ? (lon < pred->west || lon > pred->east)
+	    : (lon < pred->west && lon > pred->east))
+	    return false;
+    }
+    if (pred->circle) {
+	/* flat-earth distance, fine at the ranges AIS is heard over */
+	int64_t dlat = (int64_t)lat - pred->lat;
+	int64_t dlon = (int64_t)lon - pred->lon;
+
+	if (dlon > RAW_HALFTURN)
+	    dlon -= 2 * RAW_HALFTURN;
+	else if (dlon < -RAW_HALFTURN)
+	    dlon += 2 * RAW_HALFTURN;
+	dlon = (dlon * pred->coslat) >> 15;
+	if (dlat * dlat + dlon * dlon > pred->range2)
+	    return false;
+    }
+    return true;
+}
+
+int json_vessel_filter_read(const char *buf,
+			    struct vessel_filter_t *filter,
+			    /*@null@*/ const char **endptr)
+/* parse the selection part of an ?AIS request */
+{
+    /*@ -fullinitblock @*/
+    /* *INDENT-OFF* */
+    struct json_attr_t filter_attrs[] = {
+	{"class",          t_check,    .dflt.check = "AIS"},
+	{"mmsi",           t_uinteger, .addr.uinteger = &filter->mmsi,
+	                                  .dflt.uinteger = 0},
+	{"device",         t_string,   .addr.string = filter->device,
+	                                  .len = sizeof(filter->device)},
+	{"age",            t_integer,  .addr.integer = &filter->age,
+	                                  .dflt.integer = 0},
+	{NULL},
+    };
+    /* *INDENT-ON* */
+    /*@ +fullinitblock @*/
+
+    filter->device[0] = '\0';
+    return json_read_object(buf, filter_attrs, endptr);
+}
+
+#endif /* defined(AIVDM_ENABLE) && defined(SOCKET_EXPORT_ENABLE) */
+
+/* aistable.c ends here */
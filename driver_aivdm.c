@@ -29,7 +29,46 @@
 #define DAC1FID31_LEVEL_OFFSET			100
 #define DAC1FID31_WATERTEMP_OFFSET		100
 
-static void from_sixbit(char *bitvec, uint start, int count, char *to)
+/*
+ * The payload buffer has AIVDM_SLACK zero bytes past its end, so fields
+ * can be extracted with a single unaligned big-endian 64-bit load rather
+ * than ubits()'s byte-at-a-time loop.  Only fields that straddle more
+ * than eight bytes need to fall back on it.
+ */
+static uint64_t aivdm_ubits(unsigned char *bits, unsigned int start,
+			    unsigned int width)
+{
+    unsigned int shift = start % 8;
+
+    if (shift + width > 64)
+	return ubits((char *)bits, start, width);
+    return (getbeu64(bits, start / 8) << shift) >> (64 - width);
+}
+
+static int64_t aivdm_sbits(unsigned char *bits, unsigned int start,
+			   unsigned int width)
+{
+    uint64_t fld = aivdm_ubits(bits, start, width);
+
+    /*@ -shiftimplementation @*/
+    if ((fld & (1ULL << (width - 1))) != 0)
+	fld |= (~0ULL << (width - 1));
+    /*@ +shiftimplementation @*/
+    return (int64_t)fld;
+}
+
+static void aivdm_putbits(unsigned char *bits, unsigned int start,
+			  unsigned int width, uint64_t value)
+/* inverse of aivdm_ubits(), into a zeroed buffer */
+{
+    while (width-- > 0) {
+	if (((value >> width) & 1) != 0)
+	    bits[start / 8] |= 0x80 >> (start % 8);
+	start++;
+    }
+}
+
+static void from_sixbit(unsigned char *bitvec, uint start, int count, char *to)
 {
     /*@ +type @*/
 #ifdef S_SPLINT_S
@@ -44,7 +83,7 @@ static void from_sixbit(char *bitvec, uint start, int count, char *to)
 
     /* six-bit to ASCII */
     for (i = 0; i < count - 1; i++) {
-	newchar = sixchr[ubits(bitvec, start + 6 * i, 6U)];
+	newchar = sixchr[aivdm_ubits(bitvec, start + 6 * i, 6U)];
 	if (newchar == '@')
 	    break;
 	else
@@ -60,37 +99,126 @@ static void from_sixbit(char *bitvec, uint start, int count, char *to)
     /*@ -type @*/
 }
 
+/* six-bit value of each armoring character, shades of FIELDATA */
+static const unsigned char unarmor[128] = {
+     8,  9, 10, 11, 12, 13, 14, 15, 16, 17, 18, 19, 20, 21, 22, 23,
+    24, 25, 26, 27, 28, 29, 30, 31, 32, 33, 34, 35, 36, 37, 38, 39,
+    40, 41, 42, 43, 44, 45, 46, 47, 48, 49, 50, 51, 52, 53, 54, 55,
+     0,  1,  2,  3,  4,  5,  6,  7,  8,  9, 10, 11, 12, 13, 14, 15,
+    16, 17, 18, 19, 20, 21, 22, 23, 24, 25, 26, 27, 28, 29, 30, 31,
+    32, 33, 34, 35, 36, 37, 38, 39, 32, 33, 34, 35, 36, 37, 38, 39,
+    40, 41, 42, 43, 44, 45, 46, 47, 48, 49, 50, 51, 52, 53, 54, 55,
+    56, 57, 58, 59, 60, 61, 62, 63,  0,  1,  2,  3,  4,  5,  6,  7,
+};
+
+static void aivdm_unarmor(struct aivdm_context_t *ais_context,
+			  const unsigned char *data, size_t len)
+/* append armored payload characters to the bit buffer */
+{
+    const unsigned char *cp = data, *end = data + len;
+    unsigned char *out = ais_context->bits + ais_context->bitlen / 8;
+    unsigned int have = (unsigned int)(ais_context->bitlen % 8);
+    uint32_t acc = (have > 0) ? (uint32_t)(*out >> (8 - have)) : 0;
+
+    ais_context->bitlen += 6 * len;
+    /* on a byte boundary, four characters make three whole bytes */
+    if (have == 0)
+	for (; end - cp >= 4; cp += 4) {
+	    uint32_t w = ((uint32_t)unarmor[cp[0] & 0x7f] << 18)
+		| ((uint32_t)unarmor[cp[1] & 0x7f] << 12)
+		| ((uint32_t)unarmor[cp[2] & 0x7f] << 6)
+		| (uint32_t)unarmor[cp[3] & 0x7f];
+	    *out++ = (unsigned char)(w >> 16);
+	    *out++ = (unsigned char)(w >> 8);
+	    *out++ = (unsigned char)w;
+	}
+    for (; cp < end; cp++) {
+	acc = (acc << 6) | unarmor[*cp & 0x7f];
+	have += 6;
+	if (have >= 8) {
+	    have -= 8;
+	    *out++ = (unsigned char)(acc >> have);
+	}
+    }
+    /* trailing bits go out zero-padded */
+    if (have > 0)
+	*out = (unsigned char)(acc << (8 - have));
+}
+
+static /*@null@*/ struct aivdm_context_t *aivdm_pending(struct aivdm_context_t
+							 ais_contexts[],
+							 int chan, int seqid,
+							 const char *source,
+							 int ifrag,
+							 timestamp_t now)
+/* find the reassembly slot a fragment of a multipart message belongs in */
+{
+    struct aivdm_context_t *slot, *empty = NULL, *oldest = NULL;
+
+    for (slot = ais_contexts + AIVDM_CHANNELS;
+	 slot < ais_contexts + AIVDM_CONTEXTS; slot++) {
+	if (slot->decoded_frags > 0 && now - slot->updated > AIVDM_STALE) {
+	    gpsd_report(LOG_PROG,
+			"AIVDM partial message %d from %s dropped, stale.\n",
+			slot->seqid, slot->source);
+	    slot->decoded_frags = 0;
+	}
+	if (slot->decoded_frags == 0) {
+	    if (empty == NULL)
+		empty = slot;
+	} else if (slot->channel == chan && slot->seqid == seqid
+		   && strcmp(slot->source, source) == 0) {
+	    if (ifrag == slot->decoded_frags + 1) {
+		slot->updated = now;
+		return slot;
+	    }
+	    gpsd_report(LOG_ERROR,
+			"invalid fragment #%d received, expected #%d.\n",
+			ifrag, slot->decoded_frags + 1);
+	    /* discard what was decoded; a first fragment starts over */
+	    slot->decoded_frags = 0;
+	    empty = slot;
+	    break;
+	} else if (oldest == NULL || slot->updated < oldest->updated)
+	    oldest = slot;
+    }
+    if (ifrag != 1) {
+	if (slot == ais_contexts + AIVDM_CONTEXTS)
+	    gpsd_report(LOG_ERROR,
+			"fragment #%d of unknown message %d received.\n",
+			ifrag, seqid);
+	return NULL;
+    }
+    if (empty == NULL) {
+	/*@ -nullderef @*/
+	gpsd_report(LOG_WARN,
+		    "AIVDM reassembly table full, message %d from %s dropped.\n",
+		    oldest->seqid, oldest->source);
+	/*@ +nullderef @*/
+	empty = oldest;
+    }
+    empty->channel = chan;
+    empty->seqid = seqid;
+    empty->updated = now;
+    (void)strlcpy(empty->source, source, sizeof(empty->source));
+    return empty;
+}
+
 /*@ +charint -fixedformalarray -usedef -branchstate @*/
 bool aivdm_decode(const char *buf, size_t buflen,
-		  struct aivdm_context_t ais_contexts[AIVDM_CHANNELS],
+		  struct aivdm_context_t ais_contexts[AIVDM_CONTEXTS],
 		  struct ais_t *ais,
 		  int debug)
 {
-#ifdef __UNUSED_DEBUG__
-    char *sixbits[64] = {
-	"000000", "000001", "000010", "000011", "000100",
-	"000101", "000110", "000111", "001000", "001001",
-	"001010", "001011", "001100", "001101", "001110",
-	"001111", "010000", "010001", "010010", "010011",
-	"010100", "010101", "010110", "010111", "011000",
-	"011001", "011010", "011011", "011100", "011101",
-	"011110", "011111", "100000", "100001", "100010",
-	"100011", "100100", "100101", "100110", "100111",
-	"101000", "101001", "101010", "101011", "101100",
-	"101101", "101110", "101111", "110000", "110001",
-	"110010", "110011", "110100", "110101", "110110",
-	"110111", "111000", "111001", "111010", "111011",
-	"111100", "111101", "111110", "111111",
-    };
-#endif /* __UNUSED_DEBUG__ */
     int nfrags, ifrag, nfields = 0;
     unsigned char *field[NMEA_MAX*2];
     unsigned char fieldcopy[NMEA_MAX*2+1];
     unsigned char *data, *cp;
-    unsigned char ch, pad;
-    struct aivdm_context_t *ais_context;
-    bool imo;
-    int i;
+    unsigned char pad;
+    size_t datalen;
+    int chan, seqid;
+    char source[3];
+    struct aivdm_context_t *ais_context, *channel;
     unsigned int u;
 
     if (buflen == 0)
@@ -132,22 +260,22 @@ bool aivdm_decode(const char *buf, size_t buflen,
 	 * which makes sense as they don't come in over radio.  This
 	 * is going to break if there's ever an AIVDO type 24, though.
 	 */
-	if (strncmp((const char *)field[0], "!AIVDO", 6) != 0)
+	if (strncmp((const char *)field[0] + 3, "VDO", 3) != 0)
 	    gpsd_report(LOG_ERROR, "invalid empty AIS channel. Assuming 'A'\n");
-	ais_context = &ais_contexts[0];
+	chan = 0;
 	break;
     case '1':
 	gpsd_report(LOG_ERROR, "invalid AIS channel 0x%0x '%c'. Assuming 'A'\n",
 	                       field[4][0], (field[4][0] != '\0' ? field[4][0]:' '));
 	/*@fallthrough@*/
     case 'A':
-	ais_context = &ais_contexts[0];
+	chan = 0;
 	break;
     case '2':
 	gpsd_report(LOG_ERROR, "invalid AIS channel '2'. Assuming 'B'.\n");
 	/*@fallthrough@*/
     case 'B':
-	ais_context = &ais_contexts[1];
+	chan = 1;
 	break;
     default:
 	gpsd_report(LOG_ERROR, "invalid AIS channel 0x%0X .\n", field[4][0]);
@@ -156,48 +284,52 @@ bool aivdm_decode(const char *buf, size_t buflen,
 
     nfrags = atoi((char *)field[1]); /* number of fragments to expect */
     ifrag = atoi((char *)field[2]); /* fragment id */
+    seqid = (field[3][0] != '\0') ? atoi((char *)field[3]) : -1;
     data = field[5];
     pad = field[6][0]; /* number of padding bits */
-    gpsd_report(LOG_PROG, "nfrags=%d, ifrag=%d, decoded_frags=%d, data=%s\n",
-		nfrags, ifrag, ais_context->decoded_frags, data);
+    gpsd_report(LOG_PROG, "nfrags=%d, ifrag=%d, seqid=%d, data=%s\n",
+		nfrags, ifrag, seqid, data);
 
     /* assemble the binary data */
-
-    /* check fragment ordering */
-    if (ifrag != ais_context->decoded_frags + 1) {
-	gpsd_report(LOG_ERROR, "invalid fragment #%d received, expected #%d.\n",
-	                       ifrag, ais_context->decoded_frags + 1);
-	if (ifrag != 1)
+    channel = &ais_contexts[chan];
+    if (nfrags <= 1) {
+	/* the common case, a single-sentence message */
+	ais_context = channel;
+	ifrag = nfrags = 1;
+	ais_context->decoded_frags = 0;
+    } else {
+	/*
+	 * Aggregated feeds interleave the fragments of several
+	 * multipart messages, so each is reassembled in a slot of its
+	 * own, keyed by channel, sequential message ID, and the
+	 * talker ID of the station that relayed it.
+	 */
+	source[0] = (char)field[0][1];
+	source[1] = (source[0] != '\0') ? (char)field[0][2] : '\0';
+	source[2] = '\0';
+	ais_context = aivdm_pending(ais_contexts, chan, seqid, source, ifrag,
+				    timestamp());
+	if (ais_context == NULL)
 	    return false;
-        /* else, ifrag==1: Just discard all that was previously decoded and
-         * simply handle that packet */
-        ais_context->decoded_frags = 0;
     }
     if (ifrag == 1) {
-	(void)memset(ais_context->bits, '\0', sizeof(ais_context->bits));
+	/* only what the last message wrote needs clearing */
+	size_t used = (ais_context->bitlen + 7) / 8 + 1;
+
+	if (used > sizeof(ais_context->bits))
+	    used = sizeof(ais_context->bits);
+	(void)memset(ais_context->bits, '\0', used);
 	ais_context->bitlen = 0;
     }
 
-    /* wacky 6-bit encoding, shades of FIELDATA */
-    /*@ +charint @*/
-    for (cp = data; cp < data + strlen((char *)data); cp++) {
-	ch = *cp;
-	ch -= 48;
-	if (ch >= 40)
-	    ch -= 8;
-#ifdef __UNUSED_DEBUG__
-	gpsd_report(LOG_RAW, "%c: %s\n", *cp, sixbits[ch]);
-#endif /* __UNUSED_DEBUG__ */
-	/*@ -shiftnegative @*/
-	for (i = 5; i >= 0; i--) {
-	    if ((ch >> i) & 0x01) {
-		ais_context->bits[ais_context->bitlen / 8] |=
-		    (1 << (7 - ais_context->bitlen % 8));
-	    }
-	    ais_context->bitlen++;
-	}
-	/*@ +shiftnegative @*/
+    datalen = strlen((char *)data);
+    if (ais_context->bitlen + 6 * datalen > AIVDM_PAYLOAD * 8) {
+	gpsd_report(LOG_ERROR, "overlong AIVDM payload.\n");
+	ais_context->decoded_frags = 0;
+	return false;
     }
+    aivdm_unarmor(ais_context, data, datalen);
+    /*@ +charint @*/
     if (isdigit(pad))
 	ais_context->bitlen -= (pad - '0');	/* ASCII assumption */
     /*@ -charint @*/
@@ -215,9 +347,9 @@ bool aivdm_decode(const char *buf, size_t buflen,
         ais_context->decoded_frags = 0;
 
 #define BITS_PER_BYTE	8
-#define UBITS(s, l)	ubits((char *)ais_context->bits, s, l)
-#define SBITS(s, l)	sbits((char *)ais_context->bits, s, l)
-#define UCHARS(s, to)	from_sixbit((char *)ais_context->bits, s, sizeof(to), to)
+#define UBITS(s, l)	aivdm_ubits(ais_context->bits, s, l)
+#define SBITS(s, l)	aivdm_sbits(ais_context->bits, s, l)
+#define UCHARS(s, to)	from_sixbit(ais_context->bits, s, sizeof(to), to)
 	ais->type = UBITS(0, 6);
 	ais->repeat = UBITS(6, 2);
 	ais->mmsi = UBITS(8, 30);
@@ -313,173 +445,11 @@ bool aivdm_decode(const char *buf, size_t buflen,
 	    ais->type6.dac            = UBITS(72, 10);
 	    ais->type6.fid            = UBITS(82, 6);
 	    ais->type6.bitcount       = ais_context->bitlen - 88;
-	    imo = false;
-	    if (ais->type8.dac == 1)
-		switch (ais->type8.fid) {
-		case 12:	/* IMO236 - Dangerous cargo indication */
-		    UCHARS(88, ais->type6.dac1fid12.lastport);
-		    ais->type6.dac1fid12.lmonth		= UBITS(118, 4);
-		    ais->type6.dac1fid12.lday		= UBITS(122, 5);
-		    ais->type6.dac1fid12.lhour		= UBITS(127, 5);
-		    ais->type6.dac1fid12.lminute	= UBITS(132, 6);
-		    UCHARS(138, ais->type6.dac1fid12.nextport);
-		    ais->type6.dac1fid12.nmonth		= UBITS(168, 4);
-		    ais->type6.dac1fid12.nday		= UBITS(172, 5);
-		    ais->type6.dac1fid12.nhour		= UBITS(177, 5);
-		    ais->type6.dac1fid12.nminute	= UBITS(182, 6);
-		    UCHARS(188, ais->type6.dac1fid12.dangerous);
-		    UCHARS(308, ais->type6.dac1fid12.imdcat);
-		    ais->type6.dac1fid12.unid		= UBITS(332, 13);
-		    ais->type6.dac1fid12.amount		= UBITS(345, 10);
-		    ais->type6.dac1fid12.unit		= UBITS(355, 2);
-		    /* skip 3 bits */
-		    break;
-		case 14:	/* IMO236 - Tidal Window */
-		    ais->type6.dac1fid32.month	= UBITS(88, 4);
-		    ais->type6.dac1fid32.day	= UBITS(92, 5);
-#define ARRAY_BASE 97
-#define ELEMENT_SIZE 93
-		    for (u = 0; ARRAY_BASE + (ELEMENT_SIZE*u) <= ais_context->bitlen; u++) {
-			int a = ARRAY_BASE + (ELEMENT_SIZE*u);
-			struct tidal_t *tp = &ais->type6.dac1fid32.tidals[u];
-			tp->lat	= SBITS(a + 0, 27);
-			tp->lon	= SBITS(a + 27, 28);
-			tp->from_hour	= UBITS(a + 55, 5);
-			tp->from_min	= UBITS(a + 60, 6);
-			tp->to_hour	= UBITS(a + 66, 5);
-			tp->to_min	= UBITS(a + 71, 6);
-			tp->cdir	= UBITS(a + 77, 9);
-			tp->cspeed	= UBITS(a + 86, 7);
-		    }
-		    ais->type6.dac1fid32.ntidals = i;
-#undef ARRAY_BASE
-#undef ELEMENT_SIZE
-		    break;
-		case 15:	/* IMO236 - Extended Ship Static and Voyage Related Data */
-		    ais->type6.dac1fid15.airdraught	= UBITS(56, 11);
-		    break;
-		case 16:	/* IMO236 - Number of persons on board */
-		    if (ais->type6.bitcount == 136)
-			ais->type6.dac1fid16.persons = UBITS(88, 13);/* 289 */
-		    else
-			ais->type6.dac1fid16.persons = UBITS(55, 13);/* 236 */
-		    imo = true;
-		    break;
-		case 18:	/* IMO289 - Clearance time to enter port */
-		    ais->type6.dac1fid18.linkage	= UBITS(88, 10);
-		    ais->type6.dac1fid18.month	= UBITS(98, 4);
-		    ais->type6.dac1fid18.day	= UBITS(102, 5);
-		    ais->type6.dac1fid18.hour	= UBITS(107, 5);
-		    ais->type6.dac1fid18.minute	= UBITS(112, 6);
-		    UCHARS(118, ais->type6.dac1fid18.portname);
-		    UCHARS(238, ais->type6.dac1fid18.destination);
-		    ais->type6.dac1fid18.lon	= SBITS(268, 25);
-		    ais->type6.dac1fid18.lat	= SBITS(293, 24);
-		    /* skip 43 bits */
-		    break;
-		case 20:	/* IMO289 - Berthing data - addressed */
-		    ais->type6.dac1fid20.linkage	= UBITS(88, 10);
-		    ais->type6.dac1fid20.berth_length	= UBITS(98, 9);
-		    ais->type6.dac1fid20.berth_depth	= UBITS(107, 8);
-		    ais->type6.dac1fid20.position	= UBITS(115, 3);
-		    ais->type6.dac1fid20.month		= UBITS(118, 4);
-		    ais->type6.dac1fid20.day		= UBITS(122, 5);
-		    ais->type6.dac1fid20.hour		= UBITS(127, 5);
-		    ais->type6.dac1fid20.minute		= UBITS(132, 6);
-		    ais->type6.dac1fid20.availability	= UBITS(138, 1);
-		    ais->type6.dac1fid20.agent		= UBITS(139, 2);
-		    ais->type6.dac1fid20.fuel		= UBITS(141, 2);
-		    ais->type6.dac1fid20.chandler	= UBITS(143, 2);
-		    ais->type6.dac1fid20.stevedore	= UBITS(145, 2);
-		    ais->type6.dac1fid20.electrical	= UBITS(147, 2);
-		    ais->type6.dac1fid20.water		= UBITS(149, 2);
-		    ais->type6.dac1fid20.customs	= UBITS(151, 2);
-		    ais->type6.dac1fid20.cartage	= UBITS(153, 2);
-		    ais->type6.dac1fid20.crane		= UBITS(155, 2);
-		    ais->type6.dac1fid20.lift		= UBITS(157, 2);
-		    ais->type6.dac1fid20.medical	= UBITS(159, 2);
-		    ais->type6.dac1fid20.navrepair	= UBITS(161, 2);
-		    ais->type6.dac1fid20.provisions	= UBITS(163, 2);
-		    ais->type6.dac1fid20.shiprepair	= UBITS(165, 2);
-		    ais->type6.dac1fid20.surveyor	= UBITS(167, 2);
-		    ais->type6.dac1fid20.steam		= UBITS(169, 2);
-		    ais->type6.dac1fid20.tugs		= UBITS(171, 2);
-		    ais->type6.dac1fid20.solidwaste	= UBITS(173, 2);
-		    ais->type6.dac1fid20.liquidwaste	= UBITS(175, 2);
-		    ais->type6.dac1fid20.hazardouswaste	= UBITS(177, 2);
-		    ais->type6.dac1fid20.ballast	= UBITS(179, 2);
-		    ais->type6.dac1fid20.additional	= UBITS(181, 2);
-		    ais->type6.dac1fid20.regional1	= UBITS(183, 2);
-		    ais->type6.dac1fid20.regional2	= UBITS(185, 2);
-		    ais->type6.dac1fid20.future1	= UBITS(187, 2);
-		    ais->type6.dac1fid20.future2	= UBITS(189, 2);
-		    UCHARS(191, ais->type6.dac1fid20.berth_name);
-		    ais->type6.dac1fid20.berth_lon	= SBITS(311, 25);
-		    ais->type6.dac1fid20.berth_lat	= SBITS(336, 24);
-		    break;
-		case 23:        /* IMO289 - Area notice - addressed */
-		    break;
-		case 25:	/* IMO289 - Dangerous cargo indication */
-		    ais->type6.dac1fid25.unit 	= UBITS(88, 2);
-		    ais->type6.dac1fid25.amount	= UBITS(90, 10);
-		    for (i = 0;	100 + i*17 < (int)ais_context->bitlen; i++) {
-			ais->type6.dac1fid25.cargos[i].code 	= UBITS(100 + i*17, 4);
-			ais->type6.dac1fid25.cargos[i].subtype	= UBITS(104 + i*17, 13);
-		    }
-		    ais->type6.dac1fid25.ncargos = i;
-		    break;
-		case 28:	/* IMO289 - Route info - addressed */
-		    ais->type6.dac1fid28.linkage	= UBITS(88, 10);
-		    ais->type6.dac1fid28.sender		= UBITS(98, 3);
-		    ais->type6.dac1fid28.rtype		= UBITS(101, 5);
-		    ais->type6.dac1fid28.month		= UBITS(106, 4);
-		    ais->type6.dac1fid28.day		= UBITS(110, 5);
-		    ais->type6.dac1fid28.hour		= UBITS(115, 5);
-		    ais->type6.dac1fid28.minute		= UBITS(120, 6);
-		    ais->type6.dac1fid28.duration	= UBITS(126, 18);
-		    ais->type6.dac1fid28.waycount	= UBITS(144, 5);
-#define ARRAY_BASE 149
-#define ELEMENT_SIZE 55
-		    for (i = 0; i < ais->type6.dac1fid28.waycount; u++) {
-			int a = ARRAY_BASE + (ELEMENT_SIZE*i);
-			ais->type6.dac1fid28.waypoints[i].lon = SBITS(a+0, 28);
-			ais->type6.dac1fid28.waypoints[i].lat = SBITS(a+28,27);
-		    }
-#undef ARRAY_BASE
-#undef ELEMENT_SIZE
-		    break;
-		case 30:	/* IMO289 - Text description - addressed */
-		    ais->type6.dac1fid30.linkage   = UBITS(88, 10);
-		    from_sixbit((char *)ais_context->bits,
-				98, ais_context->bitlen-98,
-				ais->type6.dac1fid30.text);
-		    break;
-		case 32:	/* IMO289 - Tidal Window */
-		    ais->type6.dac1fid32.month	= UBITS(88, 4);
-		    ais->type6.dac1fid32.day	= UBITS(92, 5);
-#define ARRAY_BASE 97
-#define ELEMENT_SIZE 88
-		    for (u = 0; ARRAY_BASE + (ELEMENT_SIZE*u) <= ais_context->bitlen; u++) {
-			int a = ARRAY_BASE + (ELEMENT_SIZE*u);
-			struct tidal_t *tp = &ais->type6.dac1fid32.tidals[u];
-			tp->lon	= SBITS(a + 0, 25);
-			tp->lat	= SBITS(a + 25, 24);
-			tp->from_hour	= UBITS(a + 49, 5);
-			tp->from_min	= UBITS(a + 54, 6);
-			tp->to_hour	= UBITS(a + 60, 5);
-			tp->to_min	= UBITS(a + 65, 6);
-			tp->cdir	= UBITS(a + 71, 9);
-			tp->cspeed	= UBITS(a + 80, 8);
-		    }
-		    ais->type6.dac1fid32.ntidals = u;
-#undef ARRAY_BASE
-#undef ELEMENT_SIZE
-		    break;
-		}
-	    if (!imo)
-		(void)memcpy(ais->type6.bitdata,
-			     (char *)ais_context->bits + (88 / BITS_PER_BYTE),
-			     (ais->type6.bitcount + 7) / 8);
+	    /* the application payload is unpacked on demand */
+	    (void)memcpy(ais->type6.bitdata,
+			 (char *)ais_context->bits + (88 / BITS_PER_BYTE),
+			 (ais->type6.bitcount + 7) / 8);
+	    ais->type6.raw = true;
 	    break;
 	case 7: /* Binary acknowledge */
 	case 13: /* Safety Related Acknowledge */
@@ -514,206 +484,11 @@ bool aivdm_decode(const char *buf, size_t buflen,
 	    ais->type8.dac            = UBITS(40, 10);
 	    ais->type8.fid            = UBITS(50, 6);
 	    ais->type8.bitcount       = ais_context->bitlen - 56;
-	    imo = false;
-	    if (ais->type8.dac == 1)
-		switch (ais->type8.fid) {
-		case 11:        /* IMO236 - Meteorological/Hydrological data */
-		    /* layout is almost identical to FID=31 from IMO289 */
-		    ais->type8.dac1fid31.lat		= SBITS(56, 24);
-		    ais->type8.dac1fid31.lon		= SBITS(80, 25);
-		    ais->type8.dac1fid31.accuracy       = false;
-		    ais->type8.dac1fid31.day		= UBITS(105, 5);
-		    ais->type8.dac1fid31.hour		= UBITS(110, 5);
-		    ais->type8.dac1fid31.minute		= UBITS(115, 6);
-		    ais->type8.dac1fid31.wspeed		= UBITS(121, 7);
-		    ais->type8.dac1fid31.wgust		= UBITS(128, 7);
-		    ais->type8.dac1fid31.wdir		= UBITS(135, 9);
-		    ais->type8.dac1fid31.wgustdir	= UBITS(144, 9); 
-		    ais->type8.dac1fid31.airtemp	= SBITS(153, 11)
-			- DAC1FID31_AIRTEMP_OFFSET;
-		    ais->type8.dac1fid31.humidity	= UBITS(164, 7);
-		    ais->type8.dac1fid31.dewpoint	= UBITS(171, 10)
-			- DAC1FID31_DEWPOINT_OFFSET;
-		    ais->type8.dac1fid31.pressure	= UBITS(181, 9)
-			- DAC1FID31_PRESSURE_OFFSET;
-		    ais->type8.dac1fid31.pressuretend	= UBITS(190, 2);
-		    ais->type8.dac1fid31.visgreater     = false;
-		    ais->type8.dac1fid31.visibility	= UBITS(192, 8);
-		    ais->type8.dac1fid31.waterlevel	= UBITS(200, 9)
-			- DAC1FID11_LEVEL_OFFSET;
-		    ais->type8.dac1fid31.leveltrend	= UBITS(209, 2);
-		    ais->type8.dac1fid31.cspeed		= UBITS(211, 8);
-		    ais->type8.dac1fid31.cdir		= UBITS(219, 9);
-		    ais->type8.dac1fid31.cspeed2	= UBITS(228, 8);
-		    ais->type8.dac1fid31.cdir2		= UBITS(236, 9);
-		    ais->type8.dac1fid31.cdepth2	= UBITS(245, 5);
-		    ais->type8.dac1fid31.cspeed3	= UBITS(250, 8);
-		    ais->type8.dac1fid31.cdir3		= UBITS(258, 9);
-		    ais->type8.dac1fid31.cdepth3	= UBITS(267, 5);
-		    ais->type8.dac1fid31.waveheight	= UBITS(272, 8);
-		    ais->type8.dac1fid31.waveperiod	= UBITS(280, 6);
-		    ais->type8.dac1fid31.wavedir	= UBITS(286, 9);
-		    ais->type8.dac1fid31.swellheight	= UBITS(295, 8);
-		    ais->type8.dac1fid31.swellperiod	= UBITS(303, 6);
-		    ais->type8.dac1fid31.swelldir	= UBITS(309, 9);
-		    ais->type8.dac1fid31.seastate	= UBITS(318, 4);
-		    ais->type8.dac1fid31.watertemp	= UBITS(322, 10)
-			- DAC1FID31_WATERTEMP_OFFSET;
-		    ais->type8.dac1fid31.preciptype	= UBITS(332, 3);
-		    ais->type8.dac1fid31.salinity	= UBITS(335, 9);
-		    ais->type8.dac1fid31.ice		= UBITS(344, 2);
-		    imo = true;
-		    break;
-		case 13:        /* IMO236 - Fairway closed */
-		    UCHARS(56, ais->type8.dac1fid13.reason);
-		    UCHARS(176, ais->type8.dac1fid13.closefrom);
-		    UCHARS(296, ais->type8.dac1fid13.closeto);
-		    ais->type8.dac1fid13.radius 	= UBITS(416, 10);
-		    ais->type8.dac1fid13.extunit	= UBITS(426, 2);
-		    ais->type8.dac1fid13.fday   	= UBITS(428, 5);
-		    ais->type8.dac1fid13.fmonth 	= UBITS(433, 4);
-		    ais->type8.dac1fid13.fhour  	= UBITS(437, 5);
-		    ais->type8.dac1fid13.fminute	= UBITS(442, 6);
-		    ais->type8.dac1fid13.tday   	= UBITS(448, 5);
-		    ais->type8.dac1fid13.tmonth 	= UBITS(453, 4);
-		    ais->type8.dac1fid13.thour  	= UBITS(457, 5);
-		    ais->type8.dac1fid13.tminute	= UBITS(462, 6);
-		    /* skip 4 bits */
-		    break;
-		case 15:        /* IMO236 - Extended ship and voyage */
-		    ais->type8.dac1fid15.airdraught	= UBITS(56, 11);
-		    /* skip 5 bits */
-		    break;
-		case 17:        /* IMO289 - VTS-generated/synthetic targets */
-#define ARRAY_BASE 56
-#define ELEMENT_SIZE 122
-		    for (u = 0; ARRAY_BASE + (ELEMENT_SIZE*u) <= ais_context->bitlen; u++) {
-			struct target_t *tp = &ais->type8.dac1fid17.targets[u];
-			int a = ARRAY_BASE + (ELEMENT_SIZE*u);
-			tp->idtype = UBITS(a + 0, 2);
-			switch (tp->idtype) {
-			case DAC1FID17_IDTYPE_MMSI:
-			    tp->id.mmsi	= UBITS(a + 2, 42);
-			    break;
-			case DAC1FID17_IDTYPE_IMO:
-			    tp->id.imo	= UBITS(a + 2, 42);
-			    break;
-			case DAC1FID17_IDTYPE_CALLSIGN:
-			    UCHARS(a+2, tp->id.callsign);
-			    break;
-			default:
-			    UCHARS(a+2, tp->id.other);
-			    break;
-			}
-			/* skip 4 bits */
-			tp->lat	= SBITS(a + 48, 24);
-			tp->lon	= SBITS(a + 72, 25);
-			tp->course	= UBITS(a + 97, 9);
-			tp->second	= UBITS(a + 106, 6);
-			tp->speed	= UBITS(a + 112, 10);
-		    }
-		    ais->type8.dac1fid17.ntargets = u;
-#undef ARRAY_BASE
-#undef ELEMENT_SIZE
-		    break;
-		case 19:        /* IMO289 - Marine Traffic Signal */
-		    ais->type8.dac1fid19.linkage	= UBITS(56, 10);
-		    UCHARS(66, ais->type8.dac1fid19.station);
-		    ais->type8.dac1fid19.lon	= SBITS(186, 25);
-		    ais->type8.dac1fid19.lat	= SBITS(211, 24);
-		    ais->type8.dac1fid19.status	= UBITS(235, 2);
-		    ais->type8.dac1fid19.signal	= UBITS(237, 5);
-		    ais->type8.dac1fid19.hour	= UBITS(242, 5);
-		    ais->type8.dac1fid19.minute	= UBITS(247, 6);
-		    ais->type8.dac1fid19.nextsignal	= UBITS(253, 5);
-		    /* skip 102 bits */
-		    break;
-		case 21:        /* IMO289 - Weather obs. report from ship */
-		    break;
-		case 22:        /* IMO289 - Area notice - broadcast */
-		    break;
-		case 24:        /* IMO289 - Extended ship static & voyage-related data */
-		    break;
-		case 26:        /* IMO289 - Environmental */
-		    break;
-		case 27:        /* IMO289 - Route information - broadcast */
-		    ais->type8.dac1fid27.linkage	= UBITS(56, 10);
-		    ais->type8.dac1fid27.sender	= UBITS(66, 3);
-		    ais->type8.dac1fid27.rtype	= UBITS(69, 5);
-		    ais->type8.dac1fid27.month	= UBITS(74, 4);
-		    ais->type8.dac1fid27.day	= UBITS(78, 5);
-		    ais->type8.dac1fid27.hour	= UBITS(83, 5);
-		    ais->type8.dac1fid27.minute	= UBITS(88, 6);
-		    ais->type8.dac1fid27.duration	= UBITS(94, 18);
-		    ais->type8.dac1fid27.waycount	= UBITS(112, 5);
-#define ARRAY_BASE 117
-#define ELEMENT_SIZE 55
-		    for (i = 0; i < ais->type8.dac1fid27.waycount; i++) {
-			int a = ARRAY_BASE + (ELEMENT_SIZE*i);
-			ais->type8.dac1fid27.waypoints[i].lon	= SBITS(a + 0, 28);
-			ais->type8.dac1fid27.waypoints[i].lat	= SBITS(a + 28, 27);
-		    }
-#undef ARRAY_BASE
-#undef ELEMENT_SIZE
-		    break;
-		case 29:        /* IMO289 - Text Description - broadcast */
-		    ais->type8.dac1fid29.linkage   = UBITS(56, 10);
-		    from_sixbit((char *)ais_context->bits,
-				66, ais_context->bitlen-66,
-				ais->type8.dac1fid29.text);
-		    break;
-		case 31:        /* IMO289 - Meteorological/Hydrological data */
-		    ais->type8.dac1fid31.lat		= SBITS(56, 24);
-		    ais->type8.dac1fid31.lon		= SBITS(80, 25);
-		    ais->type8.dac1fid31.accuracy       = (bool)UBITS(105, 1);
-		    ais->type8.dac1fid31.day		= UBITS(106, 5);
-		    ais->type8.dac1fid31.hour		= UBITS(111, 5);
-		    ais->type8.dac1fid31.minute		= UBITS(116, 6);
-		    ais->type8.dac1fid31.wspeed		= UBITS(122, 7);
-		    ais->type8.dac1fid31.wgust		= UBITS(129, 7);
-		    ais->type8.dac1fid31.wdir		= UBITS(136, 9);
-		    ais->type8.dac1fid31.wgustdir	= UBITS(145, 9); 
-		    ais->type8.dac1fid31.airtemp	= SBITS(154, 11)
-			- DAC1FID31_AIRTEMP_OFFSET;
-		    ais->type8.dac1fid31.humidity	= UBITS(165, 7);
-		    ais->type8.dac1fid31.dewpoint	= UBITS(172, 10)
-			- DAC1FID31_DEWPOINT_OFFSET;
-		    ais->type8.dac1fid31.pressure	= UBITS(182, 9)
-			- DAC1FID31_PRESSURE_OFFSET;
-		    ais->type8.dac1fid31.pressuretend	= UBITS(191, 2);
-		    ais->type8.dac1fid31.visgreater	= UBITS(193, 1);
-		    ais->type8.dac1fid31.visibility	= UBITS(194, 7);
-		    ais->type8.dac1fid31.waterlevel	= UBITS(200, 12)
-			- DAC1FID31_LEVEL_OFFSET;
-		    ais->type8.dac1fid31.leveltrend	= UBITS(213, 2);
-		    ais->type8.dac1fid31.cspeed		= UBITS(215, 8);
-		    ais->type8.dac1fid31.cdir		= UBITS(223, 9);
-		    ais->type8.dac1fid31.cspeed2	= UBITS(232, 8);
-		    ais->type8.dac1fid31.cdir2		= UBITS(240, 9);
-		    ais->type8.dac1fid31.cdepth2	= UBITS(249, 5);
-		    ais->type8.dac1fid31.cspeed3	= UBITS(254, 8);
-		    ais->type8.dac1fid31.cdir3		= UBITS(262, 9);
-		    ais->type8.dac1fid31.cdepth3	= UBITS(271, 5);
-		    ais->type8.dac1fid31.waveheight	= UBITS(276, 8);
-		    ais->type8.dac1fid31.waveperiod	= UBITS(284, 6);
-		    ais->type8.dac1fid31.wavedir	= UBITS(290, 9);
-		    ais->type8.dac1fid31.swellheight	= UBITS(299, 8);
-		    ais->type8.dac1fid31.swellperiod	= UBITS(307, 6);
-		    ais->type8.dac1fid31.swelldir	= UBITS(313, 9);
-		    ais->type8.dac1fid31.seastate	= UBITS(322, 4);
-		    ais->type8.dac1fid31.watertemp	= UBITS(326, 10)
-			- DAC1FID31_WATERTEMP_OFFSET;
-		    ais->type8.dac1fid31.preciptype	= UBITS(336, 3);
-		    ais->type8.dac1fid31.salinity	= UBITS(339, 9);
-		    ais->type8.dac1fid31.ice		= UBITS(348, 2);
-		    imo = true;
-		    break;
-		}
-	    /* land here if we failed to match a known DAC/FID */
-	    if (!imo)
-		(void)memcpy(ais->type8.bitdata,
+	    /* the application payload is unpacked on demand */
+	    (void)memcpy(ais->type8.bitdata,
 			 (char *)ais_context->bits + (56 / BITS_PER_BYTE),
-			     (ais->type8.bitcount + 7) / 8);
+			 (ais->type8.bitcount + 7) / 8);
+	    ais->type8.raw = true;
 	    break;
 	case 9: /* Standard SAR Aircraft Position Report */
 	    if (ais_context->bitlen != 168) {
@@ -755,7 +530,7 @@ bool aivdm_decode(const char *buf, size_t buflen,
 	    ais->type12.dest_mmsi      = UBITS(40, 30);
 	    ais->type12.retransmit     = (bool)UBITS(70, 1);
 	    //ais->type12.spare        = UBITS(71, 1);
-	    from_sixbit((char *)ais_context->bits,
+	    from_sixbit(ais_context->bits,
 			72, ais_context->bitlen-72,
 			ais->type12.text);
 	    break;
@@ -766,7 +541,7 @@ bool aivdm_decode(const char *buf, size_t buflen,
 		return false;
 	    }
 	    //ais->type14.spare          = UBITS(38, 2);
-	    from_sixbit((char *)ais_context->bits,
+	    from_sixbit(ais_context->bits,
 			40, ais_context->bitlen-40,
 			ais->type14.text);
 	    break;
@@ -909,10 +684,10 @@ bool aivdm_decode(const char *buf, size_t buflen,
 		return false;
 	    }
 	    ais->type21.aid_type = UBITS(38, 5);
-	    from_sixbit((char *)ais_context->bits,
+	    from_sixbit(ais_context->bits,
 			43, 21, ais->type21.name);
 	    if (strlen(ais->type21.name) == 20 && ais_context->bitlen > 272)
-		from_sixbit((char *)ais_context->bits,
+		from_sixbit(ais_context->bits,
 			    272, (ais_context->bitlen - 272)/6,
 			    ais->type21.name+20);
 	    ais->type21.accuracy     = UBITS(163, 1);
@@ -979,15 +754,15 @@ bool aivdm_decode(const char *buf, size_t buflen,
 				ais_context->bitlen);
 		    return false;
 		}
-		if (ais_context->mmsi24) {
+		if (channel->mmsi24) {
 		    gpsd_report(LOG_WARN,
 		                "AIVDM message type 24 collision on channel %c : Discarding previous sentence 24A from %09u.\n",
 		                field[4][0],
-		                ais_context->mmsi24);
+		                channel->mmsi24);
 		    /* no return false */
 		}
-		ais_context->mmsi24 = ais->mmsi;
-		UCHARS(40, ais_context->shipname24);
+		channel->mmsi24 = ais->mmsi;
+		UCHARS(40, channel->shipname24);
 		//ais->type24.a.spare	= UBITS(160, 8);
 		return false;	/* data only partially decoded */
 	    case 1:
@@ -996,12 +771,12 @@ bool aivdm_decode(const char *buf, size_t buflen,
 				ais_context->bitlen);
 		    return false;
 		}
-		if (ais_context->mmsi24 != ais->mmsi) {
-		    if (ais_context->mmsi24)
+		if (channel->mmsi24 != ais->mmsi) {
+		    if (channel->mmsi24)
 			gpsd_report(LOG_WARN,
 			            "AIVDM message type 24 collision on channel %c: MMSI mismatch: %09u vs %09u.\n",
 			            field[4][0],
-			            ais_context->mmsi24, ais->mmsi);
+			            channel->mmsi24, ais->mmsi);
 		    else
 			gpsd_report(LOG_WARN,
 			            "AIVDM message type 24 collision on channel %c: 24B sentence from %09u without 24A.\n",
@@ -1010,8 +785,8 @@ bool aivdm_decode(const char *buf, size_t buflen,
 		    return false;
 		}
 		(void)strlcpy(ais->type24.shipname,
-			      ais_context->shipname24,
-			      sizeof(ais_context->shipname24));
+			      channel->shipname24,
+			      sizeof(channel->shipname24));
 		ais->type24.shiptype = UBITS(40, 8);
 		UCHARS(48, ais->type24.vendorid);
 		UCHARS(90, ais->type24.callsign);
@@ -1024,7 +799,7 @@ bool aivdm_decode(const char *buf, size_t buflen,
 		    ais->type24.dim.to_starboard  = UBITS(156, 6);
 		}
 		//ais->type24.b.spare	    = UBITS(162, 8);
-		ais_context->mmsi24 = 0; /* reset last know 24A for collision detection */
+		channel->mmsi24 = 0; /* reset last know 24A for collision detection */
 		break;
 	    default:
 		gpsd_report(LOG_WARN, "AIVDM message type 24 of subtype unknown.\n");
@@ -1112,6 +887,594 @@ bool aivdm_decode(const char *buf, size_t buflen,
     return false;
 }
 
+/*
+ * The DAC/FID application payloads of types 6 and 8 cost more to pick
+ * apart than everything else in the message put together, and most
+ * of them are never looked at.  aivdm_decode() leaves them as raw bits
+ * in bitdata with the raw flag set; this unpacks one when somebody is
+ * actually about to use it.  It is a no-op if there is nothing to do.
+ */
+void aivdm_decode_payload(struct ais_t *ais)
+{
+    /* the message as received, for the bit offsets in the layouts */
+    unsigned char bits[1008 / 8 + AIVDM_SLACK];
+    size_t bitlen;
+    bool imo;
+    int i;
+    unsigned int u;
+
+#define BITS_PER_BYTE	8
+#define UBITS(s, l)	aivdm_ubits(bits, s, l)
+#define SBITS(s, l)	aivdm_sbits(bits, s, l)
+#define UCHARS(s, to)	from_sixbit(bits, s, sizeof(to), to)
+    (void)memset(bits, '\0', sizeof(bits));
+    aivdm_putbits(bits, 0, 6, ais->type);
+    aivdm_putbits(bits, 6, 2, ais->repeat);
+    aivdm_putbits(bits, 8, 30, ais->mmsi);
+    /* *INDENT-OFF* */
+    switch (ais->type) {
+    case 6:
+	if (!ais->type6.raw)
+	    return;
+	ais->type6.raw = false;
+	aivdm_putbits(bits, 38, 2, ais->type6.seqno);
+	aivdm_putbits(bits, 40, 30, ais->type6.dest_mmsi);
+	aivdm_putbits(bits, 70, 1, ais->type6.retransmit);
+	aivdm_putbits(bits, 72, 10, ais->type6.dac);
+	aivdm_putbits(bits, 82, 6, ais->type6.fid);
+	(void)memcpy(bits + (88 / BITS_PER_BYTE), ais->type6.bitdata,
+		     (ais->type6.bitcount + 7) / 8);
+	bitlen = 88 + ais->type6.bitcount;
+	imo = false;
+	if (ais->type8.dac == 1)
+	    switch (ais->type8.fid) {
+	    case 12:	/* IMO236 - Dangerous cargo indication */
+		UCHARS(88, ais->type6.dac1fid12.lastport);
+		ais->type6.dac1fid12.lmonth		= UBITS(118, 4);
+		ais->type6.dac1fid12.lday		= UBITS(122, 5);
+		ais->type6.dac1fid12.lhour		= UBITS(127, 5);
+		ais->type6.dac1fid12.lminute	= UBITS(132, 6);
+		UCHARS(138, ais->type6.dac1fid12.nextport);
+		ais->type6.dac1fid12.nmonth		= UBITS(168, 4);
+		ais->type6.dac1fid12.nday		= UBITS(172, 5);
+		ais->type6.dac1fid12.nhour		= UBITS(177, 5);
+		ais->type6.dac1fid12.nminute	= UBITS(182, 6);
+		UCHARS(188, ais->type6.dac1fid12.dangerous);
+		UCHARS(308, ais->type6.dac1fid12.imdcat);
+		ais->type6.dac1fid12.unid		= UBITS(332, 13);
+		ais->type6.dac1fid12.amount		= UBITS(345, 10);
+		ais->type6.dac1fid12.unit		= UBITS(355, 2);
+		/* skip 3 bits */
+		break;
+	    case 14:	/* IMO236 - Tidal Window */
+		ais->type6.dac1fid32.month	= UBITS(88, 4);
+		ais->type6.dac1fid32.day	= UBITS(92, 5);
+#define ARRAY_BASE 97
+#define ELEMENT_SIZE 93
+		for (u = 0; ARRAY_BASE + (ELEMENT_SIZE*u) <= bitlen; u++) {
+		    int a = ARRAY_BASE + (ELEMENT_SIZE*u);
+		    struct tidal_t *tp = &ais->type6.dac1fid32.tidals[u];
+		    tp->lat	= SBITS(a + 0, 27);
+		    tp->lon	= SBITS(a + 27, 28);
+		    tp->from_hour	= UBITS(a + 55, 5);
+		    tp->from_min	= UBITS(a + 60, 6);
+		    tp->to_hour	= UBITS(a + 66, 5);
+		    tp->to_min	= UBITS(a + 71, 6);
+		    tp->cdir	= UBITS(a + 77, 9);
+		    tp->cspeed	= UBITS(a + 86, 7);
+		}
+		ais->type6.dac1fid32.ntidals = u;
+#undef ARRAY_BASE
+#undef ELEMENT_SIZE
+		break;
+	    case 15:	/* IMO236 - Extended Ship Static and Voyage Related Data */
+		ais->type6.dac1fid15.airdraught	= UBITS(56, 11);
+		break;
+	    case 16:	/* IMO236 - Number of persons on board */
+		if (ais->type6.bitcount == 136)
+		    ais->type6.dac1fid16.persons = UBITS(88, 13);/* 289 */
+		else
+		    ais->type6.dac1fid16.persons = UBITS(55, 13);/* 236 */
+		imo = true;
+		break;
+	    case 18:	/* IMO289 - Clearance time to enter port */
+		ais->type6.dac1fid18.linkage	= UBITS(88, 10);
+		ais->type6.dac1fid18.month	= UBITS(98, 4);
+		ais->type6.dac1fid18.day	= UBITS(102, 5);
+		ais->type6.dac1fid18.hour	= UBITS(107, 5);
+		ais->type6.dac1fid18.minute	= UBITS(112, 6);
+		UCHARS(118, ais->type6.dac1fid18.portname);
+		UCHARS(238, ais->type6.dac1fid18.destination);
+		ais->type6.dac1fid18.lon	= SBITS(268, 25);
+		ais->type6.dac1fid18.lat	= SBITS(293, 24);
+		/* skip 43 bits */
+		break;
+	    case 20:	/* IMO289 - Berthing data - addressed */
+		ais->type6.dac1fid20.linkage	= UBITS(88, 10);
+		ais->type6.dac1fid20.berth_length	= UBITS(98, 9);
+		ais->type6.dac1fid20.berth_depth	= UBITS(107, 8);
+		ais->type6.dac1fid20.position	= UBITS(115, 3);
+		ais->type6.dac1fid20.month		= UBITS(118, 4);
+		ais->type6.dac1fid20.day		= UBITS(122, 5);
+		ais->type6.dac1fid20.hour		= UBITS(127, 5);
+		ais->type6.dac1fid20.minute		= UBITS(132, 6);
+		ais->type6.dac1fid20.availability	= UBITS(138, 1);
+		ais->type6.dac1fid20.agent		= UBITS(139, 2);
+		ais->type6.dac1fid20.fuel		= UBITS(141, 2);
+		ais->type6.dac1fid20.chandler	= UBITS(143, 2);
+		ais->type6.dac1fid20.stevedore	= UBITS(145, 2);
+		ais->type6.dac1fid20.electrical	= UBITS(147, 2);
+		ais->type6.dac1fid20.water		= UBITS(149, 2);
+		ais->type6.dac1fid20.customs	= UBITS(151, 2);
+		ais->type6.dac1fid20.cartage	= UBITS(153, 2);
+		ais->type6.dac1fid20.crane		= UBITS(155, 2);
+		ais->type6.dac1fid20.lift		= UBITS(157, 2);
+		ais->type6.dac1fid20.medical	= UBITS(159, 2);
+		ais->type6.dac1fid20.navrepair	= UBITS(161, 2);
+		ais->type6.dac1fid20.provisions	= UBITS(163, 2);
+		ais->type6.dac1fid20.shiprepair	= UBITS(165, 2);
+		ais->type6.dac1fid20.surveyor	= UBITS(167, 2);
+		ais->type6.dac1fid20.steam		= UBITS(169, 2);
+		ais->type6.dac1fid20.tugs		= UBITS(171, 2);
+		ais->type6.dac1fid20.solidwaste	= UBITS(173, 2);
+		ais->type6.dac1fid20.liquidwaste	= UBITS(175, 2);
+		ais->type6.dac1fid20.hazardouswaste	= UBITS(177, 2);
+		ais->type6.dac1fid20.ballast	= UBITS(179, 2);
+		ais->type6.dac1fid20.additional	= UBITS(181, 2);
+		ais->type6.dac1fid20.regional1	= UBITS(183, 2);
+		ais->type6.dac1fid20.regional2	= UBITS(185, 2);
+		ais->type6.dac1fid20.future1	= UBITS(187, 2);
+		ais->type6.dac1fid20.future2	= UBITS(189, 2);
+		UCHARS(191, ais->type6.dac1fid20.berth_name);
+		ais->type6.dac1fid20.berth_lon	= SBITS(311, 25);
+		ais->type6.dac1fid20.berth_lat	= SBITS(336, 24);
+		break;
+	    case 23:        /* IMO289 - Area notice - addressed */
+		break;
+	    case 25:	/* IMO289 - Dangerous cargo indication */
+		ais->type6.dac1fid25.unit 	= UBITS(88, 2);
+		ais->type6.dac1fid25.amount	= UBITS(90, 10);
+		for (i = 0;	100 + i*17 < (int)bitlen; i++) {
+		    ais->type6.dac1fid25.cargos[i].code 	= UBITS(100 + i*17, 4);
+		    ais->type6.dac1fid25.cargos[i].subtype	= UBITS(104 + i*17, 13);
+		}
+		ais->type6.dac1fid25.ncargos = i;
+		break;
+	    case 28:	/* IMO289 - Route info - addressed */
+		ais->type6.dac1fid28.linkage	= UBITS(88, 10);
+		ais->type6.dac1fid28.sender		= UBITS(98, 3);
+		ais->type6.dac1fid28.rtype		= UBITS(101, 5);
+		ais->type6.dac1fid28.month		= UBITS(106, 4);
+		ais->type6.dac1fid28.day		= UBITS(110, 5);
+		ais->type6.dac1fid28.hour		= UBITS(115, 5);
+		ais->type6.dac1fid28.minute		= UBITS(120, 6);
+		ais->type6.dac1fid28.duration	= UBITS(126, 18);
+		ais->type6.dac1fid28.waycount	= UBITS(144, 5);
+#define ARRAY_BASE 149
+#define ELEMENT_SIZE 55
+		for (i = 0; i < ais->type6.dac1fid28.waycount; u++) {
+		    int a = ARRAY_BASE + (ELEMENT_SIZE*i);
+		    ais->type6.dac1fid28.waypoints[i].lon = SBITS(a+0, 28);
+		    ais->type6.dac1fid28.waypoints[i].lat = SBITS(a+28,27);
+		}
+#undef ARRAY_BASE
+#undef ELEMENT_SIZE
+		break;
+	    case 30:	/* IMO289 - Text description - addressed */
+		ais->type6.dac1fid30.linkage   = UBITS(88, 10);
+		from_sixbit(bits,
+			    98, bitlen-98,
+			    ais->type6.dac1fid30.text);
+		break;
+	    case 32:	/* IMO289 - Tidal Window */
+		ais->type6.dac1fid32.month	= UBITS(88, 4);
+		ais->type6.dac1fid32.day	= UBITS(92, 5);
+#define ARRAY_BASE 97
+#define ELEMENT_SIZE 88
+		for (u = 0; ARRAY_BASE + (ELEMENT_SIZE*u) <= bitlen; u++) {
+		    int a = ARRAY_BASE + (ELEMENT_SIZE*u);
+		    struct tidal_t *tp = &ais->type6.dac1fid32.tidals[u];
+		    tp->lon	= SBITS(a + 0, 25);
+		    tp->lat	= SBITS(a + 25, 24);
+		    tp->from_hour	= UBITS(a + 49, 5);
+		    tp->from_min	= UBITS(a + 54, 6);
+		    tp->to_hour	= UBITS(a + 60, 5);
+		    tp->to_min	= UBITS(a + 65, 6);
+		    tp->cdir	= UBITS(a + 71, 9);
+		    tp->cspeed	= UBITS(a + 80, 8);
+		}
+		ais->type6.dac1fid32.ntidals = u;
+#undef ARRAY_BASE
+#undef ELEMENT_SIZE
+		break;
+	    }
+	if (!imo)
+	    (void)memcpy(ais->type6.bitdata,
+			 (char *)bits + (88 / BITS_PER_BYTE),
+			 (ais->type6.bitcount + 7) / 8);
+	break;
+    case 8:
+	if (!ais->type8.raw)
+	    return;
+	ais->type8.raw = false;
+	aivdm_putbits(bits, 40, 10, ais->type8.dac);
+	aivdm_putbits(bits, 50, 6, ais->type8.fid);
+	(void)memcpy(bits + (56 / BITS_PER_BYTE), ais->type8.bitdata,
+		     (ais->type8.bitcount + 7) / 8);
+	bitlen = 56 + ais->type8.bitcount;
+	imo = false;
+	if (ais->type8.dac == 1)
+	    switch (ais->type8.fid) {
+	    case 11:        /* IMO236 - Meteorological/Hydrological data */
+		/* layout is almost identical to FID=31 from IMO289 */
+		ais->type8.dac1fid31.lat		= SBITS(56, 24);
+		ais->type8.dac1fid31.lon		= SBITS(80, 25);
+		ais->type8.dac1fid31.accuracy       = false;
+		ais->type8.dac1fid31.day		= UBITS(105, 5);
+		ais->type8.dac1fid31.hour		= UBITS(110, 5);
+		ais->type8.dac1fid31.minute		= UBITS(115, 6);
+		ais->type8.dac1fid31.wspeed		= UBITS(121, 7);
+		ais->type8.dac1fid31.wgust		= UBITS(128, 7);
+		ais->type8.dac1fid31.wdir		= UBITS(135, 9);
+		ais->type8.dac1fid31.wgustdir	= UBITS(144, 9); 
+		ais->type8.dac1fid31.airtemp	= SBITS(153, 11)
+		    - DAC1FID31_AIRTEMP_OFFSET;
+		ais->type8.dac1fid31.humidity	= UBITS(164, 7);
+		ais->type8.dac1fid31.dewpoint	= UBITS(171, 10)
+		    - DAC1FID31_DEWPOINT_OFFSET;
+		ais->type8.dac1fid31.pressure	= UBITS(181, 9)
+		    - DAC1FID31_PRESSURE_OFFSET;
+		ais->type8.dac1fid31.pressuretend	= UBITS(190, 2);
+		ais->type8.dac1fid31.visgreater     = false;
+		ais->type8.dac1fid31.visibility	= UBITS(192, 8);
+		ais->type8.dac1fid31.waterlevel	= UBITS(200, 9)
+		    - DAC1FID11_LEVEL_OFFSET;
+		ais->type8.dac1fid31.leveltrend	= UBITS(209, 2);
+		ais->type8.dac1fid31.cspeed		= UBITS(211, 8);
+		ais->type8.dac1fid31.cdir		= UBITS(219, 9);
+		ais->type8.dac1fid31.cspeed2	= UBITS(228, 8);
+		ais->type8.dac1fid31.cdir2		= UBITS(236, 9);
+		ais->type8.dac1fid31.cdepth2	= UBITS(245, 5);
+		ais->type8.dac1fid31.cspeed3	= UBITS(250, 8);
+		ais->type8.dac1fid31.cdir3		= UBITS(258, 9);
+		ais->type8.dac1fid31.cdepth3	= UBITS(267, 5);
+		ais->type8.dac1fid31.waveheight	= UBITS(272, 8);
+		ais->type8.dac1fid31.waveperiod	= UBITS(280, 6);
+		ais->type8.dac1fid31.wavedir	= UBITS(286, 9);
+		ais->type8.dac1fid31.swellheight	= UBITS(295, 8);
+		ais->type8.dac1fid31.swellperiod	= UBITS(303, 6);
+		ais->type8.dac1fid31.swelldir	= UBITS(309, 9);
+		ais->type8.dac1fid31.seastate	= UBITS(318, 4);
+		ais->type8.dac1fid31.watertemp	= UBITS(322, 10)
+		    - DAC1FID31_WATERTEMP_OFFSET;
+		ais->type8.dac1fid31.preciptype	= UBITS(332, 3);
+		ais->type8.dac1fid31.salinity	= UBITS(335, 9);
+		ais->type8.dac1fid31.ice		= UBITS(344, 2);
+		imo = true;
+		break;
+	    case 13:        /* IMO236 - Fairway closed */
+		UCHARS(56, ais->type8.dac1fid13.reason);
+		UCHARS(176, ais->type8.dac1fid13.closefrom);
+		UCHARS(296, ais->type8.dac1fid13.closeto);
+		ais->type8.dac1fid13.radius 	= UBITS(416, 10);
+		ais->type8.dac1fid13.extunit	= UBITS(426, 2);
+		ais->type8.dac1fid13.fday   	= UBITS(428, 5);
+		ais->type8.dac1fid13.fmonth 	= UBITS(433, 4);
+		ais->type8.dac1fid13.fhour  	= UBITS(437, 5);
+		ais->type8.dac1fid13.fminute	= UBITS(442, 6);
+		ais->type8.dac1fid13.tday   	= UBITS(448, 5);
+		ais->type8.dac1fid13.tmonth 	= UBITS(453, 4);
+		ais->type8.dac1fid13.thour  	= UBITS(457, 5);
+		ais->type8.dac1fid13.tminute	= UBITS(462, 6);
+		/* skip 4 bits */
+		break;
+	    case 15:        /* IMO236 - Extended ship and voyage */
+		ais->type8.dac1fid15.airdraught	= UBITS(56, 11);
+		/* skip 5 bits */
+		break;
+	    case 17:        /* IMO289 - VTS-generated/synthetic targets */
+#define ARRAY_BASE 56
+#define ELEMENT_SIZE 122
+		for (u = 0; ARRAY_BASE + (ELEMENT_SIZE*u) <= bitlen; u++) {
+		    struct target_t *tp = &ais->type8.dac1fid17.targets[u];
+		    int a = ARRAY_BASE + (ELEMENT_SIZE*u);
+		    tp->idtype = UBITS(a + 0, 2);
+		    switch (tp->idtype) {
+		    case DAC1FID17_IDTYPE_MMSI:
+			tp->id.mmsi	= UBITS(a + 2, 42);
+			break;
+		    case DAC1FID17_IDTYPE_IMO:
+			tp->id.imo	= UBITS(a + 2, 42);
+			break;
+		    case DAC1FID17_IDTYPE_CALLSIGN:
+			UCHARS(a+2, tp->id.callsign);
+			break;
+		    default:
+			UCHARS(a+2, tp->id.other);
+			break;
+		    }
+		    /* skip 4 bits */
+		    tp->lat	= SBITS(a + 48, 24);
+		    tp->lon	= SBITS(a + 72, 25);
+		    tp->course	= UBITS(a + 97, 9);
+		    tp->second	= UBITS(a + 106, 6);
+		    tp->speed	= UBITS(a + 112, 10);
+		}
+		ais->type8.dac1fid17.ntargets = u;
+#undef ARRAY_BASE
+#undef ELEMENT_SIZE
+		break;
+	    case 19:        /* IMO289 - Marine Traffic Signal */
+		ais->type8.dac1fid19.linkage	= UBITS(56, 10);
+		UCHARS(66, ais->type8.dac1fid19.station);
+		ais->type8.dac1fid19.lon	= SBITS(186, 25);
+		ais->type8.dac1fid19.lat	= SBITS(211, 24);
+		ais->type8.dac1fid19.status	= UBITS(235, 2);
+		ais->type8.dac1fid19.signal	= UBITS(237, 5);
+		ais->type8.dac1fid19.hour	= UBITS(242, 5);
+		ais->type8.dac1fid19.minute	= UBITS(247, 6);
+		ais->type8.dac1fid19.nextsignal	= UBITS(253, 5);
+		/* skip 102 bits */
+		break;
+	    case 21:        /* IMO289 - Weather obs. report from ship */
+		break;
+	    case 22:        /* IMO289 - Area notice - broadcast */
+		break;
+	    case 24:        /* IMO289 - Extended ship static & voyage-related data */
+		break;
+	    case 26:        /* IMO289 - Environmental */
+		break;
+	    case 27:        /* IMO289 - Route information - broadcast */
+		ais->type8.dac1fid27.linkage	= UBITS(56, 10);
+		ais->type8.dac1fid27.sender	= UBITS(66, 3);
+		ais->type8.dac1fid27.rtype	= UBITS(69, 5);
+		ais->type8.dac1fid27.month	= UBITS(74, 4);
+		ais->type8.dac1fid27.day	= UBITS(78, 5);
+		ais->type8.dac1fid27.hour	= UBITS(83, 5);
+		ais->type8.dac1fid27.minute	= UBITS(88, 6);
+		ais->type8.dac1fid27.duration	= UBITS(94, 18);
+		ais->type8.dac1fid27.waycount	= UBITS(112, 5);
+#define ARRAY_BASE 117
+#define ELEMENT_SIZE 55
+		for (i = 0; i < ais->type8.dac1fid27.waycount; i++) {
+		    int a = ARRAY_BASE + (ELEMENT_SIZE*i);
+		    ais->type8.dac1fid27.waypoints[i].lon	= SBITS(a + 0, 28);
+		    ais->type8.dac1fid27.waypoints[i].lat	= SBITS(a + 28, 27);
+		}
+#undef ARRAY_BASE
+#undef ELEMENT_SIZE
+		break;
+	    case 29:        /* IMO289 - Text Description - broadcast */
+		ais->type8.dac1fid29.linkage   = UBITS(56, 10);
+		from_sixbit(bits,
+			    66, bitlen-66,
+			    ais->type8.dac1fid29.text);
+		break;
+	    case 31:        /* IMO289 - Meteorological/Hydrological data */
+		ais->type8.dac1fid31.lat		= SBITS(56, 24);
+		ais->type8.dac1fid31.lon		= SBITS(80, 25);
+		ais->type8.dac1fid31.accuracy       = (bool)UBITS(105, 1);
+		ais->type8.dac1fid31.day		= UBITS(106, 5);
+		ais->type8.dac1fid31.hour		= UBITS(111, 5);
+		ais->type8.dac1fid31.minute		= UBITS(116, 6);
+		ais->type8.dac1fid31.wspeed		= UBITS(122, 7);
+		ais->type8.dac1fid31.wgust		= UBITS(129, 7);
+		ais->type8.dac1fid31.wdir		= UBITS(136, 9);
+		ais->type8.dac1fid31.wgustdir	= UBITS(145, 9); 
+		ais->type8.dac1fid31.airtemp	= SBITS(154, 11)
+		    - DAC1FID31_AIRTEMP_OFFSET;
+		ais->type8.dac1fid31.humidity	= UBITS(165, 7);
+		ais->type8.dac1fid31.dewpoint	= UBITS(172, 10)
+		    - DAC1FID31_DEWPOINT_OFFSET;
+		ais->type8.dac1fid31.pressure	= UBITS(182, 9)
+		    - DAC1FID31_PRESSURE_OFFSET;
+		ais->type8.dac1fid31.pressuretend	= UBITS(191, 2);
+		ais->type8.dac1fid31.visgreater	= UBITS(193, 1);
+		ais->type8.dac1fid31.visibility	= UBITS(194, 7);
+		ais->type8.dac1fid31.waterlevel	= UBITS(200, 12)
+		    - DAC1FID31_LEVEL_OFFSET;
+		ais->type8.dac1fid31.leveltrend	= UBITS(213, 2);
+		ais->type8.dac1fid31.cspeed		= UBITS(215, 8);
+		ais->type8.dac1fid31.cdir		= UBITS(223, 9);
+		ais->type8.dac1fid31.cspeed2	= UBITS(232, 8);
+		ais->type8.dac1fid31.cdir2		= UBITS(240, 9);
+		ais->type8.dac1fid31.cdepth2	= UBITS(249, 5);
+		ais->type8.dac1fid31.cspeed3	= UBITS(254, 8);
+		ais->type8.dac1fid31.cdir3		= UBITS(262, 9);
+		ais->type8.dac1fid31.cdepth3	= UBITS(271, 5);
+		ais->type8.dac1fid31.waveheight	= UBITS(276, 8);
+		ais->type8.dac1fid31.waveperiod	= UBITS(284, 6);
+		ais->type8.dac1fid31.wavedir	= UBITS(290, 9);
+		ais->type8.dac1fid31.swellheight	= UBITS(299, 8);
+		ais->type8.dac1fid31.swellperiod	= UBITS(307, 6);
+		ais->type8.dac1fid31.swelldir	= UBITS(313, 9);
+		ais->type8.dac1fid31.seastate	= UBITS(322, 4);
+		ais->type8.dac1fid31.watertemp	= UBITS(326, 10)
+		    - DAC1FID31_WATERTEMP_OFFSET;
+		ais->type8.dac1fid31.preciptype	= UBITS(336, 3);
+		ais->type8.dac1fid31.salinity	= UBITS(339, 9);
+		ais->type8.dac1fid31.ice		= UBITS(348, 2);
+		imo = true;
+		break;
+	    }
+	/* land here if we failed to match a known DAC/FID */
+	if (!imo)
+	    (void)memcpy(ais->type8.bitdata,
+			 (char *)bits + (56 / BITS_PER_BYTE),
+			 (ais->type8.bitcount + 7) / 8);
+	break;
+    }
+    /* *INDENT-ON* */
+#undef UCHARS
+#undef SBITS
+#undef UBITS
+#undef BITS_PER_BYTE
+}
+
 /*@ -charint +fixedformalarray +usedef +branchstate @*/
 
+#ifdef AIVDM_ENABLE
+/*
+ * Duplicate filtering.  With several receivers (or a receiver and a
+ * network feed) on one daemon, the same radio message comes in once
+ * per receiver.  Payload and pad identify it; talker, channel and
+ * sequence ID differ between receivers and are left out of the key.
+ * A multipart message is judged once, on its first fragment, and its
+ * later fragments on each device go the same way: a receiver can only
+ * reassemble a message it kept the start of, and the copies of a
+ * message on two feeds may arrive with their fragments interleaved.
+ */
+#define FNV_OFFSET	0xcbf29ce484222325ULL
+#define FNV_PRIME	0x100000001b3ULL
+
+static void aivdm_dedup_report(struct gps_device_t *session, timestamp_t now)
+/* log how many of this device's sentences were heard elsewhere first */
+{
+    char buf[BUFSIZ];
+    int i;
+
+    session->aivdm_dedup.reported = now;
+    if (session->aivdm_dedup.tagged > 0) {
+	gpsd_report(LOG_INF,
+		    "AIVDM tag blocks: %s: %lu sentences, mean age %.1f sec\n",
+		    session->gpsdata.dev.path,
+		    session->aivdm_dedup.tagged,
+		    session->aivdm_dedup.latency / session->aivdm_dedup.tagged);
+    }
+    if (session->aivdm_dedup.duplicates == 0)
+	return;
+    (void)snprintf(buf, sizeof(buf),
+		   "AIVDM dedup: %s: %lu of %lu sentences were duplicates (%.1f%%)",
+		   session->gpsdata.dev.path,
+		   session->aivdm_dedup.duplicates,
+		   session->aivdm_dedup.sentences,
+		   session->aivdm_dedup.duplicates * 100.0
+		   / session->aivdm_dedup.sentences);
+    for (i = 0; i < AIVDM_DEDUP_PEERS; i++)
+	if (session->aivdm_dedup.peers[i].first[0] != '\0')
+	    (void)snprintf(buf + strlen(buf), sizeof(buf) - strlen(buf),
+			   ", %lu (%.1f%%) first heard on %s",
+			   session->aivdm_dedup.peers[i].count,
+			   session->aivdm_dedup.peers[i].count * 100.0
+			   / session->aivdm_dedup.sentences,
+			   session->aivdm_dedup.peers[i].first);
+    gpsd_report(LOG_INF, "%s\n", buf);
+}
+
+bool aivdm_duplicate(struct gps_device_t *session)
+/* has this sentence's message been heard within the window, here or elsewhere? */
+{
+    struct gps_context_t *context = session->context;
+    const unsigned char *cp = session->packet.outbuffer;
+    const unsigned char *end = cp + session->packet.outbuflen;
+    const unsigned char *field[7];
+    const char *heard = NULL;
+    uint64_t hash = FNV_OFFSET;
+    timestamp_t now = session->packet.recv_time;
+    int nfields = 0, i, way = 0;
+    uint32_t key;
+    bool single, first;
+    struct aivdm_seen_t *bucket;
+
+    if (now == 0)
+	now = timestamp();
+    for (; cp < end && *cp != '*'; cp++)
+	if (*cp == ',') {
+	    if (nfields < (int)NITEMS(field))
+		field[nfields] = cp + 1;
+	    nfields++;
+	}
+    if (nfields < 6)
+	return false;		/* aivdm_decode() will complain */
+
+    single = field[0][0] == '1' && field[0][1] == ',';
+    first = field[1][0] == '1' && field[1][1] == ',';
+    /* a multipart message is told apart as aivdm_decode() reassembles it */
+    key = ((uint32_t)session->packet.outbuffer[1] << 24)
+	| ((uint32_t)session->packet.outbuffer[2] << 16)
+	| ((uint32_t)*field[3] << 8) | (uint32_t)*field[2];
+    if (!single && !first) {
+	/* a later fragment goes wherever this device's first one went */
+	for (i = 0; i < AIVDM_PENDING; i++)
+	    if (session->aivdm_dedup.multipart[i].key == key
+		&& session->aivdm_dedup.multipart[i].started != 0) {
+		if (session->aivdm_dedup.multipart[i].heard[0] != '\0')
+		    heard = session->aivdm_dedup.multipart[i].heard;
+		break;
+	    }
+    } else {
+	for (cp = field[4]; cp < end && *cp != '*'; cp++)
+	    hash = (hash ^ *cp) * FNV_PRIME;
+	if (hash == 0)
+	    hash = 1;		/* 0 marks an empty slot */
+
+	bucket = context->aivdm_seen[hash & (AIVDM_DEDUP_BUCKETS - 1)];
+	for (i = 0; i < AIVDM_DEDUP_WAYS; i++) {
+	    if (bucket[i].hash == hash
+		&& now - bucket[i].seen <= AIVDM_DEDUP_WINDOW) {
+		heard = bucket[i].device;
+		break;
+	    }
+	    if (bucket[i].seen < bucket[way].seen)
+		way = i;
+	}
+	/*
+	 * Where a message was heard is kept by device path, not device:
+	 * a device's slot in the daemon's pool can be freed and reused
+	 * while its messages are still remembered.
+	 */
+	if (heard == NULL) {
+	    bucket[way].hash = hash;
+	    bucket[way].seen = now;
+	    (void)strlcpy(bucket[way].device, session->gpsdata.dev.path,
+			  sizeof(bucket[way].device));
+	}
+	if (!single) {
+	    /* replace an earlier message with this key, else the oldest */
+	    for (way = i = 0; i < AIVDM_PENDING; i++) {
+		if (session->aivdm_dedup.multipart[i].key == key) {
+		    way = i;
+		    break;
+		}
+		if (session->aivdm_dedup.multipart[i].started
+		    < session->aivdm_dedup.multipart[way].started)
+		    way = i;
+	    }
+	    session->aivdm_dedup.multipart[way].key = key;
+	    session->aivdm_dedup.multipart[way].started = now;
+	    (void)strlcpy(session->aivdm_dedup.multipart[way].heard,
+			  heard != NULL ? heard : "",
+			  sizeof(session->aivdm_dedup.multipart[way].heard));
+	}
+    }
+
+    session->aivdm_dedup.sentences++;
+#ifdef NMEA_ENABLE
+    /* an aggregator's tag block says when the station heard it */
+    if (session->packet.tag.time != 0) {
+	session->aivdm_dedup.tagged++;
+	session->aivdm_dedup.latency += now - session->packet.tag.time;
+    }
+#endif /* NMEA_ENABLE */
+    if (heard != NULL) {
+	session->aivdm_dedup.duplicates++;
+	for (way = 0; way < AIVDM_DEDUP_PEERS; way++)
+	    if (strcmp(session->aivdm_dedup.peers[way].first, heard) == 0
+		|| session->aivdm_dedup.peers[way].first[0] == '\0') {
+		(void)strlcpy(session->aivdm_dedup.peers[way].first, heard,
+			      sizeof(session->aivdm_dedup.peers[way].first));
+		session->aivdm_dedup.peers[way].count++;
+		break;
+	    }
+    }
+    if (now - session->aivdm_dedup.reported > AIVDM_DEDUP_REPORT) {
+	if (session->aivdm_dedup.reported != 0)
+	    aivdm_dedup_report(session, now);
+	session->aivdm_dedup.reported = now;
+    }
+    session->aivdm_dedup.last = heard != NULL;
+    return session->aivdm_dedup.last;
+}
+#endif /* AIVDM_ENABLE */
+
 /* driver_aivdm.c ends here */
@@ -144,7 +144,7 @@ gps_mask_t evermore_parse(struct gps_device_t * session, unsigned char *buf,
 {
     unsigned char buf2[MAX_PACKET_LENGTH], *cp, *tp;
     size_t i, datalen;
-    unsigned int type, used, visible, satcnt, j, k;
+    unsigned int type, used, visible, satcnt, k;
     double version;
     gps_mask_t mask = 0;
 
@@ -334,28 +334,20 @@ gps_mask_t evermore_parse(struct gps_device_t * session, unsigned char *buf,
 	 */
 #define SBITS(sat, s, l)	sbits((char *)buf, 10 + (sat*14) + s, l)
 #define UBITS(sat, s, l)	ubits((char *)buf, 10 + (sat*14) + s, l)
-	for (k = 0; k < visible; k++) {
-	    int prn = (int)UBITS(k, 4, 5);
-	    /* this is so we can tell which never got set */
-	    for (j = 0; j < MAXCHANNELS; j++)
-		session->gpsdata.raw.mtime[j] = 0;
-	    for (j = 0; j < MAXCHANNELS; j++) {
-		if (session->gpsdata.PRN[j] == prn) {
-		    session->gpsdata.raw.codephase[j] = NAN;
-		    session->gpsdata.raw.carrierphase[j] = NAN;
-		    session->gpsdata.raw.mtime[j] = session->newdata.time;
-		    session->gpsdata.raw.satstat[j] = (unsigned)UBITS(k, 24, 8);
-		    session->gpsdata.raw.pseudorange[j] = (double)SBITS(k,40,32);
-		    session->gpsdata.raw.deltarange[j] = (double)SBITS(k,72,32);
-		    session->gpsdata.raw.doppler[j] = (double)SBITS(k, 104, 16);
-		}
-	    }
+	gpsd_raw_clear(&session->gpsdata.raw);
+	for (k = 0; k < visible && k < MAXCHANNELS; k++) {
+	    session->gpsdata.raw.PRN[k] = (int)UBITS(k, 4, 5);
+	    session->gpsdata.raw.mtime[k] = session->newdata.time;
+	    session->gpsdata.raw.satstat[k] = (unsigned)UBITS(k, 24, 8);
+	    session->gpsdata.raw.pseudorange[k] = (double)SBITS(k,40,32);
+	    session->gpsdata.raw.deltarange[k] = (double)SBITS(k,72,32);
+	    session->gpsdata.raw.doppler[k] = (double)SBITS(k, 104, 16);
 	}
 #undef SBITS
 #undef UBITS
 	gpsd_report(LOG_DATA, "MDO 0x04: time=%.2f mask={TIME|RAW}\n",
 		    session->newdata.time);
-	return TIME_SET | PPSTIME_IS | RAW_IS;
+	return TIME_SET | PPSTIME_IS | RAW_SET;
 
     case 0x20:			/* LogConfig Info, could be used as a probe for EverMore GPS */
 	gpsd_report(LOG_IO, "LogConfig EverMore packet, length %zd\n", datalen);
@@ -614,7 +606,7 @@ const struct gps_type_t evermore_binary =
     .probe_detect   = NULL,			/* no probe */
     .get_packet     = generic_get,		/* use generic one */
     .parse_packet   = evermore_parse_input,	/* parse message packets */
-    .rtcm_writer    = gpsd_write,		/* send RTCM data straight */
+    .rtcm_writer    = gpsd_write_correction,		/* send RTCM data straight */
     .event_hook     = evermore_event_hook,	/* lifetime event handler */
 #ifdef RECONFIGURE_ENABLE
     .speed_switcher = evermore_speed,		/* we can change baud rates */
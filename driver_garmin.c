@@ -1108,7 +1108,7 @@ gps_mask_t garmin_ser_parse(struct gps_device_t *session)
 
     // sending ACK too soon might hang the session
     // so send ACK last, after a pause
-    (void)usleep(300);
+    gpsd_write_pause(session, 0.0003);
     Send_ACK();
     /*@ +usedef +compdef @*/
     gpsd_report(LOG_IO, "Garmin: garmin_ser_parse( )\n");
@@ -1118,15 +1118,10 @@ gps_mask_t garmin_ser_parse(struct gps_device_t *session)
 /*@ -charint @*/
 
 #ifdef RECONFIGURE_ENABLE
-static void settle(void)
+static void settle(struct gps_device_t *session)
+/* keep quiet for 333mS after what's been sent goes out */
 {
-    struct timespec delay, rem;
-    /*@ -type -unrecog @*/
-    memset(&delay, 0, sizeof(delay));
-    delay.tv_sec = 0;
-    delay.tv_nsec = 333000000L;
-    nanosleep(&delay, &rem);
-    /*@ +type +unrecog @*/
+    gpsd_write_pause(session, 0.333);
 }
 
 static void garmin_switcher(struct gps_device_t *session, int mode)
@@ -1145,17 +1140,17 @@ static void garmin_switcher(struct gps_device_t *session, int mode)
 	} else {
 	    gpsd_report(LOG_ERROR, "Garmin: => GPS: FAILED\n");
 	}
-	settle();		// wait 333mS, essential!
+	settle(session);	// wait 333mS, essential!
 
 	/* once a sec, no binary, no averaging, NMEA 2.3, WAAS */
 	(void)nmea_send(session, "$PGRMC1,1,1");
 	//(void)nmea_send(fd, "$PGRMC1,1,1,1,,,,2,W,N");
 	(void)nmea_send(session, "$PGRMI,,,,,,,R");
-	settle();		// wait 333mS, essential!
+	settle(session);	// wait 333mS, essential!
     } else {
 	(void)nmea_send(session, "$PGRMC1,1,2,1,,,,2,W,N");
 	(void)nmea_send(session, "$PGRMI,,,,,,,R");
-	settle();		// wait 333mS, essential!
+	settle(session);	// wait 333mS, essential!
     }
 }
 #endif /* RECONFIGURE_ENABLE */
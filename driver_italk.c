@@ -255,20 +255,19 @@ static gps_mask_t decode_itk_pseudo(struct gps_device_t *session,
 	(unsigned int)getleu32(buf, 7 + 38) / 1000.0);
 
     /*@-type@*/
+    gpsd_raw_clear(&session->gpsdata.raw);
     for (i = 0; i < n; i++){
-	session->gpsdata.PRN[i] = getleu16(buf, 7 + 26 + (i*36)) & 0xff;
-	session->gpsdata.ss[i] = getleu16(buf, 7 + 26 + (i*36 + 2)) & 0x3f;
+	session->gpsdata.raw.PRN[i] = getleu16(buf, 7 + 26 + (i*36)) & 0xff;
+	session->gpsdata.raw.ss[i] = getleu16(buf, 7 + 26 + (i*36 + 2)) & 0x3f;
 	session->gpsdata.raw.satstat[i] = getleu32(buf, 7 + 26 + (i*36 + 4));
 	session->gpsdata.raw.pseudorange[i] = getled(buf, 7 + 26 + (i*36 + 8));
 	session->gpsdata.raw.doppler[i] = getled(buf, 7 + 26 + (i*36 + 16));
 	session->gpsdata.raw.carrierphase[i] = getleu16(buf, 7 + 26 + (i*36 + 28));
 
 	session->gpsdata.raw.mtime[i] = session->newdata.time;
-	session->gpsdata.raw.codephase[i] = NAN;
-	session->gpsdata.raw.deltarange[i] = NAN;
     }
     /*@+type@*/
-    return RAW_IS;
+    return RAW_SET;
 }
 
 /*@ +charint @*/
@@ -410,7 +409,7 @@ const struct gps_type_t italk_binary =
     .probe_detect   = NULL,		/* how to detect at startup time */
     .get_packet     = generic_get,	/* use generic packet grabber */
     .parse_packet   = italk_parse_input,/* parse message packets */
-    .rtcm_writer    = gpsd_write,	/* send RTCM data straight */
+    .rtcm_writer    = gpsd_write_correction,	/* send RTCM data straight */
     .event_hook     = NULL,		/* lifetime event handler */
 #ifdef RECONFIGURE_ENABLE
     .speed_switcher = NULL,		/* no speed switcher */
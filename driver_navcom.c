@@ -1289,7 +1289,7 @@ const struct gps_type_t navcom_binary =
     .probe_detect   = NULL,			/* no probe */
     .get_packet     = generic_get,		/* use generic one */
     .parse_packet   = navcom_parse_input,	/* parse message packets */
-    .rtcm_writer    = gpsd_write,		/* send RTCM data straight */
+    .rtcm_writer    = gpsd_write_correction,		/* send RTCM data straight */
     .event_hook     = navcom_event_hook,	/* lifetime event handler */
 #ifdef RECONFIGURE_ENABLE
     .speed_switcher = navcom_speed,		/* we do change baud rates */
@@ -5,6 +5,8 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <stdbool.h>
+#include <limits.h>
+#include <float.h>
 #include <math.h>
 #include <string.h>
 #include <stdarg.h>
@@ -19,15 +21,90 @@
  *
  **************************************************************************/
 
+/*
+ * NMEA numeric fields are plain decimals: an optional sign, digits, and
+ * at most one decimal point (ddmm.mmmm, hhmmss.sss, fixed-point
+ * speeds and DOPs).  These decode them without going through the libc
+ * converters.  When the digits fit in 53 bits and there are no more
+ * than 22 of them after the point, both the integer mantissa and the
+ * power of ten are exact doubles, so one IEEE division yields the
+ * correctly rounded value -- bit-for-bit what strtod() returns.
+ * Anything else (exponents, leading blanks, overlong mantissas, or an
+ * FPU with excess precision) falls back to libc.
+ */
+static const double nmea_pow10[] = {
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22,
+};
+
+static double nmea_atof(const char *s)
+/* decode a decimal field; same result as atof() */
+{
+#if defined(FLT_EVAL_METHOD) && FLT_EVAL_METHOD == 0
+    const char *p = s;
+    uint64_t mantissa = 0;
+    int digits = 0, decimals = -1;
+    bool negative = false;
+    double value;
+
+    if (*p == '\0')
+	return 0.0;		/* empty field, the common case */
+    if (*p == '-' || *p == '+')
+	negative = (*p++ == '-');
+    for (;; p++) {
+	if (*p >= '0' && *p <= '9') {
+	    mantissa = mantissa * 10 + (uint64_t)(*p - '0');
+	    if (mantissa > ((uint64_t)1 << 53))
+		return atof(s);
+	    digits++;
+	    if (decimals >= 0)
+		decimals++;
+	} else if (*p == '.' && decimals < 0)
+	    decimals = 0;
+	else if (*p == '\0')
+	    break;
+	else
+	    return atof(s);
+    }
+    if (digits == 0
+	|| decimals >= (int)(sizeof(nmea_pow10) / sizeof(nmea_pow10[0])))
+	return atof(s);
+    value = (double)mantissa;
+    if (decimals > 0)
+	value /= nmea_pow10[decimals];
+    return negative ? -value : value;
+#else
+    return atof(s);
+#endif /* FLT_EVAL_METHOD == 0 */
+}
+
+static int nmea_atoi(const char *s)
+/* decode an integer field; same result as atoi() */
+{
+    const char *p = s;
+    int n = 0;
+    bool negative = false;
+
+    if (*p == '-' || *p == '+')
+	negative = (*p++ == '-');
+    else if (*p == ' ' || (*p >= '\t' && *p <= '\r'))
+	return atoi(s);		/* leading whitespace */
+    for (; *p >= '0' && *p <= '9'; p++) {
+	if (n > (INT_MAX - 9) / 10)
+	    return atoi(s);
+	n = n * 10 + (*p - '0');
+    }
+    return negative ? -n : n;
+}
+
 static void do_lat_lon(char *field[], struct gps_fix_t *out)
 /* process a pair of latitude/longitude fields starting at field index BEGIN */
 {
     double lat, lon, d, m;
-    char str[20], *p;
+    char *p;
 
     if (*(p = field[0]) != '\0') {
-	(void)strlcpy(str, p, sizeof(str));
-	(void)sscanf(p, "%lf", &lat);
+	lat = nmea_atof(p);
 	m = 100.0 * modf(lat / 100.0, &d);
 	lat = d + m / 60.0;
 	p = field[1];
@@ -36,8 +113,7 @@ static void do_lat_lon(char *field[], struct gps_fix_t *out)
 	out->latitude = lat;
     }
     if (*(p = field[2]) != '\0') {
-	(void)strlcpy(str, p, sizeof(str));
-	(void)sscanf(p, "%lf", &lon);
+	lon = nmea_atof(p);
 	m = 100.0 * modf(lon / 100.0, &d);
 	lon = d + m / 60.0;
 
@@ -105,7 +181,7 @@ static void merge_hhmmss(char *hhmmss, struct gps_device_t *session)
     session->driver.nmea.date.tm_min = DD(hhmmss + 2);
     session->driver.nmea.date.tm_sec = DD(hhmmss + 4);
     session->driver.nmea.subseconds =
-	atof(hhmmss + 4) - session->driver.nmea.date.tm_sec;
+	nmea_atof(hhmmss + 4) - session->driver.nmea.date.tm_sec;
 }
 
 static void register_fractional_time(const char *tag, const char *fld,
@@ -114,7 +190,7 @@ static void register_fractional_time(const char *tag, const char *fld,
     if (fld[0] != '\0') {
 	session->driver.nmea.last_frac_time =
 	    session->driver.nmea.this_frac_time;
-	session->driver.nmea.this_frac_time = atof(fld);
+	session->driver.nmea.this_frac_time = nmea_atof(fld);
 	session->driver.nmea.latch_frac_time = true;
 	gpsd_report(LOG_DATA, "%s: registers fractional time %.2f\n",
 		    tag, session->driver.nmea.this_frac_time);
@@ -187,8 +263,8 @@ static gps_mask_t processGPRMC(int count, char *field[],
 	}
 	do_lat_lon(&field[3], &session->newdata);
 	mask |= LATLON_SET;
-	session->newdata.speed = atof(field[7]) * KNOTS_TO_MPS;
-	session->newdata.track = atof(field[8]);
+	session->newdata.speed = nmea_atof(field[7]) * KNOTS_TO_MPS;
+	session->newdata.track = nmea_atof(field[8]);
 	mask |= (TRACK_SET | SPEED_SET);
 	/*
 	 * This copes with GPSes like the Magellan EC-10X that *only* emit
@@ -325,7 +401,7 @@ static gps_mask_t processGPGGA(int c UNUSED, char *field[],
      */
     gps_mask_t mask;
 
-    session->gpsdata.status = atoi(field[6]);
+    session->gpsdata.status = nmea_atoi(field[6]);
     mask = STATUS_SET;
     /*
      * There are some receivers (the Trimble Placer 450 is an example) that
@@ -359,7 +435,7 @@ static gps_mask_t processGPGGA(int c UNUSED, char *field[],
 	}
 	do_lat_lon(&field[2], &session->newdata);
 	mask |= LATLON_SET;
-	session->gpsdata.satellites_used = atoi(field[7]);
+	session->gpsdata.satellites_used = nmea_atoi(field[7]);
 	altitude = field[9];
 	/*
 	 * SiRF chipsets up to version 2.2 report a null altitude field.
@@ -373,7 +449,7 @@ static gps_mask_t processGPGGA(int c UNUSED, char *field[],
 		mask |= MODE_SET;
 	    }
 	} else {
-	    session->newdata.altitude = atof(altitude);
+	    session->newdata.altitude = nmea_atof(altitude);
 	    mask |= ALTITUDE_SET;
 	    /*
 	     * This is a bit dodgy.  Technically we shouldn't set the mode
@@ -388,7 +464,7 @@ static gps_mask_t processGPGGA(int c UNUSED, char *field[],
 	    }
 	}
 	if (strlen(field[11]) > 0) {
-	    session->gpsdata.separation = atof(field[11]);
+	    session->gpsdata.separation = nmea_atof(field[11]);
 	} else {
 	    session->gpsdata.separation =
 		wgs84_separation(session->newdata.latitude,
@@ -426,7 +502,7 @@ static gps_mask_t processGPGST(int count, char *field[], struct gps_device_t *se
       return 0;
     }
 
-#define PARSE_FIELD(n) (*field[n]!='\0' ? atof(field[n]) : NAN)
+#define PARSE_FIELD(n) (*field[n]!='\0' ? nmea_atof(field[n]) : NAN)
     session->gpsdata.gst.utctime             = PARSE_FIELD(1);
     session->gpsdata.gst.rms_deviation       = PARSE_FIELD(2);
     session->gpsdata.gst.smajor_deviation    = PARSE_FIELD(3);
@@ -486,7 +562,7 @@ static gps_mask_t processGPGSA(int count, char *field[],
 	mask = ONLINE_SET;
     } else {
 	int i;
-	session->newdata.mode = atoi(field[2]);
+	session->newdata.mode = nmea_atoi(field[2]);
 	/*
 	 * The first arm of this conditional ignores dead-reckoning
 	 * fixes from an Antaris chipset. which returns E in field 2
@@ -497,15 +573,22 @@ static gps_mask_t processGPGSA(int count, char *field[],
 	else
 	    mask = MODE_SET;
 	gpsd_report(LOG_PROG, "GPGSA sets mode %d\n", session->newdata.mode);
-	session->gpsdata.dop.pdop = atof(field[15]);
-	session->gpsdata.dop.hdop = atof(field[16]);
-	session->gpsdata.dop.vdop = atof(field[17]);
-	session->gpsdata.satellites_used = 0;
-	memset(session->gpsdata.used, 0, sizeof(session->gpsdata.used));
+	session->gpsdata.dop.pdop = nmea_atof(field[15]);
+	session->gpsdata.dop.hdop = nmea_atof(field[16]);
+	session->gpsdata.dop.vdop = nmea_atof(field[17]);
+	/*
+	 * Multi-constellation receivers ship a run of GSAs, one for each
+	 * constellation, with the same mode and DOPs; the used lists of
+	 * a run are merged.
+	 */
+	if (!session->driver.nmea.gsa_last) {
+	    session->gpsdata.satellites_used = 0;
+	    memset(session->gpsdata.used, 0, sizeof(session->gpsdata.used));
+	}
 	/* the magic 6 here counts the tag, two mode fields, and the DOP fields */
-	for (i = 0; i < count - 6; i++) {
-	    int prn = atoi(field[i + 3]);
-	    if (prn > 0)
+	for (i = 0; i < count - 6 && i < 12; i++) {
+	    int prn = nmea_atoi(field[i + 3]);
+	    if (prn > 0 && session->gpsdata.satellites_used < MAXCHANNELS)
 		session->gpsdata.used[session->gpsdata.satellites_used++] =
 		    prn;
 	}
@@ -521,6 +604,76 @@ static gps_mask_t processGPGSA(int count, char *field[],
     return mask;
 }
 
+static void nmea_sky_publish(struct gps_device_t *session)
+/* copy the merged skyview into the session's satellite data */
+{
+    int i;
+
+    (void)memset(session->gpsdata.PRN, 0, sizeof(session->gpsdata.PRN));
+    (void)memset(session->gpsdata.elevation, 0,
+		 sizeof(session->gpsdata.elevation));
+    (void)memset(session->gpsdata.azimuth, 0,
+		 sizeof(session->gpsdata.azimuth));
+    (void)memset(session->gpsdata.ss, 0, sizeof(session->gpsdata.ss));
+    for (i = 0; i < session->driver.nmea.sky.count; i++) {
+	session->gpsdata.PRN[i] = session->driver.nmea.sky.sat[i].PRN;
+	session->gpsdata.elevation[i] =
+	    session->driver.nmea.sky.sat[i].elevation;
+	session->gpsdata.azimuth[i] = session->driver.nmea.sky.sat[i].azimuth;
+	session->gpsdata.ss[i] = session->driver.nmea.sky.sat[i].ss;
+    }
+    session->gpsdata.satellites_visible = i;
+    session->driver.nmea.sky.published = true;
+}
+
+static gps_mask_t nmea_sky_check(struct gps_device_t *session)
+/* publish the merged skyview if it's sane */
+{
+    int n;
+
+    /*
+     * This sanity check catches an odd behavior of SiRFstarII receivers.
+     * When they can't see any satellites at all (like, inside a
+     * building) they sometimes cough up a hairball in the form of a
+     * GSV packet with all the azimuth entries 0 (but nonzero
+     * elevations).  This behavior was observed under SiRF firmware
+     * revision 231.000.000_A2.
+     */
+    for (n = 0; n < session->driver.nmea.sky.count; n++)
+	if (session->driver.nmea.sky.sat[n].azimuth != 0)
+	    goto sane;
+    gpsd_report(LOG_WARN, "Satellite data no good (%d of %d).\n",
+		session->driver.nmea.part, session->driver.nmea.await);
+    gpsd_zero_satellites(&session->gpsdata);
+    session->driver.nmea.sky.published = true;
+    return ONLINE_SET;
+  sane:
+    nmea_sky_publish(session);
+    session->gpsdata.skyview_time = NAN;
+    gpsd_report(LOG_DATA, "GSV: Satellite data OK (%d of %d).\n",
+		session->driver.nmea.part, session->driver.nmea.await);
+    return SATELLITE_SET;
+}
+
+static bool nmea_sky_held(struct gps_device_t *session)
+/* is a skyview held back because we didn't know which talkers to expect? */
+{
+    return session->driver.nmea.sky.expect == 0
+	&& session->driver.nmea.sky.done != 0
+	&& !session->driver.nmea.sky.published;
+}
+
+static void nmea_sky_drop(struct gps_device_t *session, int slot)
+/* forget the satellites one talker has reported this epoch */
+{
+    int i, n;
+
+    for (i = n = 0; i < session->driver.nmea.sky.count; i++)
+	if (session->driver.nmea.sky.sat[i].slot != (unsigned char)slot)
+	    session->driver.nmea.sky.sat[n++] = session->driver.nmea.sky.sat[i];
+    session->driver.nmea.sky.count = n;
+}
+
 static gps_mask_t processGPGSV(int count, char *field[],
 			       struct gps_device_t *session)
 /* GPS Satellites in View */
@@ -536,13 +689,26 @@ static gps_mask_t processGPGSV(int count, char *field[],
      * 46          Signal-to-noise ratio in decibels
      * <repeat for up to 4 satellites per sentence>
      * There my be up to three GSV sentences in a data packet
+     *
+     * Multi-constellation receivers ship one such sequence per talker
+     * (GPGSV, GLGSV, GAGSV, BDGSV...) in each epoch.  The sequences are
+     * merged, and the skyview is reported once, when every talker that
+     * completed a sequence last epoch has completed one in this epoch.
+     * A talker that starts over after completing marks a new epoch.
+     * Until one epoch has gone by we don't know which talkers to wait
+     * for, so the skyview is held until a sentence other than GSV or
+     * GSA turns up, or the next epoch starts.
      */
-    int n, fldnum;
+    int slot, fldnum, i, seen;
+    gps_mask_t mask = ONLINE_SET;
+    const char *talker = session->driver.nmea.talker;
+
     if (count <= 3) {
 	gpsd_report(LOG_WARN, "malformed GPGSV - fieldcount %d <= 3\n",
 		    count);
 	gpsd_zero_satellites(&session->gpsdata);
 	session->gpsdata.satellites_visible = 0;
+	session->driver.nmea.sky.count = 0;
 	return ONLINE_SET;
     }
     if (count % 4 != 0) {
@@ -550,73 +716,101 @@ static gps_mask_t processGPGSV(int count, char *field[],
 		    count);
 	gpsd_zero_satellites(&session->gpsdata);
 	session->gpsdata.satellites_visible = 0;
+	session->driver.nmea.sky.count = 0;
 	return ONLINE_SET;
     }
 
-    session->driver.nmea.await = atoi(field[1]);
+    session->driver.nmea.await = nmea_atoi(field[1]);
     if (sscanf(field[2], "%d", &session->driver.nmea.part) < 1) {
 	gpsd_report(LOG_WARN, "malformed GPGSV - bad part\n");
 	gpsd_zero_satellites(&session->gpsdata);
+	session->driver.nmea.sky.count = 0;
 	return ONLINE_SET;
-    } else if (session->driver.nmea.part == 1)
-	gpsd_zero_satellites(&session->gpsdata);
+    }
 
-    for (fldnum = 4; fldnum < count;) {
-	if (session->gpsdata.satellites_visible >= MAXCHANNELS) {
+    /* which talker is this? */
+    for (slot = 0; slot < session->driver.nmea.sky.talkers; slot++)
+	if (strcmp(session->driver.nmea.sky.talker[slot], talker) == 0)
+	    break;
+    if (slot == session->driver.nmea.sky.talkers) {
+	if (slot == NMEA_TALKERS) {
+	    gpsd_report(LOG_WARN, "GSV from too many talkers, %s ignored\n",
+			talker);
+	    return ONLINE_SET;
+	}
+	(void)strlcpy(session->driver.nmea.sky.talker[slot], talker,
+		      sizeof(session->driver.nmea.sky.talker[slot]));
+	session->driver.nmea.sky.talkers++;
+    }
+
+    if (session->driver.nmea.part == 1) {
+	if ((session->driver.nmea.sky.done & (1u << slot)) != 0) {
+	    /* a new epoch; ship what's left of the old one */
+	    if (!session->driver.nmea.sky.published)
+		mask = nmea_sky_check(session);
+	    session->driver.nmea.sky.expect = session->driver.nmea.sky.done;
+	    session->driver.nmea.sky.done = 0;
+	    session->driver.nmea.sky.count = 0;
+	    session->driver.nmea.sky.published = false;
+	} else
+	    nmea_sky_drop(session, slot);
+	/* DOPs are recomputed from the skyview unless a GSA reports them */
+	gps_clear_dop(&session->gpsdata.dop);
+    }
+
+    for (fldnum = 4; fldnum < count; fldnum += 4) {
+	i = session->driver.nmea.sky.count;
+	if (i >= MAXCHANNELS) {
 	    gpsd_report(LOG_ERROR, "internal error - too many satellites [%d]!\n",
-                    session->gpsdata.satellites_visible);
-	    gpsd_zero_satellites(&session->gpsdata);
+                    i);
 	    break;
 	}
-	session->gpsdata.PRN[session->gpsdata.satellites_visible] =
-	    atoi(field[fldnum++]);
-	session->gpsdata.elevation[session->gpsdata.satellites_visible] =
-	    atoi(field[fldnum++]);
-	session->gpsdata.azimuth[session->gpsdata.satellites_visible] =
-	    atoi(field[fldnum++]);
-	session->gpsdata.ss[session->gpsdata.satellites_visible] =
-	    (float)atoi(field[fldnum++]);
+	session->driver.nmea.sky.sat[i].PRN = (short)nmea_atoi(field[fldnum]);
+	session->driver.nmea.sky.sat[i].elevation =
+	    (short)nmea_atoi(field[fldnum + 1]);
+	session->driver.nmea.sky.sat[i].azimuth =
+	    (short)nmea_atoi(field[fldnum + 2]);
+	session->driver.nmea.sky.sat[i].ss =
+	    (float)nmea_atoi(field[fldnum + 3]);
+	session->driver.nmea.sky.sat[i].slot = (unsigned char)slot;
 	/*
 	 * Incrementing this unconditionally falls afoul of chipsets like
 	 * the Motorola Oncore GT+ that emit empty fields at the end of the
 	 * last sentence in a GPGSV set if the number of satellites is not
 	 * a multiple of 4.
 	 */
-	if (session->gpsdata.PRN[session->gpsdata.satellites_visible] != 0)
-	    session->gpsdata.satellites_visible++;
+	if (session->driver.nmea.sky.sat[i].PRN != 0)
+	    session->driver.nmea.sky.count++;
     }
-    if (session->driver.nmea.part == session->driver.nmea.await
-	&& atoi(field[3]) != session->gpsdata.satellites_visible)
-	gpsd_report(LOG_WARN,
-		    "GPGSV field 3 value of %d != actual count %d\n",
-		    atoi(field[3]), session->gpsdata.satellites_visible);
 
     /* not valid data until we've seen a complete set of parts */
     if (session->driver.nmea.part < session->driver.nmea.await) {
 	gpsd_report(LOG_PROG, "Partial satellite data (%d of %d).\n",
 		    session->driver.nmea.part, session->driver.nmea.await);
-	return ONLINE_SET;
+	return mask;
     }
-    /*
-     * This sanity check catches an odd behavior of SiRFstarII receivers.
-     * When they can't see any satellites at all (like, inside a
-     * building) they sometimes cough up a hairball in the form of a
-     * GSV packet with all the azimuth entries 0 (but nonzero
-     * elevations).  This behavior was observed under SiRF firmware
-     * revision 231.000.000_A2.
-     */
-    for (n = 0; n < session->gpsdata.satellites_visible; n++)
-	if (session->gpsdata.azimuth[n] != 0)
-	    goto sane;
-    gpsd_report(LOG_WARN, "Satellite data no good (%d of %d).\n",
-		session->driver.nmea.part, session->driver.nmea.await);
-    gpsd_zero_satellites(&session->gpsdata);
-    return ONLINE_SET;
-  sane:
-    session->gpsdata.skyview_time = NAN;
-    gpsd_report(LOG_DATA, "GSV: Satellite data OK (%d of %d).\n",
-		session->driver.nmea.part, session->driver.nmea.await);
-    return SATELLITE_SET;
+    for (seen = i = 0; i < session->driver.nmea.sky.count; i++)
+	if (session->driver.nmea.sky.sat[i].slot == (unsigned char)slot)
+	    seen++;
+    if (nmea_atoi(field[3]) != seen)
+	gpsd_report(LOG_WARN,
+		    "GPGSV field 3 value of %d != actual count %d\n",
+		    nmea_atoi(field[3]), seen);
+    session->driver.nmea.sky.done |= 1u << slot;
+
+    /* wait for the other talkers we expect this epoch */
+    if (session->driver.nmea.sky.expect == 0) {
+	gpsd_report(LOG_PROG, "%sGSV complete, other talkers not known yet.\n",
+		    talker);
+	return mask;
+    }
+    if ((session->driver.nmea.sky.done & session->driver.nmea.sky.expect)
+	!= session->driver.nmea.sky.expect) {
+	gpsd_report(LOG_PROG, "%sGSV complete, waiting for other talkers.\n",
+		    talker);
+	return mask;
+    }
+    return nmea_sky_check(session);
 }
 
 static gps_mask_t processPGRME(int c UNUSED, char *field[],
@@ -647,11 +841,11 @@ static gps_mask_t processPGRME(int c UNUSED, char *field[],
 	mask = 0;
     } else {
 	session->newdata.epx = session->newdata.epy =
-	    atof(field[1]) * (1 / sqrt(2)) * (GPSD_CONFIDENCE / CEP50_SIGMA);
+	    nmea_atof(field[1]) * (1 / sqrt(2)) * (GPSD_CONFIDENCE / CEP50_SIGMA);
 	session->newdata.epv =
-	    atof(field[3]) * (GPSD_CONFIDENCE / CEP50_SIGMA);
+	    nmea_atof(field[3]) * (GPSD_CONFIDENCE / CEP50_SIGMA);
 	session->gpsdata.epe =
-	    atof(field[5]) * (GPSD_CONFIDENCE / CEP50_SIGMA);
+	    nmea_atof(field[5]) * (GPSD_CONFIDENCE / CEP50_SIGMA);
 	mask = HERR_SET | VERR_SET | PERR_IS;
     }
 
@@ -686,9 +880,9 @@ static gps_mask_t processGPGBS(int c UNUSED, char *field[],
     if (session->driver.nmea.date.tm_hour == DD(field[1])
 	&& session->driver.nmea.date.tm_min == DD(field[1] + 2)
 	&& session->driver.nmea.date.tm_sec == DD(field[1] + 4)) {
-	session->newdata.epy = atof(field[2]);
-	session->newdata.epx = atof(field[3]);
-	session->newdata.epv = atof(field[4]);
+	session->newdata.epy = nmea_atof(field[2]);
+	session->newdata.epx = nmea_atof(field[3]);
+	session->newdata.epv = nmea_atof(field[4]);
 	gpsd_report(LOG_DATA, "GBS: epx=%.2f epy=%.2f epv=%.2f\n",
 		    session->newdata.epx,
 		    session->newdata.epy,
@@ -734,9 +928,9 @@ static gps_mask_t processGPZDA(int c UNUSED, char *field[],
 	 * when they have a fix, so watching for it can make them look
 	 * like they have a variable fix reporting cycle.
 	 */
-	year = atoi(field[4]);
-	mon = atoi(field[3]);
-	mday = atoi(field[2]);
+	year = nmea_atoi(field[4]);
+	mon = nmea_atoi(field[3]);
+	mday = nmea_atoi(field[2]);
 	century = year - year % 100;
 	if ( (1900 > year ) || (2200 < year ) ) {
 	    gpsd_report(LOG_WARN, "malformed ZDA year: %s\n",  field[4]);
@@ -786,7 +980,7 @@ static gps_mask_t processHDT(int c UNUSED, char *field[],
     gps_mask_t mask;
     mask = ONLINE_SET;
 
-    session->gpsdata.attitude.heading = atof(field[1]);
+    session->gpsdata.attitude.heading = nmea_atof(field[1]);
     session->gpsdata.attitude.mag_st = '\0';
     session->gpsdata.attitude.pitch = NAN;
     session->gpsdata.attitude.pitch_st = '\0';
@@ -850,17 +1044,17 @@ static gps_mask_t processTNTHTM(int c UNUSED, char *field[],
     gps_mask_t mask;
     mask = ONLINE_SET;
 
-    session->gpsdata.attitude.heading = atof(field[1]);
+    session->gpsdata.attitude.heading = nmea_atof(field[1]);
     session->gpsdata.attitude.mag_st = *field[2];
-    session->gpsdata.attitude.pitch = atof(field[3]);
+    session->gpsdata.attitude.pitch = nmea_atof(field[3]);
     session->gpsdata.attitude.pitch_st = *field[4];
-    session->gpsdata.attitude.roll = atof(field[5]);
+    session->gpsdata.attitude.roll = nmea_atof(field[5]);
     session->gpsdata.attitude.roll_st = *field[6];
     session->gpsdata.attitude.yaw = NAN;
     session->gpsdata.attitude.yaw_st = '\0';
-    session->gpsdata.attitude.dip = atof(field[7]);
+    session->gpsdata.attitude.dip = nmea_atof(field[7]);
     session->gpsdata.attitude.mag_len = NAN;
-    session->gpsdata.attitude.mag_x = atof(field[8]);
+    session->gpsdata.attitude.mag_x = nmea_atof(field[8]);
     session->gpsdata.attitude.mag_y = NAN;
     session->gpsdata.attitude.mag_z = NAN;
     session->gpsdata.attitude.acc_len = NAN;
@@ -906,27 +1100,27 @@ static gps_mask_t processOHPR(int c UNUSED, char *field[],
     gps_mask_t mask;
     mask = ONLINE_SET;
 
-    session->gpsdata.attitude.heading = atof(field[1]);
+    session->gpsdata.attitude.heading = nmea_atof(field[1]);
     session->gpsdata.attitude.mag_st = '\0';
-    session->gpsdata.attitude.pitch = atof(field[2]);
+    session->gpsdata.attitude.pitch = nmea_atof(field[2]);
     session->gpsdata.attitude.pitch_st = '\0';
-    session->gpsdata.attitude.roll = atof(field[3]);
+    session->gpsdata.attitude.roll = nmea_atof(field[3]);
     session->gpsdata.attitude.roll_st = '\0';
     session->gpsdata.attitude.yaw = NAN;
     session->gpsdata.attitude.yaw_st = '\0';
     session->gpsdata.attitude.dip = NAN;
-    session->gpsdata.attitude.temp = atof(field[4]);
-    session->gpsdata.attitude.depth = atof(field[5]) / METERS_TO_FEET;
-    session->gpsdata.attitude.mag_len = atof(field[6]);
-    session->gpsdata.attitude.mag_x = atof(field[7]);
-    session->gpsdata.attitude.mag_y = atof(field[8]);
-    session->gpsdata.attitude.mag_z = atof(field[9]);
-    session->gpsdata.attitude.acc_len = atof(field[10]);
-    session->gpsdata.attitude.acc_x = atof(field[11]);
-    session->gpsdata.attitude.acc_y = atof(field[12]);
-    session->gpsdata.attitude.acc_z = atof(field[13]);
-    session->gpsdata.attitude.gyro_x = atof(field[15]);
-    session->gpsdata.attitude.gyro_y = atof(field[16]);
+    session->gpsdata.attitude.temp = nmea_atof(field[4]);
+    session->gpsdata.attitude.depth = nmea_atof(field[5]) / METERS_TO_FEET;
+    session->gpsdata.attitude.mag_len = nmea_atof(field[6]);
+    session->gpsdata.attitude.mag_x = nmea_atof(field[7]);
+    session->gpsdata.attitude.mag_y = nmea_atof(field[8]);
+    session->gpsdata.attitude.mag_z = nmea_atof(field[9]);
+    session->gpsdata.attitude.acc_len = nmea_atof(field[10]);
+    session->gpsdata.attitude.acc_x = nmea_atof(field[11]);
+    session->gpsdata.attitude.acc_y = nmea_atof(field[12]);
+    session->gpsdata.attitude.acc_z = nmea_atof(field[13]);
+    session->gpsdata.attitude.gyro_x = nmea_atof(field[15]);
+    session->gpsdata.attitude.gyro_y = nmea_atof(field[16]);
     mask |= (ALTITUDE_SET);
 
     gpsd_report(LOG_RAW, "Heading %lf.\n", session->gpsdata.attitude.heading);
@@ -956,23 +1150,23 @@ static gps_mask_t processPASHR(int c UNUSED, char *field[],
 	} else {
 	    /* if we make it this far, we at least have a 3D fix */
 	    session->newdata.mode = MODE_3D;
-	    if (1 == atoi(field[2]))
+	    if (1 == nmea_atoi(field[2]))
 		session->gpsdata.status = STATUS_DGPS_FIX;
 	    else
 		session->gpsdata.status = STATUS_FIX;
 
-	    session->gpsdata.satellites_used = atoi(field[3]);
+	    session->gpsdata.satellites_used = nmea_atoi(field[3]);
 	    merge_hhmmss(field[4], session);
 	    register_fractional_time(field[0], field[4], session);
 	    do_lat_lon(&field[5], &session->newdata);
-	    session->newdata.altitude = atof(field[9]);
-	    session->newdata.track = atof(field[11]);
-	    session->newdata.speed = atof(field[12]) / MPS_TO_KPH;
-	    session->newdata.climb = atof(field[13]);
-	    session->gpsdata.dop.pdop = atof(field[14]);
-	    session->gpsdata.dop.hdop = atof(field[15]);
-	    session->gpsdata.dop.vdop = atof(field[16]);
-	    session->gpsdata.dop.tdop = atof(field[17]);
+	    session->newdata.altitude = nmea_atof(field[9]);
+	    session->newdata.track = nmea_atof(field[11]);
+	    session->newdata.speed = nmea_atof(field[12]) / MPS_TO_KPH;
+	    session->newdata.climb = nmea_atof(field[13]);
+	    session->gpsdata.dop.pdop = nmea_atof(field[14]);
+	    session->gpsdata.dop.hdop = nmea_atof(field[15]);
+	    session->gpsdata.dop.vdop = nmea_atof(field[16]);
+	    session->gpsdata.dop.tdop = nmea_atof(field[17]);
 	    mask |= (TIME_SET | LATLON_SET | ALTITUDE_SET);
 	    mask |= (SPEED_SET | TRACK_SET | CLIMB_SET);
 	    mask |= DOP_SET;
@@ -988,13 +1182,13 @@ static gps_mask_t processPASHR(int c UNUSED, char *field[],
 	}
     } else if (0 == strcmp("SAT", field[1])) {	/* Satellite Status */
 	int i, n, p, u;
-	n = session->gpsdata.satellites_visible = atoi(field[2]);
+	n = session->gpsdata.satellites_visible = nmea_atoi(field[2]);
 	u = 0;
 	for (i = 0; i < n; i++) {
-	    session->gpsdata.PRN[i] = p = atoi(field[3 + i * 5 + 0]);
-	    session->gpsdata.azimuth[i] = atoi(field[3 + i * 5 + 1]);
-	    session->gpsdata.elevation[i] = atoi(field[3 + i * 5 + 2]);
-	    session->gpsdata.ss[i] = atof(field[3 + i * 5 + 3]);
+	    session->gpsdata.PRN[i] = p = nmea_atoi(field[3 + i * 5 + 0]);
+	    session->gpsdata.azimuth[i] = nmea_atoi(field[3 + i * 5 + 1]);
+	    session->gpsdata.elevation[i] = nmea_atoi(field[3 + i * 5 + 2]);
+	    session->gpsdata.ss[i] = nmea_atof(field[3 + i * 5 + 3]);
 	    if (field[3 + i * 5 + 4][0] == 'U')
 		session->gpsdata.used[u++] = p;
 	}
@@ -1008,6 +1202,332 @@ static gps_mask_t processPASHR(int c UNUSED, char *field[],
 }
 #endif /* ASHTECH_ENABLE */
 
+/**************************************************************************
+ *
+ * Sentence dispatch
+ *
+ **************************************************************************/
+
+/*
+ * Tags are packed big-endian into an integer so each lookup is a single
+ * switch the compiler can turn into a jump table or a short binary
+ * search, rather than a walk over the phrase table calling strcmp().
+ */
+#define NMEA_TAG3(a, b, c)	(((uint64_t)(a) << 16) | ((uint64_t)(b) << 8) | (uint64_t)(c))
+#define NMEA_TAG4(a, b, c, d)	((NMEA_TAG3(a, b, c) << 8) | (uint64_t)(d))
+#define NMEA_TAG5(a, b, c, d, e)	((NMEA_TAG4(a, b, c, d) << 8) | (uint64_t)(e))
+#define NMEA_TAG7(a, b, c, d, e, f, g)	((NMEA_TAG5(a, b, c, d, e) << 16) | NMEA_TAG3(0, f, g))
+
+/* indices into the phrase table in nmea_parse() */
+enum nmea_phrase_id {
+    PHRASE_PGRMC, PHRASE_PGRME, PHRASE_PGRMI, PHRASE_PGRMO,
+    PHRASE_RMC, PHRASE_GGA, PHRASE_GST, PHRASE_GLL, PHRASE_GSA,
+    PHRASE_GSV, PHRASE_VTG, PHRASE_ZDA, PHRASE_GBS, PHRASE_HDT,
+#ifdef TNT_ENABLE
+    PHRASE_PTNTHTM,
+#endif /* TNT_ENABLE */
+#ifdef ASHTECH_ENABLE
+    PHRASE_PASHR,
+#endif /* ASHTECH_ENABLE */
+#ifdef OCEANSERVER_ENABLE
+    PHRASE_OHPR,
+#endif /* OCEANSERVER_ENABLE */
+    NMEA_PHRASES
+};
+
+static int nmea_phrase_lookup(const char *tag, size_t len)
+/* map a sentence tag to its phrase index, or -1 if we don't handle it */
+{
+    uint64_t key = 0;
+    size_t i;
+
+    if (len > sizeof(key))
+	return -1;
+    for (i = 0; i < len; i++)
+	key = (key << 8) | (unsigned char)tag[i];
+
+    /*
+     * Proprietary sentences match on the whole tag.  This has to be
+     * tried first, otherwise Garmins can get stuck in a loop that
+     * looks like this:
+     *
+     * 1. A Garmin GPS in NMEA mode is detected.
+     *
+     * 2. PGRMC is sent to reconfigure to Garmin binary mode.
+     *    If successful, the GPS echoes the phrase.
+     *
+     * 3. nmea_parse() sees the echo as RMC because the talker ID is
+     *    ignored, and fails to recognize the echo as PGRMC and ignore it.
+     *
+     * 4. The mode is changed back to NMEA, resulting in an infinite loop.
+     */
+    /*@ -type @*/
+    switch (key) {
+    case NMEA_TAG5('P', 'G', 'R', 'M', 'C'):
+	return PHRASE_PGRMC;
+    case NMEA_TAG5('P', 'G', 'R', 'M', 'E'):
+	return PHRASE_PGRME;
+    case NMEA_TAG5('P', 'G', 'R', 'M', 'I'):
+	return PHRASE_PGRMI;
+    case NMEA_TAG5('P', 'G', 'R', 'M', 'O'):
+	return PHRASE_PGRMO;
+#ifdef TNT_ENABLE
+    case NMEA_TAG7('P', 'T', 'N', 'T', 'H', 'T', 'M'):
+	return PHRASE_PTNTHTM;
+#endif /* TNT_ENABLE */
+#ifdef ASHTECH_ENABLE
+    case NMEA_TAG5('P', 'A', 'S', 'H', 'R'):
+	return PHRASE_PASHR;
+#endif /* ASHTECH_ENABLE */
+#ifdef OCEANSERVER_ENABLE
+    case NMEA_TAG4('O', 'H', 'P', 'R'):
+	return PHRASE_OHPR;
+#endif /* OCEANSERVER_ENABLE */
+    }
+
+    /* everything else is a two-character talker ID and a sentence type */
+    if (len == 5)
+	switch (key & NMEA_TAG3(0xff, 0xff, 0xff)) {
+	case NMEA_TAG3('R', 'M', 'C'):
+	    return PHRASE_RMC;
+	case NMEA_TAG3('G', 'G', 'A'):
+	    return PHRASE_GGA;
+	case NMEA_TAG3('G', 'S', 'T'):
+	    return PHRASE_GST;
+	case NMEA_TAG3('G', 'L', 'L'):
+	    return PHRASE_GLL;
+	case NMEA_TAG3('G', 'S', 'A'):
+	    return PHRASE_GSA;
+	case NMEA_TAG3('G', 'S', 'V'):
+	    return PHRASE_GSV;
+	case NMEA_TAG3('V', 'T', 'G'):
+	    return PHRASE_VTG;
+	case NMEA_TAG3('Z', 'D', 'A'):
+	    return PHRASE_ZDA;
+	case NMEA_TAG3('G', 'B', 'S'):
+	    return PHRASE_GBS;
+	case NMEA_TAG3('H', 'D', 'T'):
+	    return PHRASE_HDT;
+	}
+    /*@ +type @*/
+    return -1;
+}
+
+/**************************************************************************
+ *
+ * Reporting-cycle model
+ *
+ **************************************************************************/
+
+/*
+ * The model remembers how many times each timestamped sentence showed
+ * up in each of the last few whole epochs; the smallest of those
+ * counts is the epoch's core.  Once every core sentence has arrived in
+ * the current epoch there is nothing left worth waiting for, so the
+ * report ships on that sentence instead of when the next epoch's
+ * timestamp turns up.  The same goes for the core sentence that came
+ * last in the previous epoch, so a receiver that drops an earlier
+ * sentence now and then doesn't lose the whole epoch.  Counting
+ * sentences copes with receivers that repeat a sentence mid-cycle,
+ * and taking the minimum over several epochs keeps sentences that a
+ * receiver rotates through its cycle, or emits only every Nth time,
+ * out of the core.
+ *
+ * The model also learns when in the epoch each sentence arrives, and
+ * how much that varies, the way TCP learns a round-trip time.  That
+ * predicts when the last core sentence is due; if it hasn't come by
+ * then and some later sentence has, it was lost, and the report ships
+ * on the later sentence rather than the epoch going unreported.
+ * Arrival times only mean something when the receiver goes quiet
+ * between epochs, so timing is left out of the decision until the
+ * model has seen such a gap; gpsfake feeds a log at an even pace with
+ * no gap, so replays report the same way however fast they are fed.
+ *
+ * With an aiding store the model is saved there, keyed by device path
+ * and receiver, and a device that turns out to be the same receiver
+ * on the next run starts out with it.
+ */
+
+#define NMEA_CYCLE_QUIET	0.02	/* shortest epoch gap to time against */
+
+static bool nmea_cycle_ready(const struct gps_device_t *session)
+/* has the model seen enough to predict the end of an epoch? */
+{
+    return session->nmea_cycle.epochs >= 2 && session->nmea_cycle.locked;
+}
+
+static bool nmea_cycle_timed(const struct gps_device_t *session)
+/* is there a quiet gap between epochs that arrival times can be read by? */
+{
+    return session->nmea_cycle.quiet >= NMEA_CYCLE_QUIET
+	&& session->nmea_cycle.quiet >= session->nmea_cycle.period / 4;
+}
+
+static void nmea_cycle_identify(struct gps_device_t *session)
+/* throw the model away if it was learned on some other receiver */
+{
+    if (session->nmea_cycle.driver != session->device_type
+	|| strncmp(session->nmea_cycle.subtype, session->subtype,
+		   sizeof(session->nmea_cycle.subtype)) != 0) {
+	if (session->nmea_cycle.epochs > 0)
+	    gpsd_report(LOG_PROG, "receiver changed, relearning NMEA cycle\n");
+	memset(&session->nmea_cycle, '\0', sizeof(session->nmea_cycle));
+	session->nmea_cycle.driver = session->device_type;
+	(void)strlcpy(session->nmea_cycle.subtype, session->subtype,
+		      sizeof(session->nmea_cycle.subtype));
+#ifdef AIDING_ENABLE
+	if (aiding_cycle_restore(session))
+	    gpsd_report(LOG_PROG, "NMEA cycle restored from aiding store.\n");
+#endif /* AIDING_ENABLE */
+    }
+}
+
+static void nmea_cycle_close(struct gps_device_t *session, timestamp_t now)
+/* a new epoch has started; fold the one just finished into the model */
+{
+    unsigned char *seen = session->driver.nmea.cycle_seen;
+    unsigned char last;
+    int i, j, depth;
+
+    if (session->driver.nmea.cycle_whole) {
+	bool was_ready = nmea_cycle_ready(session);
+	double interval = now - session->driver.nmea.cycle_start;
+	double gap = now - session->driver.nmea.cycle_last;
+
+	j = session->nmea_cycle.epochs++ % NMEA_CYCLE_DEPTH;
+	if (session->nmea_cycle.epochs >= 2 * NMEA_CYCLE_DEPTH)
+	    session->nmea_cycle.epochs -= NMEA_CYCLE_DEPTH;	/* no wrap */
+	(void)memcpy(session->nmea_cycle.history[j], seen,
+		     sizeof(session->nmea_cycle.history[j]));
+
+	depth = session->nmea_cycle.epochs;
+	if (depth > NMEA_CYCLE_DEPTH)
+	    depth = NMEA_CYCLE_DEPTH;
+	session->nmea_cycle.locked = false;
+	last = 0;
+	for (i = 0; i < NMEA_CYCLE_TAGS; i++) {
+	    unsigned char least = UCHAR_MAX;
+	    for (j = 0; j < depth; j++)
+		if (session->nmea_cycle.history[j][i] < least)
+		    least = session->nmea_cycle.history[j][i];
+	    session->nmea_cycle.core[i] = least;
+	    if (least > 0) {
+		session->nmea_cycle.locked = true;
+		if (session->driver.nmea.cycle_order[i] >= last) {
+		    last = session->driver.nmea.cycle_order[i];
+		    session->nmea_cycle.ender = (unsigned int)i;
+		}
+	    }
+	}
+	if (!was_ready && nmea_cycle_ready(session))
+	    gpsd_report(LOG_PROG,
+			"NMEA cycle learned: %d sentences per epoch.\n",
+			session->driver.nmea.cycle_count);
+
+	/* smoothed like a TCP round-trip estimate */
+	if (session->nmea_cycle.period == 0) {
+	    session->nmea_cycle.period = interval;
+	    session->nmea_cycle.quiet = gap;
+	} else {
+	    session->nmea_cycle.period +=
+		(interval - session->nmea_cycle.period) / 8;
+	    session->nmea_cycle.quiet += (gap - session->nmea_cycle.quiet) / 8;
+	}
+#ifdef AIDING_ENABLE
+	if (nmea_cycle_ready(session))
+	    aiding_cycle_save(session);
+#endif /* AIDING_ENABLE */
+    }
+
+    memset(seen, '\0', sizeof(session->driver.nmea.cycle_seen));
+    memset(session->driver.nmea.cycle_order, '\0',
+	   sizeof(session->driver.nmea.cycle_order));
+    session->driver.nmea.cycle_count = 0;
+    session->driver.nmea.cycle_whole = true;
+    session->driver.nmea.cycle_reported = false;
+    session->driver.nmea.cycle_start = now;
+}
+
+static void nmea_cycle_time(struct gps_device_t *session,
+			    unsigned int tag, timestamp_t now)
+/* learn when a sentence turns up, from its first appearance in an epoch */
+{
+    float delay = (float)(now - session->driver.nmea.cycle_start);
+    float *offset = &session->nmea_cycle.offset[tag];
+    float *spread = &session->nmea_cycle.spread[tag];
+
+    if (!session->driver.nmea.cycle_whole
+	|| session->driver.nmea.cycle_seen[tag] != 1)
+	return;
+    if (*offset == 0 && *spread == 0) {
+	*offset = delay;
+	*spread = delay / 2;
+    } else {
+	float err = delay - *offset;
+	*offset += err / 8;
+	*spread += ((float)fabs(err) - *spread) / 4;
+    }
+}
+
+static bool nmea_cycle_overdue(const struct gps_device_t *session,
+			       timestamp_t now)
+/* should the last core sentence have turned up by now? */
+{
+    unsigned int ender = session->nmea_cycle.ender;
+
+    return nmea_cycle_timed(session) && session->driver.nmea.cycle_whole
+	&& now - session->driver.nmea.cycle_start >
+	session->nmea_cycle.offset[ender] + 4 * session->nmea_cycle.spread[ender];
+}
+
+static gps_mask_t nmea_cycle_step(struct gps_device_t *session,
+				  unsigned int tag, timestamp_t now)
+/* account for one sentence; REPORT_IS if it completes the epoch */
+{
+    int i;
+
+    if (tag >= NMEA_CYCLE_TAGS)
+	return 0;
+    session->driver.nmea.cycle_count++;
+    session->driver.nmea.cycle_last = now;
+    if (session->driver.nmea.latch_frac_time) {
+	if (session->driver.nmea.cycle_seen[tag] < UCHAR_MAX)
+	    session->driver.nmea.cycle_seen[tag]++;
+	session->driver.nmea.cycle_order[tag] =
+	    (session->driver.nmea.cycle_count < UCHAR_MAX) ?
+	    (unsigned char)session->driver.nmea.cycle_count : UCHAR_MAX;
+	nmea_cycle_time(session, tag, now);
+    }
+    if (!nmea_cycle_ready(session) || session->driver.nmea.cycle_reported)
+	return 0;
+
+    if (!session->driver.nmea.latch_frac_time
+	|| tag != session->nmea_cycle.ender
+	|| session->driver.nmea.cycle_seen[tag] < session->nmea_cycle.core[tag])
+	for (i = 0; i < NMEA_CYCLE_TAGS; i++)
+	    if (session->driver.nmea.cycle_seen[i] <
+		session->nmea_cycle.core[i]) {
+		if (!nmea_cycle_overdue(session, now))
+		    return 0;
+		gpsd_report(LOG_PROG,
+			    "%s comes after an overdue end of cycle.\n",
+			    session->driver.nmea.field[0]);
+		break;
+	    }
+
+    gpsd_report(LOG_PROG, "%s completes a reporting cycle.\n",
+		session->driver.nmea.field[0]);
+    if (session->driver.nmea.cycle_whole) {
+	double delay = now - session->driver.nmea.cycle_start;
+	session->nmea_cycle.span += (delay - session->nmea_cycle.span) / 8;
+	gpsd_report(LOG_IO,
+		    "NMEA epoch reported after %.3fs (mean %.3fs, period %.3fs).\n",
+		    delay, session->nmea_cycle.span, session->nmea_cycle.period);
+    }
+    session->driver.nmea.cycle_reported = true;
+    return REPORT_IS;
+}
+
 /**************************************************************************
  *
  * Entry points begin here
@@ -1025,53 +1545,60 @@ gps_mask_t nmea_parse(char *sentence, struct gps_device_t * session)
 	char *name;
 	int nf;			/* minimum number of fields required to parse */
 	nmea_decoder decoder;
-    } nmea_phrase[] = {
+    } nmea_phrase[NMEA_PHRASES] = {
 	/*@ -nullassign @*/
-	{"PGRMC", 0, NULL},	/* ignore Garmin Sensor Config */
-	{"PGRME", 7, processPGRME}, 
-	{"PGRMI", 0, NULL},	/* ignore Garmin Sensor Init */
-	{"PGRMO", 0, NULL},	/* ignore Garmin Sentence Enable */
-	    /*
-	     * Basic sentences must come after the PG* ones, otherwise
-	     * Garmins can get stuck in a loop that looks like this:
-	     *
-	     * 1. A Garmin GPS in NMEA mode is detected.
-	     *
-	     * 2. PGRMC is sent to reconfigure to Garmin binary mode.
-	     *    If successful, the GPS echoes the phrase.
-	     *
-	     * 3. nmea_parse() sees the echo as RMC because the talker ID is
-	     *    ignored, and fails to recognize the echo as PGRMC and ignore it.
-	     *
-	     * 4. The mode is changed back to NMEA, resulting in an infinite loop.
-	     */
-	{"RMC", 8,  processGPRMC},
-	{"GGA", 13, processGPGGA},
-	{"GST", 8,  processGPGST},
-	{"GLL", 7,  processGPGLL},
-	{"GSA", 17, processGPGSA},
-	{"GSV", 0,  processGPGSV},
-	{"VTG", 0,  NULL},	/* ignore Velocity Track made Good */
-	{"ZDA", 4,  processGPZDA},
-	{"GBS", 7,  processGPGBS},
-        {"HDT", 1,  processHDT},
+	[PHRASE_PGRMC] = {"PGRMC", 0, NULL},	/* ignore Garmin Sensor Config */
+	[PHRASE_PGRME] = {"PGRME", 7, processPGRME},
+	[PHRASE_PGRMI] = {"PGRMI", 0, NULL},	/* ignore Garmin Sensor Init */
+	[PHRASE_PGRMO] = {"PGRMO", 0, NULL},	/* ignore Garmin Sentence Enable */
+	[PHRASE_RMC] = {"RMC", 8,  processGPRMC},
+	[PHRASE_GGA] = {"GGA", 13, processGPGGA},
+	[PHRASE_GST] = {"GST", 8,  processGPGST},
+	[PHRASE_GLL] = {"GLL", 7,  processGPGLL},
+	[PHRASE_GSA] = {"GSA", 17, processGPGSA},
+	[PHRASE_GSV] = {"GSV", 0,  processGPGSV},
+	[PHRASE_VTG] = {"VTG", 0,  NULL},	/* ignore Velocity Track made Good */
+	[PHRASE_ZDA] = {"ZDA", 4,  processGPZDA},
+	[PHRASE_GBS] = {"GBS", 7,  processGPGBS},
+	[PHRASE_HDT] = {"HDT", 1,  processHDT},
 #ifdef TNT_ENABLE
-	{"PTNTHTM", 9, processTNTHTM},
+	[PHRASE_PTNTHTM] = {"PTNTHTM", 9, processTNTHTM},
 #endif /* TNT_ENABLE */
 #ifdef ASHTECH_ENABLE
-	{"PASHR", 3, processPASHR},	/* general handler for Ashtech */
+	[PHRASE_PASHR] = {"PASHR", 3, processPASHR},	/* general handler for Ashtech */
 #endif /* ASHTECH_ENABLE */
 #ifdef OCEANSERVER_ENABLE
-	{"OHPR", 18, processOHPR},
+	[PHRASE_OHPR] = {"OHPR", 18, processOHPR},
 #endif /* OCEANSERVER_ENABLE */
 	    /*@ +nullassign @*/
     };
 
-    int count;
+    int count, phrase;
     gps_mask_t retval = 0;
     unsigned int i, thistag;
+    size_t taglen;
     char *p, *s, *e;
-    volatile char *t;
+
+    /*
+     * Split into fields in one pass, copying into fieldcopy as we go.
+     * The sentence itself must stay intact because it is relayed to
+     * clients after parsing, and field[] is inspected by some drivers
+     * after we return.  The checksum is discarded; '*' becomes a final
+     * delimiter, otherwise we would drop the last field.
+     */
+    /*@ -usedef @*//* splint 3.1.1 seems to have a bug here */
+    count = 0;
+    p = (char *)session->driver.nmea.fieldcopy;
+    session->driver.nmea.field[0] = p;
+    /* skip the leading '$'; stop at the checksum or the line end */
+    for (s = sentence + 1;
+	 s < sentence + NMEA_MAX && *s != '*' && *s >= ' '; s++) {
+	if (*s == ',') {
+	    *p++ = '\0';
+	    session->driver.nmea.field[++count] = p;
+	} else
+	    *p++ = *s;
+    }
 
     /*
      * We've had reports that on the Garmin GPS-10 the device sometimes
@@ -1081,39 +1608,28 @@ gps_mask_t nmea_parse(char *sentence, struct gps_device_t * session)
      * legal limit for NMEA, so we can cope by just tossing out overlong
      * packets.  This may be a generic bug of all Garmin chipsets.
      */
-    if (strlen(sentence) > NMEA_MAX) {
-	gpsd_report(LOG_WARN, "Overlong packet of %zd chars rejected.\n",
-		    strlen(sentence));
-	return ONLINE_SET;
-    }
+    for (e = s; *e != '\0'; e++)
+	if (e >= sentence + NMEA_MAX) {
+	    gpsd_report(LOG_WARN, "Overlong packet of %zd chars rejected.\n",
+			strlen(sentence));
+	    /* don't leave a half-split sentence behind */
+	    session->driver.nmea.fieldcopy[0] = '\0';
+	    for (i = 0; i < NMEA_MAX; i++)
+		session->driver.nmea.field[i] =
+		    (char *)session->driver.nmea.fieldcopy;
+	    return ONLINE_SET;
+	}
 
-    /*@ -usedef @*//* splint 3.1.1 seems to have a bug here */
-    /* make an editable copy of the sentence */
-    (void)strlcpy((char *)session->driver.nmea.fieldcopy, sentence, NMEA_MAX);
-    /* discard the checksum part */
-    for (p = (char *)session->driver.nmea.fieldcopy;
-	 (*p != '*') && (*p >= ' ');)
-	++p;
-    if (*p == '*')
-	*p++ = ',';		/* otherwise we drop the last field */
+    if (*s == '*') {
+	*p++ = '\0';
+	session->driver.nmea.field[++count] = p;
+    }
     *p = '\0';
     e = p;
-
-    /* split sentence copy on commas, filling the field array */
-    count = 0;
-    t = p;			/* end of sentence */
-    p = (char *)session->driver.nmea.fieldcopy + 1;	/* beginning of tag, 'G' not '$' */
-    /* while there is a search string and we haven't run off the buffer... */
-    while ((p != NULL) && (p <= t)) {
-	session->driver.nmea.field[count] = p;	/* we have a field. record it */
-	/*@ -compdef @*/
-	if ((p = strchr(p, ',')) != NULL) {	/* search for the next delimiter */
-	    *p = '\0';		/* replace it with a NUL */
-	    count++;		/* bump the counters and continue */
-	    p++;
-	}
-	/*@ +compdef @*/
-    }
+    if (count > 0)
+	taglen = (size_t)(session->driver.nmea.field[1] - session->driver.nmea.field[0]) - 1;
+    else
+	taglen = (size_t)(e - session->driver.nmea.field[0]);
 
     /* point remaining fields at empty string, just in case */
     for (i = (unsigned int)count;
@@ -1122,35 +1638,56 @@ gps_mask_t nmea_parse(char *sentence, struct gps_device_t * session)
 		    sizeof(session->driver.nmea.field[0])); i++)
 	session->driver.nmea.field[i] = e;
 
+    /* keep the talker ID; proprietary sentences don't have one */
+    s = session->driver.nmea.field[0];
+    if (taglen == 5 && s[0] != 'P') {
+	session->driver.nmea.talker[0] = s[0];
+	session->driver.nmea.talker[1] = s[1];
+	session->driver.nmea.talker[2] = '\0';
+    } else
+	session->driver.nmea.talker[0] = '\0';
+
     /* sentences handlers will tell us whren they have fractional time */
     session->driver.nmea.latch_frac_time = false;
 
     /* dispatch on field zero, the sentence tag */
-    for (thistag = i = 0;
-	 i < (unsigned)(sizeof(nmea_phrase) / sizeof(nmea_phrase[0])); ++i) {
-	s = session->driver.nmea.field[0];
-	if (strlen(nmea_phrase[i].name) == 3)
-	    s += 2;		/* skip talker ID */
-	if (strcmp(nmea_phrase[i].name, s) == 0) {
-	    if (nmea_phrase[i].decoder != NULL
-		&& (count >= nmea_phrase[i].nf)) {
-		retval =
-		    (nmea_phrase[i].decoder) (count,
-					      session->driver.nmea.field,
-					      session);
-		(void)strlcpy(session->gpsdata.tag, 
-			      nmea_phrase[i].name, 
-			      MAXTAGLEN);
-		/*
-		 * Must force this to be nz, as we're going to rely on a zero
-		 * value to mean "no previous tag" later.
-		 */
-		thistag = i + 1;
-	    } else
-		retval = ONLINE_SET;	/* unknown sentence */
-	    break;
-	}
+    thistag = 0;
+    phrase = nmea_phrase_lookup(session->driver.nmea.field[0], taglen);
+    /*
+     * Receivers ship the GSV sequences of all their talkers back to
+     * back, with the GSAs before or after them, so any other sentence
+     * ends the satellite report for this cycle.  That's when a skyview
+     * held for want of a talker list goes out, with every talker's
+     * GSA in for the DOPs.  It goes out as the GSV report it is, ahead
+     * of anything this sentence has to say; the core hands us the
+     * sentence again for that.
+     */
+    if (phrase != PHRASE_GSV && phrase != PHRASE_GSA
+	&& nmea_sky_held(session)) {
+	(void)strlcpy(session->gpsdata.tag,
+		      nmea_phrase[PHRASE_GSV].name, MAXTAGLEN);
+	session->reparse = true;
+	return ONLINE_SET | nmea_sky_check(session);
+    }
+    if (phrase >= 0) {
+	if (nmea_phrase[phrase].decoder != NULL
+	    && (count >= nmea_phrase[phrase].nf)) {
+	    retval =
+		(nmea_phrase[phrase].decoder) (count,
+					       session->driver.nmea.field,
+					       session);
+	    (void)strlcpy(session->gpsdata.tag,
+			  nmea_phrase[phrase].name,
+			  MAXTAGLEN);
+	    /*
+	     * Must force this to be nz, as we're going to rely on a zero
+	     * value to mean "no previous tag" later.
+	     */
+	    thistag = (unsigned int)phrase + 1;
+	} else
+	    retval = ONLINE_SET;	/* unknown sentence */
     }
+    session->driver.nmea.gsa_last = (phrase == PHRASE_GSA);
 
     /* timestamp recording for fixes happens here */
     if ((retval & TIME_SET) != 0) {
@@ -1189,7 +1726,12 @@ gps_mask_t nmea_parse(char *sentence, struct gps_device_t * session)
      * work fine.  Problems will only arise if a a sentence that
      * occurs just befiore timestamp increments also occurs in
      * mid-cycle, as in the Garmin eXplorist 210; those might jitter.
+     * Once the cycle model above has watched two whole epochs it
+     * takes over the reporting decision; this detector still finds
+     * the epoch boundaries for it.
      */
+    if (thistag > 0)
+	nmea_cycle_identify(session);
     if (session->driver.nmea.latch_frac_time) {
 	gpsd_report(LOG_PROG,
 		    "%s reporting cycle started on %.2f.\n",
@@ -1216,8 +1758,21 @@ gps_mask_t nmea_parse(char *sentence, struct gps_device_t * session)
 			    nmea_phrase[lasttag - 1].name);
 	    }
 	}
+    }
+
+    if (thistag > 0) {
+	timestamp_t now = (session->packet.recv_time > 0) ?
+	    session->packet.recv_time : timestamp();
+
+	if ((retval & CLEAR_IS) != 0)
+	    nmea_cycle_close(session, now);
+	retval |= nmea_cycle_step(session, thistag, now);
+    }
+
+    if (session->driver.nmea.latch_frac_time) {
 	/* here's where we check for end-of-cycle */
-	if (session->driver.nmea.cycle_enders & (1 << thistag)) {
+	if (!nmea_cycle_ready(session)
+	    && (session->driver.nmea.cycle_enders & (1 << thistag))) {
 	    gpsd_report(LOG_PROG,
 			"%s ends a reporting cycle.\n",
 			session->driver.nmea.field[0]);
@@ -1227,7 +1782,7 @@ gps_mask_t nmea_parse(char *sentence, struct gps_device_t * session)
     }
 
     /* we might have a reliable end-of-cycle */
-    if (session->driver.nmea.cycle_enders != 0)
+    if (session->driver.nmea.cycle_enders != 0 || nmea_cycle_ready(session))
 	session->cycle_end_reliable = true;
 
     return retval;
@@ -245,9 +245,10 @@ _proto__msg_raw(struct gps_device_t *session, unsigned char *buf, size_t data_le
 	return 0;
     }
 
+    gpsd_raw_clear(&session->gpsdata.raw);
     for (i = 0; i < n; i++){
-	session->gpsdata.PRN[i] = GET_PRN();
-	session->gpsdata.ss[i] = GET_SIGNAL()
+	session->gpsdata.raw.PRN[i] = GET_PRN();
+	session->gpsdata.raw.ss[i] = GET_SIGNAL()
 	session->gpsdata.raw.satstat[i] = GET_FLAGS();
 	session->gpsdata.raw.pseudorange[i] = GET_PSEUDORANGE();
 	session->gpsdata.raw.doppler[i] = GET_DOPPLER();
@@ -256,7 +257,7 @@ _proto__msg_raw(struct gps_device_t *session, unsigned char *buf, size_t data_le
 	session->gpsdata.raw.codephase[i] = GET_CODE_PHASE();
 	session->gpsdata.raw.deltarange[i] = GET_DELTA_RANGE();
     }
-    return RAW_IS;
+    return RAW_SET;
 }
 
 /**
@@ -285,11 +285,61 @@ static void sirfbin_mode(struct gps_device_t *session, int mode)
 			session->gpsdata.dev.baudrate,
 			9 - session->gpsdata.dev.stopbits,
 			session->gpsdata.dev.stopbits, parity);
-	(void)usleep(333);	/* guessed settling time */
+	gpsd_write_pause(session, 0.000333);	/* guessed settling time */
 	session->gpsdata.dev.driver_mode = MODE_BINARY;
     }
     session->back_to_nmea = false;
 }
+
+static double sirfbin_link_demand(struct gps_device_t *session, bool trim)
+/* bytes per navigation cycle of the messages we configured */
+{
+    /* MIDs the chip may send that we throw away or can do without */
+    static const unsigned char unused[] = {
+	0x07,			/* Clock Status Data MID 7 */
+	0x09,			/* CPU Throughput MID 9 */
+	0x0d,			/* Visible List MID 13 */
+	0x1b,			/* DGPS status MID 27 */
+	0xff,			/* Debug messages MID 255 */
+    };
+    double bytes;
+    size_t i;
+
+    if (trim) {
+	/*@ +charint @*/
+	/* Set Message Rate MID 166 */
+	unsigned char unsetmid[] = {
+	    0xa0, 0xa2, 0x00, 0x08,
+	    0xa6,		/* MID 166 */
+	    0x00,		/* enable 1 */
+	    0x00,		/* MID, filled in below */
+	    0x00,		/* never */
+	    0x00, 0x00,		/* unused */
+	    0x00, 0x00,		/* unused */
+	    0x00, 0x00, 0xb0, 0xb3
+	};
+	/*@ -charint @*/
+	for (i = 0; i < sizeof(unused); i++) {
+	    gpsd_report(LOG_PROG, "SiRF: unset MID %d...\n", unused[i]);
+	    unsetmid[6] = unused[i];
+	    (void)sirf_write(session, unsetmid);
+	}
+    }
+
+    /* framing is 8 bytes per message on top of the payload */
+    bytes = 41 + 8;		/* MND MID 2 */
+    bytes += 91 + 8;		/* GND MID 41 */
+    bytes += 19 + 8;		/* PPS Time MID 52 */
+    /* SiRF navigates once a second, so cycles and seconds coincide */
+    bytes += (188 + 8) / 3.0;	/* tracker data MID 4, every third cycle */
+    /* subframes are only asked for on fast links, 12 channels, 6 cycles apart */
+    if (session->gpsdata.dev.baudrate >= 38400)
+	bytes += 12 * (43 + 8) / 6.0;
+    /* somebody else turned on raw measurements; they aren't ours to trim */
+    if (session->driver.sirf.have_raw)
+	bytes += 12 * (56 + 8);	/* NLMD MID 28, one per channel */
+    return bytes;
+}
 #endif /* RECONFIGURE_ENABLE */
 
 static ssize_t sirf_get(struct gps_device_t *session)
@@ -362,25 +412,106 @@ static gps_mask_t sirf_msg_errors(unsigned char *buf, size_t len UNUSED)
     return 0;
 }
 
-/* Navigation Library Measurement Data MID 28 */
-static gps_mask_t sirf_msg_nlmd(struct gps_device_t *session UNUSED,
-				unsigned char *buf UNUSED, size_t len)
+static double sirf_getd(unsigned char *buf, int off, bool swapped)
+/* fetch a SiRF double in either of the word orders the chips use */
 {
+    union long_double l_d;
+
+    if (swapped)
+	l_d.l = (int64_t)(((uint64_t)getbeu32(buf, off + 4) << 32)
+			  | getbeu32(buf, off));
+    else
+	l_d.l = getbes64(buf, off);
+    return l_d.d;
+}
 
-    double gps_tow = 0.0;
+/* Navigation Library Measurement Data MID 28 */
+static gps_mask_t sirf_msg_nlmd(struct gps_device_t *session,
+				unsigned char *buf, size_t len)
+{
+    gps_mask_t mask = 0;
+    double gps_tow, cn0;
+    bool swapped;
+    timestamp_t mtime;
+    unsigned int sync;
+    int i, j;
+    union int_float i_f;
 
     if (len != 56)
 	return 0;
-
-    /* oh barf, SiRF claims to be IEEE754 but supports two
-     * different double orders, neither IEEE754 */
-    /* FIXME - decode the time, since this is the first MID with a
-     * good time stamp this will be good for ntpshm time */
+    session->driver.sirf.have_raw = true;
+
+    /*
+     * oh barf, SiRF claims to be IEEE754 but supports two
+     * different double orders, neither IEEE754.  Take whichever
+     * order gives a time of week that makes sense, and read the
+     * other doubles the same way.  This has only been checked
+     * against the documentation, not against a live chip.
+     */
+    gps_tow = sirf_getd(buf, 7, false);
+    swapped = isnan(gps_tow) != 0 || gps_tow < 0 || gps_tow >= 604800;
+    if (swapped)
+	gps_tow = sirf_getd(buf, 7, true);
     gpsd_report(LOG_PROG, "SiRF: MID 0x1c, NLMD, gps_tow: %f\n", 
 		(double)gps_tow);
+    if (isnan(gps_tow) != 0 || gps_tow < 0 || gps_tow >= 604800
+	|| (session->context->valid & GPS_TIME_VALID) == 0)
+	return 0;
 
-    return 0;
+    /* one satellite per message; a new measurement time ends the batch */
+    mtime = gpsd_gpstime_resolve(session,
+				 (unsigned short)session->context->gps_week,
+				 gps_tow);
+    mask = gpsd_raw_gather(session, mtime, &i);
+    if (i < 0)
+	return mask;
+
+    session->rawbatch.PRN[i] = (int)getub(buf, 6);
+    session->rawbatch.mtime[i] = mtime;
+    session->rawbatch.pseudorange[i] = sirf_getd(buf, 15, swapped);
+    session->rawbatch.deltarange[i] = (double)getbef(buf, 23);
+    session->rawbatch.carrierphase[i] = sirf_getd(buf, 27, swapped);
+    /* C/N0 comes as ten 100ms samples; report their mean */
+    for (cn0 = 0, j = 0; j < 10; j++)
+	cn0 += (double)getub(buf, 38 + j);
+    session->rawbatch.ss[i] = cn0 / 10;
+    /* sync state: code epoch, then data bit, then no millisecond errors */
+    sync = ((unsigned int)getub(buf, 37) >> 1) & 0x03;
+    session->rawbatch.satstat[i] = SAT_ACQUIRED;
+    if (sync >= 1)
+	session->rawbatch.satstat[i] |= SAT_CODE_TRACK;
+    if (sync >= 2)
+	session->rawbatch.satstat[i] |= SAT_DATA_SYNC;
+    return mask;
+}
+
+#ifdef AIDING_ENABLE
+static bool sirf_aid(struct gps_device_t *session, unsigned char *msg)
+/* fill a MID 128 with the stored position and the time, if we have them */
+{
+    struct aiding_t *store = &session->context->aiding;
+    unsigned int week;
+    double tow, lat, lon, e2, n;
+
+    if (store->position.time == 0
+	|| !aiding_gpstime(session->context, &week, &tow))
+	return false;
+    /* MID 128 wants ECEF */
+    lat = store->position.lat * DEG_2_RAD;
+    lon = store->position.lon * DEG_2_RAD;
+    e2 = 1 - (WGS84B * WGS84B) / ((double)WGS84A * WGS84A);
+    n = WGS84A / sqrt(1 - e2 * sin(lat) * sin(lat));
+    /*@ -shiftimplementation @*/
+    putbe32(msg, 5, (int32_t)((n + store->position.alt) * cos(lat) * cos(lon)));
+    putbe32(msg, 9, (int32_t)((n + store->position.alt) * cos(lat) * sin(lon)));
+    putbe32(msg, 13, (int32_t)((n * (1 - e2) + store->position.alt) * sin(lat)));
+    putbe32(msg, 21, (uint32_t)(tow * 100));
+    putbe16(msg, 25, week);
+    /*@ +shiftimplementation @*/
+    msg[28] |= 0x01;		/* hot start with this data */
+    return true;
 }
+#endif /* AIDING_ENABLE */
 
 static gps_mask_t sirf_msg_swversion(struct gps_device_t *session,
 				     unsigned char *buf, size_t len)
@@ -419,13 +550,32 @@ static gps_mask_t sirf_msg_swversion(struct gps_device_t *session,
 #ifdef NTPSHM_ENABLE
     session->driver.sirf.time_seen = 0;
 #endif /* NTPSHM_ENABLE */
+#if defined(RECONFIGURE_ENABLE) || defined(AIDING_ENABLE)
+    /* both ride on MID 128, which restarts the receiver; send one */
+    if (!session->context->readonly) {
+	unsigned char init[sizeof(enablesubframe)];
+	bool send = false;
+
+	(void)memcpy(init, disablesubframe, sizeof(init));
 #ifdef RECONFIGURE_ENABLE
-    if (!session->context->readonly && session->gpsdata.dev.baudrate >= 38400) {
-        /* some USB devices are also too slow, no way to tell which ones */
-	gpsd_report(LOG_PROG, "SiRF: Enabling subframe transmission...\n");
-	(void)sirf_write(session, enablesubframe);
-    }
+	if (session->gpsdata.dev.baudrate >= 38400) {
+	    /* some USB devices are also too slow, no way to tell which ones */
+	    gpsd_report(LOG_PROG, "SiRF: Enabling subframe transmission...\n");
+	    (void)memcpy(init, enablesubframe, sizeof(init));
+	    send = true;
+	}
 #endif /* RECONFIGURE_ENABLE */
+#ifdef AIDING_ENABLE
+	/* don't disturb a receiver that already knows where it is */
+	if (session->gpsdata.fix.mode < MODE_2D && sirf_aid(session, init)) {
+	    gpsd_report(LOG_PROG, "SiRF: Initializing with stored position and time...\n");
+	    send = true;
+	}
+#endif /* AIDING_ENABLE */
+	if (send)
+	    (void)sirf_write(session, init);
+    }
+#endif /* defined(RECONFIGURE_ENABLE) || defined(AIDING_ENABLE) */
     gpsd_report(LOG_DATA, "SiRF: FV MID 0x06: subtype='%s' mask={DEVICEID}\n",
 		session->subtype);
     return DEVICEID_SET;
@@ -1262,10 +1412,10 @@ static void sirfbin_event_hook(struct gps_device_t *session, event_t event)
 
 	    gpsd_report(LOG_PROG, "SiRF: baudrate: %d\n",
 			session->gpsdata.dev.baudrate);
-	    (void)usleep(3330);	/* guessed settling time */
+	    gpsd_write_pause(session, 0.00333);	/* guessed settling time */
 	    gpsd_report(LOG_PROG, "SiRF: unset MID 30...\n");
 	    (void)sirf_write(session, unsetmid30);
-	    (void)usleep(3330);	/* guessed settling time */
+	    gpsd_write_pause(session, 0.00333);	/* guessed settling time */
 
 	    gpsd_report(LOG_PROG,
 			"SiRF: Requesting periodic ecef reports...\n");
@@ -1333,13 +1483,14 @@ const struct gps_type_t sirf_binary =
     .probe_detect   = NULL,		/* no probe */
     .get_packet     = sirf_get,		/* be prepared for SiRF or NMEA */
     .parse_packet   = sirfbin_parse_input,/* parse message packets */
-    .rtcm_writer    = gpsd_write,	/* send RTCM data straight */
+    .rtcm_writer    = gpsd_write_correction,	/* send RTCM data straight */
     .event_hook     = sirfbin_event_hook,/* lifetime event handler */
 #ifdef RECONFIGURE_ENABLE
     .speed_switcher = sirfbin_speed,	/* we can change baud rate */
     .mode_switcher  = sirfbin_mode,	/* there's a mode switcher */
     .rate_switcher  = NULL,		/* no sample-rate switcher */
     .min_cycle      = 1,		/* not relevant, no rate switch */
+    .link_demand    = sirfbin_link_demand,/* message set, for link budget */
 #endif /* RECONFIGURE_ENABLE */
 #ifdef CONTROLSEND_ENABLE
     .control_send   = sirf_control_send,/* how to send a control string */
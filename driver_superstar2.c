@@ -295,10 +295,11 @@ superstar2_msg_measurement(struct gps_device_t *session, unsigned char *buf,
 	return 0;
     }
     t = getled(buf, 7);		/* measurement time */
+    gpsd_raw_clear(&session->gpsdata.raw);
     for (i = 0; i < n; i++) {
 	session->gpsdata.raw.mtime[i] = t;
-	session->gpsdata.PRN[i] = (int)getub(buf, 11 * i + 15) & 0x1f;
-	session->gpsdata.ss[i] = (double)getub(buf, 11 * i * 15 + 1) / 4.0;
+	session->gpsdata.raw.PRN[i] = (int)getub(buf, 11 * i + 15) & 0x1f;
+	session->gpsdata.raw.ss[i] = (double)getub(buf, 11 * i * 15 + 1) / 4.0;
 	session->gpsdata.raw.codephase[i] =
 	    (double)getleu32(buf, 11 * i * 15 + 2);
 	ul = (unsigned long)getleu32(buf, 11 * i * 15 + 6);
@@ -308,7 +309,7 @@ superstar2_msg_measurement(struct gps_device_t *session, unsigned char *buf,
 	session->gpsdata.raw.pseudorange[i] = (double)(ul >> 12);
     }
 
-    mask |= RAW_IS;
+    mask |= RAW_SET;
     return mask;
 }
 
@@ -558,7 +559,7 @@ const struct gps_type_t superstar2_binary = {
     /* Parse message packets */
     .parse_packet	= superstar2_parse_input,
     /* RTCM handler (using default routine) */
-    .rtcm_writer	= gpsd_write,
+    .rtcm_writer	= gpsd_write_correction,
     /* Fire on various lifetime events */
     .event_hook		= superstar2_event_hook,
 #ifdef RECONFIGURE_ENABLE
@@ -401,6 +401,22 @@ static gps_mask_t tsip_analyze(struct gps_device_t *session)
 	d1 = getbed(buf, 17);	/* Time of Measurement */
 	gpsd_report(LOG_PROG, "Raw Measurement Data %d %f %f %f %f\n",
 		    getub(buf, 0), f1, f2, f3, d1);
+	/* one satellite per packet; a new measurement time ends the batch */
+	if ((session->context->valid & GPS_TIME_VALID) != 0) {
+	    timestamp_t mtime = gpsd_gpstime_resolve(session,
+				  (unsigned short)session->context->gps_week,
+				  d1);
+	    mask |= gpsd_raw_gather(session, mtime, &i);
+	    if (i >= 0) {
+		session->rawbatch.PRN[i] = (int)getub(buf, 0);
+		session->rawbatch.ss[i] = (double)f1;
+		/* code phase comes in 1/16ths of a 293.05m C/A chip */
+		session->rawbatch.codephase[i] = f2 * (293.0522 / 16);
+		session->rawbatch.doppler[i] = (double)f3;
+		session->rawbatch.mtime[i] = mtime;
+		session->rawbatch.satstat[i] = SAT_ACQUIRED;
+	    }
+	}
 	break;
     case 0x5b:			/* Satellite Ephemeris Status */
 	break;
@@ -1119,6 +1135,25 @@ static void tsip_mode(struct gps_device_t *session, int mode)
 	gpsd_report(LOG_ERROR, "unknown mode %i requested\n", mode);
     }
 }
+
+static double tsip_link_demand(struct gps_device_t *session,
+			       /*@unused@*/ bool trim UNUSED)
+/* bytes per navigation cycle of the automatic output we rely on */
+{
+    /*
+     * DLE, id and DLE ETX add 4 bytes to each report; DLE stuffing adds
+     * a few more that we don't try to predict.  Nothing is trimmed,
+     * the I/O options we send already leave out ECEF and raw output.
+     */
+    if (session->driver.tsip.superpkt)
+	return 60 + 4		/* 0x8f-23 compact super packet */
+	    + 64 + 4;		/* 0x47 signal levels */
+    return 20 + 4		/* 0x4a LLA position */
+	+ 20 + 4		/* 0x56 ENU velocity */
+	+ 10 + 4		/* 0x41 GPS time */
+	+ 25 + 4		/* 0x6d satellite selection */
+	+ 61 + 4;		/* 0x47 signal levels, 12 satellites */
+}
 #endif /* RECONFIGURE_ENABLE */
 
 #ifdef NTPSHM_ENABLE
@@ -1148,6 +1183,7 @@ const struct gps_type_t tsip_binary =
     .mode_switcher  = tsip_mode,	/* there is a mode switcher */
     .rate_switcher  = NULL,		/* no rate switcher */
     .min_cycle      = 1,		/* not relevant, no rate switcher */
+    .link_demand    = tsip_link_demand,	/* message set, for link budget */
 #endif /* RECONFIGURE_ENABLE */
 #ifdef CONTROLSEND_ENABLE
     .control_send   = tsip_control_send,/* how to send commands */
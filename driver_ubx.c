@@ -43,14 +43,35 @@ static gps_mask_t ubx_parse(struct gps_device_t *session, unsigned char *buf,
 			    size_t len);
 static gps_mask_t ubx_msg_nav_sol(struct gps_device_t *session,
 				  unsigned char *buf, size_t data_len);
+static gps_mask_t ubx_msg_nav_pvt(struct gps_device_t *session,
+				  unsigned char *buf, size_t data_len);
 static gps_mask_t ubx_msg_nav_dop(struct gps_device_t *session,
 				  unsigned char *buf, size_t data_len);
 static gps_mask_t ubx_msg_nav_timegps(struct gps_device_t *session,
 				      unsigned char *buf, size_t data_len);
 static gps_mask_t ubx_msg_nav_svinfo(struct gps_device_t *session,
 				     unsigned char *buf, size_t data_len);
+static gps_mask_t ubx_msg_nav_sat(struct gps_device_t *session,
+				  unsigned char *buf, size_t data_len);
 static void ubx_msg_sbas(struct gps_device_t *session, unsigned char *buf);
+static gps_mask_t ubx_msg_rxm_raw(struct gps_device_t *session,
+				  unsigned char *buf, size_t data_len);
 static void ubx_msg_inf(unsigned char *buf, size_t data_len);
+#ifdef RECONFIGURE_ENABLE
+static void ubx_rate_refused(struct gps_device_t *session);
+#endif /* RECONFIGURE_ENABLE */
+
+static void ubx_msg_rate(struct gps_device_t *session, unsigned char id,
+			 unsigned char rate)
+/* ask for a NAV-class message every rate navigation cycles, 0 for never */
+{
+    unsigned char msg[3];
+
+    msg[0] = (unsigned char)UBX_CLASS_NAV;
+    msg[1] = id;
+    msg[2] = rate;
+    (void)ubx_write(session, 0x06u, 0x01, msg, 3);	/* CFG-MSG */
+}
 
 /**
  * Navigation solution message
@@ -129,6 +150,111 @@ ubx_msg_nav_sol(struct gps_device_t *session, unsigned char *buf,
     return mask;
 }
 
+/**
+ * Position, velocity and time in one message (protocol 14 and later)
+ */
+static gps_mask_t
+ubx_msg_nav_pvt(struct gps_device_t *session, unsigned char *buf,
+		size_t data_len)
+{
+    unsigned int valid, flags;
+    unsigned char navmode;
+    double hacc;
+    struct tm unpacked_date;
+    gps_mask_t mask;
+
+    /* 84 bytes from u-blox 7 firmware, 92 from later ones */
+    if (data_len < 84)
+	return 0;
+
+    if (!session->driver.ubx.have_pvt) {
+	session->driver.ubx.have_pvt = true;
+	gpsd_report(LOG_INF, "UBX: NAV-PVT seen, NAV-SOL and NAV-TIMEGPS "
+		    "no longer needed\n");
+	if (!session->context->readonly) {
+	    ubx_msg_rate(session, 0x06, 0x00);	/* NAV-SOL */
+	    ubx_msg_rate(session, 0x20, 0x00);	/* NAV-TIMEGPS */
+	}
+    }
+
+    mask = 0;
+    valid = (unsigned int)getub(buf, 11);
+    if ((valid & (UBX_PVT_VALID_DATE | UBX_PVT_VALID_TIME))
+	== (UBX_PVT_VALID_DATE | UBX_PVT_VALID_TIME)) {
+	(void)memset(&unpacked_date, '\0', sizeof(unpacked_date));
+	unpacked_date.tm_year = (int)getleu16(buf, 4) - 1900;
+	unpacked_date.tm_mon = (int)getub(buf, 6) - 1;
+	unpacked_date.tm_mday = (int)getub(buf, 7);
+	unpacked_date.tm_hour = (int)getub(buf, 8);
+	unpacked_date.tm_min = (int)getub(buf, 9);
+	unpacked_date.tm_sec = (int)getub(buf, 10);
+	/* nano is signed, the date fields are rounded to the nearest second */
+	session->newdata.time = (timestamp_t)mkgmtime(&unpacked_date)
+	    + getles32(buf, 16) * 1e-9;
+	mask |= TIME_SET | PPSTIME_IS;
+    }
+
+    flags = (unsigned int)getub(buf, 21);
+    navmode = (unsigned char)getub(buf, 20);
+    if ((flags & UBX_PVT_FLAG_GNSS_FIX_OK) == 0)
+	navmode = UBX_MODE_NOFIX;
+    switch (navmode) {
+    case UBX_MODE_TMONLY:
+    case UBX_MODE_3D:
+	session->newdata.mode = MODE_3D;
+	break;
+    case UBX_MODE_2D:
+    case UBX_MODE_DR:		/* consider this too as 2D */
+    case UBX_MODE_GPSDR:	/* FIX-ME: DR-aided GPS may be valid 3D */
+	session->newdata.mode = MODE_2D;
+	break;
+    default:
+	session->newdata.mode = MODE_NO_FIX;
+    }
+    if ((flags & UBX_PVT_FLAG_DIFF) != 0
+	&& session->newdata.mode != MODE_NO_FIX)
+	session->gpsdata.status = STATUS_DGPS_FIX;
+    else if (session->newdata.mode != MODE_NO_FIX)
+	session->gpsdata.status = STATUS_FIX;
+    else
+	session->gpsdata.status = STATUS_NO_FIX;
+    mask |= MODE_SET | STATUS_SET;
+    session->gpsdata.satellites_used = (int)getub(buf, 23);
+
+    if (session->newdata.mode != MODE_NO_FIX) {
+	session->newdata.longitude = getles32(buf, 24) * 1e-7;
+	session->newdata.latitude = getles32(buf, 28) * 1e-7;
+	session->newdata.altitude = getles32(buf, 36) / 1000.0;
+	session->gpsdata.separation =
+	    (getles32(buf, 32) - getles32(buf, 36)) / 1000.0;
+	session->newdata.speed = getles32(buf, 60) / 1000.0;
+	session->newdata.track = getles32(buf, 64) * 1e-5;
+	session->newdata.climb = -getles32(buf, 56) / 1000.0;
+	mask |= LATLON_SET | ALTITUDE_SET | SPEED_SET | TRACK_SET | CLIMB_SET;
+
+	hacc = getleu32(buf, 40) / 1000.0;
+	session->newdata.epx = session->newdata.epy = hacc / sqrt(2);
+	session->newdata.epv = getleu32(buf, 44) / 1000.0;
+	session->newdata.eps = getleu32(buf, 68) / 1000.0;
+	mask |= HERR_SET | VERR_SET | SPEEDERR_SET;
+    }
+    /* leave pDOP to NAV-DOP, which has all the others too */
+
+    gpsd_report(LOG_DATA,
+		"NAVPVT: time=%.2f lat=%.2f lon=%.2f alt=%.2f track=%.2f speed=%.2f climb=%.2f mode=%d status=%d used=%d\n",
+		session->newdata.time,
+		session->newdata.latitude,
+		session->newdata.longitude,
+		session->newdata.altitude,
+		session->newdata.track,
+		session->newdata.speed,
+		session->newdata.climb,
+		session->newdata.mode,
+		session->gpsdata.status,
+		session->gpsdata.satellites_used);
+    return mask;
+}
+
 /**
  * Dilution of precision message
  */
@@ -237,6 +363,82 @@ ubx_msg_nav_svinfo(struct gps_device_t *session, unsigned char *buf,
     return SATELLITE_SET | USED_IS;
 }
 
+/**
+ * Satellite information for every constellation (protocol 15 and later)
+ */
+static gps_mask_t
+ubx_msg_nav_sat(struct gps_device_t *session, unsigned char *buf,
+		size_t data_len)
+{
+    unsigned int i, j, nchan, nsv, st;
+
+    if (data_len < 8) {
+	gpsd_report(LOG_PROG, "runt NAV-SAT (datalen=%zd)\n", data_len);
+	return 0;
+    }
+    nchan = (unsigned int)getub(buf, 5);
+    if (nchan > MAXCHANNELS || data_len < 8 + 12 * nchan) {
+	gpsd_report(LOG_WARN,
+		    "Invalid NAV-SAT message, %u reported visible\n", nchan);
+	return 0;
+    }
+
+    if (!session->driver.ubx.have_sat) {
+	session->driver.ubx.have_sat = true;
+	gpsd_report(LOG_INF, "UBX: NAV-SAT seen, NAV-SVINFO no longer needed\n");
+	if (!session->context->readonly)
+	    ubx_msg_rate(session, 0x30, 0x00);	/* NAV-SVINFO */
+    }
+
+    gpsd_zero_satellites(&session->gpsdata);
+    nsv = 0;
+    for (i = j = st = 0; i < nchan; i++) {
+	unsigned int off = 8 + 12 * i;
+	unsigned int svid = (unsigned int)getub(buf, off + 1);
+	int prn;
+
+	if ((int)getub(buf, off + 2) == 0)
+	    continue;		/* same as NAV-SVINFO, skip the unheard */
+	/* map onto the satellite numbers u-blox uses in extended NMEA */
+	switch (getub(buf, off)) {
+	case UBX_GNSS_GPS:
+	case UBX_GNSS_SBAS:
+	    prn = (int)svid;
+	    break;
+	case UBX_GNSS_GALILEO:
+	    prn = (int)svid + 210;
+	    break;
+	case UBX_GNSS_BEIDOU:
+	    prn = (int)svid + (svid <= 5 ? 158 : 27);
+	    break;
+	case UBX_GNSS_QZSS:
+	    prn = (int)svid + 192;
+	    break;
+	case UBX_GNSS_GLONASS:
+	    prn = (int)svid + 64;
+	    break;
+	default:
+	    continue;		/* IMES and anything newer */
+	}
+	session->gpsdata.PRN[j] = prn;
+	session->gpsdata.ss[j] = (float)getub(buf, off + 2);
+	session->gpsdata.elevation[j] = (int)getsb(buf, off + 3);
+	session->gpsdata.azimuth[j] = (int)getles16(buf, off + 4);
+	st++;
+	if ((getleu32(buf, off + 8) & UBX_SAT_FLAG_USED) != 0)
+	    session->gpsdata.used[nsv++] = prn;
+	j++;
+    }
+    session->gpsdata.skyview_time = NAN;
+    session->gpsdata.satellites_visible = (int)st;
+    session->gpsdata.satellites_used = (int)nsv;
+    gpsd_report(LOG_DATA,
+		"NAVSAT: visible=%d used=%d mask={SATELLITE|USED}\n",
+		session->gpsdata.satellites_visible,
+		session->gpsdata.satellites_used);
+    return SATELLITE_SET | USED_IS;
+}
+
 /*
  * SBAS Info
  */
@@ -260,6 +462,61 @@ static void ubx_msg_sbas(struct gps_device_t *session, unsigned char *buf)
     session->driver.ubx.sbas_in_use = (unsigned char)getub(buf, 4);
 }
 
+/*
+ * Raw measurements, on the receivers that have them (LEA-4T, LEA-6T)
+ */
+static gps_mask_t
+ubx_msg_rxm_raw(struct gps_device_t *session, unsigned char *buf,
+		size_t data_len)
+{
+    /* carrier phase is reported in L1 cycles */
+#define L1_WAVELENGTH	0.190293672798365	/* meters */
+    unsigned int i, nsv;
+    int qi;
+    timestamp_t mtime;
+    union int_float i_f;
+    union long_double l_d;
+
+    if (data_len < 8)
+	return 0;
+    nsv = (unsigned int)getub(buf, 6);
+    if (data_len != 8 + 24 * nsv || nsv > MAXCHANNELS) {
+	gpsd_report(LOG_PROG, "RXM-RAW: runt or oversized (%zd, %u SVs)\n",
+		    data_len, nsv);
+	return 0;
+    }
+    mtime = gpsd_gpstime_resolve(session,
+				 (unsigned short)getles16(buf, 4),
+				 (double)getles32(buf, 0) / 1000.0);
+
+    session->driver.ubx.have_raw = true;
+    gpsd_raw_clear(&session->gpsdata.raw);
+    for (i = 0; i < nsv; i++) {
+	unsigned int off = 8 + 24 * i;
+
+	session->gpsdata.raw.PRN[i] = (int)getub(buf, off + 20);
+	session->gpsdata.raw.carrierphase[i] =
+	    getled(buf, off + 0) * L1_WAVELENGTH;
+	session->gpsdata.raw.pseudorange[i] = getled(buf, off + 8);
+	session->gpsdata.raw.doppler[i] = (double)getlef(buf, off + 16);
+	session->gpsdata.raw.ss[i] = (double)getsb(buf, off + 22);
+	session->gpsdata.raw.mtime[i] = mtime;
+	/* mesQI: >=4 code locked, >=5 carrier locked too */
+	qi = (int)getsb(buf, off + 21);
+	if (qi >= 1)
+	    session->gpsdata.raw.satstat[i] |= SAT_ACQUIRED;
+	if (qi >= 4)
+	    session->gpsdata.raw.satstat[i] |= SAT_CODE_TRACK;
+	if (qi >= 5)
+	    session->gpsdata.raw.satstat[i] |= SAT_CARR_TRACK;
+    }
+#undef L1_WAVELENGTH
+
+    gpsd_report(LOG_DATA, "RXM-RAW: time=%.3f nsv=%u mask={RAW}\n",
+		mtime, nsv);
+    return RAW_SET;
+}
+
 /*
  * Raw Subframes
  */
@@ -346,8 +603,16 @@ gps_mask_t ubx_parse(struct gps_device_t * session, unsigned char *buf,
 	break;
     case UBX_NAV_SOL:
 	gpsd_report(LOG_PROG, "UBX_NAV_SOL\n");
+	/* NAV-PVT ends the cycle instead when the receiver has it */
+	if (!session->driver.ubx.have_pvt)
+	    mask =
+		ubx_msg_nav_sol(session, &buf[6],
+				data_len) | (CLEAR_IS | REPORT_IS);
+	break;
+    case UBX_NAV_PVT:
+	gpsd_report(LOG_PROG, "UBX_NAV_PVT\n");
 	mask =
-	    ubx_msg_nav_sol(session, &buf[6],
+	    ubx_msg_nav_pvt(session, &buf[6],
 			    data_len) | (CLEAR_IS | REPORT_IS);
 	break;
     case UBX_NAV_POSUTM:
@@ -361,7 +626,8 @@ gps_mask_t ubx_parse(struct gps_device_t * session, unsigned char *buf,
 	break;
     case UBX_NAV_TIMEGPS:
 	gpsd_report(LOG_PROG, "UBX_NAV_TIMEGPS\n");
-	mask = ubx_msg_nav_timegps(session, &buf[6], data_len);
+	if (!session->driver.ubx.have_pvt)
+	    mask = ubx_msg_nav_timegps(session, &buf[6], data_len);
 	break;
     case UBX_NAV_TIMEUTC:
 	gpsd_report(LOG_IO, "UBX_NAV_TIMEUTC\n");
@@ -371,7 +637,12 @@ gps_mask_t ubx_parse(struct gps_device_t * session, unsigned char *buf,
 	break;
     case UBX_NAV_SVINFO:
 	gpsd_report(LOG_PROG, "UBX_NAV_SVINFO\n");
-	mask = ubx_msg_nav_svinfo(session, &buf[6], data_len);
+	if (!session->driver.ubx.have_sat)
+	    mask = ubx_msg_nav_svinfo(session, &buf[6], data_len);
+	break;
+    case UBX_NAV_SAT:
+	gpsd_report(LOG_PROG, "UBX_NAV_SAT\n");
+	mask = ubx_msg_nav_sat(session, &buf[6], data_len);
 	break;
     case UBX_NAV_DGPS:
 	gpsd_report(LOG_IO, "UBX_NAV_DGPS\n");
@@ -386,6 +657,7 @@ gps_mask_t ubx_parse(struct gps_device_t * session, unsigned char *buf,
 
     case UBX_RXM_RAW:
 	gpsd_report(LOG_IO, "UBX_RXM_RAW\n");
+	mask = ubx_msg_rxm_raw(session, &buf[6], data_len);
 	break;
     case UBX_RXM_SFRB:
 	mask = ubx_msg_sfrb(session, &buf[6]);
@@ -471,6 +743,10 @@ gps_mask_t ubx_parse(struct gps_device_t * session, unsigned char *buf,
     case UBX_ACK_NAK:
 	gpsd_report(LOG_IO, "UBX_ACK_NAK, class: %02x, id: %02x\n", buf[6],
 		    buf[7]);
+#ifdef RECONFIGURE_ENABLE
+	if (getub(buf, 6) == UBX_CLASS_CFG && getub(buf, 7) == 0x08)
+	    ubx_rate_refused(session);
+#endif /* RECONFIGURE_ENABLE */
 	break;
     case UBX_ACK_ACK:
 	gpsd_report(LOG_IO, "UBX_ACK_ACK, class: %02x, id: %02x\n", buf[6],
@@ -588,6 +864,128 @@ static void ubx_catch_model(struct gps_device_t *session, unsigned char *buf,
     /*@ -charint */
 }
 
+#ifdef AIDING_ENABLE
+static void ubx_put_double(unsigned char *buf, int off, double d)
+/* UBX R8 fields are little-endian IEEE doubles */
+{
+    union long_double l_d;
+
+    l_d.d = d;
+    putle32(buf, off, (uint32_t)(l_d.l & 0xffffffff));
+    putle32(buf, off + 4, (uint32_t)((uint64_t)l_d.l >> 32));
+}
+
+static void ubx_put_float(unsigned char *buf, int off, float f)
+{
+    union int_float i_f;
+
+    i_f.f = f;
+    putle32(buf, off, i_f.i);
+}
+
+static void ubx_aid_hui(struct gps_device_t *session)
+/* AID-HUI: ionosphere and UTC parameters from subframe 4 page 18 */
+{
+    const uint32_t *w = session->context->aiding.ionoutc.words;
+    unsigned char msg[72];
+    double a0, a1;
+
+    /*
+     * Word n of the page is w[n-3]; see IS-GPS-200 figure 20-1 sheet 8
+     * for where the fields sit.
+     */
+    (void)memset(msg, '\0', sizeof(msg));
+    a1 = pow(2.0, -50) * (double)(int32_t)(w[3] << 8) / 256.0;
+    a0 = pow(2.0, -30) * (double)(int32_t)(((w[4] & 0xffffff) << 8)
+					   | ((w[5] >> 16) & 0xff));
+    ubx_put_double(msg, 4, a0);
+    ubx_put_double(msg, 12, a1);
+    putle32(msg, 20, ((w[5] >> 8) & 0xff) << 12);		/* tot */
+    putle16(msg, 24, w[5] & 0xff);				/* WNt */
+    putle16(msg, 26, (int8_t)((w[6] >> 16) & 0xff));		/* dtLS */
+    putle16(msg, 28, (w[6] >> 8) & 0xff);			/* WNlsf */
+    putle16(msg, 30, w[6] & 0xff);				/* DN */
+    putle16(msg, 32, (int8_t)((w[7] >> 16) & 0xff));		/* dtLSF */
+    ubx_put_float(msg, 36, (float)(pow(2.0, -30) * (int8_t)((w[0] >> 8) & 0xff)));
+    ubx_put_float(msg, 40, (float)(pow(2.0, -27) * (int8_t)(w[0] & 0xff)));
+    ubx_put_float(msg, 44, (float)(pow(2.0, -24) * (int8_t)((w[1] >> 16) & 0xff)));
+    ubx_put_float(msg, 48, (float)(pow(2.0, -24) * (int8_t)((w[1] >> 8) & 0xff)));
+    ubx_put_float(msg, 52, (float)(pow(2.0, 11) * (int8_t)(w[1] & 0xff)));
+    ubx_put_float(msg, 56, (float)(pow(2.0, 14) * (int8_t)((w[2] >> 16) & 0xff)));
+    ubx_put_float(msg, 60, (float)(pow(2.0, 16) * (int8_t)((w[2] >> 8) & 0xff)));
+    ubx_put_float(msg, 64, (float)(pow(2.0, 16) * (int8_t)(w[2] & 0xff)));
+    putle32(msg, 68, 0x06);		/* UTC and Klobuchar parameters valid */
+    (void)ubx_write(session, 0x0bu, 0x02, msg, 72);
+}
+
+static void ubx_aid(struct gps_device_t *session)
+/* push what the aiding store knows to a freshly activated receiver */
+{
+    struct aiding_t *store = &session->context->aiding;
+    unsigned char msg[104];
+    time_t now = time(NULL);
+    unsigned int week, flags = 0;
+    double tow;
+    int i, j, eph = 0, alm = 0;
+
+    /* AID-INI: where and when we are */
+    (void)memset(msg, '\0', 48);
+    if (store->position.time != 0) {
+	putle32(msg, 0, (int32_t)(store->position.lat * 1e7));
+	putle32(msg, 4, (int32_t)(store->position.lon * 1e7));
+	putle32(msg, 8, (int32_t)(store->position.alt * 100));
+	/* a receiver that moved since is better told the truth about it */
+	putle32(msg, 12, (now - store->position.time < 86400) ? 1000000 : 30000000);
+	flags |= 0x21;		/* position valid, given as LLA */
+    }
+    if (aiding_gpstime(session->context, &week, &tow)) {
+	putle16(msg, 18, week);
+	putle32(msg, 20, (uint32_t)(tow * 1000));
+	putle32(msg, 28, 10000);	/* tAccMs: we trust the clock to 10s */
+	flags |= 0x02;		/* time valid */
+    }
+    if (flags == 0)
+	return;
+    putle32(msg, 44, flags);
+    (void)ubx_write(session, 0x0bu, 0x01, msg, 48);
+
+    if (store->ionoutc.collected != 0)
+	ubx_aid_hui(session);
+
+    /* AID-EPH: only ephemerides the receiver could still navigate with */
+    for (i = 0; i < AIDING_SVS; i++) {
+	if (store->eph[i].collected == 0
+	    || now - store->eph[i].collected > AIDING_EPH_MAXAGE)
+	    continue;
+	putle32(msg, 0, i + 1);
+	putle32(msg, 4, store->eph[i].how);
+	for (j = 0; j < 24; j++)
+	    putle32(msg, 8 + 4 * j, store->eph[i].words[j / 8][j % 8]);
+	if (!ubx_write(session, 0x0bu, 0x31, msg, 104))
+	    break;		/* output queue full */
+	eph++;
+    }
+
+    /* AID-ALM */
+    for (i = 0; i < AIDING_SVS; i++) {
+	if (store->alm[i].collected == 0
+	    || now - store->alm[i].collected > AIDING_ALM_MAXAGE)
+	    continue;
+	putle32(msg, 0, i + 1);
+	putle32(msg, 4, store->alm[i].week);
+	for (j = 0; j < 8; j++)
+	    putle32(msg, 8 + 4 * j, store->alm[i].words[j]);
+	if (!ubx_write(session, 0x0bu, 0x30, msg, 40))
+	    break;
+	alm++;
+    }
+    gpsd_report(LOG_PROG, "UBX aiding: position %s, time %s, "
+		"%d ephemerides, %d almanacs\n",
+		(flags & 0x01) ? "yes" : "no", (flags & 0x02) ? "yes" : "no",
+		eph, alm);
+}
+#endif /* AIDING_ENABLE */
+
 static void ubx_event_hook(struct gps_device_t *session, event_t event)
 {
     if (session->context->readonly)
@@ -613,27 +1011,23 @@ static void ubx_event_hook(struct gps_device_t *session, event_t event)
 	msg[7] = 0x00;
 	(void)ubx_write(session, 0x06u, 0x16, msg, 8);
 
-	msg[0] = 0x01;		/* class */
-	msg[1] = 0x04;		/* msg id  = UBX_NAV_DOP */
-	msg[2] = 0x01;		/* rate */
-	(void)ubx_write(session, 0x06u, 0x01, msg, 3);
-	msg[0] = 0x01;		/* class */
-	msg[1] = 0x06;		/* msg id  = NAV-SOL */
-	msg[2] = 0x01;		/* rate */
-	(void)ubx_write(session, 0x06u, 0x01, msg, 3);
-	msg[0] = 0x01;		/* class */
-	msg[1] = 0x20;		/* msg id  = UBX_NAV_TIMEGPS */
-	msg[2] = 0x01;		/* rate */
-	(void)ubx_write(session, 0x06u, 0x01, msg, 3);
-	msg[0] = 0x01;		/* class */
-	msg[1] = 0x30;		/* msg id  = NAV-SVINFO */
-	msg[2] = 0x0a;		/* rate */
-	(void)ubx_write(session, 0x06u, 0x01, msg, 3);
-	msg[0] = 0x01;		/* class */
-	msg[1] = 0x32;		/* msg id  = NAV-SBAS */
-	msg[2] = 0x0a;		/* rate */
-	(void)ubx_write(session, 0x06u, 0x01, msg, 3);
+	ubx_msg_rate(session, 0x04, 0x01);	/* NAV-DOP */
+	/*
+	 * Ask for NAV-PVT and NAV-SAT as well as the older messages.
+	 * Receivers that predate them NAK the request and carry on with
+	 * the old set; ones that have them get the redundant old messages
+	 * switched off when the first new one comes in.
+	 */
+	ubx_msg_rate(session, 0x06, 0x01);	/* NAV-SOL */
+	ubx_msg_rate(session, 0x20, 0x01);	/* NAV-TIMEGPS */
+	ubx_msg_rate(session, 0x07, 0x01);	/* NAV-PVT */
+	ubx_msg_rate(session, 0x30, 0x0a);	/* NAV-SVINFO */
+	ubx_msg_rate(session, 0x35, 0x0a);	/* NAV-SAT */
+	ubx_msg_rate(session, 0x32, 0x0a);	/* NAV-SBAS */
 	/*@ +type @*/
+#ifdef AIDING_ENABLE
+	ubx_aid(session);
+#endif /* AIDING_ENABLE */
     } else if (event == event_deactivate) {
 	/*@ -type @*/
 	unsigned char msg[4] = {
@@ -725,24 +1119,83 @@ static bool ubx_rate(struct gps_device_t *session, double cycletime)
     /*@ -type @*/
     unsigned char msg[6] = {
 	0x00, 0x00,		/* U2: Measurement rate (ms) */
-	0x00, 0x01,		/* U2: Navigation rate (cycles) */
+	0x01, 0x00,		/* U2: Navigation rate (cycles) */
 	0x00, 0x00,		/* U2: Alignment to reference time: 0 = UTC, !0 = GPS */
     };
     /*@ +type @*/
 
-    /* clamp to cycle times that i know work on my receiver */
-    if (cycletime > 1000.0)
-	cycletime = 1000.0;
-    if (cycletime < 200.0)
-	cycletime = 200.0;
+    /*
+     * Nothing goes faster than 25Hz.  Receivers that can't keep up
+     * with what we ask NAK it, and ubx_rate_refused() backs off.
+     */
+    if (cycletime > 1.0)
+	cycletime = 1.0;
+    if (cycletime < 0.04)
+	cycletime = 0.04;
 
     gpsd_report(LOG_IO, "UBX rate change, report every %f secs\n", cycletime);
-    s = (unsigned short)cycletime;
-    msg[0] = (unsigned char)(s >> 8);
-    msg[1] = (unsigned char)(s & 0xff);
+    s = (unsigned short)(cycletime * 1000 + 0.5);
+    putle16(msg, 0, s);
 
     return ubx_write(session, 0x06, 0x08, msg, 6);	/* CFG-RATE */
 }
+
+static void ubx_rate_refused(struct gps_device_t *session)
+/* the receiver NAKed a CFG-RATE; fall back to its next slower period */
+{
+    /* 25, 20, 10, 8, 5, 4 and 2Hz, each the limit of some generation */
+    static const unsigned short periods[] = {40, 50, 100, 125, 200, 250, 500};
+    unsigned short refused =
+	(unsigned short)(session->gpsdata.dev.cycle * 1000 + 0.5);
+    int i;
+
+    for (i = 0; i < NITEMS(periods); i++)
+	if (periods[i] > refused) {
+	    gpsd_report(LOG_INF,
+			"UBX refused a %ums measurement period, trying %ums\n",
+			refused, periods[i]);
+	    if (ubx_rate(session, periods[i] / 1000.0))
+		session->gpsdata.dev.cycle = periods[i] / 1000.0;
+	    return;
+	}
+}
+
+static double ubx_link_demand(struct gps_device_t *session, bool trim)
+/* bytes per navigation cycle of the messages we configured */
+{
+    /* NAV messages we never decode, but other software may have enabled */
+    static const unsigned char unused[] = {
+	0x01,			/* NAV-POSECEF */
+	0x02,			/* NAV-POSLLH */
+	0x03,			/* NAV-STATUS */
+	0x08,			/* NAV-POSUTM */
+	0x11,			/* NAV-VELECEF */
+	0x12,			/* NAV-VELNED */
+	0x21,			/* NAV-TIMEUTC */
+	0x22,			/* NAV-CLOCK */
+	0x31,			/* NAV-DGPS */
+    };
+    double bytes;
+    size_t i;
+
+    if (trim)
+	for (i = 0; i < sizeof(unused); i++)
+	    ubx_msg_rate(session, unused[i], 0x00);
+
+    /* framing is 8 bytes per message on top of the payload */
+    bytes = 26;			/* NAV-DOP */
+    if (session->driver.ubx.have_pvt)
+	bytes += 100;		/* NAV-PVT, 92 bytes on M8 */
+    else
+	bytes += 60 + 24;	/* NAV-SOL, NAV-TIMEGPS */
+    /* skyview and SBAS status every tenth cycle, allowing for 16 SVs */
+    bytes += (16 + 12 * 16) / 10.0;	/* NAV-SAT or NAV-SVINFO */
+    bytes += (20 + 12 * 3) / 10.0;	/* NAV-SBAS */
+    /* somebody else turned on raw measurements; they aren't ours to trim */
+    if (session->driver.ubx.have_raw)
+	bytes += 16 + 24 * 12;		/* RXM-RAW */
+    return bytes;
+}
 #endif /* RECONFIGURE_ENABLE */
 
 /* This is everything we export */
@@ -756,13 +1209,14 @@ const struct gps_type_t ubx_binary = {
     .probe_detect     = NULL,           /* Startup-time device detector */
     .get_packet       = generic_get,    /* Packet getter (using default routine) */
     .parse_packet     = parse_input,    /* Parse message packets */
-    .rtcm_writer      = gpsd_write,      /* RTCM handler (using default routine) */
+    .rtcm_writer      = gpsd_write_correction,	/* RTCM handler (using default routine) */
     .event_hook       = ubx_event_hook,	/* Fiew in variious lifetime events */
 #ifdef RECONFIGURE_ENABLE
     .speed_switcher   = ubx_speed,      /* Speed (baudrate) switch */
     .mode_switcher    = ubx_nmea_mode,  /* Switch to NMEA mode */
     .rate_switcher    = ubx_rate,       /* Message delivery rate switcher */
-    .min_cycle        = 0.25,           /* Maximum 4Hz sample rate */
+    .min_cycle        = 0.04,           /* Maximum 25Hz sample rate */
+    .link_demand      = ubx_link_demand,	/* message set, for link budget */
 #endif /* RECONFIGURE_ENABLE */
 #ifdef CONTROLSEND_ENABLE
     .control_send     = ubx_control_send,	/* no control sender yet */
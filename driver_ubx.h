@@ -28,6 +28,7 @@ typedef enum {
     UBX_NAV_STATUS	= UBX_MSGID(UBX_CLASS_NAV, 0x03),
     UBX_NAV_DOP		= UBX_MSGID(UBX_CLASS_NAV, 0x04),
     UBX_NAV_SOL		= UBX_MSGID(UBX_CLASS_NAV, 0x06),
+    UBX_NAV_PVT		= UBX_MSGID(UBX_CLASS_NAV, 0x07),
     UBX_NAV_POSUTM	= UBX_MSGID(UBX_CLASS_NAV, 0x08),
     UBX_NAV_VELECEF	= UBX_MSGID(UBX_CLASS_NAV, 0x11),
     UBX_NAV_VELNED	= UBX_MSGID(UBX_CLASS_NAV, 0x12),
@@ -37,6 +38,7 @@ typedef enum {
     UBX_NAV_SVINFO	= UBX_MSGID(UBX_CLASS_NAV, 0x30),
     UBX_NAV_DGPS	= UBX_MSGID(UBX_CLASS_NAV, 0x31),
     UBX_NAV_SBAS	= UBX_MSGID(UBX_CLASS_NAV, 0x32),
+    UBX_NAV_SAT		= UBX_MSGID(UBX_CLASS_NAV, 0x35),
     UBX_NAV_EKFSTATUS	= UBX_MSGID(UBX_CLASS_NAV, 0x40),
 
     UBX_RXM_RAW		= UBX_MSGID(UBX_CLASS_RXM, 0x10),
@@ -101,6 +103,22 @@ typedef enum {
 #define UBX_SOL_VALID_WEEK 0x04
 #define UBX_SOL_VALID_TIME 0x08
 
+/* from UBX_NAV_PVT */
+#define UBX_PVT_VALID_DATE 0x01
+#define UBX_PVT_VALID_TIME 0x02
+#define UBX_PVT_FLAG_GNSS_FIX_OK 0x01
+#define UBX_PVT_FLAG_DIFF 0x02
+
+/* from UBX_NAV_SAT */
+#define UBX_GNSS_GPS 0
+#define UBX_GNSS_SBAS 1
+#define UBX_GNSS_GALILEO 2
+#define UBX_GNSS_BEIDOU 3
+#define UBX_GNSS_IMES 4
+#define UBX_GNSS_QZSS 5
+#define UBX_GNSS_GLONASS 6
+#define UBX_SAT_FLAG_USED 0x08
+
 /* from UBX_NAV_SVINFO */
 #define UBX_SAT_USED 0x01
 #define UBX_SAT_DGPS 0x02
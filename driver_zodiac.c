@@ -46,12 +46,9 @@ static unsigned short zodiac_checksum(unsigned short *w, int n)
 /* data is assumed to contain len/2 unsigned short words
  * we change the endianness to little, when needed.
  */
-static int end_write(int fd, void *d, int len)
+static void end_copy(char *p, void *d, size_t n)
 {
-    char buf[BUFSIZ];
-    char *p = buf;
     char *data = (char *)d;
-    size_t n = (size_t) len;
 
     while (n > 0) {
 	*p++ = *(data + 1);
@@ -59,14 +56,13 @@ static int end_write(int fd, void *d, int len)
 	data += 2;
 	n -= 2;
     }
-    return write(fd, buf, len);
 }
 #else
-#define end_write write
+#define end_copy memcpy
 #endif /* WORDS_BIGENDIAN */
 
 static ssize_t zodiac_spew(struct gps_device_t *session, unsigned short type,
-			   unsigned short *dat, int dlen)
+			   unsigned short *dat, int dlen, write_t kind)
 {
     struct header h;
     int i;
@@ -82,9 +78,15 @@ static ssize_t zodiac_spew(struct gps_device_t *session, unsigned short type,
 	size_t hlen, datlen;
 	hlen = sizeof(h);
 	datlen = sizeof(unsigned short) * dlen;
-	if (end_write(session->gpsdata.gps_fd, &h, hlen) != (ssize_t) hlen ||
-	    end_write(session->gpsdata.gps_fd, dat,
-		      datlen) != (ssize_t) datlen) {
+	if (hlen + datlen > sizeof(session->msgbuf))
+	    return -1;
+	(void)end_copy(session->msgbuf, &h, hlen);
+	(void)end_copy(session->msgbuf + hlen, dat, datlen);
+	session->msgbuflen = hlen + datlen;
+	if ((kind == write_correction
+	     ? gpsd_write_correction(session, session->msgbuf, session->msgbuflen)
+	     : gpsd_write(session, session->msgbuf, session->msgbuflen))
+	    != (ssize_t) session->msgbuflen) {
 	    gpsd_report(LOG_RAW, "Reconfigure write failed\n");
 	    return -1;
 	}
@@ -116,7 +118,7 @@ static void send_rtcm(struct gps_device_t *session,
     memcpy(&data[1], rtcmbuf, rtcmbytes);
     data[n] = zodiac_checksum(data, n);
 
-    (void)zodiac_spew(session, 1351, data, n + 1);
+    (void)zodiac_spew(session, 1351, data, n + 1, write_correction);
 }
 
 static ssize_t zodiac_send_rtcm(struct gps_device_t *session,
@@ -363,18 +365,11 @@ static gps_mask_t zodiac_analyze(struct gps_device_t *session)
 	gpsd_report(LOG_RAW + 4, "Is this a trigger: %s ?\n",
 		    (char *)session->packet.outbuffer);
 
-	for (dp = gpsd_drivers; *dp; dp++) {
-	    char *trigger = (*dp)->trigger;
-
-	    if (trigger != NULL
-		&& strncmp((char *)session->packet.outbuffer, trigger,
-			   strlen(trigger)) == 0
-		&& isatty(session->gpsdata.gps_fd) != 0) {
-		gpsd_report(LOG_PROG, "found %s.\n", trigger);
+	dp = gpsd_trigger_match((char *)session->packet.outbuffer);
+	if (dp != NULL && isatty(session->gpsdata.gps_fd) != 0) {
+	    gpsd_report(LOG_PROG, "found %s.\n", (*dp)->trigger);
 
-		(void)gpsd_switch_driver(session, (*dp)->type_name);
-		return 0;
-	    }
+	    (void)gpsd_switch_driver(session, (*dp)->type_name);
 	}
 	return 0;
     }
@@ -427,7 +422,7 @@ static ssize_t zodiac_control_send(struct gps_device_t *session,
 
     /* and if len isn't even, it's your own fault */
     return zodiac_spew(session, shortwords[0], shortwords + 1,
-		       (int)(len / 2 - 1));
+		       (int)(len / 2 - 1), write_command);
 }
 #endif /* CONTROLSEND_ENABLE */
 
@@ -466,7 +461,7 @@ static bool zodiac_speed_switch(struct gps_device_t *session,
     data[5] = (unsigned short)(round(log((double)speed / 300) / M_LN2) + 1);	/* port 1 speed */
     data[14] = zodiac_checksum(data, 14);
 
-    (void)zodiac_spew(session, 1330, data, 15);
+    (void)zodiac_spew(session, 1330, data, 15, write_command);
     return true;		/* it would be nice to error-check this */
 }
 #endif /* RECONFIGURE_ENABLE */
@@ -22,9 +22,90 @@ extern const struct gps_type_t sirf_binary;
 
 ssize_t generic_get(struct gps_device_t *session)
 {
+#ifdef NETFEED_ENABLE
+    /* datagrams come in batches and are lexed one at a time */
+    if (session->sourcetype == source_udp)
+	return udp_get(session);
+#endif /* NETFEED_ENABLE */
     return packet_get(session->gpsdata.gps_fd, &session->packet);
 }
 
+/*
+ * Driver trigger strings are matched against the start of every NMEA
+ * sentence from a device that hasn't been identified yet.  Rather than
+ * comparing against each trigger in turn, they're compiled into a trie
+ * the first time one is needed; a sentence is then matched in a single
+ * pass over its leading characters.  Because triggers are anchored at
+ * the start of the sentence, the trie needs no failure links.
+ */
+#define TRIGGER_NODES	256	/* plenty for all the triggers we know */
+
+static struct trigger_node_t
+{
+    char c;			/* character leading to this node */
+    unsigned char child;	/* first node one character deeper, or 0 */
+    unsigned char sibling;	/* next node at the same depth, or 0 */
+    /*@null@*/ const struct gps_type_t **driver;	/* trigger ends here */
+} trigger_trie[TRIGGER_NODES];
+static unsigned int trigger_nodes;	/* 0 until the trie is built */
+
+static void trigger_compile(void)
+{
+    const struct gps_type_t **dp;
+
+    trigger_nodes = 1;		/* node 0 is the root */
+    for (dp = gpsd_drivers; *dp; dp++) {
+	const char *cp;
+	unsigned int node = 0;
+
+	if ((*dp)->trigger == NULL || (*dp)->trigger[0] == '\0')
+	    continue;
+	for (cp = (*dp)->trigger; *cp != '\0'; cp++) {
+	    unsigned int next = trigger_trie[node].child;
+
+	    while (next != 0 && trigger_trie[next].c != *cp)
+		next = trigger_trie[next].sibling;
+	    if (next == 0) {
+		if (trigger_nodes >= TRIGGER_NODES) {
+		    gpsd_report(LOG_ERROR,
+				"trigger trie overflow at %s\n",
+				(*dp)->trigger);
+		    break;
+		}
+		next = trigger_nodes++;
+		trigger_trie[next].c = *cp;
+		trigger_trie[next].sibling = trigger_trie[node].child;
+		trigger_trie[node].child = (unsigned char)next;
+	    }
+	    node = next;
+	}
+	/* a trigger claimed twice belongs to the first driver listed */
+	if (*cp == '\0' && trigger_trie[node].driver == NULL)
+	    trigger_trie[node].driver = dp;
+    }
+}
+
+/*@null@*/ const struct gps_type_t **gpsd_trigger_match(const char *sentence)
+/* return the driver whose trigger the sentence starts with, if any */
+{
+    const struct gps_type_t **found = NULL;
+    unsigned int node = 0;
+
+    if (trigger_nodes == 0)
+	trigger_compile();
+    for (; *sentence != '\0'; sentence++) {
+	node = trigger_trie[node].child;
+	while (node != 0 && trigger_trie[node].c != *sentence)
+	    node = trigger_trie[node].sibling;
+	if (node == 0)
+	    break;
+	/* the longest trigger matched is the most specific */
+	if (trigger_trie[node].driver != NULL)
+	    found = trigger_trie[node].driver;
+    }
+    return found;
+}
+
 gps_mask_t generic_parse_input(struct gps_device_t *session)
 {
     const struct gps_type_t **dp;
@@ -45,19 +126,24 @@ gps_mask_t generic_parse_input(struct gps_device_t *session)
 	if ((st=nmea_parse(sentence, session)) == 0) {
 	    gpsd_report(LOG_WARN, "unknown sentence: \"%s\"\n",	sentence);
 	}
-	for (dp = gpsd_drivers; *dp; dp++) {
-	    char *trigger = (*dp)->trigger;
-
-	    if (trigger!=NULL && strncmp(sentence,trigger,strlen(trigger))==0) {
-		gpsd_report(LOG_PROG, "found trigger string %s.\n", trigger);
-		if (*dp != session->device_type) {
-		    (void)gpsd_switch_driver(session, (*dp)->type_name);
-		    if (session->device_type != NULL
-			&& session->device_type->event_hook != NULL)
-			session->device_type->event_hook(session,
-							 event_triggermatch);
-		    st |= DEVICEID_SET;
-		}
+	/*
+	 * Once a trigger has picked the driver there's no point in
+	 * looking for one again; devices still on a generic driver
+	 * pay for a walk down the trigger trie, which stops at the
+	 * first character that no trigger has in that position.
+	 */
+	if (session->device_type != NULL
+	    && session->device_type->trigger != NULL)
+	    return st;
+	if ((dp = gpsd_trigger_match(sentence)) != NULL) {
+	    gpsd_report(LOG_PROG, "found trigger string %s.\n", (*dp)->trigger);
+	    if (*dp != session->device_type) {
+		(void)gpsd_switch_driver(session, (*dp)->type_name);
+		if (session->device_type != NULL
+		    && session->device_type->event_hook != NULL)
+		    session->device_type->event_hook(session,
+						     event_triggermatch);
+		st |= DEVICEID_SET;
 	    }
 	}
 	return st;
@@ -119,117 +205,188 @@ const struct gps_type_t unknown = {
  *
  **************************************************************************/
 
-static void nmea_event_hook(struct gps_device_t *session, event_t event)
+/*
+ * Subtype probes for generic NMEA devices.  Queries only ask a device
+ * to identify itself, so a device that doesn't know them ignores them
+ * (or echoes them back) and they can all be sent together.  Disruptive
+ * probes change the device's state -- its protocol or its sentence
+ * mix -- so they go out one at a time, each after the previous one has
+ * had a reply window to itself, and only if nothing has answered yet.
+ *
+ * For best overall performance, order these to probe for the most
+ * popular types soonest.
+ *
+ * Note: don't make the trigger strings identical to the probe,
+ * because some NMEA devices (notably SiRFs) will just echo
+ * unknown strings right back at you. A useful dodge is to append
+ * a comma to the trigger, because that won't be in the response
+ * unless there is actual following data.
+ */
+#define PROBE_SPACING	0.1	/* seconds between queries sent together */
+#define PROBE_WINDOW	1.0	/* seconds to wait for an answer */
+
+struct nmea_probe_t
+{
+    const char *name;		/* device type, for logging */
+    /*@null@*/ const char *nmea;	/* probe sentence, if NMEA */
+    /*@null@*/ void (*send)(struct gps_device_t *);	/* otherwise */
+    bool disruptive;		/* changes device state */
+};
+
+#ifdef SIRF_ENABLE
+static void sirf_probe(struct gps_device_t *session)
 {
-    if (session->context->readonly)
-	return;
     /*
-     * This is where we try to tickle NMEA devices into revealing their
-     * inner natures.
+     * We used to try to probe for SiRF by issuing "$PSRF105,1"
+     * and expecting "$Ack Input105.".  But it turns out this
+     * only works for SiRF-IIs; SiRF-I and SiRF-III don't respond.
+     * Thus the only reliable probe is to try to flip the SiRF into
+     * binary mode, cluing in the library to revert it on close.
+     *
+     * Because it's disruptive this goes out only after the queries
+     * have had their chance.  That also matters to gpsctl, which
+     * can't select the NMEA driver without switching the device
+     * back to binary mode.  Fix this if we ever find a nondisruptive
+     * probe string.
      */
-    if (event == event_configure) {
-	/*
-	 * The reason for splitting these probes up by packet sequence
-	 * number, interleaving them with the first few packet receives,
-	 * is because many generic-NMEA devices get confused if you send
-	 * too much at them in one go.
-	 *
-	 * A fast response to an early probe will change drivers so the
-	 * later ones won't be sent at all.  Thus, for best overall
-	 * performance, order these to probe for the most popular types
-	 * soonest.
-	 *
-	 * Note: don't make the trigger strings identical to the probe,
-	 * because some NMEA devices (notably SiRFs) will just echo
-	 * unknown strings right back at you. A useful dodge is to append
-	 * a comma to the trigger, because that won't be in the response
-	 * unless there is actual following data.
-	 */
-	switch (session->packet.counter) {
-#ifdef NMEA_ENABLE
-	case 0:
-	    /* probe for Garmin serial GPS -- expect $PGRMC followed by data */
-	    gpsd_report(LOG_PROG, "=> Probing for Garmin NMEA\n");
-	    (void)nmea_send(session, "$PGRMCE");
-	    break;
-#endif /* NMEA_ENABLE */
-#ifdef SIRF_ENABLE
-	case 1:
-	    /*
-	     * We used to try to probe for SiRF by issuing "$PSRF105,1"
-	     * and expecting "$Ack Input105.".  But it turns out this
-	     * only works for SiRF-IIs; SiRF-I and SiRF-III don't respond.
-	     * Thus the only reliable probe is to try to flip the SiRF into
-	     * binary mode, cluing in the library to revert it on close.
-	     *
-	     * SiRFs dominate the GPS-mouse market, so we used to put this test
-	     * first. Unfortunately this causes problems for gpsctl, as it cannot
-	     * select the NMEA driver without switching the device back to
-	     * binary mode!  Fix this if we ever find a nondisruptive probe string.
-	     */
-	    gpsd_report(LOG_PROG, "=> Probing for SiRF\n");
-	    (void)nmea_send(session,
-			    "$PSRF100,0,%d,%d,%d,0",
-			    session->gpsdata.dev.baudrate,
-			    9 - session->gpsdata.dev.stopbits,
-			    session->gpsdata.dev.stopbits);
-	    session->back_to_nmea = true;
-	    break;
+    (void)nmea_send(session,
+		    "$PSRF100,0,%d,%d,%d,0",
+		    session->gpsdata.dev.baudrate,
+		    9 - session->gpsdata.dev.stopbits,
+		    session->gpsdata.dev.stopbits);
+    session->back_to_nmea = true;
+}
 #endif /* SIRF_ENABLE */
-#ifdef NMEA_ENABLE
-	case 2:
-	    /* probe for the FV-18 -- expect $PFEC,GPint followed by data */
-	    gpsd_report(LOG_PROG, "=> Probing for FV-18\n");
-	    (void)nmea_send(session, "$PFEC,GPint");
-	    break;
-	case 3:
-	    /* probe for the Trimble Copernicus */
-	    gpsd_report(LOG_PROG, "=> Probing for Trimble Copernicus\n");
-	    (void)nmea_send(session, "$PTNLSNM,0139,01");
-	    break;
-#endif /* NMEA_ENABLE */
+
 #ifdef EVERMORE_ENABLE
-	case 4:
-	    gpsd_report(LOG_PROG, "=> Probing for Evermore\n");
-	    /* Enable checksum and GGA(1s), GLL(0s), GSA(1s), GSV(1s), RMC(1s), VTG(0s), PEMT101(1s) */
-	    /* EverMore will reply with: \x10\x02\x04\x38\x8E\xC6\x10\x03 */
-	    (void)gpsd_write(session,
-			     "\x10\x02\x12\x8E\x7F\x01\x01\x00\x01\x01\x01\x00\x01\x00\x00\x00\x00\x00\x00\x13\x10\x03",
-			     22);
-	    break;
+static void evermore_probe(struct gps_device_t *session)
+{
+    /* Enable checksum and GGA(1s), GLL(0s), GSA(1s), GSV(1s), RMC(1s), VTG(0s), PEMT101(1s) */
+    /* EverMore will reply with: \x10\x02\x04\x38\x8E\xC6\x10\x03 */
+    (void)gpsd_write(session,
+		     "\x10\x02\x12\x8E\x7F\x01\x01\x00\x01\x01\x01\x00\x01\x00\x00\x00\x00\x00\x00\x13\x10\x03",
+		     22);
+}
 #endif /* EVERMORE_ENABLE */
+
+#ifdef TNT_ENABLE
+static bool tnt_send(struct gps_device_t *session, const char *fmt, ...);
+
+static void tnt_probe(struct gps_device_t *session)
+{
+    /*
+     * The same run-mode command the TNT driver sends on wakeup.  A
+     * compass that gets it streams $PTNTHTM, which matches the TNT
+     * trigger.  It isn't NMEA and it changes the compass's mode, so
+     * it waits for the queries.
+     */
+    (void)tnt_send(session, "@F0.3=1");
+}
+#endif /* TNT_ENABLE */
+
+#ifdef UBX_ENABLE
+static void ubx_probe(struct gps_device_t *session)
+{
+    /* query software version */
+    (void)ubx_write(session, 0x0au, 0x04, NULL, 0);
+}
+#endif /* UBX_ENABLE */
+
+static const struct nmea_probe_t nmea_probes[] = {
+#ifdef NMEA_ENABLE
+    /* Garmin serial GPS -- expect $PGRMC followed by data */
+    {"Garmin NMEA", "$PGRMCE", NULL, false},
+    /* FV-18 -- expect $PFEC,GPint followed by data */
+    {"FV-18", "$PFEC,GPint", NULL, false},
+#endif /* NMEA_ENABLE */
 #ifdef GPSCLOCK_ENABLE
-	case 5:
-	    /* probe for Furuno Electric GH-79L4-N (GPSClock); expect $PFEC,GPssd */
-	    gpsd_report(LOG_PROG, "=> Probing for GPSClock\n");
-	    (void)nmea_send(session, "$PFEC,GPsrq");
-	    break;
+    /* Furuno Electric GH-79L4-N (GPSClock) -- expect $PFEC,GPssd */
+    {"GPSClock", "$PFEC,GPsrq", NULL, false},
 #endif /* GPSCLOCK_ENABLE */
 #ifdef ASHTECH_ENABLE
-	case 6:
-	    /* probe for Ashtech -- expect $PASHR,RID */
-	    gpsd_report(LOG_PROG, "=> Probing for Ashtech\n");
-	    (void)nmea_send(session, "$PASHQ,RID");
-	    break;
+    /* Ashtech -- expect $PASHR,RID */
+    {"Ashtech", "$PASHQ,RID", NULL, false},
 #endif /* ASHTECH_ENABLE */
 #ifdef UBX_ENABLE
-	case 7:
-	    /* probe for UBX -- query software version */
-	    gpsd_report(LOG_PROG, "=> Probing for UBX\n");
-	    (void)ubx_write(session, 0x0au, 0x04, NULL, 0);
-	    break;
+    {"UBX", NULL, ubx_probe, false},
 #endif /* UBX_ENABLE */
 #ifdef MTK3301_ENABLE
-	case 8:
-	    /* probe for MTK-3301 -- expect $PMTK705 */
-	    gpsd_report(LOG_PROG, "=> Probing for MediaTek\n");
-	    (void)nmea_send(session, "$PMTK605");
-	    break;
+    /* MTK-3301 -- expect $PMTK705 */
+    {"MediaTek", "$PMTK605", NULL, false},
 #endif /* MTK3301_ENABLE */
-	default:
-	    break;
-	}
+#ifdef SIRF_ENABLE
+    {"SiRF", NULL, sirf_probe, true},
+#endif /* SIRF_ENABLE */
+#ifdef NMEA_ENABLE
+    /* Trimble Copernicus -- sets the sentence mix */
+    {"Trimble Copernicus", "$PTNLSNM,0139,01", NULL, true},
+#endif /* NMEA_ENABLE */
+#ifdef TNT_ENABLE
+    /* True North compass -- expect $PTNTHTM */
+    {"True North", NULL, tnt_probe, true},
+#endif /* TNT_ENABLE */
+#ifdef EVERMORE_ENABLE
+    {"Evermore", NULL, evermore_probe, true},
+#endif /* EVERMORE_ENABLE */
+    {NULL, NULL, NULL, false},
+};
+
+static void nmea_probe_send(struct gps_device_t *session,
+			    const struct nmea_probe_t *probe)
+{
+    gpsd_report(LOG_PROG, "=> Probing for %s\n", probe->name);
+    gpsd_probe_sent(session, probe->name);
+    session->outqueue.probing = true;
+    if (probe->nmea != NULL)
+	(void)nmea_send(session, "%s", probe->nmea);
+    else if (probe->send != NULL)
+	probe->send(session);
+    session->outqueue.probing = false;
+}
+
+static void nmea_event_hook(struct gps_device_t *session, event_t event)
+{
+    const struct nmea_probe_t *probe;
+    timestamp_t now;
+
+    if (session->context->readonly)
+	return;
+    /*
+     * This is where we try to tickle NMEA devices into revealing their
+     * inner natures.  The configure event comes with every packet, so
+     * this is also where the probe schedule gets advanced.  A trigger
+     * match on any answer switches drivers, which cancels the probes
+     * still waiting in the output queue and ends the schedule.
+     */
+    if (event != event_configure || session->probe.done)
+	return;
+    now = timestamp();
+    if (!session->probe.started) {
+	unsigned int queries = 0;
+
+	session->probe.started = true;
+	for (probe = nmea_probes; probe->name != NULL; probe++)
+	    if (!probe->disruptive) {
+		nmea_probe_send(session, probe);
+		/* many generic-NMEA devices choke on a burst of input */
+		gpsd_write_pause(session, PROBE_SPACING);
+		queries++;
+	    }
+	session->probe.next = 0;
+	session->probe.quiet = now + queries * PROBE_SPACING + PROBE_WINDOW;
+	return;
     }
+    if (now < session->probe.quiet)
+	return;
+    for (probe = nmea_probes + session->probe.next; probe->name != NULL;
+	 probe++, session->probe.next++)
+	if (probe->disruptive) {
+	    nmea_probe_send(session, probe);
+	    session->probe.next++;
+	    session->probe.quiet = now + PROBE_WINDOW;
+	    return;
+	}
+    gpsd_probe_done(session, "no subtype found");
 }
 
 #if defined(RECONFIGURE_ENABLE) && defined(BINARY_ENABLE)
@@ -266,7 +423,7 @@ const struct gps_type_t nmea = {
     .probe_detect   = NULL,		/* no probe */
     .get_packet     = generic_get,	/* use generic packet getter */
     .parse_packet   = generic_parse_input,	/* how to interpret a packet */
-    .rtcm_writer    = gpsd_write,	/* write RTCM data straight */
+    .rtcm_writer    = gpsd_write_correction,	/* write RTCM data straight */
     .event_hook     = nmea_event_hook,	/* lifetime event handler */
 #ifdef RECONFIGURE_ENABLE
     .speed_switcher = NULL,		/* no speed switcher */
@@ -301,7 +458,7 @@ static void garmin_mode_switch(struct gps_device_t *session, int mode)
     if (mode == MODE_BINARY) {
 	(void)nmea_send(session, "$PGRMC1,1,2,1,,,,2,W,N");
 	(void)nmea_send(session, "$PGRMI,,,,,,,R");
-	(void)usleep(333);	/* standard Garmin settling time */
+	gpsd_write_pause(session, 0.000333);	/* standard Garmin settling time */
 	session->gpsdata.dev.driver_mode = MODE_BINARY;
     }
 }
@@ -434,7 +591,7 @@ const struct gps_type_t ashtech = {
     .probe_detect   = NULL,		/* no probe */
     .get_packet     = generic_get,	/* how to get a packet */
     .parse_packet   = generic_parse_input,	/* how to interpret a packet */
-    .rtcm_writer    = gpsd_write,	/* write RTCM data straight */
+    .rtcm_writer    = gpsd_write_correction,	/* write RTCM data straight */
     .event_hook     = ashtech_event_hook, /* lifetime event handler */
 #ifdef RECONFIGURE_ENABLE
     .speed_switcher = NULL,		/* no speed switcher */
@@ -485,7 +642,7 @@ const struct gps_type_t fv18 = {
     .probe_detect   = NULL,		/* no probe */
     .get_packet     = generic_get,	/* how to get a packet */
     .parse_packet   = generic_parse_input,	/* how to interpret a packet */
-    .rtcm_writer    = gpsd_write,	/* write RTCM data straight */
+    .rtcm_writer    = gpsd_write_correction,	/* write RTCM data straight */
     .event_hook     = fv18_event_hook,	/* lifetime event handler */
 #ifdef RECONFIGURE_ENABLE
     .speed_switcher = NULL,		/* no speed switcher */
@@ -538,7 +695,7 @@ const struct gps_type_t gpsclock = {
     .probe_detect   = NULL,		/* no probe */
     .get_packet     = generic_get,	/* how to get a packet */
     .parse_packet   = generic_parse_input,	/* how to interpret a packet */
-    .rtcm_writer    = gpsd_write,	/* write RTCM data straight */
+    .rtcm_writer    = gpsd_write_correction,	/* write RTCM data straight */
     .event_hook     = gpsclock_event_hook,	/* lifetime event handler */
 #ifdef RECONFIGURE_ENABLE
     .speed_switcher = NULL,		/* no speed switcher */
@@ -593,7 +750,7 @@ static const struct gps_type_t tripmate = {
     .probe_detect  = NULL,			/* no probe */
     .get_packet    = generic_get,		/* how to get a packet */
     .parse_packet  = generic_parse_input,		/* how to interpret a packet */
-    .rtcm_writer   = gpsd_write,			/* send RTCM data straight */
+    .rtcm_writer   = gpsd_write_correction,			/* send RTCM data straight */
     .event_hook    = tripmate_event_hook,	/* lifetime event handler */
 #ifdef RECONFIGURE_ENABLE
     .speed_switcher= NULL,			/* no speed switcher */
@@ -628,7 +785,7 @@ static void earthmate_event_hook(struct gps_device_t *session, event_t event)
 	return;
     if (event == event_identified) {
 	(void)gpsd_write(session, "EARTHA\r\n", 8);
-	(void)usleep(10000);
+	gpsd_write_pause(session, 0.01);
 	(void)gpsd_switch_driver(session, "Zodiac Binary");
     }
 }
@@ -705,8 +862,7 @@ static ssize_t tnt_control_send(struct gps_device_t *session,
     ssize_t status;
 
     tnt_add_checksum(msg);
-    status = write(session->gpsdata.gps_fd, msg, strlen(msg));
-    (void)tcdrain(session->gpsdata.gps_fd);
+    status = gpsd_write(session, msg, strlen(msg));
     return status;
 }
 
@@ -803,7 +959,7 @@ const struct gps_type_t trueNorth = {
  *
  **************************************************************************/
 
-static int oceanserver_send(int fd, const char *fmt, ...)
+static int oceanserver_send(struct gps_device_t *session, const char *fmt, ...)
 {
     int status;
     char buf[BUFSIZ];
@@ -813,8 +969,7 @@ static int oceanserver_send(int fd, const char *fmt, ...)
     (void)vsnprintf(buf, sizeof(buf) - 5, fmt, ap);
     va_end(ap);
     (void)strlcat(buf, "", BUFSIZ);
-    status = (int)write(fd, buf, strlen(buf));
-    (void)tcdrain(fd);
+    status = (int)gpsd_write(session, buf, strlen(buf));
     if (status == (int)strlen(buf)) {
 	gpsd_report(LOG_IO, "=> GPS: %s\n", buf);
 	return status;
@@ -831,9 +986,9 @@ static void oceanserver_event_hook(struct gps_device_t *session,
 	return;
     if (event == event_configure && session->packet.counter == 0) {
 	/* report in NMEA format */
-	(void)oceanserver_send(session->gpsdata.gps_fd, "2\n");
+	(void)oceanserver_send(session, "2\n");
 	/* ship all fields */
-	(void)oceanserver_send(session->gpsdata.gps_fd, "X2047");
+	(void)oceanserver_send(session, "X2047");
     }
 }
 
@@ -1005,6 +1160,10 @@ static const struct gps_type_t garmintxt = {
  *
  **************************************************************************/
 
+#ifdef RECONFIGURE_ENABLE
+static bool mtk3301_rate_switcher(struct gps_device_t *session, double rate);
+#endif /* RECONFIGURE_ENABLE */
+
 static gps_mask_t processMTK3301(struct gps_device_t *session)
 {
     const char *mtk_reasons[4] =
@@ -1029,10 +1188,17 @@ static gps_mask_t processMTK3301(struct gps_device_t *session)
 	    reason = atoi(session->driver.nmea.field[2]);
 	    if (atoi(session->driver.nmea.field[1]) == -1)
 		gpsd_report(LOG_WARN, "MTK NACK: unknown sentence\n");
-	    else if (reason < 3)
+	    else if (reason < 3) {
 		gpsd_report(LOG_WARN, "MTK NACK: %s, reason: %s\n", session->driver.nmea.field[1],
 			    mtk_reasons[reason]);
-	    else
+#ifdef RECONFIGURE_ENABLE
+		/* the MTK-3301 proper tops out at 5Hz; later chips do 10 */
+		if (atoi(session->driver.nmea.field[1]) == 300
+		    && session->gpsdata.dev.cycle < 0.2
+		    && mtk3301_rate_switcher(session, 0.2))
+		    session->gpsdata.dev.cycle = 0.2;
+#endif /* RECONFIGURE_ENABLE */
+	    } else
 		gpsd_report(LOG_WARN, "MTK ACK: %s\n", session->driver.nmea.field[1]);
 	    break;
 	default:
@@ -1085,8 +1251,8 @@ static bool mtk3301_rate_switcher(struct gps_device_t *session, double rate)
     /*@i1@*/ unsigned int milliseconds = 1000 * rate;
     if (rate > 1)
 	milliseconds = 1000;
-    else if (rate < 0.2)
-	milliseconds = 200;
+    else if (rate < 0.1)
+	milliseconds = 100;
 
     (void)snprintf(buf, sizeof(buf), "$PMTK300,%u,0,0,0,0", milliseconds);
     (void)nmea_send(session, buf);	/* Fix interval */
@@ -1104,13 +1270,13 @@ const struct gps_type_t mtk3301 = {
     .probe_detect   = NULL,		/* no probe */
     .get_packet     = generic_get,	/* how to get a packet */
     .parse_packet   = processMTK3301,	/* how to interpret a packet */
-    .rtcm_writer    = gpsd_write,	/* write RTCM data straight */
+    .rtcm_writer    = gpsd_write_correction,	/* write RTCM data straight */
     .event_hook     = mtk3301_event_hook,	/* lifetime event handler */
 #ifdef RECONFIGURE_ENABLE
     .speed_switcher = NULL,		/* no speed switcher */
     .mode_switcher  = NULL,		/* no mode switcher */
     .rate_switcher  = mtk3301_rate_switcher,		/* sample rate switcher */
-    .min_cycle      = 0.2,		/* max 5Hz */
+    .min_cycle      = 0.1,		/* max 10Hz on MTK-3329 and later */
 #endif /* RECONFIGURE_ENABLE */
 #ifdef CONTROLSEND_ENABLE
     .control_send   = nmea_write,	/* how to send control strings */
@@ -1132,9 +1298,15 @@ const struct gps_type_t mtk3301 = {
 static gps_mask_t aivdm_analyze(struct gps_device_t *session)
 {
     if (session->packet.type == AIVDM_PACKET) {
+	/* a copy another receiver beat us to costs only a hash lookup */
+	if (aivdm_duplicate(session) && session->context->aivdm_dedup)
+	    return ONLINE_SET;
 	if (aivdm_decode
 	    ((char *)session->packet.outbuffer, session->packet.outbuflen,
 	     session->aivdm, &session->gpsdata.ais, session->context->debug)) {
+	    /* the daemon unpacks application payloads only on demand */
+	    if (!session->context->aivdm_lazy)
+		aivdm_decode_payload(&session->gpsdata.ais);
 	    return ONLINE_SET | AIS_SET;
 	} else
 	    return ONLINE_SET;
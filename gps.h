@@ -36,8 +36,13 @@ extern "C" {
  * 5.0 - MAXCHANNELS bumped from 20 to 32 for GLONASS (July 2010)
  *       gps_open() becomes reentrant, what gps_open_r() used to be. 
  *       gps_poll() removed in favor of gps_read().  The raw hook is gone.
+ * 5.1 - DEVICE reports serial link load and budget.
+ * 5.2 - RAW reports of raw measurements, WATCH_RAWDATA to ask for them.
+ * 5.3 - DEVICE reports time to first fix.
+ * 6.0 - struct policy_t grows the AIS watch options (filter, vessels,
+ *       dedup, aisbatch), moving every gps_data_t member after it.
  */
-#define GPSD_API_MAJOR_VERSION	5	/* bump on incompatible changes */
+#define GPSD_API_MAJOR_VERSION	6	/* bump on incompatible changes */
 #define GPSD_API_MINOR_VERSION	0	/* bump on compatible changes */
 
 #define MAXTAGLEN	8	/* maximum length of sentence tag name */
@@ -952,6 +957,7 @@ struct ais_t
 	    unsigned int fid;           /* Functional ID */
 #define AIS_TYPE6_BINARY_MAX	920	/* 920 bits */
 	    size_t bitcount;		/* bit count of the data */
+	    bool raw;			/* payload still undecoded in bitdata */
 	    union {
 		char bitdata[(AIS_TYPE6_BINARY_MAX + 7) / 8];
 		/* IMO236 - Dangerous Cargo Indication */
@@ -1094,6 +1100,7 @@ struct ais_t
 	    unsigned int fid;       	/* Functional ID */
 #define AIS_TYPE8_BINARY_MAX	952	/* 952 bits */
 	    size_t bitcount;		/* bit count of the data */
+	    bool raw;			/* payload still undecoded in bitdata */
 	    union {
 		char bitdata[(AIS_TYPE8_BINARY_MAX + 7) / 8];
 		/* IMO236 - Fairway Closed */
@@ -1519,6 +1526,8 @@ struct dop_t {
 
 struct rawdata_t {
     /* raw measurement data */
+    int PRN[MAXCHANNELS];		/* satellite measured, 0 if none */
+    double ss[MAXCHANNELS];		/* carrier-to-noise (dB-Hz) */
     double codephase[MAXCHANNELS];	/* meters */
     double carrierphase[MAXCHANNELS];	/* meters */
     double pseudorange[MAXCHANNELS];	/* meters */
@@ -1556,6 +1565,24 @@ struct devconfig_t {
     char parity;			/* 'N', 'O', or 'E' */
     double cycle, mincycle;     	/* refresh cycle time in seconds */
     int driver_mode;    		/* is driver in native mode or not? */
+    double load;			/* measured fraction of link used */
+    double budget;			/* fraction the message set needs */
+    double ttff;			/* seconds from activation to 3D fix */
+};
+
+/* AIS filters a watcher can set; an empty list means no filter */
+#define AIS_FILTER_MMSIS	16	/* longest MMSI allow or deny list */
+struct ais_filter_t {
+    double box[4];			/* south, west, north, east, degrees */
+    int nbox;
+    double radius[3];			/* lat, lon in degrees, radius in nm */
+    int nradius;
+    unsigned int mmsi[AIS_FILTER_MMSIS];	/* pass only these MMSIs */
+    int nmmsi;
+    unsigned int notmmsi[AIS_FILTER_MMSIS];	/* never pass these */
+    int nnotmmsi;
+    unsigned int types[32];		/* pass only these message types */
+    int ntypes;
 };
 
 struct policy_t {
@@ -1565,6 +1592,11 @@ struct policy_t {
     int raw;				/* requesting raw data? */
     bool scaled;			/* requesting report scaling? */ 
     bool timing;			/* requesting timing info */
+    bool rawdata;			/* requesting raw measurements? */
+    bool vessels;			/* AIS vessel changes, not reports */
+    bool dedup;				/* drop AIS heard on another device */
+    struct ais_filter_t aisfilter;	/* which AIS reports to pass */
+    int aisbatch;			/* ms AIS reports may wait, batched */
     int loglevel;			/* requested log level of messages */
     char devpath[GPS_PATH_MAX];		/* specific device to watch */
     char remote[GPS_PATH_MAX];		/* ...if this was passthrough */
@@ -1587,6 +1619,7 @@ typedef int socket_t;
 #define WATCH_RAW	0x000080u	/* output of raw packets */
 #define WATCH_SCALED	0x000100u	/* scale output to floats */ 
 #define WATCH_TIMING	0x000200u	/* timing information */
+#define WATCH_RAWDATA	0x000400u	/* raw measurements */
 #define WATCH_DEVICE	0x000800u	/* watch specific device */
 #define WATCH_NEWSTYLE	0x010000u	/* force JSON streaming */
 #define WATCH_OLDSTYLE	0x020000u	/* force old-style streaming */
@@ -1628,7 +1661,8 @@ struct gps_data_t {
 #define POLICY_SET	(1llu<<29)
 #define LOGMESSAGE_SET	(1llu<<30)
 #define ERROR_SET	(1llu<<31)
-#define SET_HIGH_BIT	31
+#define RAW_SET 	(1llu<<32)
+#define SET_HIGH_BIT	32
     timestamp_t online;		/* NZ if GPS is on line, 0 if not.
 				 *
 				 * Note: gpsd clears this time when sentences
@@ -1678,7 +1712,7 @@ struct gps_data_t {
     char tag[MAXTAGLEN+1];	/* tag of last sentence processed */
 
     /* pack things never reported together to reduce structure size */ 
-#define UNION_SET	(RTCM2_SET|RTCM3_SET|SUBFRAME_SET|AIS_SET|ATTITUDE_SET|VERSION_SET|DEVICELIST_SET|LOGMESSAGE_SET|ERROR_SET|GST_SET|VERSION_SET)
+#define UNION_SET	(RTCM2_SET|RTCM3_SET|SUBFRAME_SET|AIS_SET|ATTITUDE_SET|VERSION_SET|DEVICELIST_SET|LOGMESSAGE_SET|ERROR_SET|GST_SET|VERSION_SET|RAW_SET)
     union {
 	/* unusual forms of sensor data that might come up the pipe */ 
 	struct rtcm2_t	rtcm2;
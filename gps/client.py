@@ -127,6 +127,7 @@ WATCH_RARE	= 0x000040	# output of packets in hex
 WATCH_RAW	= 0x000080	# output of raw packets
 WATCH_SCALED	= 0x000100	# scale output to floats 
 WATCH_TIMING	= 0x000200	# timing information
+WATCH_RAWDATA	= 0x000400	# raw measurements
 WATCH_DEVICE	= 0x000800	# watch specific device
 
 class gpsjson(gpscommon):
@@ -143,6 +144,8 @@ class gpsjson(gpscommon):
         # This particular logic can fire on SKY or RTCM2 objects.
         if hasattr(self.data, "satellites"):
             self.data.satellites = map(lambda x: dictwrapper(x), self.data.satellites)
+        if hasattr(self.data, "meas"):
+            self.data.meas = map(lambda x: dictwrapper(x), self.data.meas)
 
     def stream(self, flags=0, outfile=None):
         "Control streaming reports from the daemon,"
@@ -160,6 +163,8 @@ class gpsjson(gpscommon):
                 arg += ',"scaled":false'
             if flags & WATCH_TIMING:
                 arg += ',"scaled":false'
+            if flags & WATCH_RAWDATA:
+                arg += ',"rawdata":false'
         else: # flags & WATCH_ENABLE:
             arg = '?WATCH={"enable":true'
             if flags & WATCH_JSON:
@@ -174,6 +179,8 @@ class gpsjson(gpscommon):
                 arg += ',"scaled":true'
             if flags & WATCH_TIMING:
                 arg += ',"scaled":true'
+            if flags & WATCH_RAWDATA:
+                arg += ',"rawdata":true'
             if flags & WATCH_DEVICE:
                 arg += ',"device":"%s"' % outfile
         return self.send(arg + "}")
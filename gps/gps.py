@@ -52,7 +52,8 @@ GST_SET        	= (1<<27)
 VERSION_SET    	= (1<<28)
 POLICY_SET     	= (1<<29)
 ERROR_SET      	= (1<<30)
-UNION_SET      	= (RTCM2_SET|RTCM3_SET|SUBFRAME_SET|AIS_SET|VERSION_SET|DEVICELIST_SET|ERROR_SET|GST_SET)
+RAW_SET        	= (1<<31)
+UNION_SET      	= (RTCM2_SET|RTCM3_SET|SUBFRAME_SET|AIS_SET|VERSION_SET|DEVICELIST_SET|ERROR_SET|GST_SET|RAW_SET)
 STATUS_NO_FIX = 0
 STATUS_FIX = 1
 STATUS_DGPS_FIX = 2
@@ -9,6 +9,7 @@
 
 #define GPS_JSON_COMMAND_MAX	80
 #define GPS_JSON_RESPONSE_MAX	4096
+#define GPS_JSON_BATCH_MAX	(GPS_JSON_RESPONSE_MAX * 2)	/* AIS batches */
 
 #ifdef __cplusplus
 extern "C" {
@@ -19,6 +20,7 @@ char *json_stringify(/*@out@*/char *, size_t, /*@in@*/const char *);
 void json_tpv_dump(const struct gps_data_t *, /*@out@*/char *, size_t);
 void json_noise_dump(const struct gps_data_t *, /*@out@*/char *, size_t);
 void json_sky_dump(const struct gps_data_t *, /*@out@*/char *, size_t);
+void json_raw_dump(const struct gps_data_t *, /*@out@*/char *, size_t);
 void json_att_dump(const struct gps_data_t *, /*@out@*/char *, size_t);
 void json_subframe_dump(const struct gps_data_t *, /*@out@*/ char buf[], size_t);
 void json_device_dump(const struct gps_device_t *, /*@out@*/char *, size_t);
@@ -107,6 +107,9 @@ static gps_mask_t get_packet(struct gps_device_t *session)
 	/*@ +usedef @*/
 
 	fieldmask = gpsd_poll(session);
+	/* a packet handed back to the driver needs no more input */
+	while (session->reparse)
+	    fieldmask |= gpsd_poll(session);
 
 	/* conditional prevents mask dumper from eating CPU */
 	if (debuglevel >= LOG_DATA)
@@ -123,6 +126,8 @@ static gps_mask_t get_packet(struct gps_device_t *session)
 static void settle(struct gps_device_t *session)
 /* allow the device to settle after a control operation */
 {
+    /* output is queued, some of it maybe behind a pause; ship it all */
+    gpsd_write_drain(session);
     /*
      * See the 'deep black magic' comment in serial.c:set_serial().
      */
@@ -661,8 +666,11 @@ int main(int argc, char **argv)
 	}
 
 	/* if no control operation was specified, we're done */
-	if (speed==NULL && !to_nmea && !to_binary && control==NULL)
+	if (speed==NULL && !to_nmea && !to_binary && control==NULL) {
+	    /* don't leave probes from the hunt half-sent */
+	    gpsd_write_drain(&session);
 	    exit(0);
+	}
 
 	/* maybe user wants to see the packet rather than send it */
 	if (echo)
@@ -788,6 +796,8 @@ int main(int argc, char **argv)
 	/*@ +compdef @*/
 #endif /* CONTROLSEND_ENABLE */
 
+	/* anything still queued would be lost on exit */
+	gpsd_write_drain(&session);
 	exit(status);
 	/*@ +nullderef @*/
 	/*@ +mustfreeonly +immediatetrans @*/
@@ -251,16 +251,18 @@ static void usage(void)
 {
     const struct gps_type_t **dp;
 
-    (void)printf("usage: gpsd [-b] [-n] [-N] [-D n] [-F sockfile] [-G] [-P pidfile] [-S port] [-h] device...\n\
+    (void)printf("usage: gpsd [-b] [-n] [-N] [-D n] [-F sockfile] [-A storefile] [-G] [-P pidfile] [-S port] [-h] device...\n\
   Options include: \n\
   -b		     	    = bluetooth-safe: open data sources read-only\n\
   -n			    = don't wait for client connects to poll GPS\n\
   -N			    = don't go into background\n\
   -F sockfile		    = specify control socket location\n\
+  -A storefile		    = keep warm-start aiding data in this file\n\
   -G         		    = make gpsd listen on INADDR_ANY\n\
   -P pidfile	      	    = set file to record process ID \n\
   -D integer (default 0)    = set debug level \n\
   -S integer (default %s) = set port for daemon \n\
+  -U bytes		    = set socket receive buffer for UDP feeds \n\
   -h		     	    = help message \n\
   -V			    = emit version and exit.\n\
 A device may be a local serial device for GPS input, or a URL of the form:\n\
@@ -503,8 +505,37 @@ struct subscriber_t
     int fd;			/* client file descriptor. -1 if unused */
     timestamp_t active;		/* when subscriber last polled for data */
     struct policy_t policy;	/* configurable bits */
+#ifdef AIVDM_ENABLE
+    struct ais_predicate_t aispred;	/* policy AIS filters, compiled */
+    /*@null@*/struct aisbatch_t *aisbatch;	/* AIS reports held back */
+#endif /* AIVDM_ENABLE */
 };
 
+#ifdef AIVDM_ENABLE
+/*
+ * Watchers that set "aisbatch" get their AIS reports coalesced, so a
+ * busy feed costs one send() per batch rather than per message.  A
+ * batch is just a run of ordinary report lines; it goes out when the
+ * next report won't fit, when its oldest report has waited the
+ * watcher's "aisbatch" milliseconds, or ahead of any other output to
+ * that watcher.  Buffers come from a small pool rather than living in
+ * every subscriber slot.
+ */
+#define AIS_BATCHERS	16	/* watchers that can batch at once */
+#define AIS_BATCH_WAIT	1000	/* longest wait allowed, milliseconds */
+
+struct aisbatch_t {
+    /*@null@*/struct subscriber_t *owner;	/* NULL if slot is free */
+    timestamp_t first;		/* when the oldest report went in */
+    size_t len;
+    char buf[GPS_JSON_BATCH_MAX];
+};
+
+static struct aisbatch_t aisbatches[AIS_BATCHERS];
+
+static void aisbatch_flush(struct aisbatch_t *);
+#endif /* AIVDM_ENABLE */
+
 #ifdef LIMITED_MAX_CLIENTS
 #define MAXSUBSCRIBERS LIMITED_MAX_CLIENTS
 #else
@@ -535,6 +566,20 @@ static /*@null@*//*@observer@ */ struct subscriber_t *allocate_client(void)
     return NULL;
 }
 
+#ifdef AIVDM_ENABLE
+static void aivdm_dedup_policy(void)
+/* duplicate AIS sentences need decoding only while someone wants them */
+{
+    struct subscriber_t *sub;
+
+    context.aivdm_dedup = true;
+    for (sub = subscribers; sub < subscribers + MAXSUBSCRIBERS; sub++)
+	if (sub->active != 0 && sub->policy.watcher && sub->policy.json
+	    && !sub->policy.dedup && !sub->policy.vessels)
+	    context.aivdm_dedup = false;
+}
+#endif /* AIVDM_ENABLE */
+
 static void detach_client(struct subscriber_t *sub)
 /* detach a client and terminate the session */
 {
@@ -556,8 +601,23 @@ static void detach_client(struct subscriber_t *sub)
     sub->policy.raw = 0;
     sub->policy.scaled = false;
     sub->policy.timing = false;
+    sub->policy.rawdata = false;
+    sub->policy.vessels = false;
+    sub->policy.dedup = false;
+    memset(&sub->policy.aisfilter, 0, sizeof(sub->policy.aisfilter));
     sub->policy.devpath[0] = '\0';
     sub->fd = UNALLOCATED_FD;
+#ifdef AIVDM_ENABLE
+    memset(&sub->aispred, 0, sizeof(sub->aispred));
+    sub->policy.aisbatch = 0;
+    if (sub->aisbatch != NULL) {
+	/* nobody left to ship it to */
+	sub->aisbatch->owner = NULL;
+	sub->aisbatch->len = 0;
+	sub->aisbatch = NULL;
+    }
+    aivdm_dedup_policy();
+#endif /* AIVDM_ENABLE */
     /*@+mustfreeonly@*/
 }
 
@@ -567,6 +627,16 @@ static ssize_t throttled_write(struct subscriber_t *sub, char *buf,
 {
     ssize_t status;
 
+#ifdef AIVDM_ENABLE
+    /* held-back AIS reports go out ahead of anything newer */
+    if (sub->aisbatch != NULL && sub->aisbatch->len > 0
+	&& buf != sub->aisbatch->buf) {
+	aisbatch_flush(sub->aisbatch);
+	if (sub->fd == UNALLOCATED_FD)
+	    return 0;
+    }
+#endif /* AIVDM_ENABLE */
+
     if (context.debug >= 3) {
 	if (isprint(buf[0]))
 	    gpsd_report(LOG_IO, "=> client(%d): %s\n", sub_index(sub), buf);
@@ -619,6 +689,69 @@ static void notify_watchers(struct gps_device_t *device, const char *sentence, .
 	if (sub->active != 0 && subscribed(sub, device))
 	    (void)throttled_write(sub, buf, strlen(buf));
 }
+
+#ifdef AIVDM_ENABLE
+static void aisbatch_flush(struct aisbatch_t *batch)
+/* ship a watcher's held-back AIS reports in one write */
+{
+    size_t len = batch->len;
+
+    if (batch->owner == NULL || len == 0)
+	return;
+    /* clear first; the write may detach the client and free the slot */
+    batch->len = 0;
+    (void)throttled_write(batch->owner, batch->buf, len);
+}
+
+static void aisbatch_add(struct subscriber_t *sub, const char *report)
+/* hold back an AIS report for a batching watcher */
+{
+    struct aisbatch_t *batch = sub->aisbatch;
+    size_t len = strlen(report);
+
+    assert(batch != NULL);
+    if (batch->len + len > sizeof(batch->buf))
+	aisbatch_flush(batch);
+    if (sub->aisbatch == NULL || len > sizeof(batch->buf)) {
+	(void)throttled_write(sub, (char *)report, len);
+	return;
+    }
+    if (batch->len == 0)
+	batch->first = timestamp();
+    (void)memcpy(batch->buf + batch->len, report, len);
+    batch->len += len;
+}
+
+static void aisbatch_policy(struct subscriber_t *sub)
+/* give a watcher a batch buffer if it wants one, take it back if not */
+{
+    struct aisbatch_t *batch;
+
+    if (sub->policy.aisbatch > AIS_BATCH_WAIT)
+	sub->policy.aisbatch = AIS_BATCH_WAIT;
+    if (sub->policy.aisbatch <= 0) {
+	sub->policy.aisbatch = 0;
+	if (sub->aisbatch != NULL) {
+	    aisbatch_flush(sub->aisbatch);
+	    if (sub->aisbatch != NULL) {
+		sub->aisbatch->owner = NULL;
+		sub->aisbatch = NULL;
+	    }
+	}
+    } else if (sub->aisbatch == NULL) {
+	for (batch = aisbatches; batch < aisbatches + AIS_BATCHERS; batch++)
+	    if (batch->owner == NULL) {
+		batch->owner = sub;
+		batch->len = 0;
+		sub->aisbatch = batch;
+		return;
+	    }
+	gpsd_report(LOG_WARN, "client(%d): no AIS batch buffer free\n",
+		    sub_index(sub));
+	sub->policy.aisbatch = 0;
+    }
+}
+#endif /* AIVDM_ENABLE */
 #endif /* SOCKET_EXPORT_ENABLE */
 
 static void deactivate_device(struct gps_device_t *device)
@@ -788,7 +921,7 @@ static void handle_control(int sfd, char *buf)
 		} else {
 		    gpsd_report(LOG_INF, "<= control(%d): writing to %s \n", sfd,
 				stash);
-		    if (write(devp->gpsdata.gps_fd, eq, strlen(eq)) <= 0) {
+		    if (gpsd_write(devp, eq, strlen(eq)) <= 0) {
 			gpsd_report(LOG_WARN, "<= control(%d): write to device failed\n",
 				    sfd);
 			ignore_return(write(sfd, "ERROR\n", 6));
@@ -833,7 +966,7 @@ static void handle_control(int sfd, char *buf)
                         gpsd_report(LOG_INF,
                                     "<= control(%d): writing %d bytes fromhex(%s) to %s\n",
                                     sfd, st, eq, stash);
-                        if (write(devp->gpsdata.gps_fd, eq, (size_t) st) <= 0) {
+                        if (gpsd_write(devp, eq, (size_t) st) <= 0) {
                             gpsd_report(LOG_WARN, "<= control(%d): write to device failed\n",
                                         sfd);
                             ignore_return(write(sfd, "ERROR\n", 6));
@@ -961,13 +1094,113 @@ static void set_serial(struct gps_device_t *device,
 	     * The minimum delay time is probably constant
 	     * across any given type of UART.
 	     */
-	    (void)tcdrain(device->gpsdata.gps_fd);
+	    gpsd_write_drain(device);
 	    (void)usleep(50000);
 	    gpsd_set_speed(device, speed, parity, stopbits);
 	}
     }
     /* *INDENT-ON* */
 }
+
+/* how much of a serial link's capacity we are willing to fill */
+#define LINK_TARGET	0.75
+
+static void link_budget(struct gps_device_t *device)
+/* fit a device's output into its serial link, trimming or speeding up */
+{
+    const struct gps_type_t *dt = device->device_type;
+    double demand, budget, need, cycle = device->gpsdata.dev.cycle;
+    unsigned int framing;
+    speed_t speed;
+    bool changed = false;
+
+    /* look once per completed load measurement */
+    if (device->link.windows == device->link.budgeted)
+	return;
+    device->link.budgeted = device->link.windows;
+    if (dt == NULL || dt->link_demand == NULL || context.readonly
+	|| device->servicetype != service_sensor)
+	return;
+
+    speed = gpsd_get_speed(&device->ttyset);
+    if (speed == 0 || cycle <= 0)
+	return;
+    framing = 9 + device->gpsdata.dev.stopbits
+	+ (device->gpsdata.dev.parity != 'N' ? 1 : 0);
+
+    /*
+     * A link loaded past the target when the configured messages
+     * would not fill it is carrying output we have no use for.
+     * If it is still overloaded a window after that, or the messages
+     * we do use won't fit, the only thing left is a faster link.
+     */
+    need = device->gpsdata.dev.load;
+    if (!device->link.trimmed && need > LINK_TARGET) {
+	gpsd_report(LOG_INF,
+		    "%s link %.0f%% loaded, switching off unused output\n",
+		    device->gpsdata.dev.path, need * 100);
+	device->link.trimmed = true;
+	demand = dt->link_demand(device, true);
+	need = 0;
+	changed = true;
+    } else
+	demand = dt->link_demand(device, false);
+    budget = demand * framing / (speed * cycle);
+    if (isnan(need) != 0 || need < budget)
+	need = budget;
+
+#ifndef FIXED_PORT_SPEED
+    if (need > LINK_TARGET && dt->speed_switcher != NULL) {
+	static const speed_t rates[] = {9600, 19200, 38400, 57600, 115200};
+	char serialmode[4];
+	int i;
+
+	/* the slowest standard rate that fits, else the fastest */
+	for (i = 0; i < NITEMS(rates) - 1; i++)
+	    if (rates[i] > speed && need * speed / rates[i] <= LINK_TARGET)
+		break;
+	/* don't keep asking for a speed the device has already refused */
+	if (rates[i] > speed
+	    && (device->link.refused == 0 || rates[i] < device->link.refused)) {
+	    gpsd_report(LOG_INF,
+			"%s needs %.0f%% of %dbps, switching to %dbps\n",
+			device->gpsdata.dev.path, need * 100,
+			(int)speed, (int)rates[i]);
+	    serialmode[0] = '8';
+	    serialmode[1] = device->gpsdata.dev.parity;
+	    serialmode[2] = '0' + (char)device->gpsdata.dev.stopbits;
+	    serialmode[3] = '\0';
+	    set_serial(device, rates[i], serialmode);
+	    if (gpsd_get_speed(&device->ttyset) == speed) {
+		gpsd_report(LOG_WARN,
+			    "%s did not accept a switch to %dbps\n",
+			    device->gpsdata.dev.path, (int)rates[i]);
+		device->link.refused = rates[i];
+	    } else {
+		speed = gpsd_get_speed(&device->ttyset);
+		budget = demand * framing / (speed * cycle);
+		/* what was measured at the old speed no longer applies */
+		device->link.start = 0;
+		device->gpsdata.dev.load = NAN;
+		changed = true;
+	    }
+	}
+    }
+#endif /* FIXED_PORT_SPEED */
+
+    if (isnan(device->gpsdata.dev.budget) != 0)
+	changed = true;
+    device->gpsdata.dev.budget = budget;
+    if (changed && budget > LINK_TARGET)
+	gpsd_report(LOG_WARN,
+		    "%s output needs %.0f%% of its %dbps link\n",
+		    device->gpsdata.dev.path, budget * 100, (int)speed);
+    if (changed) {
+	char buf[GPS_JSON_RESPONSE_MAX];
+	json_device_dump(device, buf, sizeof(buf));
+	notify_watchers(device, buf);
+    }
+}
 #endif /* RECONFIGURE_ENABLE */
 
 #ifdef SOCKET_EXPORT_ENABLE
@@ -1042,6 +1275,18 @@ static void handle_request(struct subscriber_t *sub,
 		    ++end;
 		buf = end;
 	    }
+#ifdef AIVDM_ENABLE
+	    aisbatch_policy(sub);
+	    if (status == 0
+		&& !aistable_compile(&sub->policy.aisfilter, &sub->aispred)) {
+		memset(&sub->policy.aisfilter, 0,
+		       sizeof(sub->policy.aisfilter));
+		(void)aistable_compile(&sub->policy.aisfilter, &sub->aispred);
+		(void)snprintf(reply, replylen,
+			       "{\"class\":\"ERROR\",\"message\":\"Invalid WATCH: bad AIS filter\"}\r\n");
+		gpsd_report(LOG_ERROR, "response: %s\n", reply);
+	    } else
+#endif /* AIVDM_ENABLE */
 	    if (status != 0) {
 		(void)snprintf(reply, replylen,
 			       "{\"class\":\"ERROR\",\"message\":\"Invalid WATCH: %s\"}\r\n",
@@ -1186,9 +1431,11 @@ static void handle_request(struct subscriber_t *sub,
 		    serialmode[2] = '\0';
 		    set_serial(device,
 			       (speed_t) devconf.baudrate, serialmode);
+		    /* asking for more than the device can do gets its best */
+		    if (devconf.cycle < dt->min_cycle)
+			devconf.cycle = dt->min_cycle;
 		    if (dt->rate_switcher != NULL
-			&& isnan(devconf.cycle) == 0
-			&& devconf.cycle >= dt->min_cycle)
+			&& isnan(devconf.cycle) == 0)
 			if (dt->rate_switcher(device, devconf.cycle))
 			    device->gpsdata.dev.cycle = devconf.cycle;
 		}
@@ -1267,6 +1514,53 @@ static void handle_request(struct subscriber_t *sub,
     } else if (strncmp(buf, "VERSION;", 8) == 0) {
 	buf += 8;
 	json_version_dump(reply, replylen);
+#ifdef AIVDM_ENABLE
+    } else if (strncmp(buf, "AIS", 3) == 0
+	       && (buf[3] == ';' || buf[3] == '=')) {
+	struct vessel_filter_t filter;
+	const struct vessel_t *vp;
+	char tbuf[JSON_DATE_MAX+1];
+	int count = 0;
+	buf += 3;
+	memset(&filter, 0, sizeof(filter));
+	if (*buf == ';') {
+	    ++buf;
+	} else {
+	    int status = json_vessel_filter_read(buf + 1, &filter, &end);
+	    if (end == NULL)
+		buf += strlen(buf);
+	    else {
+		if (*end == ';')
+		    ++end;
+		buf = end;
+	    }
+	    if (status != 0) {
+		(void)snprintf(reply, replylen,
+			       "{\"class\":\"ERROR\",\"message\":\"Invalid AIS: %s\"}\r\n",
+			       json_error_string(status));
+		gpsd_report(LOG_ERROR, "response: %s\n", reply);
+		goto bailout;
+	    }
+	}
+	/*
+	 * A busy receiver can hear more vessels than fit in a reply,
+	 * so the snapshot goes straight out one VESSEL at a time,
+	 * after a header saying how many to expect.  The last one
+	 * is left in the reply buffer to go out the usual way.
+	 */
+	for (vp = aistable_next(&filter, NULL); vp != NULL;
+	     vp = aistable_next(&filter, vp))
+	    count++;
+	(void)snprintf(reply, replylen,
+		       "{\"class\":\"VESSELS\",\"time\":\"%s\",\"count\":%d}\r\n",
+		       unix_to_iso8601(timestamp(), tbuf, sizeof(tbuf)), count);
+	for (vp = aistable_next(&filter, NULL);
+	     vp != NULL && sub->fd != UNALLOCATED_FD;
+	     vp = aistable_next(&filter, vp)) {
+	    (void)throttled_write(sub, reply, strlen(reply));
+	    json_vessel_dump(vp, sub->policy.scaled, reply, replylen);
+	}
+#endif /* AIVDM_ENABLE */
     } else {
 	const char *errend;
 	errend = buf + strlen(buf) - 1;
@@ -1287,6 +1581,10 @@ static void handle_request(struct subscriber_t *sub,
 static void raw_report(struct subscriber_t *sub, struct gps_device_t *device)
 /* report a raw packet to a subscriber */
 {
+    /* it goes out when the driver has had it back */
+    if (device->reparse)
+	return;
+
     /* *INDENT-OFF* */
     /*
      * NMEA and other textual sentences are simply
@@ -1371,6 +1669,9 @@ static void consume_packets(struct gps_device_t *device)
     int fragments;
 #ifdef SOCKET_EXPORT_ENABLE
     struct subscriber_t *sub;
+#ifdef AIVDM_ENABLE
+    const struct vessel_t *vessel;
+#endif /* AIVDM_ENABLE */
 #endif /* SOCKET_EXPORT_ENABLE */
 
     gpsd_report(LOG_RAW + 1, "polling %d\n",
@@ -1462,6 +1763,11 @@ static void consume_packets(struct gps_device_t *device)
 	if ((changed & PACKET_SET) == 0)
 	    break;
 
+#if defined(SOCKET_EXPORT_ENABLE) && defined(RECONFIGURE_ENABLE)
+	/* keep the device's output within what its link can carry */
+	link_budget(device);
+#endif /* defined(SOCKET_EXPORT_ENABLE) && defined(RECONFIGURE_ENABLE) */
+
 	/* conditional prevents mask dumper from eating CPU */
 	if (context.debug >= LOG_DATA)
 	    gpsd_report(LOG_DATA,
@@ -1580,11 +1886,24 @@ static void consume_packets(struct gps_device_t *device)
 
 #ifdef SHM_EXPORT_ENABLE
 	if ((changed & (REPORT_IS|GST_SET|SATELLITE_SET|SUBFRAME_SET|
-			ATTITUDE_SET|RTCM2_SET|RTCM3_SET|AIS_SET)) != 0)
+			ATTITUDE_SET|RTCM2_SET|RTCM3_SET|AIS_SET|RAW_SET)) != 0) {
+#ifdef AIVDM_ENABLE
+	    /* shared-memory clients get the report fully decoded */
+	    if ((changed & AIS_SET) != 0 && context.shmexport != NULL)
+		aivdm_decode_payload(&device->gpsdata.ais);
+#endif /* AIVDM_ENABLE */
 	    shm_update(&context, &device->gpsdata);
+	}
 #endif /* SHM_EXPORT_ENABLE */
 
 #ifdef SOCKET_EXPORT_ENABLE
+#ifdef AIVDM_ENABLE
+	/* keep the vessel table current; non-NULL if this changed it */
+	vessel = NULL;
+	if ((changed & AIS_SET) != 0)
+	    vessel = aistable_update(device);
+#endif /* AIVDM_ENABLE */
+
 	/* update all subscribers associated with this device */
 	for (sub = subscribers; sub < subscribers + MAXSUBSCRIBERS; sub++) {
 	    /*@-nullderef@*/
@@ -1626,12 +1945,53 @@ static void consume_packets(struct gps_device_t *device)
 		    {
 			char buf[GPS_JSON_RESPONSE_MAX * 4];
 
-			json_data_report(changed,
+			gps_mask_t report = changed;
+
+#ifdef AIVDM_ENABLE
+			bool aispass = true;
+
+			/* dedup watchers have had this message already */
+			if (sub->policy.dedup && device->aivdm_dedup.last)
+			    report &= ~AIS_SET;
+			/* nor is it rendered for watchers filtering it out */
+			if ((report & AIS_SET) != 0
+			    && !aistable_match(&sub->aispred,
+					       &device->gpsdata.ais)) {
+			    report &= ~AIS_SET;
+			    aispass = false;
+			}
+			/* first watcher to see a binary message pays for it */
+			if ((report & AIS_SET) != 0)
+			    aivdm_decode_payload(&device->gpsdata.ais);
+			/* batching watchers get AIS held back, the rest now */
+			if (sub->aisbatch != NULL && (report & AIS_SET) != 0) {
+			    json_data_report(AIS_SET,
+					     &device->gpsdata, &sub->policy,
+					     buf, sizeof(buf));
+			    if (buf[0] != '\0')
+				aisbatch_add(sub, buf);
+			    report &= ~AIS_SET;
+			}
+#endif /* AIVDM_ENABLE */
+			json_data_report(report,
 					 &device->gpsdata, &sub->policy,
 					 buf, sizeof(buf));
 			if (buf[0] != '\0')
 			    (void)throttled_write(sub, buf, strlen(buf));
 
+#ifdef AIVDM_ENABLE
+			if (vessel != NULL && sub->policy.vessels && aispass) {
+			    char vbuf[GPS_JSON_RESPONSE_MAX];
+
+			    json_vessel_dump(vessel, sub->policy.scaled,
+					     vbuf, sizeof(vbuf));
+			    if (sub->aisbatch != NULL)
+				aisbatch_add(sub, vbuf);
+			    else
+				(void)throttled_write(sub, vbuf, strlen(vbuf));
+			}
+#endif /* AIVDM_ENABLE */
+
 #ifdef TIMING_ENABLE
 			if (buf[0] != '\0' && sub->policy.timing) {
 			    (void)snprintf(buf, sizeof(buf),
@@ -1663,19 +2023,27 @@ static int handle_gpsd_request(struct subscriber_t *sub, const char *buf)
 /* execute GPSD requests from a buffer */
 {
     char reply[GPS_JSON_RESPONSE_MAX + 1];
+    ssize_t status = 0;
 
-    reply[0] = '\0';
     if (buf[0] == '?') {
 	const char *end;
-	for (end = ++buf; *buf != '\0'; buf = end)
+	for (end = ++buf; *buf != '\0' && status >= 0; buf = end)
 	    if (isspace(*buf))
 		end = buf + 1;
-	    else
-		handle_request(sub, buf, &end,
-			       reply + strlen(reply),
-			       sizeof(reply) - strlen(reply));
+	    else {
+		/*
+		 * Ship each reply before handling the next request;
+		 * some requests write to the client themselves.
+		 */
+		reply[0] = '\0';
+		handle_request(sub, buf, &end, reply, sizeof(reply));
+		if (sub->fd == UNALLOCATED_FD)
+		    status = -1;
+		else if (reply[0] != '\0')
+		    status = throttled_write(sub, reply, strlen(reply));
+	    }
     }
-    return (int)throttled_write(sub, reply, strlen(reply));
+    return (int)status;
 }
 #endif /* SOCKET_EXPORT_ENABLE */
 
@@ -1764,6 +2132,9 @@ int main(int argc, char *argv[])
 #ifdef SOCKET_EXPORT_ENABLE
     static char *gpsd_service = NULL;	/* this static pacifies splint */
     struct subscriber_t *sub;
+#ifdef AIVDM_ENABLE
+    struct aisbatch_t *batch;
+#endif /* AIVDM_ENABLE */
 #endif /* SOCKET_EXPORT_ENABLE */
 #ifdef CONTROL_SOCKET_ENABLE
     static int csock = -1;
@@ -1775,6 +2146,9 @@ int main(int argc, char *argv[])
     sockaddr_t fsin;
 #endif /* defined(SOCKET_EXPORT_ENABLE) || defined(CONTROL_SOCKET_ENABLE) */
     static char *pid_file = NULL;
+#ifdef AIDING_ENABLE
+    static char *aiding_file = NULL;
+#endif /* AIDING_ENABLE */
     struct gps_device_t *device;
     fd_set rfds;
     int i, option, msocks[2], dfd;
@@ -1791,8 +2165,17 @@ int main(int argc, char *argv[])
     (void)setlocale(LC_NUMERIC, "C");
     context.debug = 0;
     gps_context_init(&context);
-    while ((option = getopt(argc, argv, "F:D:S:bGhlNnP:V")) != -1) {
+#if defined(SOCKET_EXPORT_ENABLE) && defined(AIVDM_ENABLE)
+    context.aivdm_lazy = true;
+    aivdm_dedup_policy();
+#endif /* defined(SOCKET_EXPORT_ENABLE) && defined(AIVDM_ENABLE) */
+    while ((option = getopt(argc, argv, "A:F:D:S:U:bGhlNnP:V")) != -1) {
 	switch (option) {
+#ifdef AIDING_ENABLE
+	case 'A':
+	    aiding_file = optarg;
+	    break;
+#endif /* AIDING_ENABLE */
 	case 'D':
 	    context.debug = (int)strtol(optarg, 0, 0);
 #ifdef CLIENTDEBUG_ENABLE
@@ -1807,6 +2190,11 @@ int main(int argc, char *argv[])
 	case 'N':
 	    go_background = false;
 	    break;
+#ifdef NETFEED_ENABLE
+	case 'U':
+	    context.udp_rcvbuf = (int)strtol(optarg, 0, 0);
+	    break;
+#endif /* NETFEED_ENABLE */
 	case 'b':
 	    context.readonly = true;
 	    break;
@@ -1856,6 +2244,11 @@ int main(int argc, char *argv[])
 	}
     }
 
+#ifdef AIDING_ENABLE
+    if (aiding_file != NULL)
+	(void)aiding_load(&context, aiding_file);
+#endif /* AIDING_ENABLE */
+
 #ifdef SYSTEMD_ENABLE
     sd_socket_count = sd_get_socket_count();
     if (sd_socket_count > 0 && control_socket) {
@@ -2022,8 +2415,13 @@ int main(int argc, char *argv[])
 	}
 #endif
 	pw = getpwnam(GPSD_USER);
-	if (pw)
+	if (pw) {
+#ifdef AIDING_ENABLE
+	    /* the store has to stay writable once we're no longer root */
+	    aiding_own(&context, pw->pw_uid, getegid());
+#endif /* AIDING_ENABLE */
 	    (void)setuid(pw->pw_uid);
+	}
 	/*@+type@*/
     }
     gpsd_report(LOG_INF, "running with effective group ID %d\n", getegid());
@@ -2041,6 +2439,10 @@ int main(int argc, char *argv[])
 	    if (allocated_device(&devices[dfd]))
 		(void)gpsd_wrap(&devices[dfd]);
 	}
+#ifdef AIDING_ENABLE
+	if (context.aiding.dirty)
+	    (void)aiding_save(&context);
+#endif /* AIDING_ENABLE */
 	gpsd_report(LOG_WARN, "gpsd restarted by SIGHUP\n");
     }
 
@@ -2073,8 +2475,36 @@ int main(int argc, char *argv[])
     }
 
     while (0 == signalled) {
+	fd_set wfds;
+	timestamp_t wakeup = 1;
+
 	(void)memcpy((char *)&rfds, (char *)&all_fds, sizeof(rfds));
 
+	/* wake up when a device can take queued output */
+	FD_ZERO(&wfds);
+	for (device = devices; device < devices + MAXDEVICES; device++)
+	    if (allocated_device(device) && device->gpsdata.gps_fd >= 0
+		&& device->outqueue.count > 0) {
+		timestamp_t delay = device->outqueue.holdoff - timestamp();
+
+		if (delay > 0) {
+		    if (delay < wakeup)
+			wakeup = delay;
+		} else
+		    FD_SET(device->gpsdata.gps_fd, &wfds);
+	    }
+#if defined(SOCKET_EXPORT_ENABLE) && defined(AIVDM_ENABLE)
+	/* ...and when a batch of AIS reports is due to go out */
+	for (batch = aisbatches; batch < aisbatches + AIS_BATCHERS; batch++)
+	    if (batch->owner != NULL && batch->len > 0) {
+		timestamp_t delay = batch->first - timestamp()
+		    + batch->owner->policy.aisbatch / 1000.0;
+
+		if (delay < wakeup)
+		    wakeup = delay > 0 ? delay : 0;
+	    }
+#endif /* defined(SOCKET_EXPORT_ENABLE) && defined(AIVDM_ENABLE) */
+
 	gpsd_report(LOG_RAW + 2, "select waits\n");
 	/*
 	 * Poll for user commands or GPS data.  The timeout doesn't
@@ -2085,10 +2515,10 @@ int main(int argc, char *argv[])
 	 * low-clock-rate SBCs and the like).
 	 */
 	/*@ -usedef @*/
-	tv.tv_sec = 1;
-	tv.tv_usec = 0;
+	tv.tv_sec = (time_t)wakeup;
+	tv.tv_usec = (suseconds_t)((wakeup - tv.tv_sec) * 1000000);
 	errno = 0;
-	if (select(maxfd + 1, &rfds, NULL, NULL, &tv) == -1) {
+	if (select(maxfd + 1, &rfds, &wfds, NULL, &tv) == -1) {
 	    if (errno == EINTR)
 		continue;
 	    gpsd_report(LOG_ERROR, "select: %s\n", strerror(errno));
@@ -2232,6 +2662,9 @@ int main(int argc, char *argv[])
 /* *INDENT-ON* */
 
 	    if (device->gpsdata.gps_fd >= 0) {
+		/* feed the device what it's ready for */
+		if (device->outqueue.count > 0)
+		    (void)gpsd_write_flush(device);
 		if (FD_ISSET(device->gpsdata.gps_fd, &rfds))
 		    /* get data from the device */
 		    consume_packets(device);
@@ -2248,6 +2681,15 @@ int main(int argc, char *argv[])
 	    }
 	} /* devices */
 
+#if defined(SOCKET_EXPORT_ENABLE) && defined(AIVDM_ENABLE)
+	/* ship AIS batches whose oldest report has waited long enough */
+	for (batch = aisbatches; batch < aisbatches + AIS_BATCHERS; batch++)
+	    if (batch->owner != NULL && batch->len > 0
+		&& timestamp() - batch->first
+		   >= batch->owner->policy.aisbatch / 1000.0)
+		aisbatch_flush(batch);
+#endif /* defined(SOCKET_EXPORT_ENABLE) && defined(AIVDM_ENABLE) */
+
 #ifdef __UNUSED_AUTOCONNECT__
 	if (context.fixcnt > 0 && !context.autconnect) {
 	    for (device = devices; device < devices + MAXDEVICES; device++) {
@@ -2293,6 +2735,9 @@ int main(int argc, char *argv[])
 		    sub->active = timestamp();
 		    if (handle_gpsd_request(sub, buf) < 0)
 			detach_client(sub);
+#ifdef AIVDM_ENABLE
+		    aivdm_dedup_policy();
+#endif /* AIVDM_ENABLE */
 		}
 	    } else {
 		if (!sub->policy.watcher
@@ -2374,6 +2819,12 @@ int main(int argc, char *argv[])
 	    (void)gpsd_wrap(&devices[dfd]);
     }
 
+#ifdef AIDING_ENABLE
+    /* keep what we learned about the sky for the next start */
+    if (context.aiding.dirty)
+	(void)aiding_save(&context);
+#endif /* AIDING_ENABLE */
+
     gpsd_report(LOG_WARN, "exiting.\n");
 
 #ifdef SOCKET_EXPORT_ENABLE
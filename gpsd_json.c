@@ -246,6 +246,71 @@ void json_noise_dump(const struct gps_data_t *gpsdata,
     (void)strlcat(reply, "}\r\n", sizeof(reply) - strlen(reply));
 }
 
+void json_raw_dump(const struct gps_data_t *gpsdata,
+		   /*@out@*/ char *reply, size_t replylen)
+/*
+ * Dump raw measurements.  A full channel set is big, so the encoding
+ * is kept tight: short member names, no empty channels, no members
+ * the receiver didn't supply, and a per-channel measurement time only
+ * where it differs from the report's.
+ */
+{
+    const struct rawdata_t *raw = &gpsdata->raw;
+    double mtime = NAN;
+    int i;
+
+    assert(replylen > 2);
+    for (i = 0; i < MAXCHANNELS; i++)
+	if (raw->PRN[i] != 0) {
+	    mtime = raw->mtime[i];
+	    break;
+	}
+    (void)strlcpy(reply, "{\"class\":\"RAW\",", replylen);
+    (void)snprintf(reply + strlen(reply),
+		   replylen - strlen(reply),
+		   "\"tag\":\"%s\",",
+		   gpsdata->tag[0] != '\0' ? gpsdata->tag : "-");
+    if (gpsdata->dev.path[0] != '\0')
+	(void)snprintf(reply + strlen(reply),
+		       replylen - strlen(reply),
+		       "\"device\":\"%s\",", gpsdata->dev.path);
+    if (isnan(mtime) == 0)
+	(void)snprintf(reply + strlen(reply),
+		       replylen - strlen(reply),
+		       "\"time\":%.6f,", mtime);
+    (void)strlcat(reply, "\"meas\":[", replylen);
+    for (i = 0; i < MAXCHANNELS; i++) {
+	if (raw->PRN[i] == 0)
+	    continue;
+	(void)snprintf(reply + strlen(reply),
+		       replylen - strlen(reply),
+		       "{\"PRN\":%d,\"st\":%u,", raw->PRN[i], raw->satstat[i]);
+#define ADD_RAW_FIELD(tag, field, fmt) do {                     \
+    if (isnan(raw->field[i]) == 0)                           \
+	(void)snprintf(reply + strlen(reply),                \
+		       replylen - strlen(reply),             \
+		       "\"" tag "\":" fmt ",", raw->field[i]);  \
+    } while(0)
+
+	ADD_RAW_FIELD("ss", ss,           "%.1f");
+	ADD_RAW_FIELD("pr", pseudorange,  "%.3f");
+	ADD_RAW_FIELD("cp", carrierphase, "%.3f");
+	ADD_RAW_FIELD("cd", codephase,    "%.3f");
+	ADD_RAW_FIELD("dr", deltarange,   "%.3f");
+	ADD_RAW_FIELD("do", doppler,      "%.3f");
+	if (raw->mtime[i] != mtime)
+	    ADD_RAW_FIELD("mt", mtime,    "%.6f");
+
+#undef ADD_RAW_FIELD
+	if (reply[strlen(reply) - 1] == ',')
+	    reply[strlen(reply) - 1] = '\0';	/* trim trailing comma */
+	(void)strlcat(reply, "},", replylen);
+    }
+    if (reply[strlen(reply) - 1] == ',')
+	reply[strlen(reply) - 1] = '\0';	/* trim trailing comma */
+    (void)strlcat(reply, "]}\r\n", replylen);
+}
+
 void json_sky_dump(const struct gps_data_t *datap,
 		   /*@out@*/ char *reply, size_t replylen)
 {
@@ -385,6 +450,18 @@ void json_device_dump(const struct gps_device_t *device,
 			       ",\"mincycle\":%2.2f",
 			       device->device_type->min_cycle);
 #endif /* RECONFIGURE_ENABLE */
+	    if (isnan(device->gpsdata.dev.load) == 0)
+		(void)snprintf(reply + strlen(reply),
+			       replylen - strlen(reply),
+			       ",\"load\":%.2f", device->gpsdata.dev.load);
+	    if (isnan(device->gpsdata.dev.budget) == 0)
+		(void)snprintf(reply + strlen(reply),
+			       replylen - strlen(reply),
+			       ",\"budget\":%.2f", device->gpsdata.dev.budget);
+	    if (isnan(device->gpsdata.dev.ttff) == 0)
+		(void)snprintf(reply + strlen(reply),
+			       replylen - strlen(reply),
+			       ",\"ttff\":%.1f", device->gpsdata.dev.ttff);
 	}
     }
     if (reply[strlen(reply) - 1] == ',')
@@ -392,18 +469,67 @@ void json_device_dump(const struct gps_device_t *device,
     (void)strlcat(reply, "}\r\n", replylen);
 }
 
+static void json_uint_list(char *reply, size_t replylen, const char *name,
+			   const unsigned int *list, int n)
+/* append a nonempty list of unsigned integers as a JSON array */
+{
+    int i;
+
+    if (n <= 0)
+	return;
+    (void)snprintf(reply + strlen(reply), replylen - strlen(reply),
+		   "\"%s\":[", name);
+    for (i = 0; i < n; i++)
+	(void)snprintf(reply + strlen(reply), replylen - strlen(reply),
+		       "%u,", list[i]);
+    reply[strlen(reply) - 1] = '\0';
+    (void)strlcat(reply, "],", replylen);
+}
+
 void json_watch_dump(const struct policy_t *ccp,
 		     /*@out@*/ char *reply, size_t replylen)
 {
+    int i;
+
     /*@-compdef@*/
     (void)snprintf(reply, replylen,
-		   "{\"class\":\"WATCH\",\"enable\":%s,\"json\":%s,\"nmea\":%s,\"raw\":%d,\"scaled\":%s,\"timing\":%s,",
+		   "{\"class\":\"WATCH\",\"enable\":%s,\"json\":%s,\"nmea\":%s,\"raw\":%d,\"scaled\":%s,\"timing\":%s,\"rawdata\":%s,",
 		   ccp->watcher ? "true" : "false",
 		   ccp->json ? "true" : "false",
 		   ccp->nmea ? "true" : "false",
 		   ccp->raw,
 		   ccp->scaled ? "true" : "false",
-		   ccp->timing ? "true" : "false");
+		   ccp->timing ? "true" : "false",
+		   ccp->rawdata ? "true" : "false");
+    if (ccp->vessels)
+	(void)strlcat(reply, "\"vessels\":true,", replylen);
+    if (ccp->dedup)
+	(void)strlcat(reply, "\"dedup\":true,", replylen);
+    if (ccp->aisbatch > 0)
+	(void)snprintf(reply + strlen(reply), replylen - strlen(reply),
+		       "\"aisbatch\":%d,", ccp->aisbatch);
+    if (ccp->aisfilter.nbox > 0) {
+	(void)strlcat(reply, "\"aisbox\":[", replylen);
+	for (i = 0; i < ccp->aisfilter.nbox; i++)
+	    (void)snprintf(reply + strlen(reply), replylen - strlen(reply),
+			   "%.6f,", ccp->aisfilter.box[i]);
+	reply[strlen(reply) - 1] = '\0';
+	(void)strlcat(reply, "],", replylen);
+    }
+    if (ccp->aisfilter.nradius > 0) {
+	(void)strlcat(reply, "\"aisradius\":[", replylen);
+	for (i = 0; i < ccp->aisfilter.nradius; i++)
+	    (void)snprintf(reply + strlen(reply), replylen - strlen(reply),
+			   "%.6f,", ccp->aisfilter.radius[i]);
+	reply[strlen(reply) - 1] = '\0';
+	(void)strlcat(reply, "],", replylen);
+    }
+    json_uint_list(reply, replylen, "aismmsi",
+		   ccp->aisfilter.mmsi, ccp->aisfilter.nmmsi);
+    json_uint_list(reply, replylen, "aisnotmmsi",
+		   ccp->aisfilter.notmmsi, ccp->aisfilter.nnotmmsi);
+    json_uint_list(reply, replylen, "aistypes",
+		   ccp->aisfilter.types, ccp->aisfilter.ntypes);
     if (ccp->devpath[0] != '\0')
 	(void)snprintf(reply + strlen(reply), replylen - strlen(reply),
 		       "\"device\":\"%s\",", ccp->devpath);
@@ -1337,208 +1463,439 @@ void json_rtcm3_dump(const struct rtcm3_t *rtcm,
 #endif /* defined(RTCM104V3_ENABLE) */
 
 #if defined(AIVDM_ENABLE)
-void json_aivdm_dump(const struct ais_t *ais, 
-		     /*@null@*/const char *device, bool scaled,
-		     /*@out@*/char *buf, size_t buflen)
+/*
+ * Appenders for the AIS writers.  Each writes at the cursor, never at or
+ * past end, and returns the advanced cursor; the caller puts the NUL on.
+ * Nothing already written is rescanned, unlike snprintf(buf + strlen(buf)).
+ */
+
+static char *json_put_raw(char *cp, const char *end, const char *s)
 {
-    char buf1[JSON_VAL_MAX * 2 + 1];
-    char buf2[JSON_VAL_MAX * 2 + 1];
-    char buf3[JSON_VAL_MAX * 2 + 1];
-    bool imo;
-    int i;
+    while (*s != '\0' && cp < end)
+	*cp++ = *s++;
+    return cp;
+}
 
-    static char *nav_legends[] = {
-	"Under way using engine",
-	"At anchor",
-	"Not under command",
-	"Restricted manoeuverability",
-	"Constrained by her draught",
-	"Moored",
-	"Aground",
-	"Engaged in fishing",
-	"Under way sailing",
-	"Reserved for HSC",
-	"Reserved for WIG",
-	"Reserved",
-	"Reserved",
-	"Reserved",
-	"Reserved",
-	"Not defined",
-    };
-    static char *epfd_legends[] = {
-	"Undefined",
-	"GPS",
-	"GLONASS",
-	"Combined GPS/GLONASS",
-	"Loran-C",
-	"Chayka",
-	"Integrated navigation system",
-	"Surveyed",
-	"Galileo",
-    };
+static char *json_put_digits(char *cp, const char *end,
+			     unsigned int n, int width)
+/* append n in decimal, zero-padded to at least width digits */
+{
+    char digits[10];
+    int i = 0;
+
+    do {
+	digits[i++] = (char)('0' + n % 10);
+	n /= 10;
+    } while (n != 0);
+    while (i < width)
+	digits[i++] = '0';
+    while (i > 0 && cp < end)
+	*cp++ = digits[--i];
+    return cp;
+}
 
-    static char *ship_type_legends[100] = {
-	"Not available",
-	"Reserved for future use",
-	"Reserved for future use",
-	"Reserved for future use",
-	"Reserved for future use",
-	"Reserved for future use",
-	"Reserved for future use",
-	"Reserved for future use",
-	"Reserved for future use",
-	"Reserved for future use",
-	"Reserved for future use",
-	"Reserved for future use",
-	"Reserved for future use",
-	"Reserved for future use",
-	"Reserved for future use",
-	"Reserved for future use",
-	"Reserved for future use",
-	"Reserved for future use",
-	"Reserved for future use",
-	"Reserved for future use",
-	"Wing in ground (WIG) - all ships of this type",
-	"Wing in ground (WIG) - Hazardous category A",
-	"Wing in ground (WIG) - Hazardous category B",
-	"Wing in ground (WIG) - Hazardous category C",
-	"Wing in ground (WIG) - Hazardous category D",
-	"Wing in ground (WIG) - Reserved for future use",
-	"Wing in ground (WIG) - Reserved for future use",
-	"Wing in ground (WIG) - Reserved for future use",
-	"Wing in ground (WIG) - Reserved for future use",
-	"Wing in ground (WIG) - Reserved for future use",
-	"Fishing",
-	"Towing",
-	"Towing: length exceeds 200m or breadth exceeds 25m",
-	"Dredging or underwater ops",
-	"Diving ops",
-	"Military ops",
-	"Sailing",
-	"Pleasure Craft",
-	"Reserved",
-	"Reserved",
-	"High speed craft (HSC) - all ships of this type",
-	"High speed craft (HSC) - Hazardous category A",
-	"High speed craft (HSC) - Hazardous category B",
-	"High speed craft (HSC) - Hazardous category C",
-	"High speed craft (HSC) - Hazardous category D",
-	"High speed craft (HSC) - Reserved for future use",
-	"High speed craft (HSC) - Reserved for future use",
-	"High speed craft (HSC) - Reserved for future use",
-	"High speed craft (HSC) - Reserved for future use",
-	"High speed craft (HSC) - No additional information",
-	"Pilot Vessel",
-	"Search and Rescue vessel",
-	"Tug",
-	"Port Tender",
-	"Anti-pollution equipment",
-	"Law Enforcement",
-	"Spare - Local Vessel",
-	"Spare - Local Vessel",
-	"Medical Transport",
-	"Ship according to RR Resolution No. 18",
-	"Passenger - all ships of this type",
-	"Passenger - Hazardous category A",
-	"Passenger - Hazardous category B",
-	"Passenger - Hazardous category C",
-	"Passenger - Hazardous category D",
-	"Passenger - Reserved for future use",
-	"Passenger - Reserved for future use",
-	"Passenger - Reserved for future use",
-	"Passenger - Reserved for future use",
-	"Passenger - No additional information",
-	"Cargo - all ships of this type",
-	"Cargo - Hazardous category A",
-	"Cargo - Hazardous category B",
-	"Cargo - Hazardous category C",
-	"Cargo - Hazardous category D",
-	"Cargo - Reserved for future use",
-	"Cargo - Reserved for future use",
-	"Cargo - Reserved for future use",
-	"Cargo - Reserved for future use",
-	"Cargo - No additional information",
-	"Tanker - all ships of this type",
-	"Tanker - Hazardous category A",
-	"Tanker - Hazardous category B",
-	"Tanker - Hazardous category C",
-	"Tanker - Hazardous category D",
-	"Tanker - Reserved for future use",
-	"Tanker - Reserved for future use",
-	"Tanker - Reserved for future use",
-	"Tanker - Reserved for future use",
-	"Tanker - No additional information",
-	"Other Type - all ships of this type",
-	"Other Type - Hazardous category A",
-	"Other Type - Hazardous category B",
-	"Other Type - Hazardous category C",
-	"Other Type - Hazardous category D",
-	"Other Type - Reserved for future use",
-	"Other Type - Reserved for future use",
-	"Other Type - Reserved for future use",
-	"Other Type - Reserved for future use",
-	"Other Type - no additional information",
-    };
+static char *json_put_uint(char *cp, const char *end,
+			   const char *key, unsigned int n)
+{
+    return json_put_digits(json_put_raw(cp, end, key), end, n, 1);
+}
+
+static char *json_put_int(char *cp, const char *end, const char *key, int n)
+{
+    cp = json_put_raw(cp, end, key);
+    if (n >= 0)
+	return json_put_digits(cp, end, (unsigned int)n, 1);
+    cp = json_put_raw(cp, end, "-");
+    return json_put_digits(cp, end, 0u - (unsigned int)n, 1);
+}
+
+static char *json_put_real(char *cp, const char *end, const char *key,
+			   double x, int prec)
+/* append x in fixed point with prec decimals, as %.*f does */
+{
+    char digits[32];
+
+    (void)snprintf(digits, sizeof(digits), "%.*f", prec, x);
+    return json_put_raw(json_put_raw(cp, end, key), end, digits);
+}
+
+static char *json_put_bool(char *cp, const char *end, const char *key, bool b)
+{
+    return json_put_raw(json_put_raw(cp, end, key), end, JSON_BOOL(b));
+}
+
+static char *json_put_string(char *cp, const char *end,
+			     const char *key, const char *s)
+/* append a quoted string, escaped the way json_stringify() does it */
+{
+    static const char hexchar[] = "0123456789abcdef";
+
+    cp = json_put_raw(cp, end, key);
+    cp = json_put_raw(cp, end, "\"");
+    for (; *s != '\0' && cp < end; s++) {
+	unsigned char c = (unsigned char)*s;
+	char esc[7];
+
+	if (!isascii(c) || iscntrl(c)) {
+	    esc[0] = '\\';
+	    esc[2] = '\0';
+	    switch (c) {
+	    case '\b':
+		esc[1] = 'b';
+		break;
+	    case '\f':
+		esc[1] = 'f';
+		break;
+	    case '\n':
+		esc[1] = 'n';
+		break;
+	    case '\r':
+		esc[1] = 'r';
+		break;
+	    case '\t':
+		esc[1] = 't';
+		break;
+	    default:
+		(void)memcpy(esc + 1, "u00", 3);
+		esc[4] = hexchar[c >> 4];
+		esc[5] = hexchar[c & 0x0f];
+		esc[6] = '\0';
+		break;
+	    }
+	    cp = json_put_raw(cp, end, esc);
+	} else {
+	    if (c == '"' || c == '\\')
+		*cp++ = '\\';
+	    if (cp < end)
+		*cp++ = (char)c;
+	}
+    }
+    return json_put_raw(cp, end, "\"");
+}
+
+static char *json_put_dayhm(char *cp, const char *end,
+			    unsigned int month, unsigned int day,
+			    unsigned int hour, unsigned int minute)
+/* append the MM-DDTHH:MM part every AIS date has */
+{
+    cp = json_put_digits(cp, end, month, 2);
+    cp = json_put_digits(json_put_raw(cp, end, "-"), end, day, 2);
+    cp = json_put_digits(json_put_raw(cp, end, "T"), end, hour, 2);
+    return json_put_digits(json_put_raw(cp, end, ":"), end, minute, 2);
+}
+
+static char *json_put_timestamp(char *cp, const char *end, const char *key,
+				unsigned int year, unsigned int month,
+				unsigned int day, unsigned int hour,
+				unsigned int minute, unsigned int second)
+/* append a quoted YYYY-MM-DDTHH:MM:SSZ */
+{
+    cp = json_put_raw(json_put_raw(cp, end, key), end, "\"");
+    cp = json_put_digits(cp, end, year, 4);
+    cp = json_put_dayhm(json_put_raw(cp, end, "-"), end,
+			month, day, hour, minute);
+    cp = json_put_digits(json_put_raw(cp, end, ":"), end, second, 2);
+    return json_put_raw(cp, end, "Z\"");
+}
+
+static char *json_put_eta(char *cp, const char *end, const char *key,
+			  unsigned int month, unsigned int day,
+			  unsigned int hour, unsigned int minute)
+/* append a quoted MM-DDTHH:MMZ, a date with no year or seconds */
+{
+    cp = json_put_raw(json_put_raw(cp, end, key), end, "\"");
+    cp = json_put_dayhm(cp, end, month, day, hour, minute);
+    return json_put_raw(cp, end, "Z\"");
+}
+
+static char *json_put_data(char *cp, const char *end, const char *key,
+			   const char *bitdata, size_t bitcount)
+/* append a binary payload as "bitcount:hexdata" */
+{
+    cp = json_put_raw(json_put_raw(cp, end, key), end, "\"");
+    cp = json_put_digits(cp, end, (unsigned int)bitcount, 1);
+    cp = json_put_raw(cp, end, ":");
+    cp = json_put_raw(cp, end, gpsd_hexdump((char *)bitdata,
+					    (bitcount + 7) / 8));
+    return json_put_raw(cp, end, "\"");
+}
+
+/* composite fields, the inverse of what json_ais_read() does with them */
+#define AIS_PUT_TIMESTAMP(cp, end, key, s) \
+	json_put_timestamp(cp, end, key, (s).year, (s).month, (s).day, \
+			   (s).hour, (s).minute, (s).second)
+#define AIS_PUT_ETA(cp, end, key, s) \
+	json_put_eta(cp, end, key, (s).month, (s).day, (s).hour, (s).minute)
+#define AIS_PUT_DATA(cp, end, key, s) \
+	json_put_data(cp, end, key, (s).bitdata, (s).bitcount)
+
+/* legends scaled reports write in place of the codes */
+static const char *nav_legends[] = {
+    "Under way using engine",
+    "At anchor",
+    "Not under command",
+    "Restricted manoeuverability",
+    "Constrained by her draught",
+    "Moored",
+    "Aground",
+    "Engaged in fishing",
+    "Under way sailing",
+    "Reserved for HSC",
+    "Reserved for WIG",
+    "Reserved",
+    "Reserved",
+    "Reserved",
+    "Reserved",
+    "Not defined",
+};
+
+#define NAVSTATUS_DISPLAY(n) (((n) < (unsigned int)NITEMS(nav_legends)) ? nav_legends[n] : "INVALID NAVIGATION STATUS")
+
+static const char *epfd_legends[] = {
+    "Undefined",
+    "GPS",
+    "GLONASS",
+    "Combined GPS/GLONASS",
+    "Loran-C",
+    "Chayka",
+    "Integrated navigation system",
+    "Surveyed",
+    "Galileo",
+};
+
+#define EPFD_DISPLAY(n) (((n) < (unsigned int)NITEMS(epfd_legends)) ? epfd_legends[n] : "INVALID EPFD")
+
+static const char *ship_type_legends[100] = {
+    "Not available",
+    "Reserved for future use",
+    "Reserved for future use",
+    "Reserved for future use",
+    "Reserved for future use",
+    "Reserved for future use",
+    "Reserved for future use",
+    "Reserved for future use",
+    "Reserved for future use",
+    "Reserved for future use",
+    "Reserved for future use",
+    "Reserved for future use",
+    "Reserved for future use",
+    "Reserved for future use",
+    "Reserved for future use",
+    "Reserved for future use",
+    "Reserved for future use",
+    "Reserved for future use",
+    "Reserved for future use",
+    "Reserved for future use",
+    "Wing in ground (WIG) - all ships of this type",
+    "Wing in ground (WIG) - Hazardous category A",
+    "Wing in ground (WIG) - Hazardous category B",
+    "Wing in ground (WIG) - Hazardous category C",
+    "Wing in ground (WIG) - Hazardous category D",
+    "Wing in ground (WIG) - Reserved for future use",
+    "Wing in ground (WIG) - Reserved for future use",
+    "Wing in ground (WIG) - Reserved for future use",
+    "Wing in ground (WIG) - Reserved for future use",
+    "Wing in ground (WIG) - Reserved for future use",
+    "Fishing",
+    "Towing",
+    "Towing: length exceeds 200m or breadth exceeds 25m",
+    "Dredging or underwater ops",
+    "Diving ops",
+    "Military ops",
+    "Sailing",
+    "Pleasure Craft",
+    "Reserved",
+    "Reserved",
+    "High speed craft (HSC) - all ships of this type",
+    "High speed craft (HSC) - Hazardous category A",
+    "High speed craft (HSC) - Hazardous category B",
+    "High speed craft (HSC) - Hazardous category C",
+    "High speed craft (HSC) - Hazardous category D",
+    "High speed craft (HSC) - Reserved for future use",
+    "High speed craft (HSC) - Reserved for future use",
+    "High speed craft (HSC) - Reserved for future use",
+    "High speed craft (HSC) - Reserved for future use",
+    "High speed craft (HSC) - No additional information",
+    "Pilot Vessel",
+    "Search and Rescue vessel",
+    "Tug",
+    "Port Tender",
+    "Anti-pollution equipment",
+    "Law Enforcement",
+    "Spare - Local Vessel",
+    "Spare - Local Vessel",
+    "Medical Transport",
+    "Ship according to RR Resolution No. 18",
+    "Passenger - all ships of this type",
+    "Passenger - Hazardous category A",
+    "Passenger - Hazardous category B",
+    "Passenger - Hazardous category C",
+    "Passenger - Hazardous category D",
+    "Passenger - Reserved for future use",
+    "Passenger - Reserved for future use",
+    "Passenger - Reserved for future use",
+    "Passenger - Reserved for future use",
+    "Passenger - No additional information",
+    "Cargo - all ships of this type",
+    "Cargo - Hazardous category A",
+    "Cargo - Hazardous category B",
+    "Cargo - Hazardous category C",
+    "Cargo - Hazardous category D",
+    "Cargo - Reserved for future use",
+    "Cargo - Reserved for future use",
+    "Cargo - Reserved for future use",
+    "Cargo - Reserved for future use",
+    "Cargo - No additional information",
+    "Tanker - all ships of this type",
+    "Tanker - Hazardous category A",
+    "Tanker - Hazardous category B",
+    "Tanker - Hazardous category C",
+    "Tanker - Hazardous category D",
+    "Tanker - Reserved for future use",
+    "Tanker - Reserved for future use",
+    "Tanker - Reserved for future use",
+    "Tanker - Reserved for future use",
+    "Tanker - No additional information",
+    "Other Type - all ships of this type",
+    "Other Type - Hazardous category A",
+    "Other Type - Hazardous category B",
+    "Other Type - Hazardous category C",
+    "Other Type - Hazardous category D",
+    "Other Type - Reserved for future use",
+    "Other Type - Reserved for future use",
+    "Other Type - Reserved for future use",
+    "Other Type - Reserved for future use",
+    "Other Type - no additional information",
+};
 
 #define SHIPTYPE_DISPLAY(n) (((n) < (unsigned int)NITEMS(ship_type_legends)) ? ship_type_legends[n] : "INVALID SHIP TYPE")
 
-    static const char *station_type_legends[16] = {
-	"All types of mobiles",
-	"Reserved for future use",
-	"All types of Class B mobile stations",
-	"SAR airborne mobile station",
-	"Aid to Navigation station",
-	"Class B shipborne mobile station",
-	"Regional use and inland waterways",
-	"Regional use and inland waterways",
-	"Regional use and inland waterways",
-	"Regional use and inland waterways",
-	"Reserved for future use",
-	"Reserved for future use",
-	"Reserved for future use",
-	"Reserved for future use",
-	"Reserved for future use",
-	"Reserved for future use",
-    };
+static const char *station_type_legends[16] = {
+    "All types of mobiles",
+    "Reserved for future use",
+    "All types of Class B mobile stations",
+    "SAR airborne mobile station",
+    "Aid to Navigation station",
+    "Class B shipborne mobile station",
+    "Regional use and inland waterways",
+    "Regional use and inland waterways",
+    "Regional use and inland waterways",
+    "Regional use and inland waterways",
+    "Reserved for future use",
+    "Reserved for future use",
+    "Reserved for future use",
+    "Reserved for future use",
+    "Reserved for future use",
+    "Reserved for future use",
+};
 
-#define STATIONTYPE_DISPLAY(n) (((n) < (unsigned int)NITEMS(ship_type_legends)) ? station_type_legends[n] : "INVALID STATION TYPE")
-
-    static const char *navaid_type_legends[] = {
-	"Unspecified",
-	"Reference point",
-	"RACON",
-	"Fixed offshore structure",
-	"Spare, Reserved for future use.",
-	"Light, without sectors",
-	"Light, with sectors",
-	"Leading Light Front",
-	"Leading Light Rear",
-	"Beacon, Cardinal N",
-	"Beacon, Cardinal E",
-	"Beacon, Cardinal S",
-	"Beacon, Cardinal W",
-	"Beacon, Port hand",
-	"Beacon, Starboard hand",
-	"Beacon, Preferred Channel port hand",
-	"Beacon, Preferred Channel starboard hand",
-	"Beacon, Isolated danger",
-	"Beacon, Safe water",
-	"Beacon, Special mark",
-	"Cardinal Mark N",
-	"Cardinal Mark E",
-	"Cardinal Mark S",
-	"Cardinal Mark W",
-	"Port hand Mark",
-	"Starboard hand Mark",
-	"Preferred Channel Port hand",
-	"Preferred Channel Starboard hand",
-	"Isolated danger",
-	"Safe Water",
-	"Special Mark",
-	"Light Vessel / LANBY / Rigs",
-    };
+#define STATIONTYPE_DISPLAY(n) (((n) < (unsigned int)NITEMS(station_type_legends)) ? station_type_legends[n] : "INVALID STATION TYPE")
+
+static const char *navaid_type_legends[] = {
+    "Unspecified",
+    "Reference point",
+    "RACON",
+    "Fixed offshore structure",
+    "Spare, Reserved for future use.",
+    "Light, without sectors",
+    "Light, with sectors",
+    "Leading Light Front",
+    "Leading Light Rear",
+    "Beacon, Cardinal N",
+    "Beacon, Cardinal E",
+    "Beacon, Cardinal S",
+    "Beacon, Cardinal W",
+    "Beacon, Port hand",
+    "Beacon, Starboard hand",
+    "Beacon, Preferred Channel port hand",
+    "Beacon, Preferred Channel starboard hand",
+    "Beacon, Isolated danger",
+    "Beacon, Safe water",
+    "Beacon, Special mark",
+    "Cardinal Mark N",
+    "Cardinal Mark E",
+    "Cardinal Mark S",
+    "Cardinal Mark W",
+    "Port hand Mark",
+    "Starboard hand Mark",
+    "Preferred Channel Port hand",
+    "Preferred Channel Starboard hand",
+    "Isolated danger",
+    "Safe Water",
+    "Special Mark",
+    "Light Vessel / LANBY / Rigs",
+};
+
+#define NAVAIDTYPE_DISPLAY(n) (((n) < (unsigned int)NITEMS(navaid_type_legends)) ? navaid_type_legends[n] : "INVALID NAVAID TYPE")
+
+static char *json_put_turn(char *cp, const char *end, const char *key, int turn)
+/* rate of turn: "nan" if not available, "fastleft"/"fastright" if fast */
+{
+    double rot1;
+
+    cp = json_put_raw(cp, end, key);
+    if (turn == -128)
+	return json_put_raw(cp, end, "\"nan\"");
+    else if (turn == -127)
+	return json_put_raw(cp, end, "\"fastleft\"");
+    else if (turn == 127)
+	return json_put_raw(cp, end, "\"fastright\"");
+    rot1 = turn / 4.733;
+    return json_put_real(cp, end, "", rot1 * rot1, 0);
+}
 
-#define NAVAIDTYPE_DISPLAY(n) (((n) < (unsigned int)NITEMS(navaid_type_legends[0])) ? navaid_type_legends[n] : "INVALID NAVAID TYPE")
+static char *json_put_speed(char *cp, const char *end, const char *key,
+			    unsigned int speed)
+/* speed in knots: "nan" if not available, "fast" for fast movers */
+{
+    cp = json_put_raw(cp, end, key);
+    if (speed == AIS_SPEED_NOT_AVAILABLE)
+	return json_put_raw(cp, end, "\"nan\"");
+    else if (speed == AIS_SPEED_FAST_MOVER)
+	return json_put_raw(cp, end, "\"fast\"");
+    return json_put_real(cp, end, "", speed / 10.0, 1);
+}
+
+static char *json_put_sar_alt(char *cp, const char *end, const char *key,
+			      unsigned int alt)
+/* SAR altitude: "nan" if not available, "high" above the ceiling */
+{
+    cp = json_put_raw(cp, end, key);
+    if (alt == AIS_ALT_NOT_AVAILABLE)
+	return json_put_raw(cp, end, "\"nan\"");
+    else if (alt == AIS_ALT_HIGH)
+	return json_put_raw(cp, end, "\"high\"");
+    return json_put_digits(cp, end, alt, 1);
+}
+
+static char *json_put_sar_speed(char *cp, const char *end, const char *key,
+				unsigned int speed)
+/* SAR speed: "nan" if not available, "fast" for fast movers */
+{
+    cp = json_put_raw(cp, end, key);
+    if (speed == AIS_SAR_SPEED_NOT_AVAILABLE)
+	return json_put_raw(cp, end, "\"nan\"");
+    else if (speed == AIS_SAR_FAST_MOVER)
+	return json_put_raw(cp, end, "\"fast\"");
+    return json_put_digits(cp, end, speed, 1);
+}
+
+/* the fields scaled reports write specially */
+#define AIS_PUT_TURN(cp, end, key, s)	json_put_turn(cp, end, key, (s).turn)
+#define AIS_PUT_SPEED(cp, end, key, s)	json_put_speed(cp, end, key, (s).speed)
+#define AIS_PUT_ALT(cp, end, key, s)	json_put_sar_alt(cp, end, key, (s).alt)
+#define AIS_PUT_SAR_SPEED(cp, end, key, s) \
+	json_put_sar_speed(cp, end, key, (s).speed)
+
+#include "ais_json_dump.i"	/* generated AIS writers */
+
+void json_aivdm_dump(const struct ais_t *ais,
+		     /*@null@*/const char *device, bool scaled,
+		     /*@out@*/char *buf, size_t buflen)
+{
+    char *cp, *tail = NULL, *end = buf + buflen - 1;
+    bool imo;
+    int i;
 
     static const char *signal_legends[] = {
 	"N/A",
@@ -1558,7 +1915,7 @@ void json_aivdm_dump(const struct ais_t *ais,
 	"X = Vessels shall proceed only on direction.",
     };
 
-#define SIGNAL_DISPLAY(n) (((n) < (unsigned int)NITEMS(signal_legends[0])) ? signal_legends[n] : "INVALID SIGNAL TYPE")
+#define SIGNAL_DISPLAY(n) (((n) < (unsigned int)NITEMS(signal_legends)) ? signal_legends[n] : "INVALID SIGNAL TYPE")
 
     static const char *route_type[32] = {
 	"Undefined (default)",
@@ -1595,693 +1952,675 @@ void json_aivdm_dump(const struct ais_t *ais,
 	"Cancel route identified by message linkage",
     };
 
-    static char *idtypes[] = {
+    static const char *idtypes[] = {
 	"mmsi",
 	"imo",
 	"callsign",
 	"other",
     };
 
-    (void)snprintf(buf, buflen, "{\"class\":\"AIS\",");
+    static const char *trends[] = {
+	"steaady",
+	"increasing"
+	"decreasing",
+	"N/A",
+    };
+
+    static const char *preciptypes[] = {
+	"rain",
+	"thunderstorm",
+	"freezing rain",
+	"mixed/ice",
+	"snow",
+	"reserved",
+	"reserved",
+	"N/A",
+    };
+
+    cp = json_put_raw(buf, end, "{\"class\":\"AIS\",");
     if (device != NULL && device[0] != '\0')
-	(void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-		       "\"device\":\"%s\",", device);
-    (void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-		   "\"type\":%u,\"repeat\":%u,\"mmsi\":%u,\"scaled\":%s,",
-		   ais->type, ais->repeat, ais->mmsi, JSON_BOOL(scaled));
-    /*@ -formatcode -mustfreefresh @*/
+	cp = json_put_raw(json_put_string(cp, end, "\"device\":", device),
+			  end, ",");
+    cp = json_put_uint(cp, end, "\"type\":", ais->type);
+    cp = json_put_uint(cp, end, ",\"repeat\":", ais->repeat);
+    cp = json_put_uint(cp, end, ",\"mmsi\":", ais->mmsi);
+    cp = json_put_bool(cp, end, ",\"scaled\":", scaled);
+    cp = json_put_raw(cp, end, ",");
+
+    /*
+     * Reports are written by code generated from the same specification
+     * as the parser, scaled or not.  Types with subtypes or union members
+     * are done by hand below.
+     */
     switch (ais->type) {
-    case 1:			/* Position Report */
+    case 1:
     case 2:
     case 3:
-	if (scaled) {
-	    char turnlegend[20];
-	    char speedlegend[20];
-
-	    /*
-	     * Express turn as nan if not available,
-	     * "fastleft"/"fastright" for fast turns.
-	     */
-	    if (ais->type1.turn == -128)
-		(void)strlcpy(turnlegend, "\"nan\"", sizeof(turnlegend));
-	    else if (ais->type1.turn == -127)
-		(void)strlcpy(turnlegend, "\"fastleft\"", sizeof(turnlegend));
-	    else if (ais->type1.turn == 127)
-		(void)strlcpy(turnlegend, "\"fastright\"",
-			      sizeof(turnlegend));
-	    else {
-		double rot1 = ais->type1.turn / 4.733;
-		(void)snprintf(turnlegend, sizeof(turnlegend),
-			       "%.0f", rot1 * rot1);
-	    }
-
-	    /*
-	     * Express speed as nan if not available,
-	     * "fast" for fast movers.
-	     */
-	    if (ais->type1.speed == AIS_SPEED_NOT_AVAILABLE)
-		(void)strlcpy(speedlegend, "\"nan\"", sizeof(speedlegend));
-	    else if (ais->type1.speed == AIS_SPEED_FAST_MOVER)
-		(void)strlcpy(speedlegend, "\"fast\"", sizeof(speedlegend));
-	    else
-		(void)snprintf(speedlegend, sizeof(speedlegend),
-			       "%.1f", ais->type1.speed / 10.0);
-
-	    (void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-			   "\"status\":\"%s\",\"turn\":%s,\"speed\":%s,"
-			   "\"accuracy\":%s,\"lon\":%.4f,\"lat\":%.4f,"
-			   "\"course\":%u,\"heading\":%u,\"second\":%u,"
-			   "\"maneuver\":%u,\"raim\":%s,\"radio\":%u}\r\n",
-			   nav_legends[ais->type1.status],
-			   turnlegend,
-			   speedlegend,
-			   JSON_BOOL(ais->type1.accuracy),
-			   ais->type1.lon / AIS_LATLON_SCALE,
-			   ais->type1.lat / AIS_LATLON_SCALE,
-			   ais->type1.course,
-			   ais->type1.heading,
-			   ais->type1.second,
-			   ais->type1.maneuver,
-			   JSON_BOOL(ais->type1.raim), ais->type1.radio);
-	} else {
-	    (void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-			   "\"status\":%u,\"turn\":%d,\"speed\":%u,"
-			   "\"accuracy\":%s,\"lon\":%d,\"lat\":%d,"
-			   "\"course\":%u,\"heading\":%u,\"second\":%u,"
-			   "\"maneuver\":%u,\"raim\":%s,\"radio\":%u}\r\n",
-			   ais->type1.status,
-			   ais->type1.turn,
-			   ais->type1.speed,
-			   JSON_BOOL(ais->type1.accuracy),
-			   ais->type1.lon,
-			   ais->type1.lat,
-			   ais->type1.course,
-			   ais->type1.heading,
-			   ais->type1.second,
-			   ais->type1.maneuver,
-			   JSON_BOOL(ais->type1.raim), ais->type1.radio);
-	}
+	tail = json_ais1_dump(ais, scaled, cp, end);
 	break;
-    case 4:			/* Base Station Report */
-    case 11:			/* UTC/Date Response */
-	/* some fields have beem merged to an ISO8601 date */
-	if (scaled) {
-	    (void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-			   "\"timestamp\":\"%4u-%02u-%02uT%02u:%02u:%02uZ\","
-			   "\"accuracy\":%s,\"lon\":%.4f,\"lat\":%.4f,"
-			   "\"epfd\":\"%s\",\"raim\":%s,\"radio\":%u}\r\n",
-			   ais->type4.year,
-			   ais->type4.month,
-			   ais->type4.day,
-			   ais->type4.hour,
-			   ais->type4.minute,
-			   ais->type4.second,
-			   JSON_BOOL(ais->type4.accuracy),
-			   ais->type4.lon / AIS_LATLON_SCALE,
-			   ais->type4.lat / AIS_LATLON_SCALE,
-			   epfd_legends[ais->type4.epfd],
-			   JSON_BOOL(ais->type4.raim), ais->type4.radio);
-	} else {
-	    (void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-			   "\"timestamp\":\"%04u-%02u-%02uT%02u:%02u:%02uZ\","
-			   "\"accuracy\":%s,\"lon\":%d,\"lat\":%d,"
-			   "\"epfd\":%u,\"raim\":%s,\"radio\":%u}\r\n",
-			   ais->type4.year,
-			   ais->type4.month,
-			   ais->type4.day,
-			   ais->type4.hour,
-			   ais->type4.minute,
-			   ais->type4.second,
-			   JSON_BOOL(ais->type4.accuracy),
-			   ais->type4.lon,
-			   ais->type4.lat,
-			   ais->type4.epfd,
-			   JSON_BOOL(ais->type4.raim), ais->type4.radio);
-	}
+    case 4:
+    case 11:
+	tail = json_ais4_dump(ais, scaled, cp, end);
 	break;
-    case 5:			/* Ship static and voyage related data */
-	/* some fields have beem merged to an ISO8601 partial date */
-	if (scaled) {
-            /* *INDENT-OFF* */
-	    (void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-			   "\"imo\":%u,\"ais_version\":%u,\"callsign\":\"%s\","
-			   "\"shipname\":\"%s\",\"shiptype\":\"%s\","
-			   "\"to_bow\":%u,\"to_stern\":%u,\"to_port\":%u,"
-			   "\"to_starboard\":%u,\"epfd\":\"%s\","
-			   "\"eta\":\"%02u-%02uT%02u:%02uZ\","
-			   "\"draught\":%.1f,\"destination\":\"%s\","
-			   "\"dte\":%u}\r\n",
-			   ais->type5.imo,
-			   ais->type5.ais_version,
-			   json_stringify(buf1, sizeof(buf1),
-					  ais->type5.callsign),
-			   json_stringify(buf2, sizeof(buf2),
-					  ais->type5.shipname),
-			   SHIPTYPE_DISPLAY(ais->type5.shiptype),
-			   ais->type5.to_bow, ais->type5.to_stern,
-			   ais->type5.to_port, ais->type5.to_starboard,
-			   epfd_legends[ais->type5.epfd], ais->type5.month,
-			   ais->type5.day, ais->type5.hour, ais->type5.minute,
-			   ais->type5.draught / 10.0,
-			   json_stringify(buf3, sizeof(buf3),
-					  ais->type5.destination),
-			   ais->type5.dte);
-            /* *INDENT-ON* */
-	} else {
-	    (void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-			   "\"imo\":%u,\"ais_version\":%u,\"callsign\":\"%s\","
-			   "\"shipname\":\"%s\",\"shiptype\":%u,"
-			   "\"to_bow\":%u,\"to_stern\":%u,\"to_port\":%u,"
-			   "\"to_starboard\":%u,\"epfd\":%u,"
-			   "\"eta\":\"%02u-%02uT%02u:%02uZ\","
-			   "\"draught\":%u,\"destination\":\"%s\","
-			   "\"dte\":%u}\r\n",
-			   ais->type5.imo,
-			   ais->type5.ais_version,
-			   json_stringify(buf1, sizeof(buf1),
-					  ais->type5.callsign),
-			   json_stringify(buf2, sizeof(buf2),
-					  ais->type5.shipname),
-			   ais->type5.shiptype, ais->type5.to_bow,
-			   ais->type5.to_stern, ais->type5.to_port,
-			   ais->type5.to_starboard, ais->type5.epfd,
-			   ais->type5.month, ais->type5.day, ais->type5.hour,
-			   ais->type5.minute, ais->type5.draught,
-			   json_stringify(buf3, sizeof(buf3),
-					  ais->type5.destination),
-			   ais->type5.dte);
-	}
+    case 5:
+	tail = json_ais5_dump(ais, scaled, cp, end);
 	break;
+    case 7:
+    case 13:
+	tail = json_ais7_dump(ais, scaled, cp, end);
+	break;
+    case 9:
+	tail = json_ais9_dump(ais, scaled, cp, end);
+	break;
+    case 10:
+	tail = json_ais10_dump(ais, scaled, cp, end);
+	break;
+    case 12:
+	tail = json_ais12_dump(ais, scaled, cp, end);
+	break;
+    case 14:
+	tail = json_ais14_dump(ais, scaled, cp, end);
+	break;
+    case 15:
+	tail = json_ais15_dump(ais, scaled, cp, end);
+	break;
+    case 16:
+	tail = json_ais16_dump(ais, scaled, cp, end);
+	break;
+    case 17:
+	tail = json_ais17_dump(ais, scaled, cp, end);
+	break;
+    case 18:
+	tail = json_ais18_dump(ais, scaled, cp, end);
+	break;
+    case 19:
+	tail = json_ais19_dump(ais, scaled, cp, end);
+	break;
+    case 20:
+	tail = json_ais20_dump(ais, scaled, cp, end);
+	break;
+    case 21:
+	tail = json_ais21_dump(ais, scaled, cp, end);
+	break;
+    case 23:
+	tail = json_ais23_dump(ais, scaled, cp, end);
+	break;
+    case 25:
+	tail = json_ais25_dump(ais, scaled, cp, end);
+	break;
+    case 26:
+	tail = json_ais26_dump(ais, scaled, cp, end);
+	break;
+    case 27:
+	tail = json_ais27_dump(ais, scaled, cp, end);
+	break;
+    }
+    if (tail != NULL) {
+	*tail = '\0';
+	return;
+    }
+
+    switch (ais->type) {
     case 6:			/* Binary Message */
-	(void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-		       "\"seqno\":%u,\"dest_mmsi\":%u,"
-		       "\"retransmit\":%s,\"dac\":%u,\"fid\":%u,",
-		       ais->type6.seqno,
-		       ais->type6.dest_mmsi,
-		       JSON_BOOL(ais->type6.retransmit),
-		       ais->type6.dac,
-		       ais->type6.fid);
+	cp = json_put_uint(cp, end, "\"seqno\":", ais->type6.seqno);
+	cp = json_put_uint(cp, end, ",\"dest_mmsi\":", ais->type6.dest_mmsi);
+	cp = json_put_bool(cp, end, ",\"retransmit\":", ais->type6.retransmit);
+	cp = json_put_uint(cp, end, ",\"dac\":", ais->type6.dac);
+	cp = json_put_uint(cp, end, ",\"fid\":", ais->type6.fid);
+	cp = json_put_raw(cp, end, ",");
 	imo = false;
-	if (ais->type6.dac == 1)
+	if (ais->type6.dac == 1 && !ais->type6.raw)
 	    switch (ais->type6.fid) {
 	    case 12:	/* IMO236 -Dangerous cargo indication */
 		/* some fields have beem merged to an ISO8601 partial date */
-		(void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-			       "\"lastport\":\"%s\",\"departure\":\"%02u-%02uT%02u:%02uZ\","
-			       "\"nextport\":\"%s\",\"eta\":\"%02u-%02uT%02u:%02uZ\","
-			       "\"dangerous\":\"%s\",\"imdcat\":\"%s\","
-			       "\"unid\":%u,\"amount\":%u,\"unit\":%u}\r\n",
-			       ais->type6.dac1fid12.lastport,
-			       ais->type6.dac1fid12.lmonth,
-			       ais->type6.dac1fid12.lday,
-			       ais->type6.dac1fid12.lhour,
-			       ais->type6.dac1fid12.lminute,
-			       ais->type6.dac1fid12.nextport,
-			       ais->type6.dac1fid12.nmonth,
-			       ais->type6.dac1fid12.nday,
-			       ais->type6.dac1fid12.nhour,
-			       ais->type6.dac1fid12.nminute,
-			       ais->type6.dac1fid12.dangerous,
-			       ais->type6.dac1fid12.imdcat,
-			       ais->type6.dac1fid12.unid,
-			       ais->type6.dac1fid12.amount,
-			       ais->type6.dac1fid12.unit);
+		cp = json_put_string(cp, end, "\"lastport\":",
+				     ais->type6.dac1fid12.lastport);
+		cp = json_put_eta(cp, end, ",\"departure\":",
+				  ais->type6.dac1fid12.lmonth,
+				  ais->type6.dac1fid12.lday,
+				  ais->type6.dac1fid12.lhour,
+				  ais->type6.dac1fid12.lminute);
+		cp = json_put_string(cp, end, ",\"nextport\":",
+				     ais->type6.dac1fid12.nextport);
+		cp = json_put_eta(cp, end, ",\"eta\":",
+				  ais->type6.dac1fid12.nmonth,
+				  ais->type6.dac1fid12.nday,
+				  ais->type6.dac1fid12.nhour,
+				  ais->type6.dac1fid12.nminute);
+		cp = json_put_string(cp, end, ",\"dangerous\":",
+				     ais->type6.dac1fid12.dangerous);
+		cp = json_put_string(cp, end, ",\"imdcat\":",
+				     ais->type6.dac1fid12.imdcat);
+		cp = json_put_uint(cp, end, ",\"unid\":",
+				   ais->type6.dac1fid12.unid);
+		cp = json_put_uint(cp, end, ",\"amount\":",
+				   ais->type6.dac1fid12.amount);
+		cp = json_put_uint(cp, end, ",\"unit\":",
+				   ais->type6.dac1fid12.unit);
+		cp = json_put_raw(cp, end, "}\r\n");
 		break;
 	    case 15:	/* IMO236 - Extended Ship Static and Voyage Related Data */
-		(void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-		    "\"airdraught\":%u}\r\n",
-		    ais->type6.dac1fid15.airdraught);
+		cp = json_put_uint(cp, end, "\"airdraught\":",
+				   ais->type6.dac1fid15.airdraught);
+		cp = json_put_raw(cp, end, "}\r\n");
 		break;
 	    case 16:	/* IMO236 - Number of persons on board */
-		(void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-			       "\"persons\":%u}\t\n", ais->type6.dac1fid16.persons);
+		cp = json_put_uint(cp, end, "\"persons\":",
+				   ais->type6.dac1fid16.persons);
+		cp = json_put_raw(cp, end, "}\t\n");
 		imo = true;
 		break;
 	    case 18:	/* IMO289 - Clearance time to enter port */
-		(void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-			       "\"linkage\":%u,\"arrival\":\"%u-%uT%u:%uZ\",\"portname\":\"%s\",\"destination\":\"%s\",",
-			       ais->type6.dac1fid18.linkage,
-			       ais->type6.dac1fid18.month,
-			       ais->type6.dac1fid18.day,
-				   ais->type6.dac1fid18.hour,
-			       ais->type6.dac1fid18.minute,
-			       ais->type6.dac1fid18.portname,
-			       ais->type6.dac1fid18.destination);
-		if (scaled)
-		    (void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-				   "\"lon\":%.3f,\"lat\":%.3f}\r\n",
-				   ais->type6.dac1fid18.lon/AIS_LATLON3_SCALE,
-				   ais->type6.dac1fid18.lat/AIS_LATLON3_SCALE);
-		else
-		    (void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-			       "\"lon\":%d,\"lat\":%d}\r\n",
-			       ais->type6.dac1fid18.lon,
-			       ais->type6.dac1fid18.lat);
+		cp = json_put_uint(cp, end, "\"linkage\":",
+				   ais->type6.dac1fid18.linkage);
+		cp = json_put_raw(cp, end, ",\"arrival\":\"");
+		cp = json_put_digits(cp, end, ais->type6.dac1fid18.month, 1);
+		cp = json_put_raw(cp, end, "-");
+		cp = json_put_digits(cp, end, ais->type6.dac1fid18.day, 1);
+		cp = json_put_raw(cp, end, "T");
+		cp = json_put_digits(cp, end, ais->type6.dac1fid18.hour, 1);
+		cp = json_put_raw(cp, end, ":");
+		cp = json_put_digits(cp, end, ais->type6.dac1fid18.minute, 1);
+		cp = json_put_raw(cp, end, "Z\"");
+		cp = json_put_string(cp, end, ",\"portname\":",
+				     ais->type6.dac1fid18.portname);
+		cp = json_put_string(cp, end, ",\"destination\":",
+				     ais->type6.dac1fid18.destination);
+		if (scaled) {
+		    cp = json_put_real(cp, end, ",\"lon\":",
+				       ais->type6.dac1fid18.lon / AIS_LATLON3_SCALE, 3);
+		    cp = json_put_real(cp, end, ",\"lat\":",
+				       ais->type6.dac1fid18.lat / AIS_LATLON3_SCALE, 3);
+		} else {
+		    cp = json_put_int(cp, end, ",\"lon\":",
+				      ais->type6.dac1fid18.lon);
+		    cp = json_put_int(cp, end, ",\"lat\":",
+				      ais->type6.dac1fid18.lat);
+		}
+		cp = json_put_raw(cp, end, "}\r\n");
 		break;
 	    case 20:        /* IMO289 - Berthing Data */
-                (void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-			       "\"linkage\":%u,\"berth_length\":%u,"
-			       "\"position\":%u,\"arrival\":\"%u-%uT%u:%u\","
-			       "\"availability\":%u,"
-			       "\"agent\":%u,\"fuel\":%u,\"chandler\":%u,"
-			       "\"stevedore\":%u,\"electrical\":%u,"
-			       "\"water\":%u,\"customs\":%u,\"cartage\":%u,"
-			       "\"crane\":%u,\"lift\":%u,\"medical\":%u,"
-			       "\"navrepair\":%u,\"provisions\":%u,"
-			       "\"shiprepair\":%u,\"surveyor\":%u,"
-			       "\"steam\":%u,\"tugs\":%u,\"solidwaste\":%u,"
-			       "\"liquidwaste\":%u,\"hazardouswaste\":%u,"
-			       "\"ballast\":%u,\"additional\":%u,\""
-			       "\"regional1\":%u,\"regional2\":%u,"
-			       "\"future1\":%u,\"future2\":%u,"
-			       "\"berth_name\":\"%s\",",
-			       ais->type6.dac1fid20.linkage,
-			       ais->type6.dac1fid20.berth_length,
-			       ais->type6.dac1fid20.position,
-			       ais->type6.dac1fid20.month,
-			       ais->type6.dac1fid20.day,
-			       ais->type6.dac1fid20.hour,
-			       ais->type6.dac1fid20.minute,
-			       ais->type6.dac1fid20.availability,
-			       ais->type6.dac1fid20.agent,
-			       ais->type6.dac1fid20.fuel,
-			       ais->type6.dac1fid20.chandler,
-			       ais->type6.dac1fid20.stevedore,
-			       ais->type6.dac1fid20.electrical,
-			       ais->type6.dac1fid20.water,
-			       ais->type6.dac1fid20.customs,
-			       ais->type6.dac1fid20.cartage,
-			       ais->type6.dac1fid20.crane,
-			       ais->type6.dac1fid20.lift,
-			       ais->type6.dac1fid20.medical,
-			       ais->type6.dac1fid20.navrepair,
-			       ais->type6.dac1fid20.provisions,
-			       ais->type6.dac1fid20.shiprepair,
-			       ais->type6.dac1fid20.surveyor,
-			       ais->type6.dac1fid20.steam,
-			       ais->type6.dac1fid20.tugs,
-			       ais->type6.dac1fid20.solidwaste,
-			       ais->type6.dac1fid20.liquidwaste,
-			       ais->type6.dac1fid20.hazardouswaste,
-			       ais->type6.dac1fid20.ballast,
-			       ais->type6.dac1fid20.additional,
-			       ais->type6.dac1fid20.regional1,
-			       ais->type6.dac1fid20.regional2,
-			       ais->type6.dac1fid20.future1,
-			       ais->type6.dac1fid20.future2,
-			       ais->type6.dac1fid20.berth_name);
-            if (scaled)
-		(void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-			       "\"berth_lon\":%.3f,"
-			       "\"berth_lat\":%.3f,"
-			       "\"berth_depth\":%.1f}\r\n",
-			       ais->type6.dac1fid20.berth_lon / AIS_LATLON3_SCALE,
-			       ais->type6.dac1fid20.berth_lat / AIS_LATLON3_SCALE,
-			       ais->type6.dac1fid20.berth_depth * 0.1);
-            else
-                (void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-			       "\"berth_lon\":%d,"
-			       "\"berth_lat\":%d,"
-			       "\"berth_depth\":%u}\r\n",
-			       ais->type6.dac1fid20.berth_lon,
-			       ais->type6.dac1fid20.berth_lat,
-			       ais->type6.dac1fid20.berth_depth);
+		cp = json_put_uint(cp, end, "\"linkage\":",
+				   ais->type6.dac1fid20.linkage);
+		cp = json_put_uint(cp, end, ",\"berth_length\":",
+				   ais->type6.dac1fid20.berth_length);
+		cp = json_put_uint(cp, end, ",\"position\":",
+				   ais->type6.dac1fid20.position);
+		cp = json_put_raw(cp, end, ",\"arrival\":\"");
+		cp = json_put_digits(cp, end, ais->type6.dac1fid20.month, 1);
+		cp = json_put_raw(cp, end, "-");
+		cp = json_put_digits(cp, end, ais->type6.dac1fid20.day, 1);
+		cp = json_put_raw(cp, end, "T");
+		cp = json_put_digits(cp, end, ais->type6.dac1fid20.hour, 1);
+		cp = json_put_raw(cp, end, ":");
+		cp = json_put_digits(cp, end, ais->type6.dac1fid20.minute, 1);
+		cp = json_put_raw(cp, end, "\"");
+		cp = json_put_uint(cp, end, ",\"availability\":",
+				   ais->type6.dac1fid20.availability);
+		cp = json_put_uint(cp, end, ",\"agent\":",
+				   ais->type6.dac1fid20.agent);
+		cp = json_put_uint(cp, end, ",\"fuel\":",
+				   ais->type6.dac1fid20.fuel);
+		cp = json_put_uint(cp, end, ",\"chandler\":",
+				   ais->type6.dac1fid20.chandler);
+		cp = json_put_uint(cp, end, ",\"stevedore\":",
+				   ais->type6.dac1fid20.stevedore);
+		cp = json_put_uint(cp, end, ",\"electrical\":",
+				   ais->type6.dac1fid20.electrical);
+		cp = json_put_uint(cp, end, ",\"water\":",
+				   ais->type6.dac1fid20.water);
+		cp = json_put_uint(cp, end, ",\"customs\":",
+				   ais->type6.dac1fid20.customs);
+		cp = json_put_uint(cp, end, ",\"cartage\":",
+				   ais->type6.dac1fid20.cartage);
+		cp = json_put_uint(cp, end, ",\"crane\":",
+				   ais->type6.dac1fid20.crane);
+		cp = json_put_uint(cp, end, ",\"lift\":",
+				   ais->type6.dac1fid20.lift);
+		cp = json_put_uint(cp, end, ",\"medical\":",
+				   ais->type6.dac1fid20.medical);
+		cp = json_put_uint(cp, end, ",\"navrepair\":",
+				   ais->type6.dac1fid20.navrepair);
+		cp = json_put_uint(cp, end, ",\"provisions\":",
+				   ais->type6.dac1fid20.provisions);
+		cp = json_put_uint(cp, end, ",\"shiprepair\":",
+				   ais->type6.dac1fid20.shiprepair);
+		cp = json_put_uint(cp, end, ",\"surveyor\":",
+				   ais->type6.dac1fid20.surveyor);
+		cp = json_put_uint(cp, end, ",\"steam\":",
+				   ais->type6.dac1fid20.steam);
+		cp = json_put_uint(cp, end, ",\"tugs\":",
+				   ais->type6.dac1fid20.tugs);
+		cp = json_put_uint(cp, end, ",\"solidwaste\":",
+				   ais->type6.dac1fid20.solidwaste);
+		cp = json_put_uint(cp, end, ",\"liquidwaste\":",
+				   ais->type6.dac1fid20.liquidwaste);
+		cp = json_put_uint(cp, end, ",\"hazardouswaste\":",
+				   ais->type6.dac1fid20.hazardouswaste);
+		cp = json_put_uint(cp, end, ",\"ballast\":",
+				   ais->type6.dac1fid20.ballast);
+		cp = json_put_uint(cp, end, ",\"additional\":",
+				   ais->type6.dac1fid20.additional);
+		cp = json_put_uint(cp, end, ",\"\"regional1\":",
+				   ais->type6.dac1fid20.regional1);
+		cp = json_put_uint(cp, end, ",\"regional2\":",
+				   ais->type6.dac1fid20.regional2);
+		cp = json_put_uint(cp, end, ",\"future1\":",
+				   ais->type6.dac1fid20.future1);
+		cp = json_put_uint(cp, end, ",\"future2\":",
+				   ais->type6.dac1fid20.future2);
+		cp = json_put_string(cp, end, ",\"berth_name\":",
+				     ais->type6.dac1fid20.berth_name);
+		if (scaled) {
+		    cp = json_put_real(cp, end, ",\"berth_lon\":",
+				       ais->type6.dac1fid20.berth_lon / AIS_LATLON3_SCALE, 3);
+		    cp = json_put_real(cp, end, ",\"berth_lat\":",
+				       ais->type6.dac1fid20.berth_lat / AIS_LATLON3_SCALE, 3);
+		    cp = json_put_real(cp, end, ",\"berth_depth\":",
+				       ais->type6.dac1fid20.berth_depth * 0.1, 1);
+		} else {
+		    cp = json_put_int(cp, end, ",\"berth_lon\":",
+				      ais->type6.dac1fid20.berth_lon);
+		    cp = json_put_int(cp, end, ",\"berth_lat\":",
+				      ais->type6.dac1fid20.berth_lat);
+		    cp = json_put_uint(cp, end, ",\"berth_depth\":",
+				       ais->type6.dac1fid20.berth_depth);
+		}
+		cp = json_put_raw(cp, end, "}\r\n");
 		break;
 	    case 23:    /* IMO289 - Area notice - addressed */
 		break;
 	    case 25:	/* IMO289 - Dangerous cargo indication */
-		(void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-			       "\"unit\":%u,\"amount\":%u,\"cargos\":[",
-			       ais->type6.dac1fid25.unit,
-			       ais->type6.dac1fid25.amount);
-		for (i = 0; i < (int)ais->type6.dac1fid25.ncargos; i++)
-		    (void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-				   "{\"code\":%u,\"subtype\":%u},",
-
-				   ais->type6.dac1fid25.cargos[i].code,
-				   ais->type6.dac1fid25.cargos[i].subtype);
-		if (buf[strlen(buf) - 1] == ',')
-		    buf[strlen(buf) - 1] = '\0';
-		(void)strlcat(buf, "]}\r\n,", buflen - strlen(buf));
+		cp = json_put_uint(cp, end, "\"unit\":",
+				   ais->type6.dac1fid25.unit);
+		cp = json_put_uint(cp, end, ",\"amount\":",
+				   ais->type6.dac1fid25.amount);
+		cp = json_put_raw(cp, end, ",\"cargos\":[");
+		for (i = 0; i < (int)ais->type6.dac1fid25.ncargos; i++) {
+		    cp = json_put_uint(cp, end, "{\"code\":",
+				       ais->type6.dac1fid25.cargos[i].code);
+		    cp = json_put_uint(cp, end, ",\"subtype\":",
+				       ais->type6.dac1fid25.cargos[i].subtype);
+		    cp = json_put_raw(cp, end, "},");
+		}
+		if (cp[-1] == ',')
+		    cp--;
+		cp = json_put_raw(cp, end, "]}\r\n,");
 		break;
 	    case 28:	/* IMO289 - Route info - addressed */
-		(void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-		    "\"linkage\":%u,\"sender\":%u,",
-		    ais->type6.dac1fid28.linkage,
-		    ais->type6.dac1fid28.sender);
+		cp = json_put_uint(cp, end, "\"linkage\":",
+				   ais->type6.dac1fid28.linkage);
+		cp = json_put_uint(cp, end, ",\"sender\":",
+				   ais->type6.dac1fid28.sender);
 		if (scaled)
-		    (void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-				   "\"rtype\":\"%s\",",
-				   route_type[ais->type6.dac1fid28.rtype]);
+		    cp = json_put_string(cp, end, ",\"rtype\":",
+					 route_type[ais->type6.dac1fid28.rtype]);
 		else
-		    (void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-			"\"rtype\":%u,",
-			ais->type6.dac1fid28.rtype);
-		(void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-		    "\"start\":\"%02u-%02uT%02u:%02uZ\",\"duration\":%u,\"waypoints:[",
-		    ais->type6.dac1fid28.month,
-		    ais->type6.dac1fid28.day,
-		    ais->type6.dac1fid28.hour,
-		    ais->type6.dac1fid28.minute,
-		    ais->type6.dac1fid28.duration);
+		    cp = json_put_uint(cp, end, ",\"rtype\":",
+				       ais->type6.dac1fid28.rtype);
+		cp = json_put_eta(cp, end, ",\"start\":",
+				  ais->type6.dac1fid28.month,
+				  ais->type6.dac1fid28.day,
+				  ais->type6.dac1fid28.hour,
+				  ais->type6.dac1fid28.minute);
+		cp = json_put_uint(cp, end, ",\"duration\":",
+				   ais->type6.dac1fid28.duration);
+		cp = json_put_raw(cp, end, ",\"waypoints:[");
 		for (i = 0; i < ais->type6.dac1fid28.waycount; i++) {
-		    if (scaled)
-			(void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-			    "{\"lon\":%.4f,\"lat\":%.4f},",
-			    ais->type6.dac1fid28.waypoints[i].lon / AIS_LATLON4_SCALE,
-			    ais->type6.dac1fid28.waypoints[i].lat / AIS_LATLON4_SCALE);
-		    else
-			(void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-			    "{\"lon\":%d,\"lat\":%d},",
-			    ais->type6.dac1fid28.waypoints[i].lon,
-			    ais->type6.dac1fid28.waypoints[i].lat);
+		    if (scaled) {
+			cp = json_put_real(cp, end, "{\"lon\":",
+					   ais->type6.dac1fid28.waypoints[i].lon / AIS_LATLON4_SCALE, 4);
+			cp = json_put_real(cp, end, ",\"lat\":",
+					   ais->type6.dac1fid28.waypoints[i].lat / AIS_LATLON4_SCALE, 4);
+		    } else {
+			cp = json_put_int(cp, end, "{\"lon\":",
+					  ais->type6.dac1fid28.waypoints[i].lon);
+			cp = json_put_int(cp, end, ",\"lat\":",
+					  ais->type6.dac1fid28.waypoints[i].lat);
+		    }
+		    cp = json_put_raw(cp, end, "},");
 		}
-		if (buf[strlen(buf) - 1] == ',')
-		    buf[strlen(buf)-1] = '\0';
-		(void)strlcat(buf, "]}\r\n,", buflen - strlen(buf));
+		if (cp[-1] == ',')
+		    cp--;
+		cp = json_put_raw(cp, end, "]}\r\n,");
 		break;
 	    case 30:	/* IMO289 - Text description - addressed */
-		(void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-		       "\"linkage\":%u,\"text\":\"%s\"}\r\n",
-		       ais->type6.dac1fid30.linkage,
-		       json_stringify(buf1, sizeof(buf1), 
-				      ais->type6.dac1fid30.text));
+		cp = json_put_uint(cp, end, "\"linkage\":",
+				   ais->type6.dac1fid30.linkage);
+		cp = json_put_string(cp, end, ",\"text\":",
+				     ais->type6.dac1fid30.text);
+		cp = json_put_raw(cp, end, "}\r\n");
 		break;
 	    case 14:	/* IMO236 - Tidal Window */
 	    case 32:	/* IMO289 - Tidal Window */
-	      (void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-		  "\"month\":%u,\"day\":%u,\"tidals\":[",
-		  ais->type6.dac1fid32.month,
-		  ais->type6.dac1fid32.day);
-	      for (i = 0; i < ais->type6.dac1fid32.ntidals; i++) {
-		  const struct tidal_t *tp =  &ais->type6.dac1fid32.tidals[i];
-		  if (scaled)
-		      (void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-			  "{\"lon\":%.3f,\"lat\":%.3f,",
-			  tp->lon / AIS_LATLON3_SCALE,
-			  tp->lat / AIS_LATLON3_SCALE);
-		  else
-		      (void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-			  "{\"lon\":%d,\"lat\":%d,",
-			  tp->lon,
-			  tp->lat);
-		  (void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-		      "\"from_hour\":%u,\"from_min\":%u,\"to_hour\":%u,\"to_min\":%u,\"cdir\":%u",
-		      tp->from_hour,
-		      tp->from_min,
-		      tp->to_hour,
-		      tp->to_min,
-		      tp->cdir);
-		  if (scaled)
-		      (void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-			  "\"cspeed\":%.1f},",
-			  tp->cspeed / 10.0);
-		  else
-		      (void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-			  "\"cspeed\":%u},",
-			  tp->cspeed);
-	      }
-	      if (buf[strlen(buf) - 1] == ',')
-		  buf[strlen(buf)-1] = '\0';
-	      (void)strlcat(buf, "]}\r\n,", buflen - strlen(buf));
-	      break;
+		cp = json_put_uint(cp, end, "\"month\":",
+				   ais->type6.dac1fid32.month);
+		cp = json_put_uint(cp, end, ",\"day\":",
+				   ais->type6.dac1fid32.day);
+		cp = json_put_raw(cp, end, ",\"tidals\":[");
+		for (i = 0; i < ais->type6.dac1fid32.ntidals; i++) {
+		    const struct tidal_t *tp = &ais->type6.dac1fid32.tidals[i];
+		    if (scaled) {
+			cp = json_put_real(cp, end, "{\"lon\":",
+					   tp->lon / AIS_LATLON3_SCALE, 3);
+			cp = json_put_real(cp, end, ",\"lat\":",
+					   tp->lat / AIS_LATLON3_SCALE, 3);
+		    } else {
+			cp = json_put_int(cp, end, "{\"lon\":", tp->lon);
+			cp = json_put_int(cp, end, ",\"lat\":", tp->lat);
+		    }
+		    cp = json_put_uint(cp, end, ",\"from_hour\":", tp->from_hour);
+		    cp = json_put_uint(cp, end, ",\"from_min\":", tp->from_min);
+		    cp = json_put_uint(cp, end, ",\"to_hour\":", tp->to_hour);
+		    cp = json_put_uint(cp, end, ",\"to_min\":", tp->to_min);
+		    cp = json_put_uint(cp, end, ",\"cdir\":", tp->cdir);
+		    if (scaled)
+			cp = json_put_real(cp, end, "\"cspeed\":",
+					   tp->cspeed / 10.0, 1);
+		    else
+			cp = json_put_uint(cp, end, "\"cspeed\":", tp->cspeed);
+		    cp = json_put_raw(cp, end, "},");
+		}
+		if (cp[-1] == ',')
+		    cp--;
+		cp = json_put_raw(cp, end, "]}\r\n,");
+		break;
 	    }
-	if (!imo)
-	    (void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-			   "\"data\":\"%zd:%s\"}\r\n",
-			   ais->type6.bitcount,
-			   gpsd_hexdump((char *)ais->type6.bitdata,
-					(ais->type6.bitcount + 7) / 8));
-	break;
-    case 7:			/* Binary Acknowledge */
-    case 13:			/* Safety Related Acknowledge */
-	(void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-		       "\"mmsi1\":%u,\"mmsi2\":%u,\"mmsi3\":%u,\"mmsi4\":%u}\r\n",
-		       ais->type7.mmsi1,
-		       ais->type7.mmsi2, ais->type7.mmsi3, ais->type7.mmsi4);
+	if (!imo) {
+	    cp = AIS_PUT_DATA(cp, end, "\"data\":", ais->type6);
+	    cp = json_put_raw(cp, end, "}\r\n");
+	}
 	break;
     case 8:			/* Binary Broadcast Message */
 	imo = false;
-	(void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-		       "\"dac\":%u,\"fid\":%u,",ais->type8.dac,ais->type8.fid);
-	if (ais->type8.dac == 1) {
-	    const char *trends[] = {
-		"steaady",
-		"increasing"
-		"decreasing",
-		"N/A",
-	    };
+	cp = json_put_uint(cp, end, "\"dac\":", ais->type8.dac);
+	cp = json_put_uint(cp, end, ",\"fid\":", ais->type8.fid);
+	cp = json_put_raw(cp, end, ",");
+	if (ais->type8.dac == 1 && !ais->type8.raw) {
 	    switch (ais->type8.fid) {
 	    case 11:        /* IMO236 - Meteorological/Hydrological data */
 	    case 31:        /* IMO289 - Meteorological/Hydrological data */
 		/* some fields have beem merged to an ISO8601 partial date */
 		/* layout is almost identical to FID=31 from IMO289 */
-		if (scaled)
-		    (void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-				   "{\"lat\":%.3f,\"lon\":%.3f,",
-				   ais->type8.dac1fid31.lat / AIS_LATLON3_SCALE,
-				   ais->type8.dac1fid31.lon / AIS_LATLON3_SCALE);
-		else
-		    (void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-				   "{\"lat\":%d,\"lon\":%d,",
-				   ais->type8.dac1fid31.lat,
-				   ais->type8.dac1fid31.lon);
+		if (scaled) {
+		    cp = json_put_real(cp, end, "{\"lat\":",
+				       ais->type8.dac1fid31.lat / AIS_LATLON3_SCALE, 3);
+		    cp = json_put_real(cp, end, ",\"lon\":",
+				       ais->type8.dac1fid31.lon / AIS_LATLON3_SCALE, 3);
+		} else {
+		    cp = json_put_int(cp, end, "{\"lat\":",
+				      ais->type8.dac1fid31.lat);
+		    cp = json_put_int(cp, end, ",\"lon\":",
+				      ais->type8.dac1fid31.lon);
+		}
+		cp = json_put_raw(cp, end, ",");
 		if (ais->type8.fid == 31)
-		    (void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-				   "\"accuracy\":%s,",
-				   JSON_BOOL(ais->type8.dac1fid31.accuracy));
-		(void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-			       "\"timestamp\":\"%02uT%02u:%02uZ\","
-			       "\"wapeed\":%u,\"wgust\":%u,\"wdir\":%u,"
-			       "\"wgustdir\":%u,\"humidity\":%u",
-			       ais->type8.dac1fid31.day,
-			       ais->type8.dac1fid31.hour,
-			       ais->type8.dac1fid31.minute,
-			       ais->type8.dac1fid31.wspeed,
-			       ais->type8.dac1fid31.wgust,
-			       ais->type8.dac1fid31.wdir,
-			       ais->type8.dac1fid31.wgustdir,
-			       ais->type8.dac1fid31.humidity);
-		if (scaled)
-		    (void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-				   "\"airtemp\":%1f,\"dewpoint\":%1f,"
-				   "\"pressure\":%u,\"pressuretend\":\"%s\",",
-				   ais->type8.dac1fid31.airtemp * 0.1,
-				   ais->type8.dac1fid31.dewpoint * 0.1,
-				   ais->type8.dac1fid31.pressure,
-				   trends[ais->type8.dac1fid31.pressuretend]);
-		else
-		    (void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-				   "\"airtemp\":%d,\"dewpoint\":%d,"
-				   "\"pressure\":%u,\"pressuretend\":%u,"
-				   "\"visgreater\":%s,",
-				   ais->type8.dac1fid31.airtemp,
-				   ais->type8.dac1fid31.dewpoint,
-				   ais->type8.dac1fid31.pressure,
-				   ais->type8.dac1fid31.pressuretend,
-				   JSON_BOOL(ais->type8.dac1fid31.visgreater));
+		    cp = json_put_raw(json_put_bool(cp, end, "\"accuracy\":",
+						    ais->type8.dac1fid31.accuracy),
+				      end, ",");
+		cp = json_put_raw(cp, end, "\"timestamp\":\"");
+		cp = json_put_digits(cp, end, ais->type8.dac1fid31.day, 2);
+		cp = json_put_digits(json_put_raw(cp, end, "T"), end,
+				     ais->type8.dac1fid31.hour, 2);
+		cp = json_put_digits(json_put_raw(cp, end, ":"), end,
+				     ais->type8.dac1fid31.minute, 2);
+		cp = json_put_raw(cp, end, "Z\"");
+		cp = json_put_uint(cp, end, ",\"wapeed\":",
+				   ais->type8.dac1fid31.wspeed);
+		cp = json_put_uint(cp, end, ",\"wgust\":",
+				   ais->type8.dac1fid31.wgust);
+		cp = json_put_uint(cp, end, ",\"wdir\":",
+				   ais->type8.dac1fid31.wdir);
+		cp = json_put_uint(cp, end, ",\"wgustdir\":",
+				   ais->type8.dac1fid31.wgustdir);
+		cp = json_put_uint(cp, end, ",\"humidity\":",
+				   ais->type8.dac1fid31.humidity);
+		if (scaled) {
+		    cp = json_put_real(cp, end, "\"airtemp\":",
+				       ais->type8.dac1fid31.airtemp * 0.1, 6);
+		    cp = json_put_real(cp, end, ",\"dewpoint\":",
+				       ais->type8.dac1fid31.dewpoint * 0.1, 6);
+		    cp = json_put_uint(cp, end, ",\"pressure\":",
+				       ais->type8.dac1fid31.pressure);
+		    cp = json_put_string(cp, end, ",\"pressuretend\":",
+					 trends[ais->type8.dac1fid31.pressuretend]);
+		    cp = json_put_raw(cp, end, ",");
+		} else {
+		    cp = json_put_int(cp, end, "\"airtemp\":",
+				      ais->type8.dac1fid31.airtemp);
+		    cp = json_put_int(cp, end, ",\"dewpoint\":",
+				      ais->type8.dac1fid31.dewpoint);
+		    cp = json_put_uint(cp, end, ",\"pressure\":",
+				       ais->type8.dac1fid31.pressure);
+		    cp = json_put_uint(cp, end, ",\"pressuretend\":",
+				       ais->type8.dac1fid31.pressuretend);
+		    cp = json_put_bool(cp, end, ",\"visgreater\":",
+				       ais->type8.dac1fid31.visgreater);
+		    cp = json_put_raw(cp, end, ",");
+		}
 
 		if (scaled)
-		    (void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-				   "\"visibility\":%1f,",
-				   ais->type8.dac1fid31.visibility * 0.1);
+		    cp = json_put_raw(json_put_real(cp, end, "\"visibility\":",
+						    ais->type8.dac1fid31.visibility * 0.1, 6),
+				      end, ",");
 		else
-		    (void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-				   "\"visibility\":%u,:",
-				   ais->type8.dac1fid31.visibility);
+		    cp = json_put_raw(json_put_uint(cp, end, "\"visibility\":",
+						    ais->type8.dac1fid31.visibility),
+				      end, ",:");
 		if (!scaled)
-		    (void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-				   "\"waterlevel\":%d,",
-				   ais->type8.dac1fid31.waterlevel);
+		    cp = json_put_raw(json_put_int(cp, end, "\"waterlevel\":",
+						   ais->type8.dac1fid31.waterlevel),
+				      end, ",");
 		else if (ais->type8.fid == 31)
-		    (void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-				   "\"waterlevel\":%.1f,:",
-				   ais->type8.dac1fid31.waterlevel * 0.01);
+		    cp = json_put_raw(json_put_real(cp, end, "\"waterlevel\":",
+						    ais->type8.dac1fid31.waterlevel * 0.01, 1),
+				      end, ",:");
 		else
-		    (void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-				   "\"waterlevel\":%.1f,:",
-				   ais->type8.dac1fid31.waterlevel * 0.1);
+		    cp = json_put_raw(json_put_real(cp, end, "\"waterlevel\":",
+						    ais->type8.dac1fid31.waterlevel * 0.1, 1),
+				      end, ",:");
 
 		if (scaled) {
-		    const char *preciptypes[] = {
-			"rain",
-			"thunderstorm",
-			"freezing rain",
-			"mixed/ice",
-			"snow",
-			"reserved",
-			"reserved",
-			"N/A",
-		    };
-		    (void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-				   "\"leveltrend\":\"%s\","
-				   "\"cspeed\":%.1f,\"cdir\":%u"
-				   "\"cspeed2\":%.1f,\"cdir2\":%u,\"cdepth2\":%u,"
-				   "\"cspeed3\":%.1f,\"cdir3\":%u,\"cdepth3\":%u,"
-				   "\"waveheight\":%.1f,\"waveperiod\":%u,\"wavedir\":%u,"
-				   "\"swellheight\":%.1f,\"swellperiod\":%u,\"swelldir\":%u,"
-				   "\"seastate\":%u,\"watertemp\":%.1f,"
-				   "\"preciptype\":%s,\"salinity\":%.1f,\"ice\":%s",
-				   trends[ais->type8.dac1fid31.leveltrend],
-				   ais->type8.dac1fid31.cspeed * 0.1,
-				   ais->type8.dac1fid31.cdir,
-				   ais->type8.dac1fid31.cspeed2 * 0.1,
-				   ais->type8.dac1fid31.cdir2,
-				   ais->type8.dac1fid31.cdepth2,
-				   ais->type8.dac1fid31.cspeed3 * 0.1,
-				   ais->type8.dac1fid31.cdir3,
-				   ais->type8.dac1fid31.cdepth3,
-				   ais->type8.dac1fid31.waveheight * 0.1,
-				   ais->type8.dac1fid31.waveperiod,
-				   ais->type8.dac1fid31.wavedir,
-				   ais->type8.dac1fid31.swellheight * 0.1,
-				   ais->type8.dac1fid31.swellperiod,
-				   ais->type8.dac1fid31.swelldir,
-				   ais->type8.dac1fid31.seastate,
-				   ais->type8.dac1fid31.watertemp * 0.1,
-				   preciptypes[ais->type8.dac1fid31.preciptype],
-				   ais->type8.dac1fid31.salinity * 0.1,
-				   JSON_BOOL(ais->type8.dac1fid31.ice));
-		} else
-		    (void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-				   "\"leveltrend\":%u,"
-				   "\"cspeed\":%u,\"cdir\":%u"
-				   "\"cspeed2\":%u,\"cdir2\":%u,\"cdepth2\":%u,"
-				   "\"cspeed3\":%u,\"cdir3\":%u,\"cdepth3\":%u,"
-				   "\"waveheight\":%u,\"waveperiod\":%u,\"wavedir\":%u,"
-				   "\"swellheight\":%u,\"swellperiod\":%u,\"swelldir\":%u,"
-				   "\"seastate\":%u,\"watertemp\":%d,"
-				   "\"preciptype\":%u,\"salinity\":%u,\"ice\":%s",
-				   ais->type8.dac1fid31.leveltrend,
-				   ais->type8.dac1fid31.cspeed,
-				   ais->type8.dac1fid31.cdir,
-				   ais->type8.dac1fid31.cspeed2,
-				   ais->type8.dac1fid31.cdir2,
-				   ais->type8.dac1fid31.cdepth2,
-				   ais->type8.dac1fid31.cspeed3,
-				   ais->type8.dac1fid31.cdir3,
-				   ais->type8.dac1fid31.cdepth3,
-				   ais->type8.dac1fid31.waveheight,
-				   ais->type8.dac1fid31.waveperiod,
-				   ais->type8.dac1fid31.wavedir,
-				   ais->type8.dac1fid31.swellheight,
-				   ais->type8.dac1fid31.swellperiod,
-				   ais->type8.dac1fid31.swelldir,
-				   ais->type8.dac1fid31.seastate,
-				   ais->type8.dac1fid31.watertemp,
-				   ais->type8.dac1fid31.preciptype,
-				   ais->type8.dac1fid31.salinity,
-				   JSON_BOOL(ais->type8.dac1fid31.ice));
-		(void)strlcat(buf, "}\r\n", buflen - strlen(buf));
+		    cp = json_put_string(cp, end, "\"leveltrend\":",
+					 trends[ais->type8.dac1fid31.leveltrend]);
+		    cp = json_put_real(cp, end, ",\"cspeed\":",
+				       ais->type8.dac1fid31.cspeed * 0.1, 1);
+		    cp = json_put_uint(cp, end, ",\"cdir\":",
+				       ais->type8.dac1fid31.cdir);
+		    cp = json_put_real(cp, end, "\"cspeed2\":",
+				       ais->type8.dac1fid31.cspeed2 * 0.1, 1);
+		    cp = json_put_uint(cp, end, ",\"cdir2\":",
+				       ais->type8.dac1fid31.cdir2);
+		    cp = json_put_uint(cp, end, ",\"cdepth2\":",
+				       ais->type8.dac1fid31.cdepth2);
+		    cp = json_put_real(cp, end, ",\"cspeed3\":",
+				       ais->type8.dac1fid31.cspeed3 * 0.1, 1);
+		    cp = json_put_uint(cp, end, ",\"cdir3\":",
+				       ais->type8.dac1fid31.cdir3);
+		    cp = json_put_uint(cp, end, ",\"cdepth3\":",
+				       ais->type8.dac1fid31.cdepth3);
+		    cp = json_put_real(cp, end, ",\"waveheight\":",
+				       ais->type8.dac1fid31.waveheight * 0.1, 1);
+		    cp = json_put_uint(cp, end, ",\"waveperiod\":",
+				       ais->type8.dac1fid31.waveperiod);
+		    cp = json_put_uint(cp, end, ",\"wavedir\":",
+				       ais->type8.dac1fid31.wavedir);
+		    cp = json_put_real(cp, end, ",\"swellheight\":",
+				       ais->type8.dac1fid31.swellheight * 0.1, 1);
+		    cp = json_put_uint(cp, end, ",\"swellperiod\":",
+				       ais->type8.dac1fid31.swellperiod);
+		    cp = json_put_uint(cp, end, ",\"swelldir\":",
+				       ais->type8.dac1fid31.swelldir);
+		    cp = json_put_uint(cp, end, ",\"seastate\":",
+				       ais->type8.dac1fid31.seastate);
+		    cp = json_put_real(cp, end, ",\"watertemp\":",
+				       ais->type8.dac1fid31.watertemp * 0.1, 1);
+		    cp = json_put_raw(cp, end, ",\"preciptype\":");
+		    cp = json_put_raw(cp, end,
+				      preciptypes[ais->type8.dac1fid31.preciptype]);
+		    cp = json_put_real(cp, end, ",\"salinity\":",
+				       ais->type8.dac1fid31.salinity * 0.1, 1);
+		} else {
+		    cp = json_put_uint(cp, end, "\"leveltrend\":",
+				       ais->type8.dac1fid31.leveltrend);
+		    cp = json_put_uint(cp, end, ",\"cspeed\":",
+				       ais->type8.dac1fid31.cspeed);
+		    cp = json_put_uint(cp, end, ",\"cdir\":",
+				       ais->type8.dac1fid31.cdir);
+		    cp = json_put_uint(cp, end, "\"cspeed2\":",
+				       ais->type8.dac1fid31.cspeed2);
+		    cp = json_put_uint(cp, end, ",\"cdir2\":",
+				       ais->type8.dac1fid31.cdir2);
+		    cp = json_put_uint(cp, end, ",\"cdepth2\":",
+				       ais->type8.dac1fid31.cdepth2);
+		    cp = json_put_uint(cp, end, ",\"cspeed3\":",
+				       ais->type8.dac1fid31.cspeed3);
+		    cp = json_put_uint(cp, end, ",\"cdir3\":",
+				       ais->type8.dac1fid31.cdir3);
+		    cp = json_put_uint(cp, end, ",\"cdepth3\":",
+				       ais->type8.dac1fid31.cdepth3);
+		    cp = json_put_uint(cp, end, ",\"waveheight\":",
+				       ais->type8.dac1fid31.waveheight);
+		    cp = json_put_uint(cp, end, ",\"waveperiod\":",
+				       ais->type8.dac1fid31.waveperiod);
+		    cp = json_put_uint(cp, end, ",\"wavedir\":",
+				       ais->type8.dac1fid31.wavedir);
+		    cp = json_put_uint(cp, end, ",\"swellheight\":",
+				       ais->type8.dac1fid31.swellheight);
+		    cp = json_put_uint(cp, end, ",\"swellperiod\":",
+				       ais->type8.dac1fid31.swellperiod);
+		    cp = json_put_uint(cp, end, ",\"swelldir\":",
+				       ais->type8.dac1fid31.swelldir);
+		    cp = json_put_uint(cp, end, ",\"seastate\":",
+				       ais->type8.dac1fid31.seastate);
+		    cp = json_put_int(cp, end, ",\"watertemp\":",
+				      ais->type8.dac1fid31.watertemp);
+		    cp = json_put_uint(cp, end, ",\"preciptype\":",
+				       ais->type8.dac1fid31.preciptype);
+		    cp = json_put_uint(cp, end, ",\"salinity\":",
+				       ais->type8.dac1fid31.salinity);
+		}
+		cp = json_put_bool(cp, end, ",\"ice\":",
+				   ais->type8.dac1fid31.ice);
+		cp = json_put_raw(cp, end, "}\r\n");
 		imo = true;
 		break;
 	    case 13:        /* IMO236 - Fairway closed */
-		(void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-			       "\"reason\":\"%s\",\"closefrom\":\"%s\","
-			       "\"closeto\":\"%s\",\"radius\":%u,"
-			       "\"extunit\":%u,"
-			       "\"from\":\"%02u-%02uT%02u:%02u\","
-			       "\"to\":\"%02u-%02uT%02u:%02u\"}\r\n",
-			       ais->type8.dac1fid13.reason,
-			       ais->type8.dac1fid13.closefrom,
-			       ais->type8.dac1fid13.closeto,
-			       ais->type8.dac1fid13.radius,
-			       ais->type8.dac1fid13.extunit,
-			       ais->type8.dac1fid13.fmonth,
-			       ais->type8.dac1fid13.fday,
-			       ais->type8.dac1fid13.fhour,
-			       ais->type8.dac1fid13.fminute,
-			       ais->type8.dac1fid13.tmonth,
-			       ais->type8.dac1fid13.tday,
-			       ais->type8.dac1fid13.thour,
-			       ais->type8.dac1fid13.tminute);
+		cp = json_put_string(cp, end, "\"reason\":",
+				     ais->type8.dac1fid13.reason);
+		cp = json_put_string(cp, end, ",\"closefrom\":",
+				     ais->type8.dac1fid13.closefrom);
+		cp = json_put_string(cp, end, ",\"closeto\":",
+				     ais->type8.dac1fid13.closeto);
+		cp = json_put_uint(cp, end, ",\"radius\":",
+				   ais->type8.dac1fid13.radius);
+		cp = json_put_uint(cp, end, ",\"extunit\":",
+				   ais->type8.dac1fid13.extunit);
+		cp = json_put_raw(cp, end, ",\"from\":\"");
+		cp = json_put_dayhm(cp, end,
+				    ais->type8.dac1fid13.fmonth,
+				    ais->type8.dac1fid13.fday,
+				    ais->type8.dac1fid13.fhour,
+				    ais->type8.dac1fid13.fminute);
+		cp = json_put_raw(cp, end, "\",\"to\":\"");
+		cp = json_put_dayhm(cp, end,
+				    ais->type8.dac1fid13.tmonth,
+				    ais->type8.dac1fid13.tday,
+				    ais->type8.dac1fid13.thour,
+				    ais->type8.dac1fid13.tminute);
+		cp = json_put_raw(cp, end, "\"}\r\n");
 		break;
 	    case 15:        /* IMO236 - Extended ship and voyage */
-		(void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-			       "\"airdraught\":%u}\r\n",
-			       ais->type8.dac1fid15.airdraught);
+		cp = json_put_uint(cp, end, "\"airdraught\":",
+				   ais->type8.dac1fid15.airdraught);
+		cp = json_put_raw(cp, end, "}\r\n");
 		break;
 	    case 17:        /* IMO289 - VTS-generated/synthetic targets */
-		(void)strlcat(buf, "\"targets\":[", buflen - strlen(buf));
+		cp = json_put_raw(cp, end, "\"targets\":[");
 		for (i = 0; i < ais->type8.dac1fid17.ntargets; i++) {
+		    const struct target_t *tp = &ais->type8.dac1fid17.targets[i];
+
 		    if (scaled)
-			(void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-			    "{\"idtype\":\"%s\",",
-			    idtypes[ais->type8.dac1fid17.targets[i].idtype]);
+			cp = json_put_string(cp, end, "{\"idtype\":",
+					     idtypes[tp->idtype]);
 		    else
-			(void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-			    "{\"idtype\":%u,",
-			    ais->type8.dac1fid17.targets[i].idtype);
-		    switch (ais->type8.dac1fid17.targets[i].idtype) {
+			cp = json_put_uint(cp, end, "{\"idtype\":",
+					   tp->idtype);
+		    cp = json_put_raw(cp, end, ",\"");
+		    cp = json_put_raw(cp, end, idtypes[tp->idtype]);
+		    cp = json_put_raw(cp, end, "\":");
+		    switch (tp->idtype) {
 		    case DAC1FID17_IDTYPE_MMSI:
-			(void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-			    "\"%s\":\"%u\",",
-			    idtypes[ais->type8.dac1fid17.targets[i].idtype],
-			    ais->type8.dac1fid17.targets[i].id.mmsi);
+			cp = json_put_raw(cp, end, "\"");
+			cp = json_put_digits(cp, end, tp->id.mmsi, 1);
+			cp = json_put_raw(cp, end, "\"");
 			break;
 		    case DAC1FID17_IDTYPE_IMO:
-			(void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-			    "\"%s\":\"%u\",",
-			    idtypes[ais->type8.dac1fid17.targets[i].idtype],
-			    ais->type8.dac1fid17.targets[i].id.imo);
+			cp = json_put_raw(cp, end, "\"");
+			cp = json_put_digits(cp, end, tp->id.imo, 1);
+			cp = json_put_raw(cp, end, "\"");
 			break;
 		    case DAC1FID17_IDTYPE_CALLSIGN:
-			(void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-			    "\"%s\":\"%s\",",
-			    idtypes[ais->type8.dac1fid17.targets[i].idtype],
-			    ais->type8.dac1fid17.targets[i].id.callsign);
+			cp = json_put_string(cp, end, "", tp->id.callsign);
 			break;
 		    default:
-			(void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-			    "\"%s\":\"%s\",",
-			    idtypes[ais->type8.dac1fid17.targets[i].idtype],
-			    ais->type8.dac1fid17.targets[i].id.other);
+			cp = json_put_string(cp, end, "", tp->id.other);
 		    }
-		    if (scaled)
-			(void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-			    "\"lat\":%.3f,\"lon\":%.3f,",
-			    ais->type8.dac1fid17.targets[i].lat / AIS_LATLON3_SCALE,
-			    ais->type8.dac1fid17.targets[i].lon / AIS_LATLON3_SCALE);
-		    else
-			(void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-			    "\"lat\":%d,\"lon\":%d,",
-			    ais->type8.dac1fid17.targets[i].lat,
-			    ais->type8.dac1fid17.targets[i].lon);
-		    (void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-			"\"course\":%u,\"second\":%u,\"speed\":%u},",
-			ais->type8.dac1fid17.targets[i].course,
-			ais->type8.dac1fid17.targets[i].second,
-			ais->type8.dac1fid17.targets[i].speed);
+		    if (scaled) {
+			cp = json_put_real(cp, end, ",\"lat\":",
+					   tp->lat / AIS_LATLON3_SCALE, 3);
+			cp = json_put_real(cp, end, ",\"lon\":",
+					   tp->lon / AIS_LATLON3_SCALE, 3);
+		    } else {
+			cp = json_put_int(cp, end, ",\"lat\":", tp->lat);
+			cp = json_put_int(cp, end, ",\"lon\":", tp->lon);
+		    }
+		    cp = json_put_uint(cp, end, ",\"course\":", tp->course);
+		    cp = json_put_uint(cp, end, ",\"second\":", tp->second);
+		    cp = json_put_uint(cp, end, ",\"speed\":", tp->speed);
+		    cp = json_put_raw(cp, end, "},");
 		}
-		if (buf[strlen(buf) - 1] == ',')
-		    buf[strlen(buf) - 1] = '\0';
-		(void)strlcat(buf, "]}\r\n,", buflen - strlen(buf));
+		if (cp[-1] == ',')
+		    cp--;
+		cp = json_put_raw(cp, end, "]}\r\n,");
 		break;
 	    case 19:        /* IMO289 - Marine Traffic Signal */
-		if (scaled)
-		    (void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-			"\"linkage\":%u,\"station\":\"%s\",\"lon\":%.3f,\"lat\":%.3f,\"status\":%u,\"signal\":\"%s\",\"hour\":%u,\"minute\":%u,\"nextsignal\":\"%s\"}\r\n",
-			ais->type8.dac1fid19.linkage,
-			ais->type8.dac1fid19.station,
-			ais->type8.dac1fid19.lon / AIS_LATLON3_SCALE,
-			ais->type8.dac1fid19.lat / AIS_LATLON3_SCALE,
-			ais->type8.dac1fid19.status,
-			SIGNAL_DISPLAY(ais->type8.dac1fid19.signal),
-			ais->type8.dac1fid19.hour,
-			ais->type8.dac1fid19.minute,
-			SIGNAL_DISPLAY(ais->type8.dac1fid19.nextsignal));
-		else
-		    (void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-			"\"linkage\":%u,\"station\":\"%s\",\"lon\":%d,\"lat\":%d,\"status\":%u,\"signal\":%u,\"hour\":%u,\"minute\":%u,\"nextsignal\":%u}\r\n",
-			ais->type8.dac1fid19.linkage,
-			ais->type8.dac1fid19.station,
-			ais->type8.dac1fid19.lon,
-			ais->type8.dac1fid19.lat,
-			ais->type8.dac1fid19.status,
-			ais->type8.dac1fid19.signal,
-			ais->type8.dac1fid19.hour,
-			ais->type8.dac1fid19.minute,
-			ais->type8.dac1fid19.nextsignal);
+		cp = json_put_uint(cp, end, "\"linkage\":",
+				   ais->type8.dac1fid19.linkage);
+		cp = json_put_string(cp, end, ",\"station\":",
+				     ais->type8.dac1fid19.station);
+		if (scaled) {
+		    cp = json_put_real(cp, end, ",\"lon\":",
+				       ais->type8.dac1fid19.lon / AIS_LATLON3_SCALE, 3);
+		    cp = json_put_real(cp, end, ",\"lat\":",
+				       ais->type8.dac1fid19.lat / AIS_LATLON3_SCALE, 3);
+		    cp = json_put_uint(cp, end, ",\"status\":",
+				       ais->type8.dac1fid19.status);
+		    cp = json_put_string(cp, end, ",\"signal\":",
+					 SIGNAL_DISPLAY(ais->type8.dac1fid19.signal));
+		    cp = json_put_uint(cp, end, ",\"hour\":",
+				       ais->type8.dac1fid19.hour);
+		    cp = json_put_uint(cp, end, ",\"minute\":",
+				       ais->type8.dac1fid19.minute);
+		    cp = json_put_string(cp, end, ",\"nextsignal\":",
+					 SIGNAL_DISPLAY(ais->type8.dac1fid19.nextsignal));
+		} else {
+		    cp = json_put_int(cp, end, ",\"lon\":",
+				      ais->type8.dac1fid19.lon);
+		    cp = json_put_int(cp, end, ",\"lat\":",
+				      ais->type8.dac1fid19.lat);
+		    cp = json_put_uint(cp, end, ",\"status\":",
+				       ais->type8.dac1fid19.status);
+		    cp = json_put_uint(cp, end, ",\"signal\":",
+				       ais->type8.dac1fid19.signal);
+		    cp = json_put_uint(cp, end, ",\"hour\":",
+				       ais->type8.dac1fid19.hour);
+		    cp = json_put_uint(cp, end, ",\"minute\":",
+				       ais->type8.dac1fid19.minute);
+		    cp = json_put_uint(cp, end, ",\"nextsignal\":",
+				       ais->type8.dac1fid19.nextsignal);
+		}
+		cp = json_put_raw(cp, end, "}\r\n");
 		break;
 	    case 21:        /* IMO289 - Weather obs. report from ship */
 		break;
@@ -2292,498 +2631,203 @@ void json_aivdm_dump(const struct ais_t *ais,
 	    case 25:        /* IMO289 - Dangerous Cargo Indication */
 		break;
 	    case 27:        /* IMO289 - Route information - broadcast */
-		(void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-		    "\"linkage\":%u,\"sender\":%u,",
-		    ais->type8.dac1fid27.linkage,
-		    ais->type8.dac1fid27.sender);
+		cp = json_put_uint(cp, end, "\"linkage\":",
+				   ais->type8.dac1fid27.linkage);
+		cp = json_put_uint(cp, end, ",\"sender\":",
+				   ais->type8.dac1fid27.sender);
 		if (scaled)
-		    (void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-			"\"rtype\":\"%s\",",
-			route_type[ais->type8.dac1fid27.rtype]);
+		    cp = json_put_string(cp, end, ",\"rtype\":",
+					 route_type[ais->type8.dac1fid27.rtype]);
 		else
-		    (void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-			"\"rtype\":%u,",
-			ais->type8.dac1fid27.rtype);
-		(void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-			"\"start\":\"%02u-%02uT%02u:%02uZ\",\"duration\":%u,\"waypoints\":[",
-		    ais->type8.dac1fid27.month,
-		    ais->type8.dac1fid27.day,
-		    ais->type8.dac1fid27.hour,
-		    ais->type8.dac1fid27.minute,
-		    ais->type8.dac1fid27.duration);
+		    cp = json_put_uint(cp, end, ",\"rtype\":",
+				       ais->type8.dac1fid27.rtype);
+		cp = json_put_eta(cp, end, ",\"start\":",
+				  ais->type8.dac1fid27.month,
+				  ais->type8.dac1fid27.day,
+				  ais->type8.dac1fid27.hour,
+				  ais->type8.dac1fid27.minute);
+		cp = json_put_uint(cp, end, ",\"duration\":",
+				   ais->type8.dac1fid27.duration);
+		cp = json_put_raw(cp, end, ",\"waypoints\":[");
 		for (i = 0; i < ais->type8.dac1fid27.waycount; i++) {
-		    if (scaled)
-			(void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-			    "{\"lon\":%.4f,\"lat\":%.4f},",
-			    ais->type8.dac1fid27.waypoints[i].lon / AIS_LATLON4_SCALE,
-			    ais->type8.dac1fid27.waypoints[i].lat / AIS_LATLON4_SCALE);
-		    else
-			(void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-			    "{\"lon\":%d,\"lat\":%d},",
-			    ais->type8.dac1fid27.waypoints[i].lon,
-			    ais->type8.dac1fid27.waypoints[i].lat);
+		    if (scaled) {
+			cp = json_put_real(cp, end, "{\"lon\":",
+					   ais->type8.dac1fid27.waypoints[i].lon / AIS_LATLON4_SCALE, 4);
+			cp = json_put_real(cp, end, ",\"lat\":",
+					   ais->type8.dac1fid27.waypoints[i].lat / AIS_LATLON4_SCALE, 4);
+		    } else {
+			cp = json_put_int(cp, end, "{\"lon\":",
+					  ais->type8.dac1fid27.waypoints[i].lon);
+			cp = json_put_int(cp, end, ",\"lat\":",
+					  ais->type8.dac1fid27.waypoints[i].lat);
+		    }
+		    cp = json_put_raw(cp, end, "},");
 		}
-		if (buf[strlen(buf) - 1] == ',')
-		    buf[strlen(buf) - 1] = '\0';
-		(void)strlcat(buf, "]}\r\n,", buflen - strlen(buf));
+		if (cp[-1] == ',')
+		    cp--;
+		cp = json_put_raw(cp, end, "]}\r\n,");
 		break;
 	    case 29:        /* IMO289 - Text Description - broadcast */
-		(void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-		       "\"linkage\":%u,\"text\":\"%s\"}\r\n",
-		       ais->type8.dac1fid29.linkage,
-		       json_stringify(buf1, sizeof(buf1), 
-				      ais->type8.dac1fid29.text));
+		cp = json_put_uint(cp, end, "\"linkage\":",
+				   ais->type8.dac1fid29.linkage);
+		cp = json_put_string(cp, end, ",\"text\":",
+				     ais->type8.dac1fid29.text);
+		cp = json_put_raw(cp, end, "}\r\n");
 		break;
 	    }
 	}
-	if (!imo)
-	    (void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-			   "\"data\":\"%zd:%s\"}\r\n",
-			   ais->type8.bitcount,
-			   gpsd_hexdump((char *)ais->type8.bitdata,
-					(ais->type8.bitcount + 7) / 8));
-	break;
-    case 9:			/* Standard SAR Aircraft Position Report */
-	if (scaled) {
-	    char altlegend[20];
-	    char speedlegend[20];
-
-	    /*
-	     * Express altitude as nan if not available,
-	     * "high" for above the reporting ceiling.
-	     */
-	    if (ais->type9.alt == AIS_ALT_NOT_AVAILABLE)
-		(void)strlcpy(altlegend, "\"nan\"", sizeof(altlegend));
-	    else if (ais->type9.alt == AIS_ALT_HIGH)
-		(void)strlcpy(altlegend, "\"high\"", sizeof(altlegend));
-	    else
-		(void)snprintf(altlegend, sizeof(altlegend),
-			       "%u", ais->type9.alt);
-
-	    /*
-	     * Express speed as nan if not available,
-	     * "high" for above the reporting ceiling.
-	     */
-	    if (ais->type9.speed == AIS_SAR_SPEED_NOT_AVAILABLE)
-		(void)strlcpy(speedlegend, "\"nan\"", sizeof(speedlegend));
-	    else if (ais->type9.speed == AIS_SAR_FAST_MOVER)
-		(void)strlcpy(speedlegend, "\"fast\"", sizeof(speedlegend));
-	    else
-		(void)snprintf(speedlegend, sizeof(speedlegend),
-			       "%u", ais->type1.speed);
-
-	    (void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-			   "\"alt\":%s,\"speed\":%s,\"accuracy\":%s,"
-			   "\"lon\":%.4f,\"lat\":%.4f,\"course\":%.1f,"
-			   "\"second\":%u,\"regional\":%u,\"dte\":%u,"
-			   "\"raim\":%s,\"radio\":%u}\r\n",
-			   altlegend,
-			   speedlegend,
-			   JSON_BOOL(ais->type9.accuracy),
-			   ais->type9.lon / AIS_LATLON_SCALE,
-			   ais->type9.lat / AIS_LATLON_SCALE,
-			   ais->type9.course / 10.0,
-			   ais->type9.second,
-			   ais->type9.regional,
-			   ais->type9.dte,
-			   JSON_BOOL(ais->type9.raim), ais->type9.radio);
-	} else {
-	    (void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-			   "\"alt\":%u,\"speed\":%u,\"accuracy\":%s,"
-			   "\"lon\":%d,\"lat\":%d,\"course\":%u,"
-			   "\"second\":%u,\"regional\":%u,\"dte\":%u,"
-			   "\"raim\":%s,\"radio\":%u}\r\n",
-			   ais->type9.alt,
-			   ais->type9.speed,
-			   JSON_BOOL(ais->type9.accuracy),
-			   ais->type9.lon,
-			   ais->type9.lat,
-			   ais->type9.course,
-			   ais->type9.second,
-			   ais->type9.regional,
-			   ais->type9.dte,
-			   JSON_BOOL(ais->type9.raim), ais->type9.radio);
-	}
-	break;
-    case 10:			/* UTC/Date Inquiry */
-	(void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-		       "\"dest_mmsi\":%u}\r\n", ais->type10.dest_mmsi);
-	break;
-    case 12:			/* Safety Related Message */
-	(void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-		       "\"seqno\":%u,\"dest_mmsi\":%u,\"retransmit\":%s,\"text\":\"%s\"}\r\n",
-		       ais->type12.seqno,
-		       ais->type12.dest_mmsi,
-		       JSON_BOOL(ais->type12.retransmit),
-		       json_stringify(buf1, sizeof(buf1), ais->type12.text));
-	break;
-    case 14:			/* Safety Related Broadcast Message */
-	(void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-		       "\"text\":\"%s\"}\r\n",
-		       json_stringify(buf1, sizeof(buf1), ais->type14.text));
-	break;
-    case 15:			/* Interrogation */
-	(void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-		       "\"mmsi1\":%u,\"type1_1\":%u,\"offset1_1\":%u,"
-		       "\"type1_2\":%u,\"offset1_2\":%u,\"mmsi2\":%u,"
-		       "\"type2_1\":%u,\"offset2_1\":%u}\r\n",
-		       ais->type15.mmsi1,
-		       ais->type15.type1_1,
-		       ais->type15.offset1_1,
-		       ais->type15.type1_2,
-		       ais->type15.offset1_2,
-		       ais->type15.mmsi2,
-		       ais->type15.type2_1, ais->type15.offset2_1);
-	break;
-    case 16:
-	(void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-		       "\"mmsi1\":%u,\"offset1\":%u,\"increment1\":%u,"
-		       "\"mmsi2\":%u,\"offset2\":%u,\"increment2\":%u}\r\n",
-		       ais->type16.mmsi1,
-		       ais->type16.offset1,
-		       ais->type16.increment1,
-		       ais->type16.mmsi2,
-		       ais->type16.offset2, ais->type16.increment2);
-	break;
-    case 17:
-	if (scaled) {
-	    (void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-			   "\"lon\":%.1f,\"lat\":%.1f,\"data\":\"%zd:%s\"}\r\n",
-			   ais->type17.lon / AIS_GNSS_LATLON_SCALE,
-			   ais->type17.lat / AIS_GNSS_LATLON_SCALE,
-			   ais->type17.bitcount,
-			   gpsd_hexdump((char *)ais->type17.bitdata,
-					(ais->type17.bitcount + 7) / 8));
-	} else {
-	    (void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-			   "\"lon\":%d,\"lat\":%d,\"data\":\"%zd:%s\"}\r\n",
-			   ais->type17.lon,
-			   ais->type17.lat,
-			   ais->type17.bitcount,
-			   gpsd_hexdump((char *)ais->type17.bitdata,
-					(ais->type17.bitcount + 7) / 8));
-	}
-	break;
-    case 18:
-	if (scaled) {
-	    (void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-			   "\"reserved\":%u,\"speed\":%.1f,\"accuracy\":%s,"
-			   "\"lon\":%.4f,\"lat\":%.4f,\"course\":%.1f,"
-			   "\"heading\":%u,\"second\":%u,\"regional\":%u,"
-			   "\"cs\":%s,\"display\":%s,\"dsc\":%s,\"band\":%s,"
-			   "\"msg22\":%s,\"raim\":%s,\"radio\":%u}\r\n",
-			   ais->type18.reserved,
-			   ais->type18.speed / 10.0,
-			   JSON_BOOL(ais->type18.accuracy),
-			   ais->type18.lon / AIS_LATLON_SCALE,
-			   ais->type18.lat / AIS_LATLON_SCALE,
-			   ais->type18.course / 10.0,
-			   ais->type18.heading,
-			   ais->type18.second,
-			   ais->type18.regional,
-			   JSON_BOOL(ais->type18.cs),
-			   JSON_BOOL(ais->type18.display),
-			   JSON_BOOL(ais->type18.dsc),
-			   JSON_BOOL(ais->type18.band),
-			   JSON_BOOL(ais->type18.msg22),
-			   JSON_BOOL(ais->type18.raim), ais->type18.radio);
-	} else {
-	    (void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-			   "\"reserved\":%u,\"speed\":%u,\"accuracy\":%s,"
-			   "\"lon\":%d,\"lat\":%d,\"course\":%u,"
-			   "\"heading\":%u,\"second\":%u,\"regional\":%u,"
-			   "\"cs\":%s,\"display\":%s,\"dsc\":%s,\"band\":%s,"
-			   "\"msg22\":%s,\"raim\":%s,\"radio\":%u}\r\n",
-			   ais->type18.reserved,
-			   ais->type18.speed,
-			   JSON_BOOL(ais->type18.accuracy),
-			   ais->type18.lon,
-			   ais->type18.lat,
-			   ais->type18.course,
-			   ais->type18.heading,
-			   ais->type18.second,
-			   ais->type18.regional,
-			   JSON_BOOL(ais->type18.cs),
-			   JSON_BOOL(ais->type18.display),
-			   JSON_BOOL(ais->type18.dsc),
-			   JSON_BOOL(ais->type18.band),
-			   JSON_BOOL(ais->type18.msg22),
-			   JSON_BOOL(ais->type18.raim), ais->type18.radio);
-	}
-	break;
-    case 19:
-	if (scaled) {
-	    (void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-			   "\"reserved\":%u,\"speed\":%.1f,\"accuracy\":%s,"
-			   "\"lon\":%.4f,\"lat\":%.4f,\"course\":%.1f,"
-			   "\"heading\":%u,\"second\":%u,\"regional\":%u,"
-			   "\"shipname\":\"%s\",\"shiptype\":\"%s\","
-			   "\"to_bow\":%u,\"to_stern\":%u,\"to_port\":%u,"
-			   "\"to_starboard\":%u,\"epfd\":\"%s\",\"raim\":%s,"
-			   "\"dte\":%u,\"assigned\":%s}\r\n",
-			   ais->type19.reserved,
-			   ais->type19.speed / 10.0,
-			   JSON_BOOL(ais->type19.accuracy),
-			   ais->type19.lon / AIS_LATLON_SCALE,
-			   ais->type19.lat / AIS_LATLON_SCALE,
-			   ais->type19.course / 10.0,
-			   ais->type19.heading,
-			   ais->type19.second,
-			   ais->type19.regional,
-			   ais->type19.shipname,
-			   SHIPTYPE_DISPLAY(ais->type19.shiptype),
-			   ais->type19.to_bow,
-			   ais->type19.to_stern,
-			   ais->type19.to_port,
-			   ais->type19.to_starboard,
-			   epfd_legends[ais->type19.epfd],
-			   JSON_BOOL(ais->type19.raim),
-			   ais->type19.dte, JSON_BOOL(ais->type19.assigned));
-	} else {
-	    (void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-			   "\"reserved\":%u,\"speed\":%u,\"accuracy\":%s,"
-			   "\"lon\":%d,\"lat\":%d,\"course\":%u,"
-			   "\"heading\":%u,\"second\":%u,\"regional\":%u,"
-			   "\"shipname\":\"%s\",\"shiptype\":%u,"
-			   "\"to_bow\":%u,\"to_stern\":%u,\"to_port\":%u,"
-			   "\"to_starboard\":%u,\"epfd\":%u,\"raim\":%s,"
-			   "\"dte\":%u,\"assigned\":%s}\r\n",
-			   ais->type19.reserved,
-			   ais->type19.speed,
-			   JSON_BOOL(ais->type19.accuracy),
-			   ais->type19.lon,
-			   ais->type19.lat,
-			   ais->type19.course,
-			   ais->type19.heading,
-			   ais->type19.second,
-			   ais->type19.regional,
-			   ais->type19.shipname,
-			   ais->type19.shiptype,
-			   ais->type19.to_bow,
-			   ais->type19.to_stern,
-			   ais->type19.to_port,
-			   ais->type19.to_starboard,
-			   ais->type19.epfd,
-			   JSON_BOOL(ais->type19.raim),
-			   ais->type19.dte, JSON_BOOL(ais->type19.assigned));
-	}
-	break;
-    case 20:			/* Data Link Management Message */
-	(void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-		       "\"offset1\":%u,\"number1\":%u,"
-		       "\"timeout1\":%u,\"increment1\":%u,"
-		       "\"offset2\":%u,\"number2\":%u,"
-		       "\"timeout2\":%u,\"increment2\":%u,"
-		       "\"offset3\":%u,\"number3\":%u,"
-		       "\"timeout3\":%u,\"increment3\":%u,"
-		       "\"offset4\":%u,\"number4\":%u,"
-		       "\"timeout4\":%u,\"increment4\":%u}\r\n",
-		       ais->type20.offset1,
-		       ais->type20.number1,
-		       ais->type20.timeout1,
-		       ais->type20.increment1,
-		       ais->type20.offset2,
-		       ais->type20.number2,
-		       ais->type20.timeout2,
-		       ais->type20.increment2,
-		       ais->type20.offset3,
-		       ais->type20.number3,
-		       ais->type20.timeout3,
-		       ais->type20.increment3,
-		       ais->type20.offset4,
-		       ais->type20.number4,
-		       ais->type20.timeout4, ais->type20.increment4);
-	break;
-    case 21:			/* Aid to Navigation */
-	if (scaled) {
-	    (void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-			   "\"aid_type\":\"%s\",\"name\":\"%s\",\"lon\":%.4f,"
-			   "\"lat\":%.4f,\"accuracy\":%s,\"to_bow\":%u,"
-			   "\"to_stern\":%u,\"to_port\":%u,"
-			   "\"to_starboard\":%u,\"epfd\":\"%s\","
-			   "\"second\":%u,\"regional\":%u,"
-			   "\"off_position\":%s,\"raim\":%s,"
-			   "\"virtual_aid\":%s}\r\n",
-			   NAVAIDTYPE_DISPLAY(ais->type21.aid_type),
-			   json_stringify(buf1, sizeof(buf1),
-					  ais->type21.name),
-			   ais->type21.lon / AIS_LATLON_SCALE,
-			   ais->type21.lat / AIS_LATLON_SCALE,
-			   JSON_BOOL(ais->type21.accuracy),
-			   ais->type21.to_bow, ais->type21.to_stern,
-			   ais->type21.to_port, ais->type21.to_starboard,
-			   epfd_legends[ais->type21.epfd], ais->type21.second,
-			   ais->type21.regional,
-			   JSON_BOOL(ais->type21.off_position),
-			   JSON_BOOL(ais->type21.raim),
-			   JSON_BOOL(ais->type21.virtual_aid));
-	} else {
-	    (void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-			   "\"aid_type\":%u,\"name\":\"%s\",\"accuracy\":%s,"
-			   "\"lon\":%d,\"lat\":%d,\"to_bow\":%u,"
-			   "\"to_stern\":%u,\"to_port\":%u,\"to_starboard\":%u,"
-			   "\"epfd\":%u,\"second\":%u,\"regional\":%u,"
-			   "\"off_position\":%s,\"raim\":%s,"
-			   "\"virtual_aid\":%s}\r\n",
-			   ais->type21.aid_type,
-			   ais->type21.name,
-			   JSON_BOOL(ais->type21.accuracy),
-			   ais->type21.lon,
-			   ais->type21.lat,
-			   ais->type21.to_bow,
-			   ais->type21.to_stern,
-			   ais->type21.to_port,
-			   ais->type21.to_starboard,
-			   ais->type21.epfd,
-			   ais->type21.second,
-			   ais->type21.regional,
-			   JSON_BOOL(ais->type21.off_position),
-			   JSON_BOOL(ais->type21.raim),
-			   JSON_BOOL(ais->type21.virtual_aid));
+	if (!imo) {
+	    cp = AIS_PUT_DATA(cp, end, "\"data\":", ais->type8);
+	    cp = json_put_raw(cp, end, "}\r\n");
 	}
 	break;
     case 22:			/* Channel Management */
-	(void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-		       "\"channel_a\":%u,\"channel_b\":%u,"
-		       "\"txrx\":%u,\"power\":%s,",
-		       ais->type22.channel_a,
-		       ais->type22.channel_b,
-		       ais->type22.txrx, JSON_BOOL(ais->type22.power));
+	cp = json_put_uint(cp, end, "\"channel_a\":", ais->type22.channel_a);
+	cp = json_put_uint(cp, end, ",\"channel_b\":", ais->type22.channel_b);
+	cp = json_put_uint(cp, end, ",\"txrx\":", ais->type22.txrx);
+	cp = json_put_bool(cp, end, ",\"power\":", ais->type22.power);
+	cp = json_put_raw(cp, end, ",");
 	if (ais->type22.addressed) {
-	    (void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-			   "\"dest1\":%u,\"dest2\":%u",
-			   ais->type22.mmsi.dest1, ais->type22.mmsi.dest2);
+	    cp = json_put_uint(cp, end, "\"dest1\":", ais->type22.mmsi.dest1);
+	    cp = json_put_uint(cp, end, ",\"dest2\":", ais->type22.mmsi.dest2);
 	} else if (scaled) {
-	    (void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-			   "\"ne_lon\":\"%f\",\"ne_lat\":\"%f\","
-			   "\"sw_lon\":\"%f\",\"sw_lat\":\"%f\",",
-			   ais->type22.area.ne_lon / AIS_CHANNEL_LATLON_SCALE,
-			   ais->type22.area.ne_lat / AIS_CHANNEL_LATLON_SCALE,
-			   ais->type22.area.sw_lon / AIS_CHANNEL_LATLON_SCALE,
-			   ais->type22.area.sw_lat /
-			   AIS_CHANNEL_LATLON_SCALE);
+	    cp = json_put_real(cp, end, "\"ne_lon\":\"",
+			       ais->type22.area.ne_lon / AIS_CHANNEL_LATLON_SCALE, 6);
+	    cp = json_put_real(cp, end, "\",\"ne_lat\":\"",
+			       ais->type22.area.ne_lat / AIS_CHANNEL_LATLON_SCALE, 6);
+	    cp = json_put_real(cp, end, "\",\"sw_lon\":\"",
+			       ais->type22.area.sw_lon / AIS_CHANNEL_LATLON_SCALE, 6);
+	    cp = json_put_real(cp, end, "\",\"sw_lat\":\"",
+			       ais->type22.area.sw_lat / AIS_CHANNEL_LATLON_SCALE, 6);
+	    cp = json_put_raw(cp, end, "\",");
 	} else {
-	    (void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-			   "\"ne_lon\":%d,\"ne_lat\":%d,"
-			   "\"sw_lon\":%d,\"sw_lat\":%d,",
-			   ais->type22.area.ne_lon,
-			   ais->type22.area.ne_lat,
-			   ais->type22.area.sw_lon, ais->type22.area.sw_lat);
+	    cp = json_put_int(cp, end, "\"ne_lon\":", ais->type22.area.ne_lon);
+	    cp = json_put_int(cp, end, ",\"ne_lat\":", ais->type22.area.ne_lat);
+	    cp = json_put_int(cp, end, ",\"sw_lon\":", ais->type22.area.sw_lon);
+	    cp = json_put_int(cp, end, ",\"sw_lat\":", ais->type22.area.sw_lat);
+	    cp = json_put_raw(cp, end, ",");
 	}
-	(void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-		       "\"addressed\":%s,\"band_a\":%s,"
-		       "\"band_b\":%s,\"zonesize\":%u}\r\n",
-		       JSON_BOOL(ais->type22.addressed),
-		       JSON_BOOL(ais->type22.band_a),
-		       JSON_BOOL(ais->type22.band_b), ais->type22.zonesize);
+	cp = json_put_bool(cp, end, "\"addressed\":", ais->type22.addressed);
+	cp = json_put_bool(cp, end, ",\"band_a\":", ais->type22.band_a);
+	cp = json_put_bool(cp, end, ",\"band_b\":", ais->type22.band_b);
+	cp = json_put_uint(cp, end, ",\"zonesize\":", ais->type22.zonesize);
+	cp = json_put_raw(cp, end, "}\r\n");
 	break;
-    case 23:			/* Group Assignment Command */
-	if (scaled) {
-	    (void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-			   "\"ne_lon\":\"%f\",\"ne_lat\":\"%f\","
-			   "\"sw_lon\":\"%f\",\"sw_lat\":\"%f\","
-			   "\"stationtype\":\"%s\",\"shiptype\":\"%s\","
-			   "\"interval\":%u,\"quiet\":%u}\r\n",
-			   ais->type23.ne_lon / AIS_CHANNEL_LATLON_SCALE,
-			   ais->type23.ne_lat / AIS_CHANNEL_LATLON_SCALE,
-			   ais->type23.sw_lon / AIS_CHANNEL_LATLON_SCALE,
-			   ais->type23.sw_lat / AIS_CHANNEL_LATLON_SCALE,
-			   STATIONTYPE_DISPLAY(ais->type23.stationtype),
-			   SHIPTYPE_DISPLAY(ais->type23.shiptype),
-			   ais->type23.interval, ais->type23.quiet);
+    case 24:			/* Class B CS Static Data Report */
+	cp = json_put_string(cp, end, "\"shipname\":", ais->type24.shipname);
+	if (scaled)
+	    cp = json_put_string(cp, end, ",\"shiptype\":",
+				 SHIPTYPE_DISPLAY(ais->type24.shiptype));
+	else
+	    cp = json_put_uint(cp, end, ",\"shiptype\":",
+			       ais->type24.shiptype);
+	cp = json_put_string(cp, end, ",\"vendorid\":", ais->type24.vendorid);
+	cp = json_put_string(cp, end, ",\"callsign\":", ais->type24.callsign);
+	if (AIS_AUXILIARY_MMSI(ais->mmsi)) {
+	    cp = json_put_uint(cp, end, ",mothership_\"mmsi\":",
+			       ais->type24.mothership_mmsi);
 	} else {
-	    (void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-			   "\"ne_lon\":%d,\"ne_lat\":%d,"
-			   "\"sw_lon\":%d,\"sw_lat\":%d,"
-			   "\"stationtype\":%u,\"shiptype\":%u,"
-			   "\"interval\":%u,\"quiet\":%u}\r\n",
-			   ais->type23.ne_lon,
-			   ais->type23.ne_lat,
-			   ais->type23.sw_lon,
-			   ais->type23.sw_lat,
-			   ais->type23.stationtype,
-			   ais->type23.shiptype,
-			   ais->type23.interval, ais->type23.quiet);
+	    cp = json_put_uint(cp, end, ",\"to_bow\":",
+			       ais->type24.dim.to_bow);
+	    cp = json_put_uint(cp, end, ",\"to_stern\":",
+			       ais->type24.dim.to_stern);
+	    cp = json_put_uint(cp, end, ",\"to_port\":",
+			       ais->type24.dim.to_port);
+	    cp = json_put_uint(cp, end, ",\"to_starboard\":",
+			       ais->type24.dim.to_starboard);
 	}
+	cp = json_put_raw(cp, end, "}\r\n");
 	break;
-    case 24:			/* Class B CS Static Data Report */
+    default:
+	if (cp[-1] == ',')
+	    cp--;
+	cp = json_put_raw(cp, end, "}\r\n");
+	break;
+    }
+    *cp = '\0';
+}
+#endif /* defined(AIVDM_ENABLE) */
+
+#if defined(AIVDM_ENABLE) && defined(SOCKET_EXPORT_ENABLE)
+void json_vessel_dump(const struct vessel_t *vp, bool scaled,
+		      /*@out@*/char *buf, size_t buflen)
+/* dump what the vessel table knows about one vessel */
+{
+    char tbuf[JSON_DATE_MAX+1];
+    char buf1[JSON_VAL_MAX * 2 + 1];
+    char buf2[JSON_VAL_MAX * 2 + 1];
+    char buf3[JSON_VAL_MAX * 2 + 1];
+
+    (void)snprintf(buf, buflen, "{\"class\":\"VESSEL\",\"mmsi\":%u,",
+		   vp->mmsi);
+    if (vp->device[0] != '\0')
 	(void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-		       "\"shipname\":\"%s\",",
-		       json_stringify(buf1, sizeof(buf1),
-				      ais->type24.shipname));
-	if (scaled) {
+		       "\"device\":\"%s\",", vp->device);
+    (void)snprintf(buf + strlen(buf), buflen - strlen(buf),
+		   "\"time\":\"%s\",",
+		   unix_to_iso8601(vp->heard, tbuf, sizeof(tbuf)));
+    if (vp->state.postype != 0) {
+	(void)snprintf(buf + strlen(buf), buflen - strlen(buf),
+		       "\"postype\":%u,\"postime\":\"%s\",\"status\":%u,"
+		       "\"accuracy\":%s,",
+		       vp->state.postype,
+		       unix_to_iso8601(vp->reported, tbuf, sizeof(tbuf)),
+		       vp->state.status, JSON_BOOL(vp->state.accuracy));
+	if (scaled)
 	    (void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-			   "\"shiptype\":\"%s\",",
-			   SHIPTYPE_DISPLAY(ais->type24.shiptype));
-	} else {
+			   "\"lon\":%.4f,\"lat\":%.4f,\"speed\":%.1f,"
+			   "\"course\":%.1f,\"heading\":%u,",
+			   vp->state.lon / AIS_LATLON_SCALE,
+			   vp->state.lat / AIS_LATLON_SCALE,
+			   vp->state.speed / 10.0,
+			   vp->state.course / 10.0, vp->state.heading);
+	else
 	    (void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-			   "\"shiptype\":%u,", ais->type24.shiptype);
-	}
+			   "\"lon\":%d,\"lat\":%d,\"speed\":%u,"
+			   "\"course\":%u,\"heading\":%u,",
+			   vp->state.lon, vp->state.lat, vp->state.speed,
+			   vp->state.course, vp->state.heading);
+    }
+    if (vp->state.statictype != 0) {
 	(void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-		       "\"vendorid\":\"%s\",\"callsign\":\"%s\",",
-		       ais->type24.vendorid, ais->type24.callsign);
-	if (AIS_AUXILIARY_MMSI(ais->mmsi)) {
+		       "\"statictype\":%u,\"statictime\":\"%s\","
+		       "\"shipname\":\"%s\",\"shiptype\":%u,"
+		       "\"to_bow\":%u,\"to_stern\":%u,\"to_port\":%u,"
+		       "\"to_starboard\":%u,",
+		       vp->state.statictype,
+		       unix_to_iso8601(vp->described, tbuf, sizeof(tbuf)),
+		       json_stringify(buf1, sizeof(buf1), vp->state.shipname),
+		       vp->state.shiptype,
+		       vp->state.to_bow, vp->state.to_stern,
+		       vp->state.to_port, vp->state.to_starboard);
+	if (vp->state.callsign[0] != '\0')
 	    (void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-			   "mothership_\"mmsi\":%u}\r\n",
-			   ais->type24.mothership_mmsi);
-	} else {
+			   "\"callsign\":\"%s\",",
+			   json_stringify(buf2, sizeof(buf2),
+					  vp->state.callsign));
+	/* only type 5 carries voyage data */
+	if (vp->state.statictype == 5) {
 	    (void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-			   "\"to_bow\":%u,\"to_stern\":%u,"
-			   "\"to_port\":%u,\"to_starboard\":%u}\r\n",
-			   ais->type24.dim.to_bow,
-			   ais->type24.dim.to_stern,
-			   ais->type24.dim.to_port,
-			   ais->type24.dim.to_starboard);
+			   "\"imo\":%u,\"eta\":\"%02u-%02uT%02u:%02uZ\","
+			   "\"destination\":\"%s\",",
+			   vp->state.imo,
+			   vp->state.month, vp->state.day,
+			   vp->state.hour, vp->state.minute,
+			   json_stringify(buf3, sizeof(buf3),
+					  vp->state.destination));
+	    if (scaled)
+		(void)snprintf(buf + strlen(buf), buflen - strlen(buf),
+			       "\"draught\":%.1f,", vp->state.draught / 10.0);
+	    else
+		(void)snprintf(buf + strlen(buf), buflen - strlen(buf),
+			       "\"draught\":%u,", vp->state.draught);
 	}
-	break;
-    case 25:			/* Binary Message, Single Slot */
-	(void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-		       "\"addressed\":%s,\"structured\":%s,\"dest_mmsi\":%u,"
-		       "\"app_id\":%u,\"data\":\"%zd:%s\"}\r\n",
-		       JSON_BOOL(ais->type25.addressed),
-		       JSON_BOOL(ais->type25.structured),
-		       ais->type25.dest_mmsi,
-		       ais->type25.app_id,
-		       ais->type25.bitcount,
-		       gpsd_hexdump((char *)ais->type25.bitdata,
-				    (ais->type25.bitcount + 7) / 8));
-	break;
-    case 26:			/* Binary Message, Multiple Slot */
-	(void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-		       "\"addressed\":%s,\"structured\":%s,\"dest_mmsi\":%u,"
-		       "\"app_id\":%u,\"data\":\"%zd:%s\"\"radio\":%u}\r\n",
-		       JSON_BOOL(ais->type26.addressed),
-		       JSON_BOOL(ais->type26.structured),
-		       ais->type26.dest_mmsi,
-		       ais->type26.app_id,
-		       ais->type26.bitcount,
-		       gpsd_hexdump((char *)ais->type26.bitdata,
-				    (ais->type26.bitcount + 7) / 8),
-		       ais->type26.radio);
-	break;
-    case 27:			/* Long Range AIS Broadcast message */
-	(void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-		       "\"status\":\"%s\","
-		       "\"accuracy\":%s,\"lon\":%.1f,\"lat\":%.1f,"
-		       "\"speed\":%u,\"course\":%u,raim\":%s,\"gnss\":%s}\r\n",
-		       nav_legends[ais->type27.status],
-		       JSON_BOOL(ais->type27.accuracy),
-		       ais->type27.lon / AIS_LONGRANGE_LATLON_SCALE,
-		       ais->type27.lat / AIS_LONGRANGE_LATLON_SCALE,
-		       ais->type27.speed,
-		       ais->type27.course,
-		       JSON_BOOL(ais->type27.raim),
-		       JSON_BOOL(ais->type27.gnss));
-	break;
-    default:
-	if (buf[strlen(buf) - 1] == ',')
-	    buf[strlen(buf) - 1] = '\0';
-	(void)strlcat(buf, "}\r\n", buflen);
-	break;
     }
-    /*@ +formatcode +mustfreefresh @*/
+    if (buf[strlen(buf) - 1] == ',')
+	buf[strlen(buf) - 1] = '\0';
+    (void)strlcat(buf, "}\r\n", buflen);
 }
-#endif /* defined(AIVDM_ENABLE) */
+#endif /* defined(AIVDM_ENABLE) && defined(SOCKET_EXPORT_ENABLE) */
 
 #ifdef COMPASS_ENABLE
 void json_att_dump(const struct gps_data_t *gpsdata,
@@ -2937,6 +2981,10 @@ void json_data_report(gps_mask_t changed,
 	json_subframe_dump(datap, buf+strlen(buf), buflen-strlen(buf));
     }
 
+    if ((changed & RAW_SET) != 0 && policy->rawdata) {
+	json_raw_dump(datap, buf+strlen(buf), buflen-strlen(buf));
+    }
+
 #ifdef COMPASS_ENABLE
     if ((changed & ATTITUDE_SET) != 0) {
 	json_att_dump(datap, buf+strlen(buf), buflen-strlen(buf));
@@ -2958,7 +3006,8 @@ void json_data_report(gps_mask_t changed,
 #endif /* RTCM104V3_ENABLE */
 
 #ifdef AIVDM_ENABLE
-    if ((changed & AIS_SET) != 0) {
+    /* vessel watchers get the table's VESSEL reports instead */
+    if ((changed & AIS_SET) != 0 && !policy->vessels) {
 	json_aivdm_dump(&datap->ais, datap->dev.path,
 			policy->scaled,
 			buf+strlen(buf), buflen-strlen(buf));
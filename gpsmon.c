@@ -231,6 +231,9 @@ static ssize_t readpkt(void)
 	longjmp(terminate, TERM_SELECT_FAILED);
 
     changed = gpsd_poll(&session);
+    /* a packet handed back to the driver needs no more input */
+    while (session.reparse)
+	changed |= gpsd_poll(&session);
     if (changed == 0)
 	longjmp(terminate, TERM_EMPTY_READ);
 
@@ -526,6 +526,12 @@ int json_read_array(const char *cp, const struct json_array_t *arr,
 
     tp = arr->arr.strings.store;
     arrcount = 0;
+    while (isspace(*cp))
+	cp++;
+    if (*cp == ']') {
+	json_debug_trace((1, "Empty array.\n"));
+	goto breakout;
+    }
     for (offset = 0; offset < arr->maxlen; offset++) {
 	json_debug_trace((1, "Looking at %s\n", cp));
 	switch (arr->element_type) {
@@ -564,8 +570,28 @@ int json_read_array(const char *cp, const struct json_array_t *arr,
 	    break;
 	case t_integer:
 	case t_uinteger:
-	case t_time:
 	case t_real:
+	    {
+		char *ep = NULL;
+
+		while (isspace(*cp))
+		    cp++;
+		if (arr->element_type == t_integer)
+		    arr->arr.integers.store[offset] =
+			(int)strtol(cp, &ep, 10);
+		else if (arr->element_type == t_uinteger)
+		    arr->arr.uintegers.store[offset] =
+			(unsigned int)strtoul(cp, &ep, 10);
+		else
+		    arr->arr.reals.store[offset] = strtod(cp, &ep);
+		if (ep == cp) {
+		    json_debug_trace((1, "Bad number in numeric array.\n"));
+		    return JSON_ERR_BADNUM;
+		}
+		cp = ep;
+	    }
+	    break;
+	case t_time:
 	case t_boolean:
 	case t_character:
 	case t_array:
@@ -33,6 +33,15 @@ struct json_array_t {
 	    char *store;
 	    int storelen;
 	} strings;
+	struct {
+	    int *store;
+	} integers;
+	struct {
+	    unsigned int *store;
+	} uintegers;
+	struct {
+	    double *store;
+	} reals;
     } arr;
     int *count, maxlen;
 };
@@ -112,6 +121,9 @@ void json_enable_debug(int, FILE *);
  * STRUCTARRAY takes the name of a structure array, a pointer to a an 
  * initializer defining the subobject type, and the address of an integer to
  * store the length in. 
+ *
+ * NUMBERARRAY takes an array of numbers, its element type (integer,
+ * uinteger or real) and the address of an integer to store the length in.
  */
 #define STRUCTOBJECT(s, f)	.addr.offset = offsetof(s, f)
 #define STRUCTARRAY(a, e, n) \
@@ -121,5 +133,10 @@ void json_enable_debug(int, FILE *);
 	.addr.array.arr.objects.stride = sizeof(a[0]), \
 	.addr.array.count = n, \
 	.addr.array.maxlen = NITEMS(a)
+#define NUMBERARRAY(a, t, n) \
+	.addr.array.element_type = t_##t, \
+	.addr.array.arr.t##s.store = a, \
+	.addr.array.count = n, \
+	.addr.array.maxlen = NITEMS(a)
 
 /* json.h ends here */
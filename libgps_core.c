@@ -204,12 +204,13 @@ void libgps_dump_state(struct gps_data_t *collect)
 		      collect->version.proto_minor);
     if (collect->set & POLICY_SET)
 	(void)fprintf(debugfp,
-		      "POLICY: watcher=%s nmea=%s raw=%d scaled=%s timing=%s, devpath=%s\n",
+		      "POLICY: watcher=%s nmea=%s raw=%d scaled=%s timing=%s rawdata=%s, devpath=%s\n",
 		      collect->policy.watcher ? "true" : "false",
 		      collect->policy.nmea ? "true" : "false",
 		      collect->policy.raw,
 		      collect->policy.scaled ? "true" : "false",
 		      collect->policy.timing ? "true" : "false",
+		      collect->policy.rawdata ? "true" : "false",
 		      collect->policy.devpath);
     if (collect->set & SATELLITE_SET) {
 	int i;
@@ -193,6 +193,68 @@ static int json_sky_read(const char *buf, struct gps_data_t *gpsdata,
     return 0;
 }
 
+static int json_raw_read(const char *buf, struct gps_data_t *gpsdata,
+			 /*@null@*/ const char **endptr)
+{
+    struct rawdata_t *raw = &gpsdata->raw;
+    double mtime;
+    int count;
+    /*@ -fullinitblock @*/
+    const struct json_attr_t json_attrs_meas[] = {
+	/* *INDENT-OFF* */
+	{"PRN",	   t_integer,  .addr.integer = raw->PRN},
+	{"st",	   t_uinteger, .addr.uinteger = raw->satstat},
+	{"ss",	   t_real,     .addr.real = raw->ss,
+	                          .dflt.real = NAN},
+	{"pr",	   t_real,     .addr.real = raw->pseudorange,
+	                          .dflt.real = NAN},
+	{"cp",	   t_real,     .addr.real = raw->carrierphase,
+	                          .dflt.real = NAN},
+	{"cd",	   t_real,     .addr.real = raw->codephase,
+	                          .dflt.real = NAN},
+	{"dr",	   t_real,     .addr.real = raw->deltarange,
+	                          .dflt.real = NAN},
+	{"do",	   t_real,     .addr.real = raw->doppler,
+	                          .dflt.real = NAN},
+	{"mt",	   t_real,     .addr.real = raw->mtime,
+	                          .dflt.real = NAN},
+	/* *INDENT-ON* */
+	{NULL},
+    };
+    const struct json_attr_t json_attrs_raw[] = {
+	/* *INDENT-OFF* */
+	{"class",      t_check,   .dflt.check = "RAW"},
+	{"device",     t_string,  .addr.string  = gpsdata->dev.path,
+	                             .len = sizeof(gpsdata->dev.path)},
+	{"tag",	       t_string,  .addr.string  = gpsdata->tag,
+	                             .len = sizeof(gpsdata->tag)},
+	{"time",       t_real,    .addr.real = &mtime,
+	      	                     .dflt.real = NAN},
+	{"meas",       t_array,   .addr.array.element_type = t_object,
+				     .addr.array.arr.objects.subtype=json_attrs_meas,
+	                             .addr.array.maxlen = MAXCHANNELS,
+	                             .addr.array.count = &count},
+	{NULL},
+	/* *INDENT-ON* */
+    };
+    /*@ +fullinitblock @*/
+    int status, i;
+
+    status = json_read_object(buf, json_attrs_raw, endptr);
+    if (status != 0)
+	return status;
+
+    /* channels past the end of the array are empty */
+    for (i = count; i < MAXCHANNELS; i++)
+	raw->PRN[i] = 0;
+    /* measurement times are only sent where they differ */
+    for (i = 0; i < count; i++)
+	if (isnan(raw->mtime[i]) != 0)
+	    raw->mtime[i] = mtime;
+
+    return 0;
+}
+
 static int json_att_read(const char *buf, struct gps_data_t *gpsdata,
 			 /*@null@*/ const char **endptr)
 {
@@ -278,6 +340,12 @@ static int json_devicelist_read(const char *buf, struct gps_data_t *gpsdata,
 				        .dflt.real = NAN},
 	{"mincycle",   t_real,       STRUCTOBJECT(struct devconfig_t, mincycle),
 				        .dflt.real = NAN},
+	{"load",       t_real,       STRUCTOBJECT(struct devconfig_t, load),
+				        .dflt.real = NAN},
+	{"budget",     t_real,       STRUCTOBJECT(struct devconfig_t, budget),
+				        .dflt.real = NAN},
+	{"ttff",       t_real,       STRUCTOBJECT(struct devconfig_t, ttff),
+				        .dflt.real = NAN},
 	{NULL},
 	/* *INDENT-ON* */
     };
@@ -408,6 +476,13 @@ int libgps_json_unpack(const char *buf,
 	if (status == 0)
 	    gpsdata->set |= SATELLITE_SET;
 	return status;
+    } else if (STARTSWITH(classtag, "\"class\":\"RAW\"")) {
+	status = json_raw_read(buf, gpsdata, end);
+	if (status == 0) {
+	    gpsdata->set &= ~UNION_SET;
+	    gpsdata->set |= RAW_SET;
+	}
+	return status;
     } else if (STARTSWITH(classtag, "\"class\":\"ATT\"")) {
 	status = json_att_read(buf, gpsdata, end);
 	if (status == 0) {
@@ -41,9 +41,13 @@ extern char *strtok_r(char *, const char *, char **);
 struct privdata_t
 {
     bool newstyle;
-    /* data buffered from the last read */
+    /*
+     * Data buffered from the last read.  There's room for a whole
+     * batch of AIS reports behind a partial line, so a batch comes in
+     * with one recv() and is handed out a report per gps_read().
+     */
     ssize_t waiting;
-    char buffer[GPS_JSON_RESPONSE_MAX * 2];
+    char buffer[GPS_JSON_BATCH_MAX + GPS_JSON_RESPONSE_MAX];
 #ifdef LIBGPS_DEBUG
     int waitcount;
 #endif /* LIBGPS_DEBUG */
@@ -102,7 +106,10 @@ bool gps_waiting(const struct gps_data_t *gpsdata, int timeout)
     struct timeval tv;
 
     libgps_debug_trace((DEBUG_CALLS, "gps_waiting(%d): %d\n", timeout, PRIVATE(gpsdata)->waitcount++));
-    if (PRIVATE(gpsdata)->waiting > 0)
+    /* a complete report already buffered needs no wait */
+    if (PRIVATE(gpsdata)->waiting > 0
+	&& memchr(PRIVATE(gpsdata)->buffer, '\n',
+		  (size_t)PRIVATE(gpsdata)->waiting) != NULL)
 	return true;
 
     /* we might want to check for EINTR if this returns false */
@@ -529,6 +536,8 @@ int gps_stream(struct gps_data_t *gpsdata, unsigned int flags,
 		(void)strlcat(buf, "\"scaled\":false,", sizeof(buf));
 	    if (flags & WATCH_TIMING)
 		(void)strlcat(buf, "\"timing\":false,", sizeof(buf));
+	    if (flags & WATCH_RAWDATA)
+		(void)strlcat(buf, "\"rawdata\":false,", sizeof(buf));
 	    if (buf[strlen(buf) - 1] == ',')
 		buf[strlen(buf) - 1] = '\0';
 	    (void)strlcat(buf, "};", sizeof(buf));
@@ -555,6 +564,8 @@ int gps_stream(struct gps_data_t *gpsdata, unsigned int flags,
 		(void)strlcat(buf, "\"scaled\":true,", sizeof(buf));
 	    if (flags & WATCH_TIMING)
 		(void)strlcat(buf, "\"timing\":true,", sizeof(buf));
+	    if (flags & WATCH_RAWDATA)
+		(void)strlcat(buf, "\"rawdata\":true,", sizeof(buf));
 	    /*@-nullpass@*//* shouldn't be needed, splint has a bug */
 	    if (flags & WATCH_DEVICE)
 		(void)snprintf(buf + strlen(buf), sizeof(buf) - strlen(buf),
@@ -15,6 +15,7 @@
 #include <libgen.h>
 #include <math.h>
 #include <string.h>
+#include <errno.h>
 #include <fcntl.h>
 #include <sys/types.h>
 #include <sys/stat.h>
@@ -47,6 +48,39 @@ static void gpsd_run_device_hook(char *device_name, char *hook)
     }
 }
 
+void gpsd_probe_sent(struct gps_device_t *session, const char *name)
+/* note a subtype probe in the device's transcript */
+{
+    if (session->probe.count < PROBE_TRANSCRIPT) {
+	session->probe.transcript[session->probe.count].name = name;
+	session->probe.transcript[session->probe.count].sent =
+	    timestamp() - session->opentime;
+    }
+    session->probe.count++;
+}
+
+void gpsd_probe_done(struct gps_device_t *session, const char *result)
+/* probing is over: drop probes not yet sent, and report how it went */
+{
+    char buf[BUFSIZ];
+    unsigned int i;
+
+    if (session->probe.done || session->probe.count == 0)
+	return;
+    session->probe.done = true;
+    session->probe.identified = timestamp() - session->opentime;
+    gpsd_write_cancel(session, write_probe);
+    buf[0] = '\0';
+    for (i = 0; i < session->probe.count && i < PROBE_TRANSCRIPT; i++)
+	(void)snprintf(buf + strlen(buf), sizeof(buf) - strlen(buf),
+		       " %s@%.2f", session->probe.transcript[i].name,
+		       session->probe.transcript[i].sent);
+    gpsd_report(LOG_INF,
+		"%s: probing done (%s) %.2f sec after activation, probes:%s\n",
+		session->gpsdata.dev.path, result,
+		session->probe.identified, buf);
+}
+
 int gpsd_switch_driver(struct gps_device_t *session, char *type_name)
 {
     const struct gps_type_t **dp;
@@ -63,6 +97,9 @@ int gpsd_switch_driver(struct gps_device_t *session, char *type_name)
 			(*dp)->type_name);
 	    gpsd_assert_sync(session);
 	    /*@i@*/ session->device_type = *dp;
+	    /* anything but generic NMEA ends the subtype probing */
+	    if ((*dp)->packet_type != NMEA_PACKET || (*dp)->trigger != NULL)
+		gpsd_probe_done(session, (*dp)->type_name);
 #ifdef RECONFIGURE_ENABLE
 	    session->gpsdata.dev.mincycle = session->device_type->min_cycle;
 #endif /* RECONFIGURE_ENABLE */
@@ -109,6 +146,9 @@ void gps_context_init(struct gps_context_t *context)
 #ifdef SHM_EXPORT_ENABLE
 	.shmexport      = NULL,
 #endif /* SHM_EXPORT_ENABLE */
+#ifdef AIDING_ENABLE
+	.aiding		= {.path = NULL, .dirty = false},
+#endif /* AIDING_ENABLE */
     };
     /*@ +initallelements +nullassign +nullderef @*/
     /* *INDENT-ON* */
@@ -130,6 +170,9 @@ void gpsd_init(struct gps_device_t *session, struct gps_context_t *context,
     session->rtcmtime = (timestamp_t)0;
     session->sourcetype = source_unknown;	/* gpsd_open() sets this */
     session->servicetype = service_unknown;	/* gpsd_open() sets this */
+    session->outqueue.count = 0;
+    session->outqueue.used = session->outqueue.sent = 0;
+    session->outqueue.holdoff = (timestamp_t)0;
     /*@ -temptrans @*/
     session->context = context;
     /*@ +temptrans @*/
@@ -143,6 +186,17 @@ void gpsd_init(struct gps_device_t *session, struct gps_context_t *context,
     session->gpsdata.epe = NAN;
     session->mag_var = NAN;
     session->gpsdata.dev.cycle = session->gpsdata.dev.mincycle = 1;
+    session->gpsdata.dev.load = session->gpsdata.dev.budget = NAN;
+    session->gpsdata.dev.ttff = NAN;
+#ifdef NMEA_ENABLE
+    /* a new device has to learn its own reporting cycle */
+    memset(&session->nmea_cycle, '\0', sizeof(session->nmea_cycle));
+#endif /* NMEA_ENABLE */
+#ifdef AIVDM_ENABLE
+    /* the payload decoder relies on the bit buffers starting out zeroed */
+    memset(session->aivdm, '\0', sizeof(session->aivdm));
+    memset(&session->aivdm_dedup, '\0', sizeof(session->aivdm_dedup));
+#endif /* AIVDM_ENABLE */
 
     /* tty-level initialization */
     gpsd_tty_init(session);
@@ -182,6 +236,7 @@ void gpsd_clear(struct gps_device_t *session)
 #endif /* SIRF_ENABLE */
     packet_init(&session->packet);
     session->packet.debug = session->context->debug;
+    session->reparse = false;
     // session->gpsdata.online = 0;
     session->gpsdata.fix.mode = MODE_NOT_SEEN;
     session->gpsdata.status = STATUS_NO_FIX;
@@ -194,21 +249,56 @@ void gpsd_clear(struct gps_device_t *session)
     /* clear the private data union */
     memset(&session->driver, '\0', sizeof(session->driver));
 
+    /* a new connection gets its link load measured afresh */
+    memset(&session->link, '\0', sizeof(session->link));
+    session->gpsdata.dev.load = session->gpsdata.dev.budget = NAN;
+    session->gpsdata.dev.ttff = NAN;
+
+    gpsd_raw_clear(&session->rawbatch);
+
+    /* probing starts over on every activation */
+    memset(&session->probe, '\0', sizeof(session->probe));
+
     session->opentime = timestamp();
 }
 
+#if defined(NETFEED_ENABLE) || defined(PASSTHROUGH_ENABLE)
+static void gpsd_stamp_socket(struct gps_device_t *session)
+/* ask the kernel to timestamp data arriving on a network feed */
+{
+#ifdef SO_TIMESTAMPNS
+    int on = 1;
+
+    if (session->gpsdata.gps_fd < 0)
+	return;
+    if (setsockopt(session->gpsdata.gps_fd, SOL_SOCKET, SO_TIMESTAMPNS,
+		   (char *)&on, sizeof(on)) == 0)
+	session->packet.kernel_stamps = true;
+    else
+	gpsd_report(LOG_WARN, "no kernel timestamps on fd %d: %s\n",
+		    session->gpsdata.gps_fd, strerror(errno));
+#endif /* SO_TIMESTAMPNS */
+}
+#endif /* defined(NETFEED_ENABLE) || defined(PASSTHROUGH_ENABLE) */
+
 int gpsd_open(struct gps_device_t *session)
 /* open a device for access to its data */
 {
+    /* a tty gets clock samples taken after read() instead */
+    session->packet.kernel_stamps = false;
 #ifdef NETFEED_ENABLE
     /* special case: source may be a URI to a remote GNSS or DGPS service */
     if (netgnss_uri_check(session->gpsdata.dev.path)) {
 	session->gpsdata.gps_fd = netgnss_uri_open(session,
 						   session->gpsdata.dev.path);
-	session->sourcetype = source_tcp;
+	if (strncmp(session->gpsdata.dev.path, "udp://", 6) == 0)
+	    session->sourcetype = source_udp;
+	else
+	    session->sourcetype = source_tcp;
 	gpsd_report(LOG_SPIN,
 		    "netgnss_uri_open(%s) returns socket on fd %d\n",
 		    session->gpsdata.dev.path, session->gpsdata.gps_fd);
+	gpsd_stamp_socket(session);
 	return session->gpsdata.gps_fd;
     /* otherwise, could be an TCP data feed */
     } else if (strncmp(session->gpsdata.dev.path, "tcp://", 6) == 0) {
@@ -232,6 +322,7 @@ int gpsd_open(struct gps_device_t *session)
 	    gpsd_report(LOG_SPIN, "TCP device opened on fd %d\n", dsock);
 	session->gpsdata.gps_fd = dsock;
 	session->sourcetype = source_tcp;
+	gpsd_stamp_socket(session);
 	return session->gpsdata.gps_fd;
     /* or could be UDP */
     } else if (strncmp(session->gpsdata.dev.path, "udp://", 6) == 0) {
@@ -255,6 +346,7 @@ int gpsd_open(struct gps_device_t *session)
 	    gpsd_report(LOG_SPIN, "UDP device opened on fd %d\n", dsock);
 	session->gpsdata.gps_fd = dsock;
 	session->sourcetype = source_udp;
+	gpsd_stamp_socket(session);
 	return session->gpsdata.gps_fd;
     }
 #endif /* NETFEED_ENABLE */
@@ -281,6 +373,7 @@ int gpsd_open(struct gps_device_t *session)
 	/* watch to remote is issued when WATCH is */
 	session->gpsdata.gps_fd = dsock;
 	session->sourcetype = source_gpsd;
+	gpsd_stamp_socket(session);
 	return session->gpsdata.gps_fd;
     }
 #endif /* PASSTHROUGH_ENABLE */
@@ -672,6 +765,14 @@ static void gpsd_error_model(struct gps_device_t *session,
 #define V_UERE_WITH_DGPS	5.75	/* meters, 95% confidence */
 #define P_UERE_NO_DGPS		19.0	/* meters, 95% confidence */
 #define P_UERE_WITH_DGPS	4.75	/* meters, 95% confidence */
+    /*
+     * Successive fixes less than about a second apart share most of
+     * their error, because the receiver's navigation filter carries
+     * it from one to the next.  Dividing the sum of two such errors
+     * by a 40ms interval would claim speed errors of hundreds of m/s
+     * at 25Hz, so rate errors are never spread over less than this.
+     */
+#define ERR_DECORRELATION	1.0	/* seconds */
     double h_uere, v_uere, p_uere;
 
     if (NULL == session)
@@ -752,6 +853,8 @@ static void gpsd_error_model(struct gps_device_t *session,
 		timestamp_t t = fix->time - oldfix->time;
 		double e =
 		    EMIX(oldfix->epx, oldfix->epy) + EMIX(fix->epx, fix->epy);
+		if (t < ERR_DECORRELATION)
+		    t = ERR_DECORRELATION;
 		fix->eps = e / t;
 	    } else
 		fix->eps = NAN;
@@ -761,6 +864,8 @@ static void gpsd_error_model(struct gps_device_t *session,
 	    if (oldfix->mode > MODE_3D && fix->mode > MODE_3D) {
 		timestamp_t t = fix->time - oldfix->time;
 		double e = oldfix->epv + fix->epv;
+		if (t < ERR_DECORRELATION)
+		    t = ERR_DECORRELATION;
 		/* if vertical uncertainties are zero this will be too */
 		fix->epc = e / t;
 	    }
@@ -802,6 +907,140 @@ static void gpsd_error_model(struct gps_device_t *session,
 }
 #endif /* CHEAPFLOATS_ENABLE */
 
+/* seconds of input each measurement of serial-link load covers */
+#define LINK_WINDOW	4.0
+
+static void gpsd_link_account(struct gps_device_t *session, size_t chars)
+/* keep track of what fraction of the serial link's capacity is in use */
+{
+    timestamp_t now = timestamp();
+    double elapsed;
+    speed_t speed;
+
+    /* only serial links have a capacity to measure against */
+    if (session->servicetype != service_sensor)
+	return;
+    if (session->link.start == 0) {
+	session->link.start = now;
+	session->link.chars = 0;
+	return;
+    }
+    session->link.chars += chars;
+    elapsed = now - session->link.start;
+    if (elapsed < LINK_WINDOW || elapsed < 4 * session->gpsdata.dev.cycle)
+	return;
+
+    speed = gpsd_get_speed(&session->ttyset);
+    if (speed > 0) {
+	/* start bit, eight data bits, parity bit if any, stop bits */
+	unsigned int framing = 9 + session->gpsdata.dev.stopbits
+	    + (session->gpsdata.dev.parity != 'N' ? 1 : 0);
+	session->gpsdata.dev.load =
+	    (double)session->link.chars * framing / (speed * elapsed);
+	gpsd_report(LOG_PROG, "%s link load %.0f%% at %dbps\n",
+		    session->gpsdata.dev.path,
+		    session->gpsdata.dev.load * 100, (int)speed);
+    }
+    session->link.windows++;
+    session->link.start = now;
+    session->link.chars = 0;
+}
+
+static gps_mask_t gpsd_digest(struct gps_device_t *session,
+			      gps_mask_t received)
+/* get the data from the current packet into the scoreboard */
+{
+    /* Get data from current packet into the fix structure */
+    if (session->packet.type != COMMENT_PACKET)
+	if (session->device_type != NULL
+	    && session->device_type->parse_packet != NULL)
+	    received |= session->device_type->parse_packet(session);
+
+    session->gpsdata.set = ONLINE_SET | received;
+
+#ifdef CHEAPFLOATS_ENABLE
+    /*
+     * Compute fix-quality data from the satellite positions.
+     * These will not overwrite any DOPs reported from the packet
+     * we just got.
+     */
+    if ((received & SATELLITE_SET) != 0
+	&& session->gpsdata.satellites_visible > 0) {
+	session->gpsdata.set |= fill_dop(&session->gpsdata, &session->gpsdata.dop);
+	session->gpsdata.epe = NAN;
+    }
+#endif /* CHEAPFLOATS_ENABLE */
+
+    /* copy/merge device data into staging buffers */
+    /*@-nullderef -nullpass@*/
+    if ((session->gpsdata.set & CLEAR_IS) != 0)
+	gps_clear_fix(&session->gpsdata.fix);
+    /* don't downgrade mode if holding previous fix */
+    if (session->gpsdata.fix.mode > session->newdata.mode)
+	session->gpsdata.set &= ~MODE_SET;
+    //gpsd_report(LOG_PROG,
+    //              "transfer mask on %s: %02x\n", session->gpsdata.tag, session->gpsdata.set);
+    gps_merge_fix(&session->gpsdata.fix,
+		  session->gpsdata.set, &session->newdata);
+#ifdef CHEAPFLOATS_ENABLE
+    gpsd_error_model(session, &session->gpsdata.fix, &session->oldfix);
+#endif /* CHEAPFLOATS_ENABLE */
+
+    /*@+nullderef -nullpass@*/
+
+    /*
+     * Count good fixes. We used to check
+     *      session->gpsdata.status > STATUS_NO_FIX
+     * here, but that wasn't quite right.  That tells us whether
+     * we think we have a valid fix for the current cycle, but remains
+     * true while following non-fix packets are received.  What we
+     * really want to know is whether the last packet received was a
+     * fix packet AND held a valid fix. We must ignore non-fix packets
+     * AND packets which have fix data but are flagged as invalid. Some
+     * devices output fix packets on a regular basis, even when unable
+     * to derive a good fix. Such packets should set STATUS_NO_FIX.
+     */
+    if ((session->gpsdata.set & LATLON_SET) != 0
+	&& session->gpsdata.status > STATUS_NO_FIX) {
+	session->context->fixcnt++;
+	session->fixcnt++;
+#ifdef AIDING_ENABLE
+	aiding_fix(session);
+#endif /* AIDING_ENABLE */
+    }
+
+    /* time to first fix, as seen from device activation */
+    if (session->gpsdata.fix.mode == MODE_3D
+	&& session->servicetype == service_sensor
+	&& isnan(session->gpsdata.dev.ttff) != 0) {
+	session->gpsdata.dev.ttff = timestamp() - session->opentime;
+	gpsd_report(LOG_INF, "%s: first 3D fix %.1f sec after activation\n",
+		    session->gpsdata.dev.path, session->gpsdata.dev.ttff);
+	/* tell clients on the next packet */
+	session->notify_clients = true;
+    }
+
+#ifdef TIMING_ENABLE
+    session->d_decode_time = timestamp();
+#endif /* TIMING_ENABLE */
+
+    /*
+     * Sanity check.  This catches a surprising number of port and
+     * driver errors, including 32-vs.-64-bit problems.
+     */
+    /*@+relaxtypes +longunsignedintegral@*/
+    if ((session->gpsdata.set & TIME_SET) != 0) {
+	if (session->newdata.time > time(NULL) + (60 * 60 * 24 * 365))
+	    gpsd_report(LOG_WARN,
+			"date more than a year in the future!\n");
+	else if (session->newdata.time < 0)
+	    gpsd_report(LOG_ERROR, "date in %s is negative!\n", session->gpsdata.tag);
+    }
+    /*@-relaxtypes -longunsignedintegral@*/
+
+    return session->gpsdata.set;
+}
+
 gps_mask_t gpsd_poll(struct gps_device_t *session)
 /* update the stuff in the scoreboard structure */
 {
@@ -810,17 +1049,30 @@ gps_mask_t gpsd_poll(struct gps_device_t *session)
 
     gps_clear_fix(&session->newdata);
 
+    /* the driver reported early on this packet's account and wants it back */
+    if (session->reparse) {
+	session->reparse = false;
+	return gpsd_digest(session, PACKET_SET);
+    }
+
 #ifdef TIMING_ENABLE
     if (session->packet.outbuflen == 0)
 	session->d_xmit_time = timestamp();
 #endif /* TIMING_ENABLE */
 
+    /* keep queued output moving for callers with no main loop of ours */
+    if (session->outqueue.count > 0)
+	(void)gpsd_write_flush(session);
+
     if (session->packet.type >= COMMENT_PACKET) {
 	/*@-shiftnegative@*/
 	session->observed |= PACKET_TYPEMASK(session->packet.type);
 	/*@+shiftnegative@*/
     }
 
+    /* getters that bypass the packet lexer leave this unset */
+    session->packet.recv_time = 0;
+
     /* can we get a full packet from the device? */
     if (session->device_type) {
 	newlen = session->device_type->get_packet(session);
@@ -835,6 +1087,8 @@ gps_mask_t gpsd_poll(struct gps_device_t *session)
     /* update the scoreboard structure from the GPS */
     gpsd_report(LOG_RAW + 2, "%s sent %zd new characters\n",
 		session->gpsdata.dev.path, newlen);
+    if (newlen > 0)
+	gpsd_link_account(session, (size_t)newlen);
     if (newlen < 0) {		/* read error */
 	gpsd_report(LOG_INF, "GPS on %s returned error %zd (%lf sec since data)\n",
 		    session->gpsdata.dev.path, newlen,
@@ -885,13 +1139,18 @@ gps_mask_t gpsd_poll(struct gps_device_t *session)
 	return ONLINE_SET;
     } else {			/* we have recognized a packet */
 	gps_mask_t received = PACKET_SET;
-	session->gpsdata.online = timestamp();
+
+	/* credit the packet with the arrival time of its first byte */
+	if (session->packet.recv_time > 0)
+	    session->gpsdata.online = session->packet.recv_time;
+	else
+	    session->gpsdata.online = timestamp();
 
 	gpsd_report(LOG_RAW + 3, "Accepted packet on %s.\n",
 		    session->gpsdata.dev.path);
 
 #ifdef TIMING_ENABLE
-	session->d_recv_time = timestamp();
+	session->d_recv_time = session->gpsdata.online;
 #endif /* TIMING_ENABLE */
 
 	/* track the packet count since achieving sync on the device */
@@ -941,81 +1200,7 @@ gps_mask_t gpsd_poll(struct gps_device_t *session)
 			session->packet.outbuflen,
 			gpsd_hexdump((char *)session->packet.outbuffer, session->packet.outbuflen));
 
-	/* Get data from current packet into the fix structure */
-	if (session->packet.type != COMMENT_PACKET)
-	    if (session->device_type != NULL
-		&& session->device_type->parse_packet != NULL)
-		received |= session->device_type->parse_packet(session);
-
-	session->gpsdata.set = ONLINE_SET | received;
-
-#ifdef CHEAPFLOATS_ENABLE
-	/*
-	 * Compute fix-quality data from the satellite positions.
-	 * These will not overwrite any DOPs reported from the packet
-	 * we just got.
-	 */
-	if ((received & SATELLITE_SET) != 0
-	    && session->gpsdata.satellites_visible > 0) {
-	    session->gpsdata.set |= fill_dop(&session->gpsdata, &session->gpsdata.dop);
-	    session->gpsdata.epe = NAN;
-	}
-#endif /* CHEAPFLOATS_ENABLE */
-
-	/* copy/merge device data into staging buffers */
-	/*@-nullderef -nullpass@*/
-	if ((session->gpsdata.set & CLEAR_IS) != 0)
-	    gps_clear_fix(&session->gpsdata.fix);
-	/* don't downgrade mode if holding previous fix */
-	if (session->gpsdata.fix.mode > session->newdata.mode)
-	    session->gpsdata.set &= ~MODE_SET;
-	//gpsd_report(LOG_PROG,
-	//              "transfer mask on %s: %02x\n", session->gpsdata.tag, session->gpsdata.set);
-	gps_merge_fix(&session->gpsdata.fix,
-		      session->gpsdata.set, &session->newdata);
-#ifdef CHEAPFLOATS_ENABLE
-	gpsd_error_model(session, &session->gpsdata.fix, &session->oldfix);
-#endif /* CHEAPFLOATS_ENABLE */
-
-	/*@+nullderef -nullpass@*/
-
-	/*
-	 * Count good fixes. We used to check
-	 *      session->gpsdata.status > STATUS_NO_FIX
-	 * here, but that wasn't quite right.  That tells us whether
-	 * we think we have a valid fix for the current cycle, but remains
-	 * true while following non-fix packets are received.  What we
-	 * really want to know is whether the last packet received was a
-	 * fix packet AND held a valid fix. We must ignore non-fix packets
-	 * AND packets which have fix data but are flagged as invalid. Some
-	 * devices output fix packets on a regular basis, even when unable
-	 * to derive a good fix. Such packets should set STATUS_NO_FIX.
-	 */
-	if ((session->gpsdata.set & LATLON_SET) != 0
-	    && session->gpsdata.status > STATUS_NO_FIX) {
-	    session->context->fixcnt++;
-	    session->fixcnt++;
-	}
-
-#ifdef TIMING_ENABLE
-	session->d_decode_time = timestamp();
-#endif /* TIMING_ENABLE */
-
-	/*
-	 * Sanity check.  This catches a surprising number of port and
-	 * driver errors, including 32-vs.-64-bit problems.
-	 */
-	/*@+relaxtypes +longunsignedintegral@*/
-	if ((session->gpsdata.set & TIME_SET) != 0) {
-	    if (session->newdata.time > time(NULL) + (60 * 60 * 24 * 365))
-		gpsd_report(LOG_WARN,
-			    "date more than a year in the future!\n");
-	    else if (session->newdata.time < 0)
-		gpsd_report(LOG_ERROR, "date in %s is negative!\n", session->gpsdata.tag);
-	}
-	/*@-relaxtypes -longunsignedintegral@*/
-
-	return session->gpsdata.set;
+	return gpsd_digest(session, received);
     }
 }
 
@@ -1035,3 +1220,46 @@ void gpsd_zero_satellites( /*@out@*/ struct gps_data_t *out)
     out->satellites_visible = 0;
     gps_clear_dop(&out->dop);
 }
+
+void gpsd_raw_clear(/*@out@*/struct rawdata_t *raw)
+/* mark every measurement channel empty */
+{
+    int i;
+
+    (void)memset(raw->PRN, 0, sizeof(raw->PRN));
+    (void)memset(raw->satstat, 0, sizeof(raw->satstat));
+    for (i = 0; i < MAXCHANNELS; i++) {
+	raw->ss[i] = NAN;
+	raw->codephase[i] = NAN;
+	raw->carrierphase[i] = NAN;
+	raw->pseudorange[i] = NAN;
+	raw->deltarange[i] = NAN;
+	raw->doppler[i] = NAN;
+	raw->mtime[i] = NAN;
+    }
+}
+
+gps_mask_t gpsd_raw_gather(struct gps_device_t *session, timestamp_t mtime,
+			   /*@out@*/int *slot)
+/*
+ * Find a channel for one satellite's measurement at mtime, for drivers
+ * whose receivers report each satellite in its own message.  The first
+ * measurement of a new epoch completes the previous one, which is
+ * copied out for reporting; the caller should return the mask.
+ */
+{
+    struct rawdata_t *batch = &session->rawbatch;
+    gps_mask_t mask = 0;
+    int i;
+
+    if (batch->PRN[0] != 0 && batch->mtime[0] != mtime) {
+	(void)memcpy(&session->gpsdata.raw, batch, sizeof(struct rawdata_t));
+	gpsd_raw_clear(batch);
+	mask = RAW_SET;
+    }
+    for (i = 0; i < MAXCHANNELS; i++)
+	if (batch->PRN[i] == 0)
+	    break;
+    *slot = (i < MAXCHANNELS) ? i : -1;
+    return mask;
+}
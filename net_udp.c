@@ -1,11 +1,21 @@
 /* 
  * net_udp.c -- gather and dispatch broadcast UDP packets
+ *
+ * A busy AIS or NMEA feed can deliver thousands of datagrams a second,
+ * and at that rate a system call per datagram costs more than lexing
+ * it.  Datagrams are therefore pulled off the socket UDP_BATCH at a
+ * time, with recvmmsg(2) where the system has it, and handed to the
+ * lexer one by one.  Each datagram is taken to hold whole sentences:
+ * the lexer starts every datagram in its ground state, so a sentence
+ * cut short at the end of one is dropped rather than glued to the
+ * start of the next, which might be from another sender.
  */
 #include <sys/types.h>
 #include <stdio.h>
 #include <stdbool.h>
 #include <stdlib.h>
 #include <string.h>
+#include <errno.h>
 #include <fcntl.h>
 #ifndef S_SPLINT_S
 #include <netdb.h>
@@ -15,6 +25,20 @@
 
 #include "gpsd.h"
 
+/*
+ * A batch holds UDP_BATCH of the largest datagrams we keep, far more
+ * than the rest of a device, so batches live in a small pool instead.
+ * A feed takes one on its first read and gives it back on close.
+ */
+struct udp_batch_t {
+    /*@null@*/struct gps_device_t *owner;	/* NULL if free */
+    unsigned char buf[UDP_BATCH][UDP_DATAGRAM_MAX];
+    size_t len[UDP_BATCH];		/* 0 for a dropped datagram */
+    timestamp_t stamp[UDP_BATCH];	/* kernel arrival time */
+};
+
+static struct udp_batch_t udp_batches[UDP_FEEDS];
+
 /*@ -branchstate */
 int udp_open(struct gps_device_t *device, const char *bcastport)
 /* listen for open a connection to a UDP server */
@@ -22,6 +46,11 @@ int udp_open(struct gps_device_t *device, const char *bcastport)
     int sock;                         /* Socket */
     struct sockaddr_in broadcastAddr; /* Broadcast Address */
     unsigned short broadcastPort;     /* Port */
+    int rcvbuf;
+    socklen_t optlen = sizeof(rcvbuf);
+#if defined(SO_TIMESTAMPNS) || defined(SO_RXQ_OVFL)
+    int on = 1;
+#endif /* defined(SO_TIMESTAMPNS) || defined(SO_RXQ_OVFL) */
 
     broadcastPort = atoi(bcastport);
 
@@ -29,6 +58,35 @@ int udp_open(struct gps_device_t *device, const char *bcastport)
     if ((sock = socket(PF_INET, SOCK_DGRAM, IPPROTO_UDP)) < 0)
       return NL_NOSOCK;
 
+    /*
+     * Datagrams that arrive while we're busy wait in the socket buffer,
+     * and the default one holds only a second or so of a busy feed.
+     * Linux doubles the size asked for and caps it at rmem_max.
+     */
+    rcvbuf = device->context->udp_rcvbuf;
+    if (rcvbuf > 0
+	&& setsockopt(sock, SOL_SOCKET, SO_RCVBUF,
+		      (char *)&rcvbuf, sizeof(rcvbuf)) == -1)
+	gpsd_report(LOG_WARN, "UDP receive buffer of %d bytes refused: %s\n",
+		    rcvbuf, strerror(errno));
+    if (getsockopt(sock, SOL_SOCKET, SO_RCVBUF, (char *)&rcvbuf, &optlen) == 0)
+	gpsd_report(LOG_INF, "UDP port %s: receive buffer %d bytes\n",
+		    bcastport, rcvbuf);
+#ifdef SO_TIMESTAMPNS
+    /* stamp datagrams when they arrive, not when a batch is read */
+    if (setsockopt(sock, SOL_SOCKET, SO_TIMESTAMPNS,
+		   (char *)&on, sizeof(on)) == -1)
+	gpsd_report(LOG_WARN, "no UDP arrival times on port %s: %s\n",
+		    bcastport, strerror(errno));
+#endif /* SO_TIMESTAMPNS */
+#ifdef SO_RXQ_OVFL
+    /* have the kernel tell us how many datagrams it had to throw away */
+    if (setsockopt(sock, SOL_SOCKET, SO_RXQ_OVFL,
+		   (char *)&on, sizeof(on)) == -1)
+	gpsd_report(LOG_WARN, "no UDP overrun counts on port %s: %s\n",
+		    bcastport, strerror(errno));
+#endif /* SO_RXQ_OVFL */
+
     /* Construct bind structure */
     memset(&broadcastAddr, 0, sizeof(broadcastAddr));   /* Zero out structure */
     broadcastAddr.sin_family = AF_INET;                 /* Internet address family */
@@ -36,14 +94,228 @@ int udp_open(struct gps_device_t *device, const char *bcastport)
     broadcastAddr.sin_port = htons(broadcastPort);      /* Broadcast port */
 
     /* Bind to the broadcast port */
-    if (bind(sock, (struct sockaddr *) &broadcastAddr, sizeof(broadcastAddr)))
-      return 0;
+    if (bind(sock, (struct sockaddr *) &broadcastAddr, sizeof(broadcastAddr))) {
+      (void)close(sock);
+      return NL_NOCONNECT;
+    }
 
+    device->udp.count = device->udp.next = 0;
+    device->udp.offset = 0;
+    device->udp.kernel_drops = 0;
+    device->udp.datagrams = device->udp.reads = 0;
+    device->udp.drops = device->udp.overruns = 0;
+    device->udp.reported = timestamp();
     return sock;
 }
 
 /*@ +branchstate */
 
+void udp_release(struct gps_device_t *session)
+/* hand a feed's batch back to the pool */
+{
+    if (session->udp.batch != NULL) {
+	session->udp.batch->owner = NULL;
+	session->udp.batch = NULL;
+    }
+    session->udp.count = session->udp.next = 0;
+    session->udp.offset = 0;
+}
+
+static /*@null@*/struct udp_batch_t *udp_claim(struct gps_device_t *session)
+/* take a batch from the pool; NULL if every one is in use */
+{
+    struct udp_batch_t *batch;
+
+    for (batch = udp_batches; batch < udp_batches + UDP_FEEDS; batch++)
+	if (batch->owner == NULL) {
+	    batch->owner = session;
+	    return batch;
+	}
+    return NULL;
+}
+
+static void udp_rate_report(struct gps_device_t *session, timestamp_t now)
+/* log how well reads are being batched and what went missing */
+{
+    session->udp.reported = now;
+    gpsd_report((session->udp.overruns > 0) ? LOG_WARN : LOG_INF,
+		"UDP feed %s: %lu datagrams in %lu reads, "
+		"%lu dropped as oversized, %lu lost to overruns\n",
+		session->gpsdata.dev.path,
+		session->udp.datagrams, session->udp.reads,
+		session->udp.drops, session->udp.overruns);
+}
+
+static int udp_fill(struct gps_device_t *session)
+/* take up to a batch of queued datagrams; 0 if none, -1 on error */
+{
+#ifdef HAVE_RECVMMSG
+    struct mmsghdr msgs[UDP_BATCH];
+#else
+    struct {
+	struct msghdr msg_hdr;
+	unsigned int msg_len;
+    } msgs[UDP_BATCH];
+#endif /* HAVE_RECVMMSG */
+    struct iovec iov[UDP_BATCH];
+    /*@ -type @*/
+    union {
+	struct cmsghdr align;
+	char buf[CMSG_SPACE(sizeof(struct timespec))
+		 + CMSG_SPACE(sizeof(uint32_t))];
+    } control[UDP_BATCH];
+    /*@ +type @*/
+    struct udp_batch_t *batch = session->udp.batch;
+    timestamp_t now;
+    int i, n;
+
+    if (batch == NULL && (batch = udp_claim(session)) == NULL) {
+	gpsd_report(LOG_ERROR, "UDP feed %s: all %d batch buffers in use\n",
+		    session->gpsdata.dev.path, UDP_FEEDS);
+	return -1;
+    }
+    session->udp.batch = batch;
+    (void)memset(msgs, '\0', sizeof(msgs));
+    for (i = 0; i < UDP_BATCH; i++) {
+	iov[i].iov_base = batch->buf[i];
+	iov[i].iov_len = sizeof(batch->buf[i]);
+	msgs[i].msg_hdr.msg_iov = &iov[i];
+	msgs[i].msg_hdr.msg_iovlen = 1;
+	msgs[i].msg_hdr.msg_control = control[i].buf;
+	msgs[i].msg_hdr.msg_controllen = sizeof(control[i].buf);
+    }
+    session->udp.count = session->udp.next = 0;
+    session->udp.offset = 0;
+    errno = 0;
+#ifdef HAVE_RECVMMSG
+    n = recvmmsg(session->gpsdata.gps_fd, msgs, UDP_BATCH, MSG_DONTWAIT, NULL);
+#else
+    /* same batching, but a system call for each datagram */
+    for (n = 0; n < UDP_BATCH; n++) {
+	ssize_t got = recvmsg(session->gpsdata.gps_fd,
+			      &msgs[n].msg_hdr, MSG_DONTWAIT);
+	if (got == -1)
+	    break;
+	msgs[n].msg_len = (unsigned int)got;
+    }
+    if (n == 0)
+	n = -1;
+#endif /* HAVE_RECVMMSG */
+    if (n == -1) {
+	if (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR) {
+	    gpsd_report(LOG_RAW + 2, "no datagrams ready\n");
+	    return 0;
+	}
+	gpsd_report(LOG_RAW + 2, "errno: %s\n", strerror(errno));
+	return -1;
+    }
+
+    now = timestamp();
+    session->udp.reads++;
+    session->udp.datagrams += n;
+    for (i = 0; i < n; i++) {
+	struct msghdr *msg = &msgs[i].msg_hdr;
+	struct cmsghdr *cmsg;
+
+	batch->len[i] = (size_t)msgs[i].msg_len;
+	batch->stamp[i] = now;
+	for (cmsg = CMSG_FIRSTHDR(msg); cmsg != NULL;
+	     cmsg = CMSG_NXTHDR(msg, cmsg)) {
+	    if (cmsg->cmsg_level != SOL_SOCKET)
+		continue;
+#ifdef SO_TIMESTAMPNS
+	    if (cmsg->cmsg_type == SCM_TIMESTAMPNS) {
+		struct timespec ts;
+		(void)memcpy(&ts, CMSG_DATA(cmsg), sizeof(ts));
+		batch->stamp[i] = (timestamp_t)ts.tv_sec + ts.tv_nsec * 1e-9;
+	    }
+#endif /* SO_TIMESTAMPNS */
+#ifdef SO_RXQ_OVFL
+	    /* a running total for the socket; unsigned arithmetic wraps */
+	    if (cmsg->cmsg_type == SO_RXQ_OVFL) {
+		uint32_t dropped;
+		(void)memcpy(&dropped, CMSG_DATA(cmsg), sizeof(dropped));
+		session->udp.overruns += dropped - session->udp.kernel_drops;
+		session->udp.kernel_drops = dropped;
+	    }
+#endif /* SO_RXQ_OVFL */
+	}
+	if ((msg->msg_flags & MSG_TRUNC) != 0) {
+	    session->udp.drops++;
+	    batch->len[i] = 0;
+	}
+	if (session->packet.debug >= LOG_RAW+1)
+	    gpsd_report(LOG_RAW + 1, "Datagram %d of %d, %zu chars: %s\n",
+			i + 1, n, batch->len[i],
+			gpsd_hexdump((char *)batch->buf[i], batch->len[i]));
+    }
+    session->udp.count = n;
+
+    if (now - session->udp.reported > UDP_REPORT)
+	udp_rate_report(session, now);
+    return n;
+}
+
+ssize_t udp_get(struct gps_device_t *session)
+/* grab a packet from the current batch of datagrams, reading more if needed */
+{
+    struct gps_packet_t *lexer = &session->packet;
+    ssize_t taken = 0;
+
+    for (;;) {
+	int i;
+	size_t chunk;
+
+	if (packet_buffered_input(lexer) > 0) {
+	    packet_parse(lexer);
+	    if (lexer->outbuflen > 0)
+		return (ssize_t)lexer->outbuflen;
+	}
+
+	i = session->udp.next;
+	if (i >= session->udp.count
+	    || session->udp.offset >= session->udp.batch->len[i]) {
+	    int type = lexer->type;
+
+	    /* this datagram is used up, so start on the next */
+	    if (i < session->udp.count)
+		i = ++session->udp.next;
+	    if (i >= session->udp.count) {
+		int got = udp_fill(session);
+		if (got <= 0)
+		    return (taken > 0) ? taken : (ssize_t)got;
+		i = 0;
+	    }
+	    session->udp.offset = 0;
+	    /*
+	     * Whatever is left of the last datagram is a fragment that
+	     * can't be completed.  Keep the type of the last packet,
+	     * which gpsd_poll() goes by when no packet is returned.
+	     */
+	    packet_reset(lexer);
+	    lexer->type = type;
+	    lexer->stamp_old = lexer->stamp_new = session->udp.batch->stamp[i];
+	} else if (lexer->inbuflen == sizeof(lexer->inbuffer)) {
+	    /* as in packet_get(), a full buffer with no packet is junk */
+	    int type = lexer->type;
+
+	    packet_reset(lexer);
+	    lexer->type = type;
+	    lexer->stamp_old = lexer->stamp_new = session->udp.batch->stamp[i];
+	}
+
+	/* a datagram bigger than the lexer's buffer goes in by pieces */
+	chunk = session->udp.batch->len[i] - session->udp.offset;
+	if (chunk > sizeof(lexer->inbuffer) - lexer->inbuflen)
+	    chunk = sizeof(lexer->inbuffer) - lexer->inbuflen;
+	(void)memcpy(lexer->inbuffer + lexer->inbuflen,
+		     session->udp.batch->buf[i] + session->udp.offset, chunk);
+	lexer->inbuflen += chunk;
+	session->udp.offset += chunk;
+	taken += (ssize_t)chunk;
+    }
+}
+
 void udp_report(struct gps_context_t *context,
 		   struct gps_device_t *gps,
 		   struct gps_device_t *dgpsip)
@@ -215,7 +215,16 @@ int ntpshm_put(struct gps_device_t *session, double fixtime, double fudge)
 	return 0;
     }
 
-    (void)gettimeofday(&tv, NULL);
+    /*
+     * The receive timestamp is when the sentence carrying the fix time
+     * arrived, not when we got around to decoding it.
+     */
+    if (session->gpsdata.online > 0) {
+	double usec = 1000000.0 * modf(session->gpsdata.online, &seconds);
+	tv.tv_sec = (time_t) seconds;
+	tv.tv_usec = (suseconds_t) usec;
+    } else
+	(void)gettimeofday(&tv, NULL);
     fixtime += fudge;
     microseconds = 1000000.0 * modf(fixtime, &seconds);
     if (shmTime->clockTimeStampSec == (time_t) seconds) {
@@ -29,11 +29,16 @@ PERMISSIONS
 ***************************************************************************/
 #include <sys/types.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <stdbool.h>
 #include <ctype.h>
 #include <string.h>
 #include <errno.h>
+#include <time.h>
+#include <sys/time.h>
 #ifndef S_SPLINT_S
+#include <sys/socket.h>
+#include <sys/uio.h>
 #include <netinet/in.h>
 #include <arpa/inet.h>		/* for htons() */
 #include <unistd.h>
@@ -50,6 +55,9 @@ PERMISSIONS
  * 1) Comments. These begin with # and end with \r\n.
  *
  * 2) NMEA lines.  These begin with $, and with \r\n, and have a checksum.
+ *    They may be prefixed with an NMEA 4.x tag block, as aggregated AIS
+ *    feeds do: \s:source,c:time*hh\ with its own checksum.  The tag block
+ *    is checked here and stripped from the sentence; see tagblock_parse().
  *
  * 3) Binary packets.  These begin with some fixed leader character(s),
  *    have a length embedded in them, and end with a checksum (and possibly)
@@ -104,6 +112,14 @@ enum
 #define STX	(unsigned char)0x02
 #define ETX	(unsigned char)0x03
 
+/* buffer offset of the character nextstate() is currently looking at */
+#define CHAR_OFFSET(lexer)	((size_t)((lexer)->inbufptr - (lexer)->inbuffer) - 1)
+
+/* value of a digit already vetted with isxdigit() */
+#define hexdigit(c)	(unsigned int)(isdigit(c) ? (c) - '0' : toupper(c) - 'A' + 10)
+
+#define NMEA_TAG_MAX	100	/* longest tag block we'll wait out */
+
 #ifdef ONCORE_ENABLE
 static size_t oncore_payload_cksum_length(unsigned char id1, unsigned char id2)
 {
@@ -200,6 +216,11 @@ static void nextstate(struct gps_packet_t *lexer, unsigned char c)
 	    lexer->state = NMEA_BANG;
 	    break;
 	}
+	if (c == '\\') {
+	    lexer->state = NMEA_TAG_BODY;
+	    lexer->cksum_a = 0;
+	    break;
+	}
 #endif /* NMEA_ENABLE */
 #if defined(TNT_ENABLE) || defined(GARMINTXT_ENABLE) || defined(ONCORE_ENABLE)
 	if (c == '@') {
@@ -222,6 +243,7 @@ static void nextstate(struct gps_packet_t *lexer, unsigned char c)
 #if defined(TSIP_ENABLE) || defined(EVERMORE_ENABLE) || defined(GARMIN_ENABLE)
 	if (c == DLE) {
 	    lexer->state = DLE_LEADER;
+	    lexer->cksum_a = 1;		/* TSIP counts DLEs as it goes */
 	    break;
 	}
 #endif /* TSIP_ENABLE || EVERMORE_ENABLE || GARMIN_ENABLE */
@@ -390,13 +412,14 @@ static void nextstate(struct gps_packet_t *lexer, unsigned char c)
 	    lexer->state = NMEA_BINARY_BODY;
 	break;
     case NMEA_BANG:
-	if (c == 'A')
+	/* AI is usual, but base stations and repeaters have their own */
+	if (isupper(c))
 	    lexer->state = AIS_LEAD_1;
 	else
 	    lexer->state = GROUND_STATE;
 	break;
     case AIS_LEAD_1:
-	if (c == 'I')
+	if (isupper(c))
 	    lexer->state = AIS_LEAD_2;
 	else
 	    lexer->state = GROUND_STATE;
@@ -476,6 +499,11 @@ static void nextstate(struct gps_packet_t *lexer, unsigned char c)
 	    lexer->state = NMEA_DOLLAR;
 	else if (c == '!')
 	    lexer->state = NMEA_BANG;
+	else if (c == '\\') {
+	    lexer->state = NMEA_TAG_BODY;
+	    lexer->cksum_a = 0;
+	    n = 0;
+	}
 #ifdef UBX_ENABLE
 	else if (c == 0xb5)	/* LEA-5H can and will output NMEA and UBX back to back */
 	    lexer->state = UBX_LEADER_1;
@@ -483,6 +511,50 @@ static void nextstate(struct gps_packet_t *lexer, unsigned char c)
 	else
 	    lexer->state = GROUND_STATE;
 	break;
+    case NMEA_TAG_BODY:
+	if (c == '*')
+	    lexer->state = NMEA_TAG_STAR;
+	else if (!isprint(c) || c == '\\' || n > NMEA_TAG_MAX)
+	    lexer->state = GROUND_STATE;
+	else
+	    lexer->cksum_a ^= c;
+	break;
+    case NMEA_TAG_STAR:
+	if (isxdigit(c)) {
+	    lexer->cksum_b = hexdigit(c) << 4;
+	    lexer->state = NMEA_TAG_HEX1;
+	} else
+	    lexer->state = GROUND_STATE;
+	break;
+    case NMEA_TAG_HEX1:
+	if (isxdigit(c)) {
+	    lexer->cksum_b |= hexdigit(c);
+	    lexer->state = NMEA_TAG_HEX2;
+	} else
+	    lexer->state = GROUND_STATE;
+	break;
+    case NMEA_TAG_HEX2:
+	if (c != '\\')
+	    lexer->state = GROUND_STATE;
+	else if (lexer->cksum_a != lexer->cksum_b) {
+	    gpsd_report(LOG_WARN,
+			"bad checksum in NMEA tag block; expected %02X.\n",
+			lexer->cksum_a);
+	    lexer->state = GROUND_STATE;
+	} else
+	    lexer->state = NMEA_TAG_END;
+	break;
+    case NMEA_TAG_END:
+	/* the sentence proper starts here, lex it as if untagged */
+	lexer->taglen = CHAR_OFFSET(lexer);
+	n = 0;
+	if (c == '$')
+	    lexer->state = NMEA_DOLLAR;
+	else if (c == '!')
+	    lexer->state = NMEA_BANG;
+	else
+	    lexer->state = GROUND_STATE;
+	break;
     case SEATALK_LEAD_1:
 	if (c == 'I' || c == 'N')	/* II or IN are accepted */
 	    lexer->state = NMEA_LEADER_END;
@@ -671,12 +743,16 @@ static void nextstate(struct gps_packet_t *lexer, unsigned char c)
 	break;
     case SIRF_LENGTH_1:
 	lexer->length += c + 2;
+	lexer->cksum_a = 0;
 	if (lexer->length <= MAX_PACKET_LENGTH)
 	    lexer->state = SIRF_PAYLOAD;
 	else
 	    lexer->state = GROUND_STATE;
 	break;
     case SIRF_PAYLOAD:
+	/* the last two bytes counted by length are the checksum */
+	if (lexer->length > 2)
+	    lexer->cksum_a += c;
 	if (--lexer->length == 0)
 	    lexer->state = SIRF_DELIVERED;
 	break;
@@ -702,15 +778,18 @@ static void nextstate(struct gps_packet_t *lexer, unsigned char c)
 #ifdef SUPERSTAR2_ENABLE
     case SUPERSTAR2_LEADER:
 	ctmp = c;
+	lexer->cksum_a = SOH + c;
 	lexer->state = SUPERSTAR2_ID1;
 	break;
     case SUPERSTAR2_ID1:
+	lexer->cksum_a += c;
 	if ((ctmp ^ 0xff) == c)
 	    lexer->state = SUPERSTAR2_ID2;
 	else
 	    lexer->state = GROUND_STATE;
 	break;
     case SUPERSTAR2_ID2:
+	lexer->cksum_a += c;
 	lexer->length = (size_t) c;	/* how many data bytes follow this byte */
 	if (lexer->length)
 	    lexer->state = SUPERSTAR2_PAYLOAD;
@@ -718,6 +797,7 @@ static void nextstate(struct gps_packet_t *lexer, unsigned char c)
 	    lexer->state = SUPERSTAR2_CKSUM1;	/* no data, jump to checksum */
 	break;
     case SUPERSTAR2_PAYLOAD:
+	lexer->cksum_a += c;
 	if (--lexer->length == 0)
 	    lexer->state = SUPERSTAR2_CKSUM1;
 	break;
@@ -738,11 +818,13 @@ static void nextstate(struct gps_packet_t *lexer, unsigned char c)
     case ONCORE_AT2:
 	if (isupper(c)) {
 	    lexer->length = (size_t) c;
+	    lexer->cksum_a = c;
 	    lexer->state = ONCORE_ID1;
 	} else
 	    lexer->state = GROUND_STATE;
 	break;
     case ONCORE_ID1:
+	lexer->cksum_a ^= c;
 	if (isalpha(c)) {
 	    lexer->length =
 		oncore_payload_cksum_length((unsigned char)lexer->length, c);
@@ -754,8 +836,11 @@ static void nextstate(struct gps_packet_t *lexer, unsigned char c)
 	lexer->state = GROUND_STATE;
 	break;
     case ONCORE_PAYLOAD:
+	/* the last byte counted by length is the checksum itself */
 	if (--lexer->length == 0)
 	    lexer->state = ONCORE_CHECKSUM;
+	else
+	    lexer->cksum_a ^= c;
 	break;
     case ONCORE_CHECKSUM:
 	if (c != '\r')
@@ -813,35 +898,32 @@ static void nextstate(struct gps_packet_t *lexer, unsigned char c)
 	    lexer->state = GROUND_STATE;
 	break;
     case NAVCOM_LEADER_3:
+	lexer->cksum_a = c;		/* XOR checksum starts at message ID */
 	lexer->state = NAVCOM_ID;
 	break;
     case NAVCOM_ID:
+	lexer->cksum_a ^= c;
 	lexer->length = (size_t) c - 4;
 	lexer->state = NAVCOM_LENGTH_1;
 	break;
     case NAVCOM_LENGTH_1:
+	lexer->cksum_a ^= c;
 	lexer->length += (c << 8);
 	lexer->state = NAVCOM_LENGTH_2;
 	break;
     case NAVCOM_LENGTH_2:
+	lexer->cksum_a ^= c;
 	if (--lexer->length == 0)
 	    lexer->state = NAVCOM_PAYLOAD;
 	break;
     case NAVCOM_PAYLOAD:
-    {
-	unsigned char csum = lexer->inbuffer[3];
-	for (n = 4;
-	     (unsigned char *)(lexer->inbuffer + n) < lexer->inbufptr - 1;
-	     n++)
-	    csum ^= lexer->inbuffer[n];
-	if (csum != c) {
+	if ((unsigned char)lexer->cksum_a != c) {
 	    gpsd_report(LOG_IO,
 			"Navcom packet type 0x%hhx bad checksum 0x%hhx, expecting 0x%hx\n",
-			lexer->inbuffer[3], csum, c);
+			lexer->inbuffer[3], (unsigned char)lexer->cksum_a, c);
 	    lexer->state = GROUND_STATE;
 	    break;
 	}
-    }
 	lexer->state = NAVCOM_CSUM;
 	break;
     case NAVCOM_CSUM:
@@ -932,6 +1014,7 @@ static void nextstate(struct gps_packet_t *lexer, unsigned char c)
 	gpsd_report(LOG_RAW + 1, "Zodiac header id=%hd len=%hd flags=%hx\n",
 		    getword(1), getword(2), getword(3));
 #undef getword
+	lexer->cksum_a = 0;
 	if (lexer->length == 0) {
 	    lexer->state = ZODIAC_RECOGNIZED;
 	    break;
@@ -945,28 +1028,42 @@ static void nextstate(struct gps_packet_t *lexer, unsigned char c)
 	    lexer->state = GROUND_STATE;
 	break;
     case ZODIAC_PAYLOAD:
+	/* sum little-endian data words; the final word is the checksum */
+	if (lexer->length > 2)
+	    lexer->cksum_a += (CHAR_OFFSET(lexer) & 1) ? (c << 8) : c;
 	if (--lexer->length == 0)
 	    lexer->state = ZODIAC_RECOGNIZED;
 	break;
 #endif /* ZODIAC_ENABLE */
 #ifdef UBX_ENABLE
+/* UBX uses an 8-bit Fletcher checksum over class, ID, length and payload */
+#define UBX_CKSUM_UPDATE(lexer, c) \
+	do { \
+	    (lexer)->cksum_a = ((lexer)->cksum_a + (c)) & 0xff; \
+	    (lexer)->cksum_b = ((lexer)->cksum_b + (lexer)->cksum_a) & 0xff; \
+	} while (0)
     case UBX_LEADER_1:
-	if (c == 0x62)
+	if (c == 0x62) {
+	    lexer->cksum_a = lexer->cksum_b = 0;
 	    lexer->state = UBX_LEADER_2;
-	else
+	} else
 	    lexer->state = GROUND_STATE;
 	break;
     case UBX_LEADER_2:
+	UBX_CKSUM_UPDATE(lexer, c);
 	lexer->state = UBX_CLASS_ID;
 	break;
     case UBX_CLASS_ID:
+	UBX_CKSUM_UPDATE(lexer, c);
 	lexer->state = UBX_MESSAGE_ID;
 	break;
     case UBX_MESSAGE_ID:
+	UBX_CKSUM_UPDATE(lexer, c);
 	lexer->length = (size_t) c;
 	lexer->state = UBX_LENGTH_1;
 	break;
     case UBX_LENGTH_1:
+	UBX_CKSUM_UPDATE(lexer, c);
 	lexer->length += (c << 8);
 	if (lexer->length <= MAX_PACKET_LENGTH)
 	    lexer->state = UBX_LENGTH_2;
@@ -974,11 +1071,15 @@ static void nextstate(struct gps_packet_t *lexer, unsigned char c)
 	    lexer->state = GROUND_STATE;
 	break;
     case UBX_LENGTH_2:
+	UBX_CKSUM_UPDATE(lexer, c);
 	lexer->state = UBX_PAYLOAD;
 	break;
     case UBX_PAYLOAD:
+	/* the byte that runs length down to zero is CK_A */
 	if (--lexer->length == 0)
 	    lexer->state = UBX_CHECKSUM_A;
+	else
+	    UBX_CKSUM_UPDATE(lexer, c);
 	/* else stay in payload state */
 	break;
     case UBX_CHECKSUM_A:
@@ -1036,9 +1137,10 @@ static void nextstate(struct gps_packet_t *lexer, unsigned char c)
 #endif /* EVERMORE_ENABLE */
 #ifdef ITRAX_ENABLE
     case ITALK_LEADER_1:
-	if (c == '!')
+	if (c == '!') {
+	    lexer->cksum_a = 0;
 	    lexer->state = ITALK_LEADER_2;
-	else
+	} else
 	    lexer->state = GROUND_STATE;
 	break;
     case ITALK_LEADER_2:
@@ -1058,7 +1160,20 @@ static void nextstate(struct gps_packet_t *lexer, unsigned char c)
 	    lexer->state = ITALK_RECOGNIZED;
 	    gpsd_report(LOG_IO, "ITALK: trying to process runt packet\n");
 	    break;
-	} else if (--lexer->length == 0)
+	} else {
+	    /*
+	     * Payload words start at offset 7; each completed word is
+	     * folded into the checksum together with its word index.
+	     */
+	    size_t offset = CHAR_OFFSET(lexer);
+	    size_t words = (size_t) lexer->inbuffer[6];
+	    if (offset >= 7 && offset < 7 + 2 * words && (offset & 1) == 0) {
+		uint16_t tmpw = (uint16_t)((c << 8) | lexer->inbuffer[offset - 1]);
+		uint32_t tmpdw = (lexer->cksum_a + 1) * (tmpw + (offset - 8) / 2);
+		lexer->cksum_a ^= (tmpdw & 0xffff) ^ ((tmpdw >> 16) & 0xffff);
+	    }
+	}
+	if (--lexer->length == 0)
 	    lexer->state = ITALK_DELIVERED;
 	break;
     case ITALK_DELIVERED:
@@ -1075,35 +1190,45 @@ static void nextstate(struct gps_packet_t *lexer, unsigned char c)
 	break;
 #endif /* ITRAX_ENABLE */
 #ifdef GEOSTAR_ENABLE
+/* GeoStar XORs little-endian 32-bit words, so each byte goes in its lane */
+#define GEOSTAR_CKSUM_UPDATE(lexer, c) \
+	(lexer)->cksum_a ^= (unsigned int)(c) << (8 * (CHAR_OFFSET(lexer) & 3))
     case GEOSTAR_LEADER_1:
-	if (c == 'S')
+	if (c == 'S') {
+	    lexer->cksum_a = 'P' | ('S' << 8);
 	    lexer->state = GEOSTAR_LEADER_2;
-	else
+	} else
 	    lexer->state = GROUND_STATE;
 	break;
     case GEOSTAR_LEADER_2:
+	GEOSTAR_CKSUM_UPDATE(lexer, c);
 	if (c == 'G')
 	    lexer->state = GEOSTAR_LEADER_3;
 	else
 	    lexer->state = GROUND_STATE;
 	break;
     case GEOSTAR_LEADER_3:
+	GEOSTAR_CKSUM_UPDATE(lexer, c);
 	if (c == 'G')
 	    lexer->state = GEOSTAR_LEADER_4;
 	else
 	    lexer->state = GROUND_STATE;
 	break;
     case GEOSTAR_LEADER_4:
+	GEOSTAR_CKSUM_UPDATE(lexer, c);
 	lexer->state = GEOSTAR_MESSAGE_ID_1;
 	break;
     case GEOSTAR_MESSAGE_ID_1:
+	GEOSTAR_CKSUM_UPDATE(lexer, c);
 	lexer->state = GEOSTAR_MESSAGE_ID_2;
 	break;
     case GEOSTAR_MESSAGE_ID_2:
+	GEOSTAR_CKSUM_UPDATE(lexer, c);
 	lexer->length = (size_t)(c * 4);
 	lexer->state = GEOSTAR_LENGTH_1;
 	break;
     case GEOSTAR_LENGTH_1:
+	GEOSTAR_CKSUM_UPDATE(lexer, c);
 	lexer->length += (c << 8) * 4;
 	if (lexer->length <= MAX_PACKET_LENGTH)
 	    lexer->state = GEOSTAR_LENGTH_2;
@@ -1111,20 +1236,25 @@ static void nextstate(struct gps_packet_t *lexer, unsigned char c)
 	    lexer->state = GROUND_STATE;
 	break;
     case GEOSTAR_LENGTH_2:
+	GEOSTAR_CKSUM_UPDATE(lexer, c);
 	lexer->state = GEOSTAR_PAYLOAD;
 	break;
     case GEOSTAR_PAYLOAD:
+	GEOSTAR_CKSUM_UPDATE(lexer, c);
 	if (--lexer->length == 0)
 	    lexer->state = GEOSTAR_CHECKSUM_A;
 	/* else stay in payload state */
 	break;
     case GEOSTAR_CHECKSUM_A:
+	GEOSTAR_CKSUM_UPDATE(lexer, c);
 	lexer->state = GEOSTAR_CHECKSUM_B;
 	break;
     case GEOSTAR_CHECKSUM_B:
+	GEOSTAR_CKSUM_UPDATE(lexer, c);
 	lexer->state = GEOSTAR_CHECKSUM_C;
 	break;
     case GEOSTAR_CHECKSUM_C:
+	GEOSTAR_CKSUM_UPDATE(lexer, c);
 	lexer->state = GEOSTAR_RECOGNIZED;
 	break;
     case GEOSTAR_RECOGNIZED:
@@ -1143,8 +1273,10 @@ static void nextstate(struct gps_packet_t *lexer, unsigned char c)
 	    lexer->state = GROUND_STATE;
 	break;
     case TSIP_PAYLOAD:
-	if (c == DLE)
+	if (c == DLE) {
+	    lexer->cksum_a++;
 	    lexer->state = TSIP_DLE;
+	}
 	break;
     case TSIP_DLE:
 	switch (c) {
@@ -1152,6 +1284,7 @@ static void nextstate(struct gps_packet_t *lexer, unsigned char c)
 	    lexer->state = TSIP_RECOGNIZED;
 	    break;
 	case DLE:
+	    lexer->cksum_a++;
 	    lexer->state = TSIP_PAYLOAD;
 	    break;
 	default:
@@ -1160,7 +1293,7 @@ static void nextstate(struct gps_packet_t *lexer, unsigned char c)
 	}
 	break;
     case TSIP_RECOGNIZED:
-	if (c == DLE)
+	if (c == DLE) {
 	    /*
 	     * Don't go to TSIP_LEADER state -- TSIP packets aren't
 	     * checksummed, so false positives are easy.  We might be
@@ -1168,7 +1301,8 @@ static void nextstate(struct gps_packet_t *lexer, unsigned char c)
 	     * or Garmin streaming binary.
 	     */
 	    lexer->state = DLE_LEADER;
-	else
+	    lexer->cksum_a = 1;
+	} else
 	    lexer->state = GROUND_STATE;
 	break;
 #endif /* TSIP_ENABLE */
@@ -1286,15 +1420,62 @@ static void nextstate(struct gps_packet_t *lexer, unsigned char c)
 /*@ -charint +casebreak @*/
 }
 
+#ifdef NMEA_ENABLE
+static void tagblock_parse(struct gps_packet_t *lexer, const char *tag,
+			   size_t len)
+/* point the tag views at the fields of a checksummed tag block */
+{
+    const char *end = tag + len, *cp, *field;
+
+    /* tag block is \field,field,...*hh\ */
+    for (cp = field = tag + 1; cp < end; cp++) {
+	if (*cp != ',' && *cp != '*')
+	    continue;
+	if (cp - field > 2 && field[1] == ':') {
+	    if (field[0] == 's') {
+		lexer->tag.source = field + 2;
+		lexer->tag.sourcelen = (size_t)(cp - field - 2);
+	    } else if (field[0] == 'c') {
+		/* seconds since 1970, or milliseconds from some feeds */
+		lexer->tag.time = (timestamp_t)strtod(field + 2, NULL);
+		if (lexer->tag.time > 1e11)
+		    lexer->tag.time /= 1000;
+	    }
+	}
+	if (*cp == '*')
+	    break;
+	field = cp + 1;
+    }
+}
+#endif /* NMEA_ENABLE */
+
 static void packet_accept(struct gps_packet_t *lexer, int packet_type)
 /* packet grab succeeded, move to output buffer */
 {
     size_t packetlen = lexer->inbufptr - lexer->inbuffer;
     if (packetlen < sizeof(lexer->outbuffer)) {
+#ifdef NMEA_ENABLE
+	/* drivers see only the sentence; its tag block goes past the NUL */
+	size_t taglen = lexer->taglen;
+
+	packetlen -= taglen;
+	memcpy(lexer->outbuffer, lexer->inbuffer + taglen, packetlen);
+	lexer->tag.source = NULL;
+	lexer->tag.sourcelen = 0;
+	lexer->tag.time = 0;
+	if (taglen > 0) {
+	    memcpy(lexer->outbuffer + packetlen + 1, lexer->inbuffer, taglen);
+	    tagblock_parse(lexer, (char *)lexer->outbuffer + packetlen + 1,
+			   taglen);
+	}
+#else
 	memcpy(lexer->outbuffer, lexer->inbuffer, packetlen);
+#endif /* NMEA_ENABLE */
 	lexer->outbuflen = packetlen;
 	lexer->outbuffer[packetlen] = '\0';
 	lexer->type = packet_type;
+	/* the packet starts at inbuffer[0]; stamp it with that byte's read */
+	lexer->recv_time = (lexer->stamp_offset > 0) ? lexer->stamp_old : lexer->stamp_new;
 	if (lexer->debug >= LOG_RAW+1)
 	    gpsd_report(LOG_RAW+1, "Packet type %d accepted %zu = %s\n",
 		    packet_type, packetlen,
@@ -1312,6 +1493,13 @@ static void packet_discard(struct gps_packet_t *lexer)
     size_t remaining = lexer->inbuflen - discard;
     lexer->inbufptr = memmove(lexer->inbuffer, lexer->inbufptr, remaining);
     lexer->inbuflen = remaining;
+#ifdef NMEA_ENABLE
+    lexer->taglen = 0;
+#endif /* NMEA_ENABLE */
+    if (lexer->stamp_offset > discard)
+	lexer->stamp_offset -= discard;
+    else
+	lexer->stamp_offset = 0;
     if (lexer->debug >= LOG_RAW+1)
 	gpsd_report(LOG_RAW + 1,
 		    "Packet discard of %zu, chars remaining is %zu = %s\n",
@@ -1324,6 +1512,11 @@ static void character_discard(struct gps_packet_t *lexer)
 {
     memmove(lexer->inbuffer, lexer->inbuffer + 1, (size_t)-- lexer->inbuflen);
     lexer->inbufptr = lexer->inbuffer;
+#ifdef NMEA_ENABLE
+    lexer->taglen = 0;
+#endif /* NMEA_ENABLE */
+    if (lexer->stamp_offset > 0)
+	lexer->stamp_offset--;
     if (lexer->debug >= LOG_RAW+1)
 	gpsd_report(LOG_RAW + 1, "Character discarded, buffer %zu chars = %s\n",
 		    lexer->inbuflen,
@@ -1373,11 +1566,13 @@ void packet_parse(struct gps_packet_t *lexer)
 	}
 #ifdef NMEA_ENABLE
 	else if (lexer->state == NMEA_RECOGNIZED) {
+	    /* the sentence proper, past any tag block */
+	    unsigned char *sentence = lexer->inbuffer + lexer->taglen;
 	    /*
 	     * $PASHR packets have no checksum. Avoid the possibility
 	     * that random garbage might make it look like they do.
 	     */
-	    if (strncmp((const char *)lexer->inbuffer, "$PASHR,", 7) != 0)
+	    if (strncmp((const char *)sentence, "$PASHR,", 7) != 0)
 	    {
 		bool checksum_ok = true;
 		char csum[3] = { '0', '0', '0' };
@@ -1392,8 +1587,8 @@ void packet_parse(struct gps_packet_t *lexer)
 		    --end;
 		if (*end == '*') {
 		    unsigned int n, crc = 0;
-		    for (n = 1; (char *)lexer->inbuffer + n < end; n++)
-			crc ^= lexer->inbuffer[n];
+		    for (n = 1; (char *)sentence + n < end; n++)
+			crc ^= sentence[n];
 		    (void)snprintf(csum, sizeof(csum), "%02X", crc);
 		    checksum_ok = (csum[0] == toupper(end[1])
 				   && csum[1] == toupper(end[2]));
@@ -1412,9 +1607,9 @@ void packet_parse(struct gps_packet_t *lexer)
 	    }
 	    /* checksum passed or not present */
 #ifdef AIVDM_ENABLE
-	    if (strncmp((char *)lexer->inbuffer, "!AIVDM", 6) == 0)
-		packet_accept(lexer, AIVDM_PACKET);
-	    else if (strncmp((char *)lexer->inbuffer, "!AIVDO", 6) == 0)
+	    if (sentence[0] == '!'
+		&& (strncmp((char *)sentence + 3, "VDM", 3) == 0
+		    || strncmp((char *)sentence + 3, "VDO", 3) == 0))
 		packet_accept(lexer, AIVDM_PACKET);
 	    else
 #endif /* AIVDM_ENABLE */
@@ -1428,10 +1623,8 @@ void packet_parse(struct gps_packet_t *lexer)
 	    unsigned char *trailer = lexer->inbufptr - 4;
 	    unsigned int checksum =
 		(unsigned)((trailer[0] << 8) | trailer[1]);
-	    unsigned int n, crc = 0;
-	    for (n = 4; n < (unsigned)(trailer - lexer->inbuffer); n++)
-		crc += (int)lexer->inbuffer[n];
-	    crc &= 0x7fff;
+	    /* payload sum was accumulated by the lexer */
+	    unsigned int crc = lexer->cksum_a & 0x7fff;
 	    if (checksum == crc)
 		packet_accept(lexer, SIRF_PACKET);
 	    else {
@@ -1444,11 +1637,8 @@ void packet_parse(struct gps_packet_t *lexer)
 #endif /* SIRF_ENABLE */
 #ifdef SUPERSTAR2_ENABLE
 	else if (lexer->state == SUPERSTAR2_RECOGNIZED) {
-	    unsigned a = 0, b;
-	    size_t n;
+	    unsigned a = lexer->cksum_a, b;
 	    lexer->length = 4 + (size_t) lexer->inbuffer[3] + 2;
-	    for (n = 0; n < lexer->length - 2; n++)
-		a += (unsigned)lexer->inbuffer[n];
 	    b = (unsigned)getleu16(lexer->inbuffer, lexer->length - 2);
 	    gpsd_report(LOG_IO, "SuperStarII pkt dump: type %u len %u\n",
 			lexer->inbuffer[1], (unsigned int)lexer->length);
@@ -1468,13 +1658,11 @@ void packet_parse(struct gps_packet_t *lexer)
 #ifdef ONCORE_ENABLE
 	else if (lexer->state == ONCORE_RECOGNIZED) {
 	    char a, b;
-	    int i, len;
+	    int len;
 
 	    len = lexer->inbufptr - lexer->inbuffer;
 	    a = (char)(lexer->inbuffer[len - 3]);
-	    b = '\0';
-	    for (i = 2; i < len - 3; i++)
-		b ^= lexer->inbuffer[i];
+	    b = (char)lexer->cksum_a;
 	    if (a == b) {
 		gpsd_report(LOG_IO, "Accept OnCore packet @@%c%c len %d\n",
 			    lexer->inbuffer[2], lexer->inbuffer[3], len);
@@ -1493,12 +1681,8 @@ void packet_parse(struct gps_packet_t *lexer)
 	else if (lexer->state == TSIP_RECOGNIZED) {
 	    size_t packetlen = lexer->inbufptr - lexer->inbuffer;
 #ifdef TSIP_ENABLE
-	    unsigned int pos, dlecnt;
 	    /* don't count stuffed DLEs in the length */
-	    dlecnt = 0;
-	    for (pos = 0; pos < (unsigned int)packetlen; pos++)
-		if (lexer->inbuffer[pos] == DLE)
-		    dlecnt++;
+	    unsigned int dlecnt = lexer->cksum_a;
 	    if (dlecnt > 2) {
 		dlecnt -= 2;
 		dlecnt /= 2;
@@ -1709,10 +1893,9 @@ void packet_parse(struct gps_packet_t *lexer)
 #endif /* RTCM104V3_ENABLE */
 #ifdef ZODIAC_ENABLE
 	else if (lexer->state == ZODIAC_RECOGNIZED) {
-	    short len, n, sum;
+	    short len, sum;
 	    len = getword(2);
-	    for (n = sum = 0; n < len; n++)
-		sum += getword(5 + n);
+	    sum = (short)lexer->cksum_a;
 	    sum *= -1;
 	    if (len == 0 || sum == getword(5 + len)) {
 		packet_accept(lexer, ZODIAC_PACKET);
@@ -1729,16 +1912,12 @@ void packet_parse(struct gps_packet_t *lexer)
 #endif /* ZODIAC_ENABLE */
 #ifdef UBX_ENABLE
 	else if (lexer->state == UBX_RECOGNIZED) {
-	    /* UBX use a TCP like checksum */
-	    int n, len;
-	    unsigned char ck_a = (unsigned char)0;
-	    unsigned char ck_b = (unsigned char)0;
+	    /* UBX use a TCP like checksum, accumulated while lexing */
+	    int len;
+	    unsigned char ck_a = (unsigned char)lexer->cksum_a;
+	    unsigned char ck_b = (unsigned char)lexer->cksum_b;
 	    len = lexer->inbufptr - lexer->inbuffer;
 	    gpsd_report(LOG_IO, "UBX: len %d\n", len);
-	    for (n = 2; n < (len - 2); n++) {
-		ck_a += lexer->inbuffer[n];
-		ck_b += ck_a;
-	    }
 	    if (ck_a == lexer->inbuffer[len - 2] &&
 		ck_b == lexer->inbuffer[len - 1])
 		packet_accept(lexer, UBX_PACKET);
@@ -1816,7 +1995,7 @@ void packet_parse(struct gps_packet_t *lexer)
 #define getiw(i) ((uint16_t)(((uint16_t)getib((i)+1) << 8) | (uint16_t)getib((i))))
 
 	else if (lexer->state == ITALK_RECOGNIZED) {
-	    volatile uint16_t len, n, csum, xsum;
+	    uint16_t len, csum, xsum;
 
 	    /* number of words */
 	    len = (uint16_t) (lexer->inbuffer[6] & 0xff);
@@ -1824,14 +2003,8 @@ void packet_parse(struct gps_packet_t *lexer)
 	    /*@ -type @*/
 	    /* expected checksum */
 	    xsum = getiw(7 + 2 * len);
-
-
-	    csum = 0;
-	    for (n = 0; n < len; n++) {
-		volatile uint16_t tmpw = getiw(7 + 2 * n);
-		volatile uint32_t tmpdw  = (csum + 1) * (tmpw + n);
-		csum ^= (tmpdw & 0xffff) ^ ((tmpdw >> 16) & 0xffff);
-	    }
+	    /* computed checksum, folded in word by word while lexing */
+	    csum = (uint16_t) lexer->cksum_a;
 	    /*@ +type @*/
 	    if (len == 0 || csum == xsum)
 		packet_accept(lexer, ITALK_PACKET);
@@ -1859,16 +2032,11 @@ void packet_parse(struct gps_packet_t *lexer)
 #endif /* NAVCOM_ENABLE */
 #ifdef GEOSTAR_ENABLE
 	else if (lexer->state == GEOSTAR_RECOGNIZED) {
-	    /* GeoStar uses a XOR 32bit checksum */
-	    int n, len;
-	    unsigned int cs = 0L;
+	    /* GeoStar uses a XOR 32bit checksum, accumulated while lexing */
+	    int len;
+	    unsigned int cs = lexer->cksum_a;
 	    len = lexer->inbufptr - lexer->inbuffer;
 
-	    /* Calculate checksum */
-	    for (n = 0; n < len; n += 4) {
-		cs ^= getleu32(lexer->inbuffer, n);
-	    }
-
 	    if (cs == 0)
 		packet_accept(lexer, GEOSTAR_PACKET);
 	    else {
@@ -1926,15 +2094,78 @@ void packet_parse(struct gps_packet_t *lexer)
 
 #undef getword
 
+static timestamp_t packet_clock(void)
+/* sample the system clock for a read that has just completed */
+{
+#ifdef HAVE_LIBRT
+    struct timespec ts;
+
+    (void)clock_gettime(CLOCK_REALTIME, &ts);
+    return (timestamp_t)ts.tv_sec + ts.tv_nsec * 1e-9;
+#else
+    struct timeval tv;
+
+    (void)gettimeofday(&tv, NULL);
+    return (timestamp_t)tv.tv_sec + tv.tv_usec * 1e-6;
+#endif /* HAVE_LIBRT */
+}
+
+#ifdef SO_TIMESTAMPNS
+static ssize_t packet_recvmsg(int fd, struct gps_packet_t *lexer,
+			      /*@out@*/timestamp_t *stamp)
+/* read from a socket, collecting the kernel's arrival timestamp */
+{
+    struct iovec iov;
+    struct msghdr msg;
+    struct cmsghdr *cmsg;
+    char control[CMSG_SPACE(sizeof(struct timespec))];
+    ssize_t recvd;
+
+    /*@ -modobserver -type @*/
+    iov.iov_base = lexer->inbuffer + lexer->inbuflen;
+    iov.iov_len = sizeof(lexer->inbuffer) - lexer->inbuflen;
+    (void)memset(&msg, '\0', sizeof(msg));
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control;
+    msg.msg_controllen = sizeof(control);
+    recvd = recvmsg(fd, &msg, 0);
+    /*@ +modobserver +type @*/
+    *stamp = 0;
+    if (recvd > 0)
+	for (cmsg = CMSG_FIRSTHDR(&msg); cmsg != NULL;
+	     cmsg = CMSG_NXTHDR(&msg, cmsg))
+	    if (cmsg->cmsg_level == SOL_SOCKET
+		&& cmsg->cmsg_type == SCM_TIMESTAMPNS) {
+		struct timespec ts;
+		(void)memcpy(&ts, CMSG_DATA(cmsg), sizeof(ts));
+		*stamp = (timestamp_t)ts.tv_sec + ts.tv_nsec * 1e-9;
+	    }
+    /* TCP on older kernels may not deliver a stamp at all */
+    if (*stamp == 0)
+	*stamp = packet_clock();
+    return recvd;
+}
+#endif /* SO_TIMESTAMPNS */
+
 ssize_t packet_get(int fd, struct gps_packet_t *lexer)
 /* grab a packet; return -1=>I/O error, 0=>EOF, BAD_PACKET or a length */
 {
     ssize_t recvd;
+    timestamp_t stamp;
 
     /*@ -modobserver @*/
     errno = 0;
-    recvd = read(fd, lexer->inbuffer + lexer->inbuflen,
-		 sizeof(lexer->inbuffer) - (lexer->inbuflen));
+#ifdef SO_TIMESTAMPNS
+    if (lexer->kernel_stamps)
+	recvd = packet_recvmsg(fd, lexer, &stamp);
+    else
+#endif /* SO_TIMESTAMPNS */
+    {
+	recvd = read(fd, lexer->inbuffer + lexer->inbuflen,
+		     sizeof(lexer->inbuffer) - (lexer->inbuflen));
+	stamp = packet_clock();
+    }
     /*@ +modobserver @*/
     if (recvd == -1) {
 	if ((errno == EAGAIN) || (errno == EINTR)) {
@@ -1951,6 +2182,13 @@ ssize_t packet_get(int fd, struct gps_packet_t *lexer)
 			"Read %zd chars to buffer offset %zd (total %zd): %s\n",
 			recvd, lexer->inbuflen, lexer->inbuflen + recvd,
 			gpsd_hexdump((char *)lexer->inbufptr, (size_t) recvd));
+	if (recvd > 0) {
+	    /* input already buffered keeps the stamp of its own read */
+	    if (lexer->stamp_offset == 0)
+		lexer->stamp_old = lexer->stamp_new;
+	    lexer->stamp_offset = lexer->inbuflen;
+	    lexer->stamp_new = stamp;
+	}
 	lexer->inbuflen += recvd;
     }
     gpsd_report(LOG_SPIN, "packet_get() fd %d -> %zd (%d)\n",
@@ -2009,6 +2247,14 @@ void packet_reset( /*@out@*/ struct gps_packet_t *lexer)
     lexer->state = GROUND_STATE;
     lexer->inbuflen = 0;
     lexer->inbufptr = lexer->inbuffer;
+    lexer->stamp_old = lexer->stamp_new = lexer->recv_time = 0;
+    lexer->stamp_offset = 0;
+#ifdef NMEA_ENABLE
+    lexer->taglen = 0;
+    lexer->tag.source = NULL;
+    lexer->tag.sourcelen = 0;
+    lexer->tag.time = 0;
+#endif /* NMEA_ENABLE */
 #ifdef BINARY_ENABLE
     isgps_init(lexer);
 #endif /* BINARY_ENABLE */
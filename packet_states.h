@@ -18,11 +18,16 @@
    NMEA_BINARY_NL,	/* \n on end of Ashtech-style binary packet */ 
    NMEA_CR,	   	/* seen terminating \r of NMEA packet */
    NMEA_RECOGNIZED,	/* saw trailing \n of NMEA packet */
+   NMEA_TAG_BODY,	/* inside an NMEA 4.x tag block */
+   NMEA_TAG_STAR,	/* seen '*' ahead of the tag block checksum */
+   NMEA_TAG_HEX1,	/* seen first tag block checksum digit */
+   NMEA_TAG_HEX2,	/* seen second tag block checksum digit */
+   NMEA_TAG_END,	/* seen closing backslash of a good tag block */
 
    SIRF_ACK_LEAD_1,	/* seen A of possible SiRF Ack */
    SIRF_ACK_LEAD_2,	/* seen c of possible SiRF Ack */
-   AIS_LEAD_1,		/* seen A of possible marine AIS message */
-   AIS_LEAD_2,		/* seen I of possible marine AIS message */
+   AIS_LEAD_1,		/* seen 1st talker char of possible AIS message */
+   AIS_LEAD_2,		/* seen 2nd talker char of possible AIS message */
 
    SEATALK_LEAD_1,	/* SeaTalk/Garmin packet leader 'I' */
 #endif /* NMEA_ENABLE */
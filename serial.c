@@ -213,6 +213,9 @@ void gpsd_set_speed(struct gps_device_t *session,
 	|| parity != session->gpsdata.dev.parity
 	|| stopbits != session->gpsdata.dev.stopbits) {
 
+	/* what's queued was meant to go out at the old speed */
+	gpsd_write_drain(session);
+
 	/* 
 	 * Don't mess with this conditional! Speed zero is supposed to mean
 	 * to leave the port speed at whatever it currently is. This leads
@@ -475,21 +478,279 @@ int gpsd_serial_open(struct gps_device_t *session)
     return session->gpsdata.gps_fd;
 }
 
-ssize_t gpsd_write(struct gps_device_t * session, const char *buf, size_t len)
+/*
+ * Device output.  Writers queue messages on the device; the queue is
+ * fed to the device as fast as the link drains, without blocking, from
+ * the daemon's main loop (and from gpsd_poll(), for everything else
+ * that uses the library).  Only a speed change or a close waits for
+ * the queue to empty.
+ *
+ * On a tty we hand the kernel no more than OUTQUEUE_KERNEL bytes at a
+ * time, so that what's waiting stays where it can still be reordered.
+ */
+#define OUTQUEUE_DRAIN_SLACK	5.0	/* allowed beyond the expected drain */
+
+static bool paced(struct gps_device_t *session)
+/* is there a wire at a known speed behind this fd? */
+{
+    return (session->sourcetype == source_rs232
+	    || session->sourcetype == source_usb)
+	&& session->gpsdata.dev.baudrate > 0
+	&& isatty(session->gpsdata.gps_fd) != 0;
+}
+
+static double line_time(struct gps_device_t *session, size_t chars)
+/* time for chars to go out over the wire, 0 if we can't tell */
+{
+    if (!paced(session))
+	return 0;
+    return chars * (10.0 / session->gpsdata.dev.baudrate);
+}
+
+static size_t kernel_backlog(struct gps_device_t *session)
+/* output bytes the tty driver still holds, 0 if we can't tell */
+{
+    int backlog = 0;
+
+#ifdef TIOCOUTQ
+    if (paced(session)
+	&& ioctl(session->gpsdata.gps_fd, TIOCOUTQ, &backlog) == -1)
+	backlog = 0;
+#endif /* TIOCOUTQ */
+    return backlog > 0 ? (size_t)backlog : 0;
+}
+
+static void outqueue_remove(struct gps_outqueue_t *q, unsigned int i)
+/* drop message i from a device's output queue */
+{
+    size_t off = 0;
+    unsigned int j;
+
+    for (j = 0; j < i; j++)
+	off += q->msg[j].len;
+    (void)memmove(q->buf + off, q->buf + off + q->msg[i].len,
+		  q->used - off - q->msg[i].len);
+    q->used -= q->msg[i].len;
+    (void)memmove(&q->msg[i], &q->msg[i + 1],
+		  (q->count - i - 1) * sizeof(q->msg[0]));
+    q->count--;
+    if (i == 0)
+	q->sent = 0;
+}
+
+static void outqueue_insert(struct gps_outqueue_t *q, unsigned int i,
+			    write_t kind, const char *buf, size_t len)
+/* put a message into a device's output queue ahead of message i */
 {
-    ssize_t status;
-    bool ok;
+    size_t off = 0;
+    unsigned int j;
+
+    for (j = 0; j < i; j++)
+	off += q->msg[j].len;
+    (void)memmove(q->buf + off + len, q->buf + off, q->used - off);
+    (void)memcpy(q->buf + off, buf, len);
+    q->used += len;
+    (void)memmove(&q->msg[i + 1], &q->msg[i],
+		  (q->count - i) * sizeof(q->msg[0]));
+    q->msg[i].len = len;
+    q->msg[i].kind = kind;
+    q->msg[i].queued = timestamp();
+    q->msg[i].pause = 0;
+    q->count++;
+}
+
+static double drain_time(struct gps_device_t *session)
+/* how long the queue should take to go out, pauses included */
+{
+    struct gps_outqueue_t *q = &session->outqueue;
+    timestamp_t now = timestamp();
+    double expected;
+    unsigned int i;
+
+    expected = line_time(session, q->used - q->sent + kernel_backlog(session));
+    for (i = 0; i < q->count; i++)
+	expected += q->msg[i].pause;
+    if (q->holdoff > now)
+	expected += q->holdoff - now;
+    return expected;
+}
+
+bool gpsd_write_flush(struct gps_device_t *session)
+/* move queued output to the device as far as it takes it without blocking */
+{
+    struct gps_outqueue_t *q = &session->outqueue;
+
+    while (q->count > 0) {
+	timestamp_t now = timestamp();
+	size_t backlog;
+	ssize_t status;
+
+	if (q->holdoff > now)
+	    return false;
+	backlog = kernel_backlog(session);
+	if (backlog >= OUTQUEUE_KERNEL) {
+	    q->holdoff = now + line_time(session, backlog - OUTQUEUE_KERNEL / 2);
+	    return false;
+	}
+	status = write(session->gpsdata.gps_fd, q->buf + q->sent,
+		       q->msg[0].len - q->sent);
+	if (status == -1) {
+	    if (errno == EAGAIN || errno == EINTR)
+		return false;
+	    gpsd_report(LOG_WARN, "%s: write failed, %u messages dropped: %s\n",
+			session->gpsdata.dev.path, q->count, strerror(errno));
+	    q->count = 0;
+	    q->used = q->sent = 0;
+	    return true;
+	}
+	q->sent += (size_t)status;
+	if (q->sent < q->msg[0].len)
+	    return false;
+	/* a pause counts from when the message is on the wire */
+	if (q->msg[0].pause > 0)
+	    q->holdoff = now + q->msg[0].pause
+		+ line_time(session, backlog + q->msg[0].len);
+	outqueue_remove(q, 0);
+    }
+    return true;
+}
+
+void gpsd_write_drain(struct gps_device_t *session)
+/* block until the device has everything we queued for it */
+{
+    struct gps_outqueue_t *q = &session->outqueue;
+    timestamp_t deadline;
+
+    if (session->gpsdata.gps_fd == -1)
+	return;
+    /* a full queue at 4800bps takes longer than any fixed timeout */
+    deadline = timestamp() + drain_time(session) + OUTQUEUE_DRAIN_SLACK;
+    while (!gpsd_write_flush(session)) {
+	timestamp_t now = timestamp();
+	fd_set wfds;
+	struct timeval tv;
+
+	if (now > deadline) {
+	    gpsd_report(LOG_WARN, "%s: output stalled, %u messages dropped\n",
+			session->gpsdata.dev.path, q->count);
+	    q->count = 0;
+	    q->used = q->sent = 0;
+	    break;
+	}
+	if (q->holdoff > now) {
+	    (void)usleep((useconds_t)((q->holdoff - now) * 1e6));
+	    continue;
+	}
+	FD_ZERO(&wfds);
+	FD_SET(session->gpsdata.gps_fd, &wfds);
+	tv.tv_sec = 0;
+	tv.tv_usec = 100000;
+	(void)select(session->gpsdata.gps_fd + 1, NULL, &wfds, NULL, &tv);
+    }
+    (void)tcdrain(session->gpsdata.gps_fd);
+}
+
+static ssize_t gpsd_queue(struct gps_device_t *session, write_t kind,
+			  const char *buf, size_t len)
+{
+    struct gps_outqueue_t *q;
+    unsigned int i, pos;
+
     if (session == NULL ||
 	session->context == NULL || session->context->readonly)
 	return 0;
-    status = write(session->gpsdata.gps_fd, buf, len);
-    ok = (status == (ssize_t) len);
-    (void)tcdrain(session->gpsdata.gps_fd);
+    q = &session->outqueue;
+    if (kind == write_command && q->probing)
+	kind = write_probe;
+    if (session->gpsdata.gps_fd == -1)
+	return -1;
     /* extra guard prevents expensive hexdump calls */
     if (session->context->debug >= LOG_IO)
-	gpsd_report(LOG_IO, "=> GPS: %s%s\n",
-		    gpsd_hexdump((char *)buf, len), ok ? "" : " FAILED");
-    return status;
+	gpsd_report(LOG_IO, "=> GPS: %s\n", gpsd_hexdump((char *)buf, len));
+
+    /* messages not yet started may be reordered or dropped */
+    pos = (q->sent > 0) ? 1 : 0;
+    if (kind == write_correction) {
+	timestamp_t stale = timestamp() - OUTQUEUE_STALE;
+
+	for (i = pos; i < q->count; i++)
+	    if (q->msg[i].kind == write_correction
+		&& q->msg[i].queued < stale) {
+		gpsd_report(LOG_PROG, "%s: superseded correction dropped\n",
+			    session->gpsdata.dev.path);
+		outqueue_remove(q, i--);
+	    }
+	/* corrections go ahead of commands, but never into a pause */
+	for (i = pos; i < q->count; i++)
+	    if (q->msg[i].pause > 0)
+		pos = i + 1;
+	while (pos < q->count && q->msg[pos].kind == write_correction)
+	    pos++;
+	if (q->used + len > OUTQUEUE_SIZE || q->count == OUTQUEUE_MSGS) {
+	    gpsd_report(LOG_WARN, "%s: output queue full, correction dropped\n",
+			session->gpsdata.dev.path);
+	    return 0;
+	}
+    } else {
+	/*
+	 * Waiting for room would stall the daemon for as long as the
+	 * link takes to drain, so a command that doesn't fit is refused,
+	 * the same as a write the device wouldn't take.  The queue is
+	 * sized so that no driver's burst of output should come to this.
+	 */
+	(void)gpsd_write_flush(session);
+	if (q->used + len > OUTQUEUE_SIZE || q->count == OUTQUEUE_MSGS) {
+	    gpsd_report(LOG_ERROR, "%s: output queue full, command refused\n",
+			session->gpsdata.dev.path);
+	    errno = ENOBUFS;
+	    return -1;
+	}
+	pos = q->count;
+    }
+    outqueue_insert(q, pos, kind, buf, len);
+    (void)gpsd_write_flush(session);
+    return (ssize_t)len;
+}
+
+void gpsd_write_cancel(struct gps_device_t *session, write_t kind)
+/* drop queued messages of one kind that haven't started going out */
+{
+    struct gps_outqueue_t *q = &session->outqueue;
+    unsigned int i;
+
+    for (i = (q->sent > 0) ? 1 : 0; i < q->count; i++)
+	if (q->msg[i].kind == kind)
+	    outqueue_remove(q, i--);
+}
+
+ssize_t gpsd_write(struct gps_device_t *session, const char *buf, size_t len)
+/* queue a command for the device */
+{
+    return gpsd_queue(session, write_command, buf, len);
+}
+
+ssize_t gpsd_write_correction(struct gps_device_t *session,
+			      const char *buf, size_t len)
+/* queue correction data for the device */
+{
+    return gpsd_queue(session, write_correction, buf, len);
+}
+
+void gpsd_write_pause(struct gps_device_t *session, double secs)
+/* hold off further output until secs after what's queued has gone out */
+{
+    struct gps_outqueue_t *q = &session->outqueue;
+    timestamp_t until;
+
+    if (session->context->readonly || session->gpsdata.gps_fd == -1)
+	return;
+    if (q->count > 0) {
+	q->msg[q->count - 1].pause += secs;
+	return;
+    }
+    until = timestamp() + line_time(session, kernel_backlog(session)) + secs;
+    if (until > q->holdoff)
+	q->holdoff = until;
 }
 
 /*
@@ -563,7 +824,7 @@ void gpsd_assert_sync(struct gps_device_t *session)
 void gpsd_close(struct gps_device_t *session)
 {
     if (session->gpsdata.gps_fd != -1) {
-	(void)tcdrain(session->gpsdata.gps_fd);
+	gpsd_write_drain(session);
 	if (isatty(session->gpsdata.gps_fd) != 0) {
 	    /* force hangup on close on systems that don't do HUPCL properly */
 	    /*@ ignore @*/
@@ -589,4 +850,10 @@ void gpsd_close(struct gps_device_t *session)
 	(void)close(session->gpsdata.gps_fd);
 	session->gpsdata.gps_fd = -1;
     }
+#ifdef NETFEED_ENABLE
+    udp_release(session);
+#endif /* NETFEED_ENABLE */
+    session->outqueue.count = 0;
+    session->outqueue.used = session->outqueue.sent = 0;
+    session->outqueue.holdoff = 0;
 }
@@ -54,6 +54,12 @@ int json_device_read(const char *buf,
 				        .dflt.real = NAN},
 	{"mincycle",   t_real,       .addr.real = &dev->mincycle,
 				        .dflt.real = NAN},
+	{"load",       t_real,       .addr.real = &dev->load,
+				        .dflt.real = NAN},
+	{"budget",     t_real,       .addr.real = &dev->budget,
+				        .dflt.real = NAN},
+	{"ttff",       t_real,       .addr.real = &dev->ttff,
+				        .dflt.real = NAN},
 	{NULL},
     };
     /* *INDENT-ON* */
@@ -96,6 +102,22 @@ int json_watch_read(const char *buf,
 	                                  .nodefault = true},
 	{"scaled",         t_boolean,  .addr.boolean = &ccp->scaled},
 	{"timing",         t_boolean,  .addr.boolean = &ccp->timing},
+	{"rawdata",        t_boolean,  .addr.boolean = &ccp->rawdata},
+	{"vessels",        t_boolean,  .addr.boolean = &ccp->vessels},
+	{"dedup",          t_boolean,  .addr.boolean = &ccp->dedup},
+	{"aisbox",         t_array,    NUMBERARRAY(ccp->aisfilter.box, real,
+						   &ccp->aisfilter.nbox)},
+	{"aisradius",      t_array,    NUMBERARRAY(ccp->aisfilter.radius, real,
+						   &ccp->aisfilter.nradius)},
+	{"aismmsi",        t_array,    NUMBERARRAY(ccp->aisfilter.mmsi, uinteger,
+						   &ccp->aisfilter.nmmsi)},
+	{"aisnotmmsi",     t_array,    NUMBERARRAY(ccp->aisfilter.notmmsi,
+						   uinteger,
+						   &ccp->aisfilter.nnotmmsi)},
+	{"aisbatch",       t_integer,  .addr.integer = &ccp->aisbatch,
+	                                  .dflt.integer = 0},
+	{"aistypes",       t_array,    NUMBERARRAY(ccp->aisfilter.types, uinteger,
+						   &ccp->aisfilter.ntypes)},
 	{"device",         t_string,   .addr.string = ccp->devpath,
 	                                  .len = sizeof(ccp->devpath)},
 	{"remote",         t_string,   .addr.string = ccp->remote,
@@ -106,6 +128,10 @@ int json_watch_read(const char *buf,
     /*@ +fullinitblock @*/
     int status;
 
+    /* arrays take no defaults; a WATCH without filters clears them */
+    ccp->aisfilter.nbox = ccp->aisfilter.nradius = 0;
+    ccp->aisfilter.nmmsi = ccp->aisfilter.nnotmmsi = 0;
+    ccp->aisfilter.ntypes = 0;
     status = json_read_object(buf, chanconfig_attrs, endptr);
     return status;
 }
@@ -180,6 +180,9 @@ gps_mask_t gpsd_interpret_subframe(struct gps_device_t *session,
 	    preamble, words[0]);
 	return 0;
     }
+#ifdef AIDING_ENABLE
+    aiding_subframe(session->context, tSVID, words);
+#endif /* AIDING_ENABLE */
     subp->integrity = (bool)((words[0] >> 1) & 0x01);
     /* The subframe ID is in the Hand Over Word (page 80) */
     subp->TOW17 = ((words[1] >> 7) & 0x01FFFF);
@@ -0,0 +1,271 @@
+/* test_aiding.c - unit test for the warm-start aiding store
+ *
+ * Fills a store from synthetic subframes, a fix and a learned NMEA
+ * reporting cycle, saves it after
+ * moving out of the directory it was named relative to (as the daemon
+ * does when it goes into the background), and checks that loading the
+ * file back gives the same store.  Also checks that the store is only
+ * handed to the daemon's user when it is a plain file of its own.
+ *
+ * This file is Copyright (c) 2010 by the GPSD project
+ * BSD terms apply: see the file COPYING in the distribution root for details.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include <math.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#ifndef S_SPLINT_S
+#include <unistd.h>
+#endif /* S_SPLINT_S */
+
+#include "gpsd.h"
+
+static int warnings;
+static bool hush;		/* warnings are expected */
+
+void gpsd_report(int errlevel, const char *fmt, ...)
+/* assemble command in printf(3) style, use stderr */
+{
+    if (errlevel <= LOG_WARN) {
+	char buf[BUFSIZ];
+	va_list ap;
+
+	warnings++;
+	if (hush)
+	    return;
+	buf[0] = '\0';
+	va_start(ap, fmt);
+	(void)vsnprintf(buf, sizeof(buf), fmt, ap);
+	va_end(ap);
+
+	(void)fputs(buf, stderr);
+    }
+}
+
+#ifdef AIDING_ENABLE
+static void check(int num, bool ok, const char *what)
+{
+    if (!ok) {
+	(void)fprintf(stderr, "case %d FAILED: %s.\n", num, what);
+	exit(1);
+    }
+}
+
+static void subframe(struct gps_context_t *context, unsigned int prn,
+		     unsigned int id, unsigned int seed, unsigned int top)
+/* feed a subframe whose data words are made up from a seed */
+{
+    uint32_t words[10];
+    int i;
+
+    words[0] = 0x8b0000;			/* TLM preamble */
+    words[1] = (0x1234 << 7) | (id << 2);	/* HOW with subframe ID */
+    for (i = 2; i < 10; i++)
+	words[i] = (seed * 0x010101 + i) & 0xffff;
+    /* the byte the test needs somewhere in the top of one word */
+    words[2 + (top >> 8)] |= (top & 0xff) << 16;
+    aiding_subframe(context, prn, words);
+}
+
+static void owned(const char *path, bool refused)
+/* try to hand a store at path to ourselves, and see if that's refused */
+{
+    struct gps_context_t context;
+
+    (void)memset(&context, '\0', sizeof(context));
+    context.aiding.path = path;
+    warnings = 0;
+    hush = refused;
+    aiding_own(&context, getuid(), getgid());
+    hush = false;
+    if ((warnings != 0) != refused) {
+	(void)fprintf(stderr, "case 10 FAILED: %s %s.\n", path,
+		      refused ? "handed over" : "refused");
+	exit(1);
+    }
+}
+
+int main(int argc UNUSED, char *argv[] UNUSED)
+{
+    static struct gps_context_t context, reloaded;
+    static struct gps_device_t session;
+    char dir[] = "/tmp/test_aiding.XXXXXX", store[PATH_MAX];
+    struct stat sb;
+    int i;
+
+    if (mkdtemp(dir) == NULL || chdir(dir) == -1) {
+	(void)perror("test_aiding");
+	exit(1);
+    }
+    (void)snprintf(store, sizeof(store), "%s/store", dir);
+
+    /* case 1: a relative name is resolved before we move */
+    gps_context_init(&context);
+    check(1, !aiding_load(&context, "store"), "load of a missing store");
+    check(1, context.aiding.path != NULL
+	  && strcmp(context.aiding.path, store) == 0, "path resolution");
+
+    /* case 2: an ephemeris goes in once IODC and both IODEs agree */
+    subframe(&context, 5, 1, 1, (5 << 8) | 0x42);	/* IODC, word 8 */
+    subframe(&context, 5, 2, 2, (0 << 8) | 0x42);	/* IODE, word 3 */
+    check(2, context.aiding.eph[4].collected == 0, "incomplete set stored");
+    subframe(&context, 5, 3, 3, (7 << 8) | 0x42);	/* IODE, word 10 */
+    check(2, context.aiding.eph[4].collected != 0, "complete set stored");
+
+    /* case 3: a set that straddles an upload is not stored */
+    subframe(&context, 6, 1, 4, (5 << 8) | 0x42);
+    subframe(&context, 6, 2, 5, (0 << 8) | 0x43);
+    subframe(&context, 6, 3, 6, (7 << 8) | 0x42);
+    check(3, context.aiding.eph[5].collected == 0, "mismatched IODE stored");
+
+    /* case 4: almanac page for SV 7, ionosphere/UTC page 18 (ID 56) */
+    subframe(&context, 9, 5, 7, 7);
+    subframe(&context, 9, 4, 8, 56);
+    check(4, context.aiding.alm[6].collected != 0, "almanac stored");
+    check(4, context.aiding.ionoutc.collected != 0, "ionosphere stored");
+
+    /* case 5: only a 3D fix is remembered */
+    session.context = &context;
+    gps_clear_fix(&session.gpsdata.fix);
+    session.gpsdata.fix.mode = MODE_2D;
+    session.gpsdata.fix.latitude = 1;
+    session.gpsdata.fix.longitude = 2;
+    aiding_fix(&session);
+    check(5, context.aiding.position.time == 0, "2D fix stored");
+    session.gpsdata.fix.mode = MODE_3D;
+    session.gpsdata.fix.latitude = 40.123456789;
+    session.gpsdata.fix.longitude = -75.987654321;
+    session.gpsdata.fix.altitude = 123.456;
+    aiding_fix(&session);
+    check(5, context.aiding.position.time != 0, "3D fix stored");
+
+#ifdef NMEA_ENABLE
+    /* case 6: a learned NMEA cycle is filed by device and receiver */
+    (void)strlcpy(session.gpsdata.dev.path, "/dev/ttyUSB0",
+		  sizeof(session.gpsdata.dev.path));
+    (void)strlcpy(session.nmea_cycle.subtype, "MTK-3301 AXN_1.30",
+		  sizeof(session.nmea_cycle.subtype));
+    session.nmea_cycle.driver = gpsd_drivers[0];
+    session.nmea_cycle.core[3] = 1;
+    session.nmea_cycle.core[7] = 2;
+    session.nmea_cycle.ender = 7;
+    session.nmea_cycle.period = 1.0;
+    session.nmea_cycle.quiet = 0.375;
+    session.nmea_cycle.offset[7] = 0.5f;
+    session.nmea_cycle.spread[7] = 0.0625f;
+    context.aiding.dirty = false;
+    aiding_cycle_save(&session);
+    check(6, context.aiding.dirty, "new cycle model not saved");
+    context.aiding.dirty = false;
+    session.nmea_cycle.period = 1.125;
+    aiding_cycle_save(&session);
+    check(6, !context.aiding.dirty, "timing drift forced a save");
+#endif /* NMEA_ENABLE */
+
+    /* case 7: save from elsewhere, as after daemon(0, 0) */
+    check(7, chdir("/") == 0, "chdir");
+    check(7, aiding_save(&context), "save");
+    check(7, !context.aiding.dirty, "store still dirty after save");
+    check(7, stat(store, &sb) == 0, "store written where it was named");
+
+    /* case 8: what comes back is what went out */
+    gps_context_init(&reloaded);
+    check(8, aiding_load(&reloaded, store), "reload");
+    for (i = 0; i < AIDING_SVS; i++) {
+	check(8, reloaded.aiding.eph[i].collected
+	      == context.aiding.eph[i].collected, "ephemeris time");
+	check(8, reloaded.aiding.eph[i].collected == 0
+	      || (reloaded.aiding.eph[i].how == context.aiding.eph[i].how
+		  && memcmp(reloaded.aiding.eph[i].words,
+			    context.aiding.eph[i].words,
+			    sizeof(context.aiding.eph[i].words)) == 0),
+	      "ephemeris words");
+	check(8, reloaded.aiding.alm[i].collected
+	      == context.aiding.alm[i].collected
+	      && reloaded.aiding.alm[i].week == context.aiding.alm[i].week
+	      && memcmp(reloaded.aiding.alm[i].words,
+			context.aiding.alm[i].words,
+			sizeof(context.aiding.alm[i].words)) == 0,
+	      "almanac");
+    }
+    check(8, reloaded.aiding.ionoutc.collected
+	  == context.aiding.ionoutc.collected
+	  && memcmp(reloaded.aiding.ionoutc.words,
+		    context.aiding.ionoutc.words,
+		    sizeof(context.aiding.ionoutc.words)) == 0,
+	  "ionosphere");
+    check(8, reloaded.aiding.position.time == context.aiding.position.time
+	  && fabs(reloaded.aiding.position.lat - 40.123456789) < 1e-9
+	  && fabs(reloaded.aiding.position.lon + 75.987654321) < 1e-9
+	  && fabs(reloaded.aiding.position.alt - 123.456) < 1e-3,
+	  "position");
+
+#ifdef NMEA_ENABLE
+    /* case 9: the same receiver on the same device gets its model back */
+    (void)memset(&session.nmea_cycle, '\0', sizeof(session.nmea_cycle));
+    (void)strlcpy(session.nmea_cycle.subtype, "MTK-3301 AXN_1.30",
+		  sizeof(session.nmea_cycle.subtype));
+    session.nmea_cycle.driver = gpsd_drivers[0];
+    session.context = &reloaded;
+    check(9, aiding_cycle_restore(&session), "cycle model not restored");
+    check(9, session.nmea_cycle.core[3] == 1 && session.nmea_cycle.core[7] == 2
+	  && session.nmea_cycle.history[NMEA_CYCLE_DEPTH - 1][7] == 2
+	  && session.nmea_cycle.ender == 7
+	  && session.nmea_cycle.epochs == NMEA_CYCLE_DEPTH
+	  && session.nmea_cycle.locked
+	  && fabs(session.nmea_cycle.period - 1.125) < 1e-4
+	  && fabs(session.nmea_cycle.quiet - 0.375) < 1e-4
+	  && fabs(session.nmea_cycle.offset[7] - 0.5) < 1e-4
+	  && fabs(session.nmea_cycle.spread[7] - 0.0625) < 1e-4,
+	  "cycle model");
+    (void)strlcpy(session.nmea_cycle.subtype, "MTK-3329",
+		  sizeof(session.nmea_cycle.subtype));
+    check(9, !aiding_cycle_restore(&session), "model given to another receiver");
+    (void)strlcpy(session.nmea_cycle.subtype, "MTK-3301 AXN_1.30",
+		  sizeof(session.nmea_cycle.subtype));
+    (void)strlcpy(session.gpsdata.dev.path, "/dev/ttyUSB1",
+		  sizeof(session.gpsdata.dev.path));
+    check(9, !aiding_cycle_restore(&session), "model given to another device");
+#endif /* NMEA_ENABLE */
+
+    /* case 10: the store is only handed over if it's a plain file */
+    (void)strlcpy(store + strlen(dir), "/victim", sizeof(store) - strlen(dir));
+    check(10, (i = open(store, O_WRONLY | O_CREAT, 0600)) != -1, "victim");
+    (void)close(i);
+    check(10, chdir(dir) == 0, "chdir");
+    (void)symlink("victim", "symlink");
+    owned("symlink", true);
+    check(10, lstat("symlink", &sb) == 0 && S_ISLNK(sb.st_mode),
+	  "symlink replaced");
+    (void)link("victim", "hardlink");
+    (void)mkfifo("fifo", 0600);
+    owned("hardlink", true);
+    owned("fifo", true);
+    owned("fresh", false);
+    check(10, lstat("fresh", &sb) == 0 && S_ISREG(sb.st_mode)
+	  && sb.st_uid == getuid(), "fresh store not created");
+    owned("fresh", false);
+    (void)unlink("symlink");
+    (void)unlink("hardlink");
+    (void)unlink("fifo");
+    (void)unlink("fresh");
+    (void)unlink("victim");
+    check(10, chdir("/") == 0, "chdir");
+
+    (void)strlcpy(store + strlen(dir), "/store", sizeof(store) - strlen(dir));
+    (void)unlink(store);
+    (void)rmdir(dir);
+    (void)printf("aiding store round trip OK\n");
+    exit(0);
+}
+#else
+int main(int argc UNUSED, char *argv[] UNUSED)
+{
+    (void)printf("aiding not configured, nothing to test\n");
+    exit(0);
+}
+#endif /* AIDING_ENABLE */
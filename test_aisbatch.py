@@ -0,0 +1,141 @@
+#!/usr/bin/env python
+#
+# Check AIS report batching in the daemon.
+#
+# A daemon is run under gpsfake with two JSON watchers on the same
+# fake device, one with "aisbatch" set and one without.  What the
+# batching watcher receives, and when, is compared with what the other
+# one does:
+#
+# 1. A burst of AIS too big for one batch has to start arriving well
+#    before the batch wait is up, so a full batch went out on size.
+# 2. A lone report has to arrive about the batch wait after the other
+#    watcher got it, so a partial batch went out on time.
+# 3. AIS mixed with fixes has to come out in the same order for both
+#    watchers, as held-back reports go out ahead of anything newer.
+#
+# Both watchers have to get the same reports in every phase.
+
+import sys, os, time, socket, select, random, tempfile, json
+import gps.fake
+
+WAIT = 0.5		# aisbatch in seconds for the batching watcher
+BATCH = 8192		# GPS_JSON_BATCH_MAX
+SLACK = 0.3		# scheduling latency allowed, seconds
+
+errors = 0
+
+def fail(phase, message):
+    global errors
+    print >>sys.stderr, "aisbatch test %d: %s" % (phase, message)
+    errors += 1
+
+def capture(lines):
+    "Write sentences to a temporary capture gpsfake can load."
+    (fd, path) = tempfile.mkstemp(suffix=".log")
+    os.write(fd, "# aisbatch test capture\n" + "".join(lines))
+    os.close(fd)
+    return path
+
+def sentences(path, lead):
+    return [line for line in open(path) if line[0] == lead]
+
+class Watcher:
+    "A raw JSON watcher, recording the reports it gets and when."
+    def __init__(self, port, watch):
+        self.sock = socket.create_connection(("127.0.0.1", port))
+        self.sock.sendall('?WATCH=%s;\n' % json.dumps(watch))
+        self.partial = ""
+        self.reports = []
+    def read(self):
+        "Collect what has arrived, stamped with the time it was read."
+        data = self.sock.recv(65536)
+        now = time.time()
+        lines = (self.partial + data).split("\n")
+        self.partial = lines.pop()
+        for line in lines:
+            report = json.loads(line)
+            if report["class"] not in ("VERSION", "DEVICES", "WATCH", "DEVICE"):
+                self.reports.append((now, line))
+    def take(self):
+        "Hand over what has been collected."
+        (got, self.reports) = (self.reports, [])
+        return got
+
+def gather(watchers, seconds):
+    "Read from all the watchers as their reports come in."
+    end = time.time() + seconds
+    while time.time() < end:
+        (ready, _, _) = select.select([w.sock for w in watchers], [], [],
+                                      end - time.time())
+        for w in watchers:
+            if w.sock in ready:
+                w.read()
+
+def feed(fake, lines):
+    "Write sentences to the fake device in one burst; return when."
+    start = time.time()
+    fake.write("".join(lines))
+    return start
+
+aivdm = sentences("test/sample.aivdm", "!")
+nmea = sentences("test/daemon/bt-q818.log", "$")
+port = random.randint(49152, 65535)
+idle = capture([nmea[0]])
+test = gps.fake.TestSession(port=port, options="")
+try:
+    test.spawn()
+    plain = Watcher(port, {"enable": True, "json": True})
+    batched = Watcher(port, {"enable": True, "json": True,
+                             "aisbatch": int(WAIT * 1000)})
+    fake = test.fakegpslist[test.gps_add(idle, speed=38400)]
+    fake.feed()
+    gather((plain, batched), 1)
+    plain.take()
+    batched.take()
+
+    # Phase 1: a burst of several batches' worth
+    burst = aivdm * 3
+    start = feed(fake, burst)
+    gather((plain, batched), 2 * WAIT + SLACK)
+    (want, got) = (plain.take(), batched.take())
+    if [r[1] for r in want] != [r[1] for r in got]:
+        fail(1, "batched watcher got %d reports, plain one %d"
+             % (len(got), len(want)))
+    elif sum(len(r[1]) + 1 for r in got) <= BATCH:
+        fail(1, "burst fits in one batch")
+    elif got[0][0] - start > WAIT - SLACK / 2:
+        fail(1, "first batch took %.3f sec, not sent when full"
+             % (got[0][0] - start))
+
+    # Phase 2: a lone report waits out the batch
+    feed(fake, [aivdm[0]])
+    gather((plain, batched), WAIT + 2 * SLACK)
+    (want, got) = (plain.take(), batched.take())
+    if len(want) != 1 or [r[1] for r in want] != [r[1] for r in got]:
+        fail(2, "lone report not delivered to both watchers")
+    elif not WAIT - SLACK / 2 < got[0][0] - want[0][0] < WAIT + SLACK:
+        fail(2, "lone report held %.3f sec, batch wait is %.3f"
+             % (got[0][0] - want[0][0], WAIT))
+
+    # Phase 3: fixes and AIS interleaved
+    mixed = []
+    for (i, sentence) in enumerate(nmea):
+        mixed.append(sentence)
+        mixed += aivdm[i * 2 % len(aivdm):i * 2 % len(aivdm) + 2]
+    feed(fake, mixed)
+    gather((plain, batched), WAIT + 2 * SLACK)
+    (want, got) = (plain.take(), batched.take())
+    classes = set(json.loads(r[1])["class"] for r in want)
+    if "AIS" not in classes or "TPV" not in classes:
+        fail(3, "mixed capture gave %s" % ",".join(sorted(classes)))
+    elif [r[1] for r in want] != [r[1] for r in got]:
+        fail(3, "reports reordered or lost by batching")
+finally:
+    test.cleanup()
+    os.remove(idle)
+
+if errors:
+    sys.exit(1)
+print "AIS batching OK"
+sys.exit(0)
@@ -0,0 +1,376 @@
+/* test_aistable.c - unit test for the daemon's AIS vessel table
+ *
+ * Drives aistable.c the way the daemon does, through aistable_update()
+ * with decoded reports in a session and aistable_next() for ?AIS, and
+ * checks insertion, change detection, backward-shift deletion, aging,
+ * eviction and the VESSEL dump.  Then it compiles WATCH AIS filters
+ * with aistable_compile() and checks what aistable_match() lets past.
+ *
+ * This file is Copyright (c) 2010 by the GPSD project
+ * BSD terms apply: see the file COPYING in the distribution root for details.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include <math.h>
+
+#include "gpsd.h"
+#include "gps_json.h"
+
+void gpsd_report(int errlevel, const char *fmt, ...)
+/* assemble command in printf(3) style, use stderr */
+{
+    if (errlevel <= LOG_WARN) {
+	char buf[BUFSIZ];
+	va_list ap;
+
+	buf[0] = '\0';
+	va_start(ap, fmt);
+	(void)vsnprintf(buf, sizeof(buf), fmt, ap);
+	va_end(ap);
+
+	(void)fputs(buf, stderr);
+    }
+}
+
+#if defined(AIVDM_ENABLE) && defined(SOCKET_EXPORT_ENABLE)
+static struct gps_device_t session;
+
+static void check(int num, bool ok, const char *what)
+{
+    if (!ok) {
+	(void)fprintf(stderr, "case %d FAILED: %s.\n", num, what);
+	exit(1);
+    }
+}
+
+static unsigned int home(unsigned int mmsi)
+/* the slot aistable.c's vessel_home() puts an MMSI in */
+{
+    return (unsigned int)((mmsi * 2654435761u) >> 16) & (AIS_VESSELS - 1);
+}
+
+static unsigned int colliding(unsigned int from, unsigned int slot)
+/* the first MMSI after from that hashes to slot */
+{
+    while (home(++from) != slot)
+	continue;
+    return from;
+}
+
+static /*@null@*/ const struct vessel_t *position(const char *device,
+						  unsigned int mmsi, int lat)
+/* fold a type 1 position report into the table */
+{
+    (void)strlcpy(session.gpsdata.dev.path, device,
+		  sizeof(session.gpsdata.dev.path));
+    memset(&session.gpsdata.ais, '\0', sizeof(session.gpsdata.ais));
+    session.gpsdata.ais.type = 1;
+    session.gpsdata.ais.mmsi = mmsi;
+    session.gpsdata.ais.type1.status = 0;
+    session.gpsdata.ais.type1.lat = lat;
+    session.gpsdata.ais.type1.lon = -74 * 600000;
+    session.gpsdata.ais.type1.speed = 123;
+    session.gpsdata.ais.type1.course = 2345;
+    session.gpsdata.ais.type1.heading = 234;
+    return aistable_update(&session);
+}
+
+static /*@null@*/ struct vessel_t *vessel(unsigned int mmsi)
+/* the record for an MMSI as ?AIS would find it */
+{
+    struct vessel_filter_t filter;
+
+    memset(&filter, '\0', sizeof(filter));
+    filter.mmsi = mmsi;
+    /*@-temptrans@*/
+    return (struct vessel_t *)aistable_next(&filter, NULL);
+    /*@+temptrans@*/
+}
+
+static int vessels(const char *request)
+/* how many vessels an ?AIS request body selects */
+{
+    struct vessel_filter_t filter;
+    const struct vessel_t *vp;
+    int n = 0;
+
+    if (json_vessel_filter_read(request, &filter, NULL) != 0)
+	return -1;
+    for (vp = aistable_next(&filter, NULL); vp != NULL;
+	 vp = aistable_next(&filter, vp))
+	n++;
+    return n;
+}
+
+static bool compile(const char *watch, /*@out@*/struct ais_predicate_t *pred)
+/* turn the AIS filters of a WATCH into a predicate */
+{
+    struct policy_t policy;
+
+    memset(&policy, '\0', sizeof(policy));
+    memset(pred, '\0', sizeof(*pred));
+    if (json_watch_read(watch, &policy, NULL) != 0)
+	return false;
+    return aistable_compile(&policy.aisfilter, pred);
+}
+
+static int raw(double deg)
+/* degrees in type 1 units */
+{
+    return (int)floor(deg * 600000 + 0.5);
+}
+
+static const struct ais_t *report(unsigned int type, unsigned int mmsi,
+				  double lat, double lon)
+/* a message of a type with its position where the type keeps it */
+{
+    static struct ais_t ais;
+
+    memset(&ais, '\0', sizeof(ais));
+    ais.type = type;
+    ais.mmsi = mmsi;
+    /*@-type@*/
+    switch (type) {
+    case 1:
+	ais.type1.lat = raw(lat);
+	ais.type1.lon = raw(lon);
+	break;
+    case 18:
+	ais.type18.lat = raw(lat);
+	ais.type18.lon = raw(lon);
+	break;
+    case 27:
+	ais.type27.lat = (int)floor(lat * 600 + 0.5);
+	ais.type27.lon = (int)floor(lon * 600 + 0.5);
+	break;
+    }
+    /*@+type@*/
+    return &ais;
+}
+
+static bool passes(const char *watch, const struct ais_t *ais)
+/* does a watcher with these filters get this message? */
+{
+    struct ais_predicate_t pred;
+
+    check(6, compile(watch, &pred), "filter rejected");
+    return aistable_match(&pred, ais);
+}
+
+int main(int argc UNUSED, char *argv[] UNUSED)
+{
+    static struct gps_context_t context;
+    const struct vessel_t *vp;
+    struct vessel_t *wp;
+    struct ais_predicate_t pred;
+    unsigned int a, b, c, d, mmsi;
+    int lat = 40 * 600000, n;
+    timestamp_t now;
+    char buf[BUFSIZ];
+
+    gps_context_init(&context);
+    session.context = &context;
+
+    /* case 1: a new vessel is a change, hearing it again is not */
+    vp = position("/dev/ais0", 366123456, lat);
+    check(1, vp != NULL && vp->mmsi == 366123456, "new vessel");
+    check(1, position("/dev/ais0", 366123456, lat) == NULL,
+	  "repeat counted as a change");
+    check(1, position("/dev/ais1", 366123456, lat) == NULL,
+	  "same report from another receiver counted as a change");
+    check(1, position("/dev/ais1", 366123456, lat + 1) != NULL,
+	  "moved vessel not counted as a change");
+    check(1, vessels("{\"class\":\"AIS\"}") == 1, "one vessel in the table");
+
+    /* case 2: the record keeps the path of the device, not the device */
+    memset(session.gpsdata.dev.path, '\0', sizeof(session.gpsdata.dev.path));
+    check(2, vessels("{\"class\":\"AIS\",\"device\":\"/dev/ais1\"}") == 1,
+	  "device filter after the device went away");
+    check(2, vessels("{\"class\":\"AIS\",\"device\":\"/dev/ais0\"}") == 0,
+	  "device filter matched the wrong device");
+    check(2, vessels("{\"class\":\"AIS\",\"mmsi\":366123457}") == 0,
+	  "mmsi filter matched the wrong vessel");
+
+    /* case 3: the VESSEL dump, raw and scaled */
+    wp = vessel(366123456);
+    check(3, wp != NULL, "vessel lookup");
+    /*@-nullderef@*/
+    now = wp->heard;
+    wp->heard = wp->reported = 1288483200;
+    json_vessel_dump(wp, false, buf, sizeof(buf));
+    check(3, strcmp(buf, "{\"class\":\"VESSEL\",\"mmsi\":366123456,"
+		    "\"device\":\"/dev/ais1\","
+		    "\"time\":\"2010-10-31T00:00:00.000Z\","
+		    "\"postype\":1,\"postime\":\"2010-10-31T00:00:00.000Z\","
+		    "\"status\":0,\"accuracy\":false,"
+		    "\"lon\":-44400000,\"lat\":24000001,\"speed\":123,"
+		    "\"course\":2345,\"heading\":234}\r\n") == 0,
+	  "raw dump");
+    json_vessel_dump(wp, true, buf, sizeof(buf));
+    check(3, strstr(buf, "\"lon\":-74.0000,\"lat\":40.0000,\"speed\":12.3,"
+		    "\"course\":234.5,\"heading\":234}") != NULL,
+	  "scaled dump");
+    wp->heard = wp->reported = now;
+    /*@+nullderef@*/
+
+    /*
+     * case 4: backward-shift deletion.  a, b and c share a home slot
+     * and d's home is the slot after it, so d lands past c.  Once b
+     * times out, c and d have to move back or they can't be found.
+     */
+    a = colliding(200000000, 100);
+    b = colliding(a, 100);
+    c = colliding(b, 100);
+    d = colliding(c, 101);
+    check(4, position("/dev/ais0", a, lat) != NULL
+	  && position("/dev/ais0", b, lat) != NULL
+	  && position("/dev/ais0", c, lat) != NULL
+	  && position("/dev/ais0", d, lat) != NULL, "colliding inserts");
+    wp = vessel(b);
+    check(4, wp != NULL, "colliding lookup");
+    /*@-nullderef@*/
+    wp->heard -= AIS_VESSEL_TIMEOUT + 1;
+    /*@+nullderef@*/
+    /* fill to the load limit; the insert after that sweeps */
+    now = timestamp();
+    for (mmsi = 300000000, n = vessels("{\"class\":\"AIS\"}");
+	 n < AIS_VESSELS_MAX; mmsi++)
+	if (home(mmsi) < 90 || home(mmsi) > 110) {
+	    (void)position("/dev/ais0", mmsi, lat);
+	    n++;
+	}
+    check(4, vessel(b) != NULL, "vessel timed out before the sweep");
+    check(4, position("/dev/ais0", ++mmsi, lat) != NULL, "insert when full");
+    check(4, vessel(b) == NULL, "timed-out vessel survived the sweep");
+    check(4, vessels("{\"class\":\"AIS\"}") == AIS_VESSELS_MAX,
+	  "sweep removed the wrong number of vessels");
+    /* found where they are, nothing is added; lost, they'd come back new */
+    check(4, position("/dev/ais0", a, lat) == NULL
+	  && position("/dev/ais0", c, lat) == NULL
+	  && position("/dev/ais0", d, lat) == NULL,
+	  "vessel lost after deletion");
+    check(4, vessels("{\"class\":\"AIS\"}") == AIS_VESSELS_MAX,
+	  "vessel duplicated after deletion");
+
+    /* case 5: a full table with nothing timed out gives up its oldest */
+    wp = vessel(c);
+    check(5, wp != NULL, "lookup before eviction");
+    /*@-nullderef@*/
+    wp->heard = now - AIS_VESSEL_TIMEOUT / 2;
+    /*@+nullderef@*/
+    check(5, position("/dev/ais0", ++mmsi, lat) != NULL, "insert when full");
+    check(5, vessel(c) == NULL, "oldest vessel not evicted");
+    check(5, vessel(d) != NULL && vessel(a) != NULL && vessel(mmsi) != NULL,
+	  "wrong vessel evicted");
+    check(5, vessels("{\"class\":\"AIS\"}") == AIS_VESSELS_MAX,
+	  "eviction removed the wrong number of vessels");
+    check(5, vessels("{\"class\":\"AIS\",\"age\":60}") == AIS_VESSELS_MAX,
+	  "age filter dropped vessels just heard");
+
+    /* case 6: filters that make no sense are refused, none passes all */
+    check(6, compile("{\"class\":\"WATCH\"}", &pred) && !pred.active,
+	  "empty filter active");
+    check(6, aistable_match(&pred, report(5, 1, 0, 0)), "empty filter");
+    check(6, !compile("{\"class\":\"WATCH\",\"aistypes\":[0]}", &pred)
+	  && !compile("{\"class\":\"WATCH\",\"aistypes\":[28]}", &pred),
+	  "bad type accepted");
+    check(6, !compile("{\"class\":\"WATCH\",\"aisbox\":[1,2,3]}", &pred)
+	  && !compile("{\"class\":\"WATCH\",\"aisbox\":[41,-75,40,-73]}",
+		      &pred)
+	  && !compile("{\"class\":\"WATCH\",\"aisbox\":[40,-181,41,-73]}",
+		      &pred), "bad box accepted");
+    check(6, !compile("{\"class\":\"WATCH\",\"aisradius\":[40,-74]}", &pred)
+	  && !compile("{\"class\":\"WATCH\",\"aisradius\":[40,-74,0]}",
+		      &pred)
+	  && !compile("{\"class\":\"WATCH\",\"aisradius\":[91,-74,10]}",
+		      &pred), "bad radius accepted");
+
+    /* case 7: boxes, including one whose west edge is east of its east */
+#define BOX	"{\"class\":\"WATCH\",\"aisbox\":[40,-75,41,-73]}"
+    check(7, passes(BOX, report(1, 1, 40.5, -74)), "inside box");
+    check(7, passes(BOX, report(18, 1, 40, -75)), "on box corner");
+    check(7, !passes(BOX, report(1, 1, 41.01, -74)), "north of box");
+    check(7, !passes(BOX, report(1, 1, 40.5, -72.99)), "east of box");
+#undef BOX
+#define BOX	"{\"class\":\"WATCH\",\"aisbox\":[50,170,60,-170]}"
+    check(7, passes(BOX, report(1, 1, 55, 175)), "west of 180 in box");
+    check(7, passes(BOX, report(1, 1, 55, -175)), "east of 180 in box");
+    check(7, passes(BOX, report(1, 1, 55, 180)), "on 180 in box");
+    check(7, !passes(BOX, report(1, 1, 55, 0)), "box spanning 180 inverted");
+    check(7, !passes(BOX, report(1, 1, 55, 165)), "west of box spanning 180");
+    check(7, !passes(BOX, report(1, 1, 55, -165)), "east of box spanning 180");
+    check(7, !passes(BOX, report(1, 1, 45, 175)), "south of box spanning 180");
+#undef BOX
+
+    /* case 8: a radius in nautical miles, a minute of latitude each */
+#define CIRCLE	"{\"class\":\"WATCH\",\"aisradius\":[40,-74,10]}"
+    check(8, passes(CIRCLE, report(1, 1, 40.1, -74)), "6nm north");
+    check(8, !passes(CIRCLE, report(1, 1, 39.8, -74)), "12nm south");
+    /* a degree of longitude is shorter away from the equator */
+    check(8, passes(CIRCLE, report(1, 1, 40, -73.8)), "9.2nm east");
+    check(8, !passes(CIRCLE, report(1, 1, 40, -73.75)), "11.5nm east");
+    check(8, !passes(CIRCLE, report(1, 1, 40.15, -73.85)), "11.3nm northeast");
+#undef CIRCLE
+#define CIRCLE	"{\"class\":\"WATCH\",\"aisradius\":[0,179.95,10]}"
+    check(8, passes(CIRCLE, report(1, 1, 0, -179.95)), "across 180");
+    check(8, !passes(CIRCLE, report(1, 1, 0, -179.75)), "far across 180");
+#undef CIRCLE
+    check(8, !passes("{\"class\":\"WATCH\",\"aisradius\":[0,0,10]}",
+		     report(1, 1, 91, 181)), "position not available");
+
+    /* case 9: MMSI lists; what is denied never passes */
+#define MMSI	"{\"class\":\"WATCH\",\"aismmsi\":[1,2],\"aisnotmmsi\":[2]}"
+    check(9, passes(MMSI, report(5, 1, 0, 0)), "allowed MMSI");
+    check(9, !passes(MMSI, report(5, 2, 0, 0)), "denied MMSI on allow list");
+    check(9, !passes(MMSI, report(5, 3, 0, 0)), "MMSI not on allow list");
+#undef MMSI
+#define MMSI	"{\"class\":\"WATCH\",\"aisnotmmsi\":[5,7]}"
+    check(9, !passes(MMSI, report(5, 7, 0, 0)), "denied MMSI");
+    check(9, passes(MMSI, report(5, 6, 0, 0)), "MMSI not denied");
+#undef MMSI
+
+    /* case 10: the type mask */
+#define TYPES	"{\"class\":\"WATCH\",\"aistypes\":[1,5,27]}"
+    check(10, passes(TYPES, report(1, 1, 0, 0)), "type 1");
+    check(10, passes(TYPES, report(5, 1, 0, 0)), "type 5");
+    check(10, passes(TYPES, report(27, 1, 0, 0)), "type 27");
+    check(10, !passes(TYPES, report(18, 1, 0, 0)), "type 18");
+    check(10, !passes(TYPES, report(4, 1, 0, 0)), "type 4");
+#undef TYPES
+    check(10, !passes("{\"class\":\"WATCH\",\"aistypes\":[1],"
+		      "\"aismmsi\":[1]}", report(1, 2, 0, 0)),
+	  "type and MMSI filters not both applied");
+
+    /*
+     * case 11: messages without a position are placed where the vessel
+     * table last had the sender, and fail a position filter if it
+     * hasn't heard of it.  The case 1 vessel is still in the table.
+     */
+    check(11, vessel(366123456) != NULL, "case 1 vessel gone");
+#define BOX	"{\"class\":\"WATCH\",\"aisbox\":[39.9,-74.1,40.1,-73.9]}"
+    check(11, passes(BOX, report(5, 366123456, 0, 0)), "static data in box");
+    check(11, passes(BOX, report(24, 366123456, 0, 0)), "type 24 in box");
+    check(11, !passes(BOX, report(5, 123456789, 0, 0)), "unknown vessel");
+    check(11, !passes(BOX, report(1, 366123456, 0, 0)),
+	  "table position used over the message's own");
+    check(11, passes(BOX, report(27, 1, 40, -74)), "long-range position");
+#undef BOX
+    check(11, !passes("{\"class\":\"WATCH\",\"aisradius\":[50,-74,10]}",
+		      report(5, 366123456, 0, 0)),
+	  "static data outside radius");
+    check(11, passes("{\"class\":\"WATCH\",\"aisradius\":[40,-74,1]}",
+		     report(5, 366123456, 0, 0)),
+	  "static data inside radius");
+
+    (void)printf("AIS vessel table test succeeded.\n");
+    exit(0);
+}
+#else
+int main(int argc UNUSED, char *argv[] UNUSED)
+{
+    (void)printf("AIS vessel table not configured, nothing to test\n");
+    exit(0);
+}
+#endif /* defined(AIVDM_ENABLE) && defined(SOCKET_EXPORT_ENABLE) */
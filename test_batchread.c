@@ -0,0 +1,116 @@
+/* test_batchread.c - unit test for libgps reading batched reports
+ *
+ * Plays the daemon on a loopback socket and feeds a libgps client the
+ * way a watcher with "aisbatch" set gets fed: a report and the start of
+ * another, then the rest of it with a whole batch of reports behind it
+ * in one send.  Checks that gps_waiting() waits out a partial line
+ * instead of reporting it as input, and that gps_read() hands out a
+ * buffered batch one report per call without touching the socket.
+ *
+ * This file is Copyright (c) 2010 by the GPSD project
+ * BSD terms apply: see the file COPYING in the distribution root for details.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <sys/types.h>
+#include <sys/time.h>
+#ifndef S_SPLINT_S
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+#endif /* S_SPLINT_S */
+
+#include "gpsd.h"
+#include "gps_json.h"
+
+#define REPORT	"{\"class\":\"TPV\",\"mode\":2,\"lon\":0.0,\"lat\":%d.0}\n"
+
+static void check(int num, bool ok, const char *what)
+{
+    if (!ok) {
+	(void)fprintf(stderr, "case %d FAILED: %s.\n", num, what);
+	exit(1);
+    }
+}
+
+static double elapsed(const struct timeval *since)
+{
+    struct timeval now;
+
+    (void)gettimeofday(&now, NULL);
+    return (now.tv_sec - since->tv_sec) + (now.tv_usec - since->tv_usec) / 1e6;
+}
+
+static bool got(struct gps_data_t *gpsdata, int lat)
+/* did gps_read() return a whole report, the one with this latitude? */
+{
+    return gps_read(gpsdata) > 0 && (gpsdata->set & PACKET_SET) != 0
+	&& gpsdata->fix.latitude == lat;
+}
+
+int main(int argc UNUSED, char *argv[] UNUSED)
+{
+    static struct gps_data_t gpsdata;
+    struct sockaddr_in addr;
+    socklen_t addrlen = sizeof(addr);
+    char port[8], batch[GPS_JSON_BATCH_MAX];
+    struct timeval start;
+    int listener, daemon_fd, lat, n;
+    size_t len;
+
+    /* stand in for the daemon on a port the kernel picks */
+    listener = socket(PF_INET, SOCK_STREAM, 0);
+    (void)memset(&addr, '\0', sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    check(0, listener >= 0
+	  && bind(listener, (struct sockaddr *)&addr, sizeof(addr)) == 0
+	  && listen(listener, 1) == 0
+	  && getsockname(listener, (struct sockaddr *)&addr, &addrlen) == 0,
+	  "listening socket");
+    (void)snprintf(port, sizeof(port), "%d", ntohs(addr.sin_port));
+    check(0, gps_open("127.0.0.1", port, &gpsdata) == 0, "gps_open");
+    daemon_fd = accept(listener, NULL, NULL);
+    check(0, daemon_fd >= 0, "accept");
+
+    /* the stream: report 1, then report 2 and a batch behind it */
+    len = 0;
+    for (lat = 1; len + 64 < sizeof(batch); lat++)
+	len += (size_t)snprintf(batch + len, sizeof(batch) - len, REPORT, lat);
+    n = (int)(strchr(batch, '\n') - batch) + 10;
+
+    /* case 1: a report and the start of the next */
+    check(1, send(daemon_fd, batch, (size_t)n, 0) == (ssize_t)n, "send");
+    check(1, gps_waiting(&gpsdata, 1000000), "report not waiting");
+    check(1, got(&gpsdata, 1), "first report");
+
+    /* case 2: the partial line left buffered is not input yet */
+    (void)gettimeofday(&start, NULL);
+    check(2, !gps_waiting(&gpsdata, 200000), "partial line counted as input");
+    check(2, elapsed(&start) > 0.15, "gps_waiting() didn't wait");
+    check(2, gps_read(&gpsdata) == 0, "partial line read as a report");
+
+    /* case 3: the rest of it, with the batch, in one send */
+    check(3, send(daemon_fd, batch + n, len - (size_t)n, 0)
+	  == (ssize_t)(len - (size_t)n), "send");
+    check(3, gps_waiting(&gpsdata, 1000000), "batch not waiting");
+    check(3, got(&gpsdata, 2), "completed report");
+    for (n = 3; n < lat; n++) {
+	check(3, gps_waiting(&gpsdata, 0), "buffered report not waiting");
+	check(3, got(&gpsdata, n), "report from the batch");
+    }
+    check(3, !gps_waiting(&gpsdata, 0), "input after the batch");
+
+    /* case 4: the daemon going away is the end of the data */
+    (void)close(daemon_fd);
+    check(4, gps_waiting(&gpsdata, 1000000), "close not seen");
+    check(4, gps_read(&gpsdata) == -1, "close not reported");
+    (void)gps_close(&gpsdata);
+    (void)close(listener);
+
+    (void)printf("batched reads OK, %d reports\n", lat - 1);
+    exit(0);
+}
@@ -0,0 +1,251 @@
+/*
+ * test_dedup: replay one AIS capture on two feeds through the duplicate
+ * filter.
+ *
+ * The capture is first run through one session alone to learn what it
+ * decodes to.  Then the same capture is fed to two sessions sharing a
+ * context, as two receivers on one daemon would see it, with their
+ * sentences interleaved A B B A, A B B A...  so that for a multipart
+ * message one feed's first fragment and the other feed's last fragment
+ * come in ahead of their copies.  Each sentence goes through the AIVDM
+ * driver's packet parser, as in the daemon.
+ *
+ * With duplicates dropped, the two feeds together have to decode every
+ * message in the capture exactly once.  With duplicates kept, both feeds
+ * decode everything, and the reports not marked as duplicates have to
+ * be every message exactly once.  Last, the feed that first heard the
+ * messages is replaced by another device in the same slot, and the
+ * copies on the other feed still have to be dropped and charged to the
+ * feed that went away.  The exit status is 1 if not.
+ *
+ * Usage: test_dedup [-v level] capture
+ *
+ * This file is Copyright (c) 2010 by the GPSD project
+ * BSD terms apply: see the file COPYING in the distribution root for details.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include <errno.h>
+#ifndef S_SPLINT_S
+#include <unistd.h>
+#endif /* S_SPLINT_S */
+
+#include "gpsd.h"
+
+static int verbose = 0;
+
+void gpsd_report(int errlevel, const char *fmt, ...)
+/* assemble command in printf(3) style, use stderr */
+{
+    if (errlevel <= verbose) {
+	char buf[BUFSIZ];
+	va_list ap;
+
+	buf[0] = '\0';
+	va_start(ap, fmt);
+	(void)vsnprintf(buf, sizeof(buf), fmt, ap);
+	va_end(ap);
+
+	(void)fputs(buf, stderr);
+    }
+}
+
+#ifdef AIVDM_ENABLE
+#define MAX_SENTENCES	256
+
+static char *sentences[MAX_SENTENCES];
+static int nsentences;
+
+/* what the capture decodes to on one feed, and which of it was seen */
+static unsigned int expected[MAX_SENTENCES];
+static bool matched[MAX_SENTENCES];
+static int nexpected;
+
+static struct gps_context_t context;
+static /*@null@*/ const struct gps_type_t *aivdm;
+
+static void check(int num, bool ok, const char *what)
+{
+    if (!ok) {
+	(void)fprintf(stderr, "case %d FAILED: %s.\n", num, what);
+	exit(1);
+    }
+}
+
+static void load_capture(const char *path)
+/* collect the AIVDM sentences in a capture */
+{
+    char line[BUFSIZ];
+    FILE *fp;
+
+    if ((fp = fopen(path, "r")) == NULL) {
+	(void)fprintf(stderr, "test_dedup: can't open %s: %s\n",
+		      path, strerror(errno));
+	exit(1);
+    }
+    while (fgets(line, (int)sizeof(line), fp) != NULL)
+	if (line[0] == '!' && nsentences < MAX_SENTENCES
+	    && (sentences[nsentences] = strdup(line)) != NULL)
+	    nsentences++;
+    (void)fclose(fp);
+    if (nsentences == 0) {
+	(void)fprintf(stderr, "test_dedup: no sentences in %s\n", path);
+	exit(1);
+    }
+}
+
+static void feed_init(struct gps_device_t *session, const char *path)
+{
+    (void)memset(session, '\0', sizeof(*session));
+    gpsd_init(session, &context, path);
+    session->device_type = aivdm;
+}
+
+static gps_mask_t feed(struct gps_device_t *session, int n, timestamp_t now)
+/* hand sentence n of the capture to a session's driver */
+{
+    size_t len = strlen(sentences[n]);
+
+    packet_init(&session->packet);
+    (void)memcpy(session->packet.inbuffer, sentences[n], len);
+    session->packet.inbuflen = len;
+    packet_parse(&session->packet);
+    session->packet.recv_time = now;
+    if (session->packet.type != AIVDM_PACKET)
+	return 0;
+    /*@-nullderef@*/
+    return aivdm->parse_packet(session);
+    /*@+nullderef@*/
+}
+
+static bool expect(const struct ais_t *ais)
+/* is this report one of the capture's messages not yet accounted for? */
+{
+    int i;
+
+    for (i = 0; i < nexpected; i++)
+	if (!matched[i] && expected[i] == ais->mmsi) {
+	    matched[i] = true;
+	    return true;
+	}
+    return false;
+}
+
+static void replay(int num, bool drop)
+/* run the capture on two feeds, interleaved A B B A */
+{
+    static struct gps_device_t feeds[2];
+    static const int order[] = {0, 1, 1, 0};
+    int next[2] = {0, 0}, step, i, decoded = 0, unique = 0;
+
+    gps_context_init(&context);
+    context.aivdm_dedup = drop;
+    feed_init(&feeds[0], "feed A");
+    feed_init(&feeds[1], "feed B");
+    (void)memset(matched, '\0', sizeof(matched));
+
+    for (step = 0; next[0] < nsentences || next[1] < nsentences; step++) {
+	int f = order[step % NITEMS(order)];
+
+	if (next[f] >= nsentences)
+	    continue;
+	if ((feed(&feeds[f], next[f]++, 1288483200 + step / 4) & AIS_SET) == 0)
+	    continue;
+	decoded++;
+	if (!feeds[f].aivdm_dedup.last) {
+	    unique++;
+	    check(num, expect(&feeds[f].gpsdata.ais),
+		  "message decoded twice or wrongly");
+	}
+    }
+    for (i = 0; i < nexpected; i++)
+	check(num, matched[i], "message lost");
+    check(num, unique == nexpected, "wrong number of unique messages");
+    check(num, decoded == (drop ? nexpected : 2 * nexpected),
+	  "wrong number of messages decoded");
+    (void)printf("two feeds: %d messages, %d decoded with duplicates %s\n",
+		 unique, decoded, drop ? "dropped" : "kept");
+}
+
+static void reuse(int num)
+/* a feed's slot reused by another device while its messages are remembered */
+{
+    static struct gps_device_t feeds[2];
+    int i;
+
+    gps_context_init(&context);
+    context.aivdm_dedup = true;
+    feed_init(&feeds[0], "feed A");
+    feed_init(&feeds[1], "feed B");
+    for (i = 0; i < nsentences; i++)
+	(void)feed(&feeds[1], i, 1288483200);
+    feed_init(&feeds[1], "feed C");
+    for (i = 0; i < nsentences; i++)
+	check(num, (feed(&feeds[0], i, 1288483200) & AIS_SET) == 0,
+	      "copy decoded after the first feed went away");
+    check(num, strcmp(feeds[0].aivdm_dedup.peers[0].first, "feed B") == 0
+	  && feeds[0].aivdm_dedup.peers[1].first[0] == '\0',
+	  "duplicates charged to the wrong feed");
+    (void)printf("reused slot: %lu duplicates first heard on %s\n",
+		 feeds[0].aivdm_dedup.peers[0].count,
+		 feeds[0].aivdm_dedup.peers[0].first);
+}
+
+int main(int argc, char *argv[])
+{
+    static struct gps_device_t session;
+    int option, i;
+
+    while ((option = getopt(argc, argv, "v:")) != -1) {
+	switch (option) {
+	case 'v':
+	    verbose = atoi(optarg);
+	    break;
+	default:
+	    (void)fputs("usage: test_dedup [-v level] capture\n", stderr);
+	    exit(1);
+	}
+    }
+    if (optind != argc - 1) {
+	(void)fputs("test_dedup: need one capture file\n", stderr);
+	exit(1);
+    }
+    load_capture(argv[optind]);
+    for (i = 0; gpsd_drivers[i] != NULL; i++)
+	if (strcmp(gpsd_drivers[i]->type_name, "AIVDM") == 0)
+	    aivdm = gpsd_drivers[i];
+    if (aivdm == NULL) {
+	(void)fputs("test_dedup: no AIVDM driver\n", stderr);
+	exit(1);
+    }
+
+    /* case 1: what one feed makes of the capture */
+    gps_context_init(&context);
+    context.aivdm_dedup = true;
+    feed_init(&session, "feed A");
+    for (i = 0; i < nsentences; i++)
+	if ((feed(&session, i, 1288483200) & AIS_SET) != 0)
+	    expected[nexpected++] = session.gpsdata.ais.mmsi;
+    check(1, nexpected > 0, "nothing decoded");
+    (void)printf("one feed: %d messages\n", nexpected);
+
+    /* case 2: two feeds, copies dropped before decoding */
+    replay(2, true);
+
+    /* case 3: two feeds, copies decoded but marked */
+    replay(3, false);
+
+    /* case 4: where duplicates were first heard outlives the device */
+    reuse(4);
+
+    exit(0);
+}
+#else
+int main(int argc UNUSED, char *argv[] UNUSED)
+{
+    (void)printf("AIVDM not configured, nothing to test\n");
+    exit(0);
+}
+#endif /* AIVDM_ENABLE */
@@ -9,6 +9,7 @@
 #include <stdlib.h>
 #include <string.h>
 #include <stddef.h>
+#include <math.h>
 #include <getopt.h>
 
 #include "gpsd.h"
@@ -206,6 +207,24 @@ static const struct json_attr_t json_attrs_8[] = {
     {"foe",  t_integer, .addr.integer = &foe, .map=enum_table},
     {NULL},
 };
+
+/* Case 9: test parsing of RAW, members left out where not supplied */
+
+static const char *json_str9 = "{\"class\":\"RAW\",\"tag\":\"0210\",\
+           \"device\":\"/dev/ttyUSB0\",\"time\":1227373590.000000,\
+           \"meas\":[{\"PRN\":7,\"st\":7,\"ss\":44.0,\"pr\":21374633.621,\
+           \"cp\":-2157816.375,\"do\":-1283.250},\
+           {\"PRN\":26,\"st\":1,\"ss\":31.0,\"pr\":24009301.180,\
+           \"mt\":1227373589.500000}]}";
+
+/* Case 10: test parsing of numeric arrays, in WATCH AIS filters */
+
+static const char *json_str10 = "{\"class\":\"WATCH\",\"json\":true,\
+           \"aisbox\":[ 36.5, -77,41.25,-70 ],\"aismmsi\":[],\
+           \"aisnotmmsi\":[371798000],\"aistypes\":[1, 5,18]}";
+
+static struct policy_t watch10;
+
 /*@ +fullinitblock @*/
 /* *INDENT-ON* */
 
@@ -303,6 +322,36 @@ int main(int argc UNUSED, char *argv[]UNUSED)
     assert_integer("fie", fie, 6);
     assert_integer("foe", foe, 14);
 
+    status = libgps_json_unpack(json_str9, &gpsdata, NULL);
+    assert_case(9, status);
+    assert_string("tag", gpsdata.tag, "0210");
+    assert_integer("PRN[0]", gpsdata.raw.PRN[0], 7);
+    assert_uinteger("st[0]", gpsdata.raw.satstat[0], 7);
+    assert_real("ss[0]", gpsdata.raw.ss[0], 44.0);
+    assert_real("pr[0]", gpsdata.raw.pseudorange[0], 21374633.621);
+    assert_real("cp[0]", gpsdata.raw.carrierphase[0], -2157816.375);
+    assert_real("do[0]", gpsdata.raw.doppler[0], -1283.250);
+    assert_real("mt[0]", gpsdata.raw.mtime[0], 1227373590.0);
+    assert_integer("PRN[1]", gpsdata.raw.PRN[1], 26);
+    assert_real("mt[1]", gpsdata.raw.mtime[1], 1227373589.5);
+    assert_integer("PRN[2]", gpsdata.raw.PRN[2], 0);
+    assert_boolean("cp[1] absent", isnan(gpsdata.raw.carrierphase[1]) != 0,
+		   true);
+    assert_boolean("RAW_SET", (gpsdata.set & RAW_SET) != 0, true);
+
+    status = json_watch_read(json_str10, &watch10, NULL);
+    assert_case(10, status);
+    assert_integer("nbox", watch10.aisfilter.nbox, 4);
+    assert_real("box[0]", watch10.aisfilter.box[0], 36.5);
+    assert_real("box[1]", watch10.aisfilter.box[1], -77);
+    assert_real("box[2]", watch10.aisfilter.box[2], 41.25);
+    assert_integer("nradius", watch10.aisfilter.nradius, 0);
+    assert_integer("nmmsi", watch10.aisfilter.nmmsi, 0);
+    assert_integer("nnotmmsi", watch10.aisfilter.nnotmmsi, 1);
+    assert_uinteger("notmmsi[0]", watch10.aisfilter.notmmsi[0], 371798000);
+    assert_integer("ntypes", watch10.aisfilter.ntypes, 3);
+    assert_uinteger("types[2]", watch10.aisfilter.types[2], 18);
+
     (void)fprintf(stderr, "succeeded.\n");
 
     exit(0);
@@ -0,0 +1,479 @@
+/*
+ * test_lexbench: measure packet-lexer and driver throughput.
+ *
+ * Each capture named on the command line is memory-mapped and pushed
+ * through packet_parse() and the parse_packet method of the driver
+ * that owns each recognized packet type, repeatedly and with no I/O
+ * in the loop.  Results are written one JSON object per line: one
+ * per capture, then one per protocol totalled over all captures, so
+ * runs on different revisions can be compared mechanically.
+ *
+ * With -d, each capture is lexed once up front and only the driver
+ * decode step is timed, which makes a microbenchmark for the sentence
+ * and message decoders themselves.  Adding -j also renders every
+ * decoded AIS report as unscaled JSON with json_aivdm_dump(), timed
+ * separately and reported as an extra line per capture.
+ *
+ * With -c nothing is timed.  Instead each capture is replayed through
+ * the drivers twice, the second time as if the device had been closed
+ * and reopened, and the program reports how many reporting cycles got
+ * a fix report and how many bytes into the cycle the first one came.
+ *
+ * Usage: test_lexbench [-c] [-d] [-j] [-n iterations] [-t seconds] [-v level] logfile...
+ *
+ * This file is Copyright (c) 2010 by the GPSD project
+ * BSD terms apply: see the file COPYING in the distribution root for details.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include <stdint.h>
+#include <time.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#ifndef S_SPLINT_S
+#include <sys/mman.h>
+#include <unistd.h>
+#endif /* S_SPLINT_S */
+#if defined(__linux__) && !defined(S_SPLINT_S)
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#define HAVE_PERF_EVENTS
+#endif /* defined(__linux__) && !defined(S_SPLINT_S) */
+
+#include "gpsd.h"
+#include "gps_json.h"
+
+static int verbose = 0;
+static bool json_dump = false;
+
+void gpsd_report(int errlevel, const char *fmt, ...)
+/* assemble command in printf(3) style, use stderr */
+{
+    if (errlevel <= verbose) {
+	char buf[BUFSIZ];
+	va_list ap;
+
+	buf[0] = '\0';
+	va_start(ap, fmt);
+	(void)vsnprintf(buf, sizeof(buf), fmt, ap);
+	va_end(ap);
+
+	(void)fputs(buf, stderr);
+    }
+}
+
+/* indexed by packet type; BAD_PACKET is counted in the last slot */
+static const char *packet_names[] = {
+    "COMMENT", "NMEA", "AIVDM", "GARMINTXT", "SIRF", "ZODIAC", "TSIP",
+    "EVERMORE", "ITALK", "GARMIN", "NAVCOM", "UBX", "SUPERSTAR2",
+    "ONCORE", "GEOSTAR", "RTCM2", "RTCM3", "JSON", "BAD",
+};
+#define NPACKETTYPES	(int)(sizeof(packet_names)/sizeof(packet_names[0]))
+#define TYPE_SLOT(t)	((t) >= 0 && (t) < NPACKETTYPES - 1 ? (t) : NPACKETTYPES - 1)
+
+struct bench_t {
+    unsigned long packets;
+    size_t bytes;
+    double seconds;
+};
+
+static struct bench_t totals[NPACKETTYPES];
+static struct bench_t dumps;		/* AIS JSON rendering, with -j */
+static const struct gps_type_t *parsers[NPACKETTYPES];
+
+static double monotonic(void)
+{
+    struct timespec ts;
+
+    (void)clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+#ifdef HAVE_PERF_EVENTS
+static int branch_counter(void)
+/* open a user-space branch-miss counter on this process, or -1 */
+{
+    struct perf_event_attr pe;
+
+    (void)memset(&pe, '\0', sizeof(pe));
+    pe.type = PERF_TYPE_HARDWARE;
+    pe.size = sizeof(pe);
+    pe.config = PERF_COUNT_HW_BRANCH_MISSES;
+    pe.disabled = 1;
+    pe.exclude_kernel = 1;
+    pe.exclude_hv = 1;
+    return (int)syscall(__NR_perf_event_open, &pe, 0, -1, -1, 0);
+}
+#endif /* HAVE_PERF_EVENTS */
+
+/* packets collected by a lexing pass, for decode-only runs */
+static unsigned char *tape;
+static size_t tapelen, tapesize;
+
+static void tape_append(const struct gps_packet_t *lexer)
+/* record a recognized packet for later replay */
+{
+    size_t need = sizeof(lexer->type) + sizeof(lexer->outbuflen)
+	+ lexer->outbuflen;
+
+    if (tapelen + need > tapesize) {
+	tapesize = 2 * (tapesize + need);
+	if ((tape = (unsigned char *)realloc(tape, tapesize)) == NULL) {
+	    (void)fputs("test_lexbench: out of memory\n", stderr);
+	    exit(1);
+	}
+    }
+    (void)memcpy(tape + tapelen, &lexer->type, sizeof(lexer->type));
+    tapelen += sizeof(lexer->type);
+    (void)memcpy(tape + tapelen, &lexer->outbuflen, sizeof(lexer->outbuflen));
+    tapelen += sizeof(lexer->outbuflen);
+    (void)memcpy(tape + tapelen, lexer->outbuffer, lexer->outbuflen);
+    tapelen += lexer->outbuflen;
+}
+
+static void bench_packet(struct gps_device_t *session, double *last,
+			 struct bench_t *stats)
+/* decode the packet in the output buffer and charge it to its protocol */
+{
+    struct gps_packet_t *lexer = &session->packet;
+    int slot = TYPE_SLOT(lexer->type);
+    gps_mask_t changed = 0;
+    double now;
+
+    if (parsers[slot] != NULL) {
+	session->device_type = parsers[slot];
+	changed = parsers[slot]->parse_packet(session);
+	/* a driver that reported early gets the packet again */
+	if (session->reparse) {
+	    session->reparse = false;
+	    changed |= parsers[slot]->parse_packet(session);
+	}
+    }
+    now = monotonic();
+    totals[slot].packets++;
+    totals[slot].bytes += lexer->outbuflen;
+    totals[slot].seconds += now - *last;
+    stats->packets++;
+    *last = now;
+    if (json_dump && (changed & AIS_SET) != 0) {
+	char buf[GPS_JSON_RESPONSE_MAX];
+
+	json_aivdm_dump(&session->gpsdata.ais, NULL, false, buf, sizeof(buf));
+	*last = monotonic();
+	dumps.packets++;
+	dumps.bytes += strlen(buf);
+	dumps.seconds += *last - now;
+    }
+}
+
+static void bench_pass(struct gps_device_t *session,
+		       const unsigned char *map, size_t len,
+		       struct bench_t *stats, bool record)
+/* push one copy of a capture through the lexer and drivers */
+{
+    struct gps_packet_t *lexer = &session->packet;
+    size_t offset = 0;
+    double last = monotonic();
+
+    /* each pass sees the capture as a freshly opened device */
+    gpsd_clear(session);
+    gpsd_zero_satellites(&session->gpsdata);
+    for (;;) {
+	size_t chunk = sizeof(lexer->inbuffer) - lexer->inbuflen;
+
+	/* top up the input buffer the way a fast read() would */
+	if (chunk > len - offset)
+	    chunk = len - offset;
+	if (chunk > 0) {
+	    (void)memcpy(lexer->inbuffer + lexer->inbuflen, map + offset,
+			 chunk);
+	    lexer->inbuflen += chunk;
+	    offset += chunk;
+	} else if (packet_buffered_input(lexer) <= 0)
+	    break;
+
+	packet_parse(lexer);
+
+	/* same overflow rule as packet_get() */
+	if (sizeof(lexer->inbuffer) == lexer->inbuflen)
+	    packet_reset(lexer);
+
+	if (lexer->outbuflen == 0) {
+	    if (chunk == 0)
+		break;		/* trailing fragment, no more input */
+	    continue;
+	}
+
+	if (record)
+	    tape_append(lexer);
+	else
+	    bench_packet(session, &last, stats);
+    }
+    stats->bytes += len;
+}
+
+static bool tape_next(struct gps_packet_t *lexer, size_t *offset)
+/* load the next recorded packet into the output buffer */
+{
+    if (*offset >= tapelen)
+	return false;
+    (void)memcpy(&lexer->type, tape + *offset, sizeof(lexer->type));
+    *offset += sizeof(lexer->type);
+    (void)memcpy(&lexer->outbuflen, tape + *offset, sizeof(lexer->outbuflen));
+    *offset += sizeof(lexer->outbuflen);
+    (void)memcpy(lexer->outbuffer, tape + *offset, lexer->outbuflen);
+    lexer->outbuffer[lexer->outbuflen] = '\0';
+    *offset += lexer->outbuflen;
+    return true;
+}
+
+static void decode_pass(struct gps_device_t *session, struct bench_t *stats)
+/* replay the recorded packets through the drivers alone */
+{
+    size_t offset = 0;
+    double last;
+
+    gpsd_clear(session);
+    gpsd_zero_satellites(&session->gpsdata);
+    last = monotonic();
+    while (tape_next(&session->packet, &offset)) {
+	stats->bytes += session->packet.outbuflen;
+	bench_packet(session, &last, stats);
+    }
+}
+
+struct cycle_t {
+    unsigned long epochs;	/* reporting cycles opened */
+    unsigned long reported;	/* ...and reported before the next opened */
+    unsigned long reports;	/* fix reports a client would have seen */
+    size_t lag;			/* bytes from epoch start to first report */
+};
+
+static void cycle_pass(struct gps_device_t *session, struct cycle_t *stats)
+/* replay the recorded packets, watching when fixes would be reported */
+{
+    size_t offset = 0, position = 0, opened = 0;
+    bool reported = true;
+
+    gpsd_clear(session);
+    gpsd_zero_satellites(&session->gpsdata);
+    while (tape_next(&session->packet, &offset)) {
+	int slot = TYPE_SLOT(session->packet.type);
+	size_t start = position;
+	gps_mask_t changed;
+
+	position += session->packet.outbuflen;
+	if (parsers[slot] == NULL)
+	    continue;
+	session->device_type = parsers[slot];
+	changed = parsers[slot]->parse_packet(session);
+	if (session->reparse) {
+	    session->reparse = false;
+	    changed |= parsers[slot]->parse_packet(session);
+	}
+	if ((changed & CLEAR_IS) != 0) {
+	    stats->epochs++;
+	    opened = start;
+	    reported = false;
+	}
+	/* same rule as consume_packets() in gpsd.c */
+	if (!session->cycle_end_reliable
+	    && (changed & (LATLON_SET | MODE_SET)) != 0)
+	    changed |= REPORT_IS;
+	if ((changed & REPORT_IS) != 0) {
+	    stats->reports++;
+	    if (!reported && stats->epochs > 0) {
+		stats->reported++;
+		stats->lag += position - opened;
+		reported = true;
+	    }
+	}
+    }
+}
+
+static void cycle_print(const char *path, const char *pass,
+			const struct cycle_t *stats)
+/* report on when one replay of a capture would have shipped fixes */
+{
+    double lag = stats->reported > 0 ?
+	(double)stats->lag / stats->reported : 0;
+
+    /* a byte is ten bit times on the wire; 4800bps is the NMEA default */
+    (void)printf("{\"class\":\"CYCLE\",\"log\":\"%s\",\"pass\":\"%s\","
+		 "\"epochs\":%lu,\"reported\":%lu,\"reports\":%lu,"
+		 "\"lag_bytes\":%.1f,\"lag_ms_4800\":%.1f}\n",
+		 path, pass, stats->epochs, stats->reported, stats->reports,
+		 lag, lag * 10 * 1000 / 4800);
+}
+
+static void bench_log(const char *path, bool decode_only, bool cycles,
+		      int iterations, double mintime)
+/* benchmark one capture and report on it */
+{
+    static struct gps_context_t context;
+    static struct gps_device_t session;
+    struct bench_t stats;
+    struct stat sb;
+    unsigned char *map;
+    double start;
+    int fd, i;
+#ifdef HAVE_PERF_EVENTS
+    int perf_fd = branch_counter();
+    uint64_t misses = 0;
+#endif /* HAVE_PERF_EVENTS */
+
+    if ((fd = open(path, O_RDONLY)) == -1 || fstat(fd, &sb) == -1) {
+	(void)fprintf(stderr, "test_lexbench: can't open %s\n", path);
+	exit(1);
+    }
+    if (sb.st_size == 0) {
+	(void)close(fd);
+	return;
+    }
+    /*@i1@*/map = mmap(NULL, (size_t)sb.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (map == MAP_FAILED) {
+	(void)fprintf(stderr, "test_lexbench: can't map %s\n", path);
+	exit(1);
+    }
+
+    gps_context_init(&context);
+    context.debug = verbose;
+    context.readonly = true;
+    gpsd_init(&session, &context, path);
+    session.gpsdata.gps_fd = -1;
+
+    (void)memset(&stats, '\0', sizeof(stats));
+    (void)memset(&dumps, '\0', sizeof(dumps));
+    if (cycles) {
+	struct cycle_t cold, warm;
+
+	tapelen = 0;
+	bench_pass(&session, map, (size_t)sb.st_size, &stats, true);
+	/* the second replay is a reopened device that remembers its cycle */
+	(void)memset(&cold, '\0', sizeof(cold));
+	(void)memset(&warm, '\0', sizeof(warm));
+	cycle_pass(&session, &cold);
+	cycle_pass(&session, &warm);
+	cycle_print(path, "cold", &cold);
+	cycle_print(path, "warm", &warm);
+	(void)fflush(stdout);
+	(void)munmap(map, (size_t)sb.st_size);
+	(void)close(fd);
+	return;
+    }
+#ifdef HAVE_PERF_EVENTS
+    if (perf_fd != -1) {
+	(void)ioctl(perf_fd, PERF_EVENT_IOC_RESET, 0);
+	(void)ioctl(perf_fd, PERF_EVENT_IOC_ENABLE, 0);
+    }
+#endif /* HAVE_PERF_EVENTS */
+    if (decode_only) {
+	tapelen = 0;
+	bench_pass(&session, map, (size_t)sb.st_size, &stats, true);
+	stats.bytes = 0;
+    }
+    start = monotonic();
+    i = 0;
+    do {
+	if (decode_only)
+	    decode_pass(&session, &stats);
+	else
+	    bench_pass(&session, map, (size_t)sb.st_size, &stats, false);
+	i++;
+    } while (iterations > 0 ? i < iterations : monotonic() - start < mintime);
+    stats.seconds = monotonic() - start;
+#ifdef HAVE_PERF_EVENTS
+    if (perf_fd != -1) {
+	(void)ioctl(perf_fd, PERF_EVENT_IOC_DISABLE, 0);
+	if (read(perf_fd, &misses, sizeof(misses)) != (ssize_t)sizeof(misses))
+	    misses = 0;
+	(void)close(perf_fd);
+    }
+#endif /* HAVE_PERF_EVENTS */
+
+    (void)printf("{\"class\":\"BENCH\",\"log\":\"%s\",\"mode\":\"%s\","
+		 "\"iterations\":%d,"
+		 "\"bytes\":%zu,\"packets\":%lu,\"seconds\":%.6f,"
+		 "\"mbytes_sec\":%.3f,\"packets_sec\":%.1f",
+		 path, decode_only ? "decode" : "lex", i, stats.bytes, stats.packets, stats.seconds,
+		 stats.bytes / stats.seconds / 1e6,
+		 stats.packets / stats.seconds);
+#ifdef HAVE_PERF_EVENTS
+    if (perf_fd != -1 && stats.packets > 0)
+	(void)printf(",\"branch_misses_packet\":%.1f",
+		     (double)misses / stats.packets);
+#endif /* HAVE_PERF_EVENTS */
+    (void)fputs("}\n", stdout);
+    if (dumps.packets > 0 && dumps.seconds > 0)
+	(void)printf("{\"class\":\"BENCH\",\"log\":\"%s\",\"mode\":\"json\","
+		     "\"reports\":%lu,\"bytes\":%zu,\"seconds\":%.6f,"
+		     "\"mbytes_sec\":%.3f,\"reports_sec\":%.1f}\n",
+		     path, dumps.packets, dumps.bytes, dumps.seconds,
+		     dumps.bytes / dumps.seconds / 1e6,
+		     dumps.packets / dumps.seconds);
+    (void)fflush(stdout);
+
+    (void)munmap(map, (size_t)sb.st_size);
+    (void)close(fd);
+}
+
+int main(int argc, char *argv[])
+{
+    const struct gps_type_t **dp;
+    int option, iterations = 0, i;
+    double mintime = 0.2;
+    bool decode_only = false, cycles = false;
+
+    while ((option = getopt(argc, argv, "cdjn:t:v:")) != -1) {
+	switch (option) {
+	case 'c':
+	    cycles = true;
+	    break;
+	case 'd':
+	    decode_only = true;
+	    break;
+	case 'j':
+	    json_dump = true;
+	    break;
+	case 'n':
+	    iterations = atoi(optarg);
+	    break;
+	case 't':
+	    mintime = atof(optarg);
+	    break;
+	case 'v':
+	    verbose = atoi(optarg);
+	    break;
+	default:
+	    (void)fputs("usage: test_lexbench [-c] [-d] [-j] [-n iterations] "
+			"[-t seconds] [-v level] logfile...\n", stderr);
+	    exit(1);
+	}
+    }
+
+    /* the first driver claiming a packet type parses it, as in gpsd_poll() */
+    for (dp = gpsd_drivers; *dp; dp++) {
+	int slot = TYPE_SLOT((*dp)->packet_type);
+	if (parsers[slot] == NULL && (*dp)->parse_packet != NULL
+	    && (*dp)->packet_type > COMMENT_PACKET)
+	    parsers[slot] = *dp;
+    }
+
+    for (; optind < argc; optind++)
+	bench_log(argv[optind], decode_only, cycles, iterations, mintime);
+
+    for (i = 0; i < NPACKETTYPES; i++)
+	if (totals[i].packets > 0 && totals[i].seconds > 0)
+	    (void)printf("{\"class\":\"BENCH\",\"protocol\":\"%s\","
+			 "\"packets\":%lu,\"bytes\":%zu,\"seconds\":%.6f,"
+			 "\"mbytes_sec\":%.3f,\"packets_sec\":%.1f}\n",
+			 packet_names[i], totals[i].packets, totals[i].bytes,
+			 totals[i].seconds,
+			 totals[i].bytes / totals[i].seconds / 1e6,
+			 totals[i].packets / totals[i].seconds);
+    exit(0);
+}
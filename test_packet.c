@@ -41,6 +41,8 @@ struct map
     size_t testlen;
     int garbage_offset;
     int type;
+    char *tagsource;		/* tag block s: expected, NULL for none */
+    double tagtime;		/* tag block c: expected */
 };
 
 /* *INDENT-OFF* */
@@ -82,6 +84,22 @@ static struct map singletests[] = {
 	.garbage_offset = 0,
 	.type = BAD_PACKET,
     },
+    {
+	.legend = "AIVDM packet with NMEA 4.x tag block",
+	.test = "\\s:2573345,c:1241544035*08\\!AIVDM,1,1,,A,15RTgt0PAso;90TKcjM8h6g208CQ,0*4A\r\n",
+	.testlen = 76,
+	.garbage_offset = 27,
+	.type = AIVDM_PACKET,
+	.tagsource = "2573345",
+	.tagtime = 1241544035,
+    },
+    {
+	.legend = "AIVDM packet with bad tag block checksum",
+	.test = "\\s:2573345,c:1241544035*09\\!AIVDM,1,1,,A,15RTgt0PAso;90TKcjM8h6g208CQ,0*4A\r\n",
+	.testlen = 76,
+	.garbage_offset = 27,
+	.type = AIVDM_PACKET,
+    },
     /* SiRF tests */
     {
 	.legend = "SiRF WAAS version ID",
@@ -251,6 +269,46 @@ static struct map singletests[] = {
 	.garbage_offset = 0,
 	.type = RTCM3_PACKET,                         
     },
+    /* UBX tests */
+    {
+	.legend = "UBX NAV-SBAS packet",
+	.test = {
+	    0xb5, 0x62, 0x01, 0x32, 0x0c, 0x00, 0x01, 0xea,
+	    0xde, 0x13, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+	    0x00, 0x00, 0x1b, 0x17},
+	.testlen = 20,
+	.garbage_offset = 0,
+	.type = UBX_PACKET,
+    },
+    {
+	.legend = "UBX NAV-SBAS packet with wrong checksum",
+	.test = {
+	    0xb5, 0x62, 0x01, 0x32, 0x0c, 0x00, 0x01, 0xea,
+	    0xde, 0x13, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+	    0x00, 0x00, 0x1b, 0x18},
+	.testlen = 20,
+	.garbage_offset = 0,
+	.type = BAD_PACKET,
+    },
+    /* Navcom tests */
+    {
+	.legend = "Navcom packet 0x06",
+	.test = {
+	    0x02, 0x99, 0x66, 0x06, 0x06, 0x00, 0x20, 0x00,
+	    0x20, 0x03},
+	.testlen = 10,
+	.garbage_offset = 0,
+	.type = NAVCOM_PACKET,
+    },
+    {
+	.legend = "Navcom packet 0x06 with wrong checksum",
+	.test = {
+	    0x02, 0x99, 0x66, 0x06, 0x06, 0x00, 0x20, 0x00,
+	    0x21, 0x03},
+	.testlen = 10,
+	.garbage_offset = 0,
+	.type = BAD_PACKET,
+    },
 };
 /*@ +initallelements -charint +usedef @*/
 /* *INDENT-ON* */
@@ -277,6 +335,12 @@ static int packet_test(struct map *mp)
 
     packet_init(&packet);
     packet.debug = verbose;
+#ifdef NMEA_ENABLE
+    /* as if left by a tagged sentence before; it must not stick */
+    packet.tag.source = "stale";
+    packet.tag.sourcelen = 5;
+    packet.tag.time = 1;
+#endif /* NMEA_ENABLE */
     /*@i@*/ memcpy(packet.inbufptr = packet.inbuffer, mp->test, mp->testlen);
     packet.inbuflen = mp->testlen;
     /*@ -compdef -uniondef -usedef -formatcode @*/
@@ -290,7 +354,23 @@ static int packet_test(struct map *mp)
 	printf("%2zi: %s test FAILED (data garbled).\n", mp - singletests + 1,
 	       mp->legend);
 	++failure;
-    } else
+    }
+#ifdef NMEA_ENABLE
+    else if (mp->type != BAD_PACKET
+	     && (mp->tagsource == NULL
+		 ? (packet.tag.source != NULL || packet.tag.sourcelen != 0
+		    || packet.tag.time != 0)
+		 : (packet.tag.source == NULL
+		    || packet.tag.sourcelen != strlen(mp->tagsource)
+		    || strncmp(packet.tag.source, mp->tagsource,
+			       packet.tag.sourcelen) != 0
+		    || packet.tag.time != mp->tagtime))) {
+	printf("%2zi: %s test FAILED (tag block wrong).\n",
+	       mp - singletests + 1, mp->legend);
+	++failure;
+    }
+#endif /* NMEA_ENABLE */
+    else
 	printf("%2zi: %s test succeeded.\n", mp - singletests + 1,
 	       mp->legend);    /*@ +compdef +uniondef +usedef +formatcode @*/
 
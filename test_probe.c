@@ -0,0 +1,179 @@
+/*
+ * test_probe: replay a capture through the NMEA subtype probe schedule.
+ *
+ * The sentences in a capture are fed, one at a time, to a session whose
+ * device is one end of a socket pair, and gpsd_poll() takes each in the
+ * way the daemon would, so every packet fires the generic NMEA driver's
+ * configure hook and advances the probe schedule.  The replay runs far
+ * faster than the capture did, so after each sentence the session's
+ * clocks are wound back by the time the sentence would have taken on a
+ * 4800bps line; answers in the capture thus arrive when they would have
+ * relative to the probes.
+ *
+ * What comes out is the driver the session ended up with and, for each
+ * probe, the sentence it went out after.  The exit status is 1 if the
+ * schedule broke a rule: probing must be over by the end of the capture,
+ * and once a subtype is found no probe may go out or be left queued.
+ *
+ * Usage: test_probe [-v level] capture...
+ *
+ * This file is Copyright (c) 2010 by the GPSD project
+ * BSD terms apply: see the file COPYING in the distribution root for details.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include <errno.h>
+#include <time.h>
+#include <fcntl.h>
+#include <sys/types.h>
+#ifndef S_SPLINT_S
+#include <sys/socket.h>
+#include <unistd.h>
+#endif /* S_SPLINT_S */
+
+#include "gpsd.h"
+
+#define LINE_SPEED	4800	/* bits per second the capture is replayed at */
+
+static int verbose = 0;
+
+void gpsd_report(int errlevel, const char *fmt, ...)
+/* assemble command in printf(3) style, use stderr */
+{
+    if (errlevel <= verbose) {
+	char buf[BUFSIZ];
+	va_list ap;
+
+	buf[0] = '\0';
+	va_start(ap, fmt);
+	(void)vsnprintf(buf, sizeof(buf), fmt, ap);
+	va_end(ap);
+
+	(void)fputs(buf, stderr);
+    }
+}
+
+static bool replay(const char *path)
+/* run one capture past the probe schedule, report, and check the rules */
+{
+    static struct gps_context_t context;
+    static struct gps_device_t session;
+    unsigned int sentence = 0, count = 0, ended = 0, i;
+    unsigned int at[PROBE_TRANSCRIPT];
+    const char *name = strrchr(path, '/');
+    const char *result = "no driver";
+    char line[BUFSIZ], wire[BUFSIZ];
+    bool ok = true;
+    int fds[2];
+    FILE *fp;
+
+    name = (name != NULL) ? name + 1 : path;
+    if ((fp = fopen(path, "r")) == NULL) {
+	(void)fprintf(stderr, "test_probe: can't open %s: %s\n",
+		      path, strerror(errno));
+	return false;
+    }
+    if (socketpair(AF_UNIX, SOCK_STREAM, 0, fds) == -1) {
+	(void)fprintf(stderr, "test_probe: socketpair: %s\n", strerror(errno));
+	exit(1);
+    }
+    (void)fcntl(fds[0], F_SETFL, fcntl(fds[0], F_GETFL) | O_NONBLOCK);
+    (void)fcntl(fds[1], F_SETFL, fcntl(fds[1], F_GETFL) | O_NONBLOCK);
+
+    (void)memset(&session, '\0', sizeof(session));
+    gps_context_init(&context);
+    gpsd_time_init(&context, time(NULL));
+    context.debug = verbose;
+    gpsd_init(&session, &context, path);
+    session.gpsdata.gps_fd = fds[0];
+    gpsd_clear(&session);
+
+    while (fgets(line, (int)sizeof(line), fp) != NULL) {
+	double elapsed = strlen(line) * 10.0 / LINE_SPEED;
+	bool done = session.probe.done;
+	unsigned int before = session.probe.count;
+	int tries;
+
+	if (line[0] == '#')
+	    continue;
+	sentence++;
+	if (write(fds[1], line, strlen(line)) == -1) {
+	    (void)fprintf(stderr, "test_probe: write: %s\n", strerror(errno));
+	    exit(1);
+	}
+	for (tries = 0; tries < 3; tries++)
+	    if ((gpsd_poll(&session) & PACKET_SET) != 0)
+		break;
+	/* the driver may want the sentence again, as in the daemon */
+	while (session.reparse)
+	    (void)gpsd_poll(&session);
+	/* what the device would have been sent; the replay ignores it */
+	while (read(fds[1], wire, sizeof(wire)) > 0)
+	    continue;
+	for (; count < session.probe.count && count < PROBE_TRANSCRIPT; count++)
+	    at[count] = sentence;
+	if (!done && session.probe.done) {
+	    /* later sentences may pick a driver by packet type alone */
+	    ended = sentence;
+	    result = session.device_type != NULL ?
+		session.device_type->type_name : "no driver";
+	}
+	if (done && session.probe.count > before) {
+	    (void)fprintf(stderr, "%s: probe sent after probing ended\n", name);
+	    ok = false;
+	}
+	session.opentime -= elapsed;
+	session.probe.quiet -= elapsed;
+    }
+    (void)fclose(fp);
+
+    (void)printf("%s: probing ended on %s after sentence %u of %u\n",
+		 name, result, ended, sentence);
+    for (i = 0; i < count; i++)
+	(void)printf("    %s after sentence %u\n",
+		     session.probe.transcript[i].name, at[i]);
+
+    if (!session.probe.done) {
+	(void)fprintf(stderr, "%s: probing never ended\n", name);
+	ok = false;
+    }
+    for (i = 0; i < session.outqueue.count; i++)
+	if (session.outqueue.msg[i].kind == write_probe
+	    && (i > 0 || session.outqueue.sent == 0)) {
+	    (void)fprintf(stderr, "%s: probe still queued after probing ended\n",
+			  name);
+	    ok = false;
+	}
+    session.outqueue.count = 0;
+    session.outqueue.used = session.outqueue.sent = 0;
+    (void)close(fds[0]);
+    (void)close(fds[1]);
+    return ok;
+}
+
+int main(int argc, char *argv[])
+{
+    int option;
+    bool ok = true;
+
+    while ((option = getopt(argc, argv, "v:")) != -1) {
+	switch (option) {
+	case 'v':
+	    verbose = atoi(optarg);
+	    break;
+	default:
+	    (void)fputs("usage: test_probe [-v level] capture...\n", stderr);
+	    exit(1);
+	}
+    }
+    if (optind == argc) {
+	(void)fputs("test_probe: need at least one capture file\n", stderr);
+	exit(1);
+    }
+    for (; optind < argc; optind++)
+	if (!replay(argv[optind]))
+	    ok = false;
+    exit(ok ? 0 : 1);
+}
@@ -0,0 +1,283 @@
+/*
+ * test_udpblast: measure sustained ingestion over a udp:// feed.
+ *
+ * The sentences in a capture are blasted at a loopback UDP feed, a few
+ * to a datagram, by a child process, as fast as the sender can go or
+ * at a fixed rate.  The parent opens the feed the way the daemon does,
+ * with gpsd_open() on a udp:// path, and drains it through
+ * generic_get(), so datagrams are read in batches and lexed one at a
+ * time exactly as in gpsd.  The result is one JSON object giving the
+ * rate achieved, how many datagrams each receive call returned, and
+ * how many were dropped as oversized or lost to socket-buffer overruns.
+ *
+ * Every datagram sent has to be accounted for as received or overrun,
+ * and every sentence in a received datagram has to come back out of
+ * the lexer; the exit status is 1 if not.  Overruns themselves are not
+ * an error, since they depend on the receive buffer (-b) and the rate.
+ *
+ * Usage: test_udpblast [-b rcvbuf] [-n datagrams] [-r rate] [-s sentences] [-v level] capture
+ *
+ * This file is Copyright (c) 2010 by the GPSD project
+ * BSD terms apply: see the file COPYING in the distribution root for details.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include <errno.h>
+#include <time.h>
+#include <sys/types.h>
+#include <sys/select.h>
+#include <sys/time.h>
+#ifndef S_SPLINT_S
+#include <sys/wait.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+#endif /* S_SPLINT_S */
+
+#include "gpsd.h"
+
+static int verbose = 0;
+
+void gpsd_report(int errlevel, const char *fmt, ...)
+/* assemble command in printf(3) style, use stderr */
+{
+    if (errlevel <= verbose) {
+	char buf[BUFSIZ];
+	va_list ap;
+
+	buf[0] = '\0';
+	va_start(ap, fmt);
+	(void)vsnprintf(buf, sizeof(buf), fmt, ap);
+	va_end(ap);
+
+	(void)fputs(buf, stderr);
+    }
+}
+
+static double monotonic(void)
+{
+    struct timespec ts;
+
+    (void)clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+/* sentences from the capture that the lexer accepts whole */
+static char **sentences;
+static size_t nsentences;
+
+static void load_capture(const char *path)
+/* collect the NMEA and AIVDM sentences in a capture */
+{
+    static struct gps_packet_t lexer;
+    char line[BUFSIZ];
+    FILE *fp;
+
+    if ((fp = fopen(path, "r")) == NULL) {
+	(void)fprintf(stderr, "test_udpblast: can't open %s: %s\n",
+		      path, strerror(errno));
+	exit(1);
+    }
+    while (fgets(line, (int)sizeof(line), fp) != NULL) {
+	size_t len = strlen(line);
+
+	if ((line[0] != '$' && line[0] != '!') || len > MAX_PACKET_LENGTH)
+	    continue;
+	packet_init(&lexer);
+	(void)memcpy(lexer.inbuffer, line, len);
+	lexer.inbuflen = len;
+	packet_parse(&lexer);
+	if (lexer.outbuflen != len
+	    || (lexer.type != NMEA_PACKET && lexer.type != AIVDM_PACKET))
+	    continue;
+	sentences = (char **)realloc(sentences,
+				     (nsentences + 1) * sizeof(char *));
+	if (sentences == NULL || (sentences[nsentences] = strdup(line)) == NULL) {
+	    (void)fputs("test_udpblast: out of memory\n", stderr);
+	    exit(1);
+	}
+	nsentences++;
+    }
+    (void)fclose(fp);
+    if (nsentences == 0) {
+	(void)fprintf(stderr, "test_udpblast: no sentences in %s\n", path);
+	exit(1);
+    }
+}
+
+static void blast(unsigned short port, unsigned long count, double rate,
+		  int per)
+/* send count datagrams of per sentences each to the loopback port */
+{
+    struct sockaddr_in addr;
+    char buf[UDP_DATAGRAM_MAX];
+    size_t next = 0;
+    unsigned long n;
+    double start = monotonic();
+    int sock, i;
+
+    if ((sock = socket(PF_INET, SOCK_DGRAM, IPPROTO_UDP)) < 0) {
+	(void)fprintf(stderr, "test_udpblast: socket: %s\n", strerror(errno));
+	_exit(1);
+    }
+    (void)memset(&addr, '\0', sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = htons(port);
+    if (connect(sock, (struct sockaddr *)&addr, sizeof(addr)) == -1) {
+	(void)fprintf(stderr, "test_udpblast: connect: %s\n", strerror(errno));
+	_exit(1);
+    }
+    for (n = 0; n < count; n++) {
+	size_t len = 0;
+
+	for (i = 0; i < per; i++) {
+	    size_t slen = strlen(sentences[next]);
+
+	    if (len + slen > sizeof(buf))
+		break;
+	    (void)memcpy(buf + len, sentences[next], slen);
+	    len += slen;
+	    next = (next + 1) % nsentences;
+	}
+	/*
+	 * Overrun counts ride on the datagrams that do get through, so
+	 * let the receiver catch up before the last one goes out.
+	 */
+	if (n == count - 1) {
+	    struct timespec ts = {0, 200000000};
+	    (void)nanosleep(&ts, NULL);
+	} else if (rate > 0) {
+	    double ahead = start + n / rate - monotonic();
+
+	    if (ahead > 0) {
+		struct timespec ts;
+
+		ts.tv_sec = (time_t)ahead;
+		ts.tv_nsec = (long)((ahead - ts.tv_sec) * 1e9);
+		(void)nanosleep(&ts, NULL);
+	    }
+	}
+	if (send(sock, buf, len, 0) == -1)
+	    (void)fprintf(stderr, "test_udpblast: send: %s\n",
+			  strerror(errno));
+    }
+    (void)close(sock);
+    _exit(0);
+}
+
+int main(int argc, char *argv[])
+{
+    static struct gps_context_t context;
+    static struct gps_device_t session;
+    struct sockaddr_in addr;
+    socklen_t addrlen = sizeof(addr);
+    unsigned long count = 100000, packets = 0, expected = 0;
+    double rate = 0, first = 0, burst = 0, last = 0;
+    int option, per = 1, status;
+    bool ok;
+    pid_t child;
+
+    gps_context_init(&context);
+    while ((option = getopt(argc, argv, "b:n:r:s:v:")) != -1) {
+	switch (option) {
+	case 'b':
+	    context.udp_rcvbuf = atoi(optarg);
+	    break;
+	case 'n':
+	    count = strtoul(optarg, NULL, 0);
+	    break;
+	case 'r':
+	    rate = atof(optarg);
+	    break;
+	case 's':
+	    per = atoi(optarg);
+	    break;
+	case 'v':
+	    verbose = atoi(optarg);
+	    break;
+	default:
+	    (void)fputs("usage: test_udpblast [-b rcvbuf] [-n datagrams] "
+			"[-r rate] [-s sentences] [-v level] capture\n",
+			stderr);
+	    exit(1);
+	}
+    }
+    if (optind != argc - 1 || per < 1) {
+	(void)fputs("test_udpblast: need one capture file\n", stderr);
+	exit(1);
+    }
+    load_capture(argv[optind]);
+
+    /* port 0 has the kernel pick a free one */
+    context.debug = verbose;
+    gpsd_init(&session, &context, "udp://0");
+    session.packet.debug = verbose;
+    if (gpsd_open(&session) < 0) {
+	(void)fputs("test_udpblast: can't open the UDP feed\n", stderr);
+	exit(1);
+    }
+    if (getsockname(session.gpsdata.gps_fd,
+		    (struct sockaddr *)&addr, &addrlen) == -1) {
+	(void)fprintf(stderr, "test_udpblast: getsockname: %s\n",
+		      strerror(errno));
+	exit(1);
+    }
+
+    if ((child = fork()) == -1) {
+	(void)fprintf(stderr, "test_udpblast: fork: %s\n", strerror(errno));
+	exit(1);
+    } else if (child == 0) {
+	(void)close(session.gpsdata.gps_fd);
+	blast(ntohs(addr.sin_port), count, rate, per);
+    }
+
+    /* drain until the sender is done and the feed has gone quiet */
+    for (;;) {
+	fd_set fds;
+	struct timeval tv;
+	ssize_t got;
+
+	FD_ZERO(&fds);
+	FD_SET(session.gpsdata.gps_fd, &fds);
+	tv.tv_sec = 1;
+	tv.tv_usec = 0;
+	if (select(session.gpsdata.gps_fd + 1, &fds, NULL, NULL, &tv) <= 0)
+	    break;
+	while ((got = generic_get(&session)) > 0) {
+	    if (first == 0)
+		first = monotonic();
+	    if (session.packet.outbuflen > 0)
+		packets++;
+	}
+	/* the last datagram comes after a pause; leave it out of the rate */
+	burst = last;
+	last = monotonic();
+	if (got < 0) {
+	    (void)fprintf(stderr, "test_udpblast: read error: %s\n",
+			  strerror(errno));
+	    break;
+	}
+    }
+    (void)waitpid(child, &status, 0);
+
+    /* a truncated datagram may have lost the end of its last sentence */
+    expected = (session.udp.datagrams - session.udp.drops) * per;
+    ok = session.udp.datagrams + session.udp.overruns == count
+	&& packets == expected;
+    (void)printf("{\"class\":\"UDPBLAST\",\"sent\":%lu,\"received\":%lu,"
+		 "\"reads\":%lu,\"per_read\":%.1f,\"drops\":%lu,"
+		 "\"overruns\":%lu,\"packets\":%lu,\"expected\":%lu,"
+		 "\"seconds\":%.6f,\"datagrams_sec\":%.1f,\"ok\":%s}\n",
+		 count, session.udp.datagrams, session.udp.reads,
+		 session.udp.reads > 0 ?
+		 (double)session.udp.datagrams / session.udp.reads : 0,
+		 session.udp.drops, session.udp.overruns,
+		 packets, expected, burst > first ? burst - first : 0,
+		 burst > first ? (session.udp.datagrams - 1) / (burst - first) : 0,
+		 ok ? "true" : "false");
+    exit(ok ? 0 : 1);
+}